@@ -16,6 +16,11 @@
 /// @since  2017-09-21
 /// @brief  Container class for multiple sequences of data wrapped by markers
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
 namespace o2 {
 
 namespace algorithm {
@@ -39,7 +44,12 @@ namespace algorithm {
  *   marker or the trailer marker. The first requires forward, the latter
  *   backward parsing. In the first case, the trailer is optional, while
  *   in the latter required
+ * - the column description must provide operator<
  *
+ * The index is flat: the frames of all rows are stored contiguously, each
+ * row sorted by column, and the columns in a sorted vector. A dense table
+ * of the frame positions for every row and column is built on the first
+ * access after new columns have been added, giving constant time access.
  */
 template<typename RowDescT, // row description
          typename ColumnDescT, // column description
@@ -54,24 +64,18 @@ public:
   using ColumnIndexType = ColumnDescT;
   using ParserType = ParserT;
 
-  /// FrameIndex is composed from column description and row number
-  struct FrameIndex {
-    ColumnIndexType columnIndex;
-    unsigned row;
-
-    bool operator<(const FrameIndex& rh) const {
-      if (rh.columnIndex < columnIndex) return false;
-      if (columnIndex < rh.columnIndex) return true;
-      return row < rh.row;
-    }
-  };
-
   /// descriptor pointing to payload of one frame
   struct FrameData {
     const byte* buffer = nullptr;
     size_t size = 0;
   };
 
+  /// frame together with its column description
+  struct ColumnFrame {
+    ColumnIndexType columnIndex;
+    FrameData data;
+  };
+
   /**
    * Add a new data sequence, the set is traversed according to parser
    *
@@ -84,8 +88,7 @@ public:
    * @return number of inserted elements
    */
   size_t addRow(RowDescType rowData, byte* seqData, size_t seqSize) {
-    unsigned nFrames = mFrames.size();
-    unsigned currentRow = mRowData.size();
+    std::vector<ColumnFrame> frames;
     ParserType p;
     p.parse(seqData, seqSize,
             [](const typename ParserT::HeaderType& h) {return (h);},
@@ -93,34 +96,81 @@ public:
             [](const typename ParserT::TrailerType& t) {
               return t.dataLength + ParserT::totalOffset;
             },
-            [this, currentRow](typename ParserT::FrameInfo entry) {
-              // insert the header as column index in ascending order
-              auto position = mColumns.begin();
-              while (position != mColumns.end() && *position < *entry.header) {
-                position++;
-              }
-              if (position == mColumns.end() || *entry.header < *position) {
-                mColumns.emplace(position, *entry.header);
-              }
-
-              // insert frame descriptor under key composed from header and row
-              auto result = mFrames.emplace(FrameIndex{*entry.header, currentRow},
-                                            FrameData{entry.payload, entry.length});
-              return result.second;
+            [&frames](typename ParserT::FrameInfo entry) {
+              frames.emplace_back(ColumnFrame{*entry.header, FrameData{entry.payload, entry.length}});
+              return true;
             }
             );
-    auto insertedFrames = mFrames.size() - nFrames;
-    if (insertedFrames > 0) {
-      mRowData.emplace_back(rowData);
+    return addFrames(rowData, std::move(frames));
+  }
+
+  /**
+   * Add a new row from a list of frames in any order, e.g. from a sequence
+   * parsed already.
+   *
+   * A frame with the column description of a previous frame in the list ends
+   * the row, it is not inserted together with all the following ones.
+   *
+   * @param rowData   Descriptive data struct for the sequence
+   * @param frames    Frames with their column descriptions
+   * @return number of inserted elements
+   */
+  size_t addFrames(RowDescType rowData, std::vector<ColumnFrame> frames) {
+    // order the frames by column, keeping the input order for equal columns
+    std::vector<unsigned> order(frames.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&frames](unsigned a, unsigned b) {
+      return frames[a].columnIndex < frames[b].columnIndex;
+    });
+    size_t nFrames = frames.size();
+    for (size_t i = 1; i < order.size(); ++i) {
+      if (!(frames[order[i - 1]].columnIndex < frames[order[i]].columnIndex)) {
+        nFrames = std::min<size_t>(nFrames, order[i]);
+      }
+    }
+    if (nFrames == 0) {
+      return 0;
+    }
+
+    // columns not yet in the index are merged in one pass
+    std::vector<ColumnIndexType> newColumns;
+    mRowOffsets.emplace_back(mFrames.size());
+    for (auto i : order) {
+      if (i >= nFrames) continue;
+      if (!std::binary_search(mColumns.begin(), mColumns.end(), frames[i].columnIndex)) {
+        newColumns.emplace_back(frames[i].columnIndex);
+      }
+      mFrames.emplace_back(frames[i]);
     }
-    return insertedFrames;
+    mRowData.emplace_back(rowData);
+    if (newColumns.empty()) {
+      if (mIndexValid) addToIndex(mRowData.size() - 1);
+    } else {
+      std::vector<ColumnIndexType> columns;
+      columns.reserve(mColumns.size() + newColumns.size());
+      std::merge(mColumns.begin(), mColumns.end(), newColumns.begin(), newColumns.end(),
+                 std::back_inserter(columns));
+      mColumns.swap(columns);
+      mIndexValid = false;
+    }
+    return nFrames;
+  }
+
+  /// reserve space for the given numbers of rows and frames
+  void reserve(size_t nRows, size_t nFrames) {
+    mRowData.reserve(nRows);
+    mRowOffsets.reserve(nRows);
+    mFrames.reserve(nFrames);
   }
 
   /// clear the index, i.e. all internal lists
   void clear() {
     mFrames.clear();
+    mRowOffsets.clear();
     mColumns.clear();
     mRowData.clear();
+    mIndex.clear();
+    mIndexValid = true;
   }
 
   /// get number of columns in the created index
@@ -285,25 +335,57 @@ public:
   }
 
 private:
+  static const unsigned kInvalidFrame = std::numeric_limits<unsigned>::max();
+
   /// private access function for the iterators
   bool get(unsigned row, unsigned column, FrameData& data) {
-    if (this->mColumns.size() == 0) return false;
-    auto element = this->mFrames.find(FrameIndex{this->mColumns[column], row});
-    if (element != this->mFrames.end()) {
-      data = element->second;
-      return true;
+    if (row >= mRowData.size() || column >= mColumns.size()) return false;
+    if (!mIndexValid) buildIndex();
+    auto frame = mIndex[row * mColumns.size() + column];
+    if (frame == kInvalidFrame) return false;
+    data = mFrames[frame].data;
+    return true;
+  }
+
+  /// fill the positions of the frames of one row in the dense index, the
+  /// frames of the row and the columns are both sorted
+  void addToIndex(size_t row) {
+    auto nColumns = mColumns.size();
+    mIndex.resize((row + 1) * nColumns, kInvalidFrame);
+    auto end = row + 1 < mRowOffsets.size() ? mRowOffsets[row + 1] : mFrames.size();
+    auto column = mColumns.begin();
+    for (auto frame = mRowOffsets[row]; frame < end; ++frame) {
+      column = std::lower_bound(column, mColumns.end(), mFrames[frame].columnIndex);
+      mIndex[row * nColumns + (column - mColumns.begin())] = frame;
     }
-    return false;
   }
 
-  /// map of frame descriptors with key composed from header and row number
-  std::map<FrameIndex, FrameData> mFrames;
+  void buildIndex() {
+    mIndex.clear();
+    mIndex.reserve(mRowData.size() * mColumns.size());
+    for (size_t row = 0; row < mRowData.size(); ++row) {
+      addToIndex(row);
+    }
+    mIndexValid = true;
+  }
+
+  /// frame descriptors, row by row, each row sorted by column
+  std::vector<ColumnFrame> mFrames;
+  /// position of the first frame of each row
+  std::vector<size_t> mRowOffsets;
   /// list of indices in row direction
   std::vector<ColumnIndexType> mColumns;
   /// data descriptor of each row forming the columns
   std::vector<RowDescType> mRowData;
+  /// position of the frame for every row and column, kInvalidFrame if none
+  std::vector<unsigned> mIndex;
+  /// the index is built on demand after columns have been added
+  bool mIndexValid = true;
 };
 
+template<typename RowDescT, typename ColumnDescT, typename ParserT>
+const unsigned TableView<RowDescT, ColumnDescT, ParserT>::kInvalidFrame;
+
 } // namespace algorithm
 
 } // namespace o2
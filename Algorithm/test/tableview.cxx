@@ -120,3 +120,56 @@ BOOST_AUTO_TEST_CASE(test_tableview_reverse)
     BOOST_CHECK(rowidx == requiredNofRowsInColumn[colidx]);
   }
 }
+
+BOOST_AUTO_TEST_CASE(test_tableview_addframes)
+{
+  using ParserT = o2::algorithm::ReverseParser<HeartbeatHeader, HeartbeatTrailer>;
+  using ViewType = o2::algorithm::TableView<unsigned, HeartbeatHeader, ParserT>;
+  using ColumnFrame = typename ViewType::ColumnFrame;
+  ViewType view;
+
+  const char* payload = "0123456789";
+  auto frame = [payload](uint64_t header, unsigned offset, size_t size) {
+    return ColumnFrame{HeartbeatHeader{header}, {reinterpret_cast<const byte*>(payload) + offset, size}};
+  };
+
+  // frames in any order, the column of a previous frame ends the row
+  BOOST_CHECK(view.addFrames(0, {frame(0x1100000000000003, 3, 1),
+                                 frame(0x1100000000000001, 1, 1),
+                                 frame(0x1100000000000003, 9, 1),
+                                 frame(0x1100000000000000, 0, 1)}) == 2);
+  BOOST_CHECK(view.addFrames(1, {}) == 0);
+  BOOST_REQUIRE(view.getNRows() == 1);
+  BOOST_REQUIRE(view.getNColumns() == 2);
+
+  unsigned colidx = 0;
+  for (auto columnIt = view.begin(), end = view.end(); columnIt != end; ++columnIt, ++colidx) {
+    for (auto row : columnIt) {
+      BOOST_CHECK(row.size == 1);
+      BOOST_CHECK(*row.buffer == payload[colidx == 0 ? 1 : 3]);
+    }
+  }
+  BOOST_CHECK(colidx == 2);
+
+  // rows without new columns extend the index, new columns rebuild it
+  BOOST_CHECK(view.addFrames(1, {frame(0x1100000000000003, 4, 2)}) == 1);
+  BOOST_CHECK(view.addFrames(2, {frame(0x1100000000000002, 2, 1),
+                                 frame(0x1100000000000001, 5, 1)}) == 2);
+  BOOST_REQUIRE(view.getNRows() == 3);
+  BOOST_REQUIRE(view.getNColumns() == 3);
+  unsigned requiredNofRowsInColumn[] = {2, 1, 2};
+  colidx = 0;
+  for (auto columnIt = view.begin(), end = view.end(); columnIt != end; ++columnIt, ++colidx) {
+    unsigned nRows = 0;
+    for (auto row : columnIt) {
+      BOOST_CHECK(row.buffer != nullptr);
+      ++nRows;
+    }
+    BOOST_CHECK(nRows == requiredNofRowsInColumn[colidx]);
+  }
+  BOOST_CHECK(colidx == 3);
+
+  view.clear();
+  BOOST_CHECK(view.getNRows() == 0);
+  BOOST_CHECK(view.getNColumns() == 0);
+}
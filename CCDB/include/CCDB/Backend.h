@@ -42,6 +42,10 @@ public:
   /// Serializes a key (and optionally value) to an std::string using Protocol Buffers
   void Serialize(std::string*& messageString, const std::string& key, const std::string& operationType,
                  const std::string& dataSource, const std::string& object = std::string());
+
+  /// Serializes a batch of keys, answered by the server with one message part per key
+  void Serialize(std::string*& messageString, const std::vector<std::string>& keys, const std::string& operationType,
+                 const std::string& dataSource);
 };
 }
 }
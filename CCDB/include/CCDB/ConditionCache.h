@@ -0,0 +1,155 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef ALICEO2_CDB_CONDITIONCACHE_H_
+#define ALICEO2_CDB_CONDITIONCACHE_H_
+
+//  class  ConditionCache
+//  thread-safe LRU cache of the retrieved conditions, keyed by path and run range. The paths are spread over
+//  independently locked shards, the recency order and the byte budget are global
+#include "Rtypes.h" // for Int_t, ULong64_t
+#include <array>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace o2 {
+namespace CDB {
+
+class Condition;
+
+class ConditionCache
+{
+  public:
+    struct Statistics {
+      ULong64_t hits = 0;
+      ULong64_t misses = 0;
+      ULong64_t evictions = 0;
+      ULong64_t entries = 0;
+      ULong64_t bytes = 0; // measured only while a budget is set
+    };
+
+    ConditionCache();
+
+    ~ConditionCache();
+
+    ConditionCache(const ConditionCache &) = delete;
+
+    ConditionCache &operator=(const ConditionCache &) = delete;
+
+    // budget on the serialized size of the cached objects, 0 for no limit. The objects are streamed to
+    // measure their size only while a budget is set
+    void setBudget(ULong64_t bytes);
+
+    ULong64_t getBudget() const
+    {
+      return mBudget;
+    }
+
+    // entries valid for the current run are in use and never evicted
+    void setCurrentRun(Int_t run)
+    {
+      mCurrentRun = run;
+    }
+
+    // cached object for path whose run range contains run, nullptr if none.
+    // Unless pinned or valid for the current run, the object may be evicted by any later add; with pin the
+    // object found is pinned under the same lock as the lookup
+    Condition *get(const std::string &path, Int_t run, Bool_t countMiss = kTRUE, Bool_t pin = kFALSE);
+
+    Bool_t contains(const std::string &path) const;
+
+    // takes ownership of entry, cached for its own run range. If an object is already cached for the same
+    // path and run range nothing is done and kFALSE is returned, the entry staying owned by the caller
+    Bool_t add(const std::string &path, Condition *entry);
+
+    // as add, but returns the object cached for the path and run range of entry: entry itself when added,
+    // otherwise the object cached before, entry then staying owned by the caller. With pin the returned
+    // object is pinned before any eviction can happen
+    Condition *getOrAdd(const std::string &path, Condition *entry, Bool_t pin = kFALSE);
+
+    // pinned objects are not evicted until unpinned as many times as pinned
+    Bool_t pin(const std::string &path, Int_t run);
+
+    void unpin(const std::string &path, Int_t run);
+
+    // unpin the cached object itself, whatever other objects of the path are valid for its runs
+    void unpin(const std::string &path, const Condition *entry);
+
+    // delete the objects of the paths selected by the predicate, return their number
+    Int_t remove(const std::function<Bool_t(const std::string &)> &selectPath);
+
+    void clear();
+
+    Statistics getStatistics() const;
+
+    // paths and objects currently cached
+    std::vector<std::pair<std::string, Condition *>> getEntries() const;
+
+    static ULong64_t getSerializedSize(const Condition *entry);
+
+  private:
+    struct Item {
+      std::string path;
+      Int_t firstRun;
+      Int_t lastRun;
+      std::unique_ptr<Condition> entry;
+      ULong64_t bytes;    // serialized size, 0 if not measured because no budget was set
+      Int_t pins;
+      ULong64_t lastUse;  // value of the global clock at the last access
+    };
+
+    using ItemList = std::list<Item>;
+
+    // the paths are distributed over independently locked shards, each with its own list in order of use (most
+    // recently used first); the last use of the items is taken from a global clock to compare them across shards
+    struct Shard {
+      mutable std::mutex mutex;
+      ItemList lru;
+      std::unordered_map<std::string, std::vector<ItemList::iterator>> byPath;
+      ULong64_t hits = 0;
+      ULong64_t misses = 0;
+      ULong64_t evictions = 0;
+    };
+
+    static constexpr size_t kNShards = 16;
+
+    Shard &getShard(const std::string &path) const;
+
+    ItemList::iterator find(Shard &shard, const std::string &path, Int_t run) const;
+
+    void erase(Shard &shard, ItemList::iterator item);
+
+    // release a pin of the item found in the shard, enforcing the budget once the shard is unlocked
+    void unpin(Shard &shard, const std::function<ItemList::iterator(Shard &)> &findItem);
+
+    // least recently used object of the shard (which must be locked) which can be evicted, neither in use nor
+    // being keep; end of the list if none
+    ItemList::iterator findEvictable(Shard &shard, const Condition *keep) const;
+
+    // evict the least recently used objects across the shards while over budget; a single shard is locked at
+    // a time, none must be locked by the caller
+    void enforceBudget(const Condition *keep = nullptr);
+
+    mutable std::array<Shard, kNShards> mShards;
+    std::atomic<ULong64_t> mBytes{ 0 };
+    std::atomic<ULong64_t> mBudget{ 0 };
+    std::atomic<Int_t> mCurrentRun{ -1 };
+    std::atomic<ULong64_t> mClock{ 0 };
+};
+}
+}
+#endif
@@ -0,0 +1,83 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef ALICEO2_CDB_CONDITIONIDINDEX_H_
+#define ALICEO2_CDB_CONDITIONIDINDEX_H_
+
+//  class  ConditionIdIndex
+//  in-memory index of the run ranges and versions of the objects stored for one calibration path
+#include "Rtypes.h" // for Int_t, Long64_t
+#include <cstddef>
+#include <map>
+#include <vector>
+
+namespace o2 {
+namespace CDB {
+
+class ConditionIdIndex
+{
+  public:
+    struct Entry {
+      Int_t firstRun;
+      Int_t lastRun;
+      Int_t version;
+      Int_t subVersion;
+    };
+
+    void add(Int_t firstRun, Int_t lastRun, Int_t version, Int_t subVersion);
+
+    void clear();
+
+    size_t size() const
+    {
+      return mEntries.size();
+    };
+
+    const std::vector<Entry> &getEntries() const
+    {
+      return mEntries;
+    };
+
+    // object with the highest version and subVersion (or with the highest subVersion of the given version
+    // if version >= 0) whose run range contains [firstRun, lastRun]; nullptr if none.
+    // ambiguous is set if another object has the same version and subVersion.
+    // Single run queries are resolved in O(log n) on the elementary run intervals, run range queries scan
+    // the entries
+    const Entry *findHighest(Int_t firstRun, Int_t lastRun, Int_t version, bool &ambiguous) const;
+
+    // object with the given version and subVersion whose run range contains [firstRun, lastRun]
+    const Entry *find(Int_t firstRun, Int_t lastRun, Int_t version, Int_t subVersion) const;
+
+  private:
+    // elementary run intervals [mStart[i], mStart[i+1]) with the index of the highest (sub)version
+    // object valid in each of them (-1 if none)
+    struct Segments {
+      std::vector<Long64_t> mStart;
+      std::vector<Int_t> mBest;
+      std::vector<bool> mAmbiguous;
+    };
+
+    void build() const;
+
+    void buildSegments(const std::vector<Int_t> &entries, Segments &segments) const;
+
+    const Entry *findInSegments(const Segments &segments, Int_t run, bool &ambiguous) const;
+
+    std::vector<Entry> mEntries;
+
+    // lookup tables, rebuilt on the first query after an add
+    mutable bool mBuilt = false;
+    mutable Segments mAllVersions;
+    mutable std::map<Int_t, Segments> mPerVersion;
+    mutable std::map<Int_t, std::vector<Int_t>> mVersionEntries;
+};
+}
+}
+#endif
@@ -18,13 +18,20 @@
 #ifndef ALICEO2_CDB_CONDITIONSMQCLIENT_H_
 #define ALICEO2_CDB_CONDITIONSMQCLIENT_H_
 
+#include <map>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <FairMQDevice.h>
 
 namespace o2 {
 namespace CDB {
 
+class Backend;
+class Condition;
+
 class ConditionsMQClient : public FairMQDevice {
 public:
   ConditionsMQClient();
@@ -40,7 +47,17 @@ private:
   std::string mOperationType;
   std::string mDataSource;
   std::string mObjectPath;
+  int mPrefetchRuns;
+
+  /// Conditions received in advance, by identifier and run
+  std::map<std::pair<std::string, int>, std::unique_ptr<Condition>> mPrefetched;
+
+  /// Gets the conditions of the keys not prefetched in a single round-trip, then prefetches the conditions of
+  /// the mPrefetchRuns runs following the requested ones
+  void getConditions(Backend* backend, const std::vector<std::string>& keys);
 
+  /// Sends a batch request, the conditions are returned in the order of the keys (nullptr if not found)
+  std::vector<std::unique_ptr<Condition>> requestConditions(Backend* backend, const std::vector<std::string>& keys);
 };
 }
 }
@@ -18,11 +18,18 @@
 #ifndef ALICEO2_CDB_CONDITIONSMQSERVER_H_
 #define ALICEO2_CDB_CONDITIONSMQSERVER_H_
 
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include "CCDB/Manager.h"
 #include "ParameterMQServer.h"
 
+class TMessage;
+
 namespace o2 {
 namespace CDB {
 
@@ -37,15 +44,52 @@ public:
   void InitTask() override;
 
 private:
+  using Blob = std::shared_ptr<TMessage>;
+
+  /// Serialized condition shared by the replies, with its position in the LRU list
+  struct BlobEntry {
+    std::shared_future<Blob> blob;
+    std::list<std::string>::iterator position;
+    ULong64_t bytes; // 0 while being serialized
+  };
+
   Manager* mCdbManager;
 
-  void getFromOCDB(std::string key);
+  /// Serialized conditions by identifier and run, so that repeated requests are not streamed again
+  std::mutex mBlobMutex;
+  std::list<std::string> mBlobLru; // most recently used first
+  std::unordered_map<std::string, BlobEntry> mBlobs;
+  ULong64_t mBlobBytes;
+  ULong64_t mBlobBudget;
+
+  /// The broker is queried by one worker at a time
+  std::mutex mBrokerMutex;
+  int mBrokerTimeout;       // ms
+  bool mBrokerReplyPending; // the last request timed out, its reply is still to be received
+
+  /// Serves the requests of one data-get sub-socket, one worker thread per sub-socket
+  void serveRequests(int index);
+
+  /// Forwards a request to the broker, false if it could not be sent or no reply came within the timeout
+  bool queryBroker(std::unique_ptr<FairMQMessage>& request, std::unique_ptr<FairMQMessage>& reply);
+
+  /// Waits for the broker reply until the timeout or until the device leaves the running state
+  bool receiveFromBroker(std::unique_ptr<FairMQMessage>& reply);
+
+  /// Retrieves the serialized condition for a key like "/DET/Calib/Histo/Run2008_2008_v1_s0", nullptr if not found
+  Blob getFromOCDB(std::string key);
+
+  /// Serializes the condition valid for the run, or waits for the worker already doing it
+  Blob getBlob(const std::string& identifier, int runId);
+
+  /// Drops the least recently used serialized conditions above the budget, mBlobMutex must be locked
+  void evictBlobs();
+
+  /// Wraps a serialized condition in a message without copying it, an empty message if nullptr
+  std::unique_ptr<FairMQMessage> createReply(const Blob& blob);
 
   /// Parses a serialized message for a data source entry
   void ParseDataSource(std::string& dataSource, const std::string& data);
-
-  /// Deserializes a message and stores the value to an std::string using Protocol Buffers
-  void Deserialize(const std::string& messageString, std::string& key);
 };
 }
 }
@@ -13,10 +13,13 @@
 
 //  class  LocalStorage						   //
 //  access class to a DataBase in a local storage                  //
+#include "CCDB/ConditionIdIndex.h" // for ConditionIdIndex
 #include "CCDB/Manager.h"  // for StorageFactory, StorageParameters
 #include "Rtypes.h"   // for Bool_t, Int_t, ClassDef, LocalStorage::Class, etc
 #include "CCDB/Storage.h"  // for Storage
 #include "TString.h"  // for TString
+#include <map>        // for map
+#include <string>     // for string
 
 class TList;
 
@@ -49,6 +52,11 @@ class LocalStorage : public Storage
 
     void setRetry(Int_t /* nretry */, Int_t /* initsec */) override;
 
+    // The run ranges and versions of the stored objects are indexed in memory per path on first use, so that
+    // the validity lookups do not access the filesystem. Objects stored through this instance are added to
+    // the index, those written by other processes are seen after a refresh of their path (or of all paths)
+    void refreshIndex(const char *path = nullptr);
+
   protected:
     Condition *getCondition(const ConditionId &queryId) override;
 
@@ -84,7 +92,10 @@ class LocalStorage : public Storage
 
     void getEntriesForLevel1(const char *level0, const char *Level1, const ConditionId &query, TList *result);
 
+    const ConditionIdIndex &getIndex(const TString &path);
+
     TString mBaseDirectory; // path of the DB folder
+    std::map<std::string, ConditionIdIndex> mIndex; //! index of the stored objects per path
 
   ClassDefOverride(LocalStorage, 0) // access class to a DataBase in a local storage
 };
@@ -15,6 +15,8 @@
 #include <TMap.h>     // for TMap
 #include <TObject.h>  // for TObject
 #include <cstddef>   // for NULL
+#include <mutex>     // for mutex
+#include "CCDB/ConditionCache.h" // for ConditionCache
 #include "Rtypes.h"   // for Int_t, Bool_t, kFALSE, kTRUE, ClassDef, etc
 #include "TString.h"  // for TString
 #include <CCDB/TObjectWrapper.h>
@@ -134,7 +136,11 @@ class Manager : public TObject
       return mOcdbUploadMode;
     }
 
-    Condition *getCondition(const ConditionId &query, Bool_t forceCaching = kFALSE);
+    // with forceCaching the object is cached even if the query is not for the current run, and a single run
+    // query is looked up in the cache by its own run. With pin a cached object is pinned together with its
+    // lookup, so that concurrent retrievals cannot evict it before the caller is done: release it with
+    // unpinCondition(entry). An object which could not be cached is not pinned
+    Condition *getCondition(const ConditionId &query, Bool_t forceCaching = kFALSE, Bool_t pin = kFALSE);
 
     Condition *getCondition(const IdPath &path, Int_t runNumber = -1, Int_t version = -1, Int_t subVersion = -1);
 
@@ -170,6 +176,27 @@ class Manager : public TObject
       return mCache;
     }
 
+    // Limit the serialized size of the cached objects, least recently used ones being evicted (0: no limit).
+    // With a budget the cache is kept when the run changes, objects being looked up by run range; the objects
+    // valid for the current run and the pinned ones are never evicted.
+    // Cached objects are looked up concurrently, retrievals from the storages are serialized.
+    void setCacheBudget(ULong64_t bytes)
+    {
+      mConditionCache.setBudget(bytes);
+    }
+
+    // keep the cached object of path valid for run (current run if -1) through run changes and evictions
+    Bool_t pinCondition(const char *path, Int_t run = -1);
+
+    void unpinCondition(const char *path, Int_t run = -1);
+
+    void unpinCondition(const Condition *entry);
+
+    ConditionCache::Statistics getCacheStatistics() const
+    {
+      return mConditionCache.getStatistics();
+    }
+
     ULong64_t setLock(Bool_t lockFlag = kTRUE, ULong64_t key = 0);
 
     Bool_t getLock() const
@@ -214,9 +241,9 @@ class Manager : public TObject
 
     void unloadFromCache(const char *path);
 
-    const TMap *getConditionCache() const
+    const ConditionCache &getConditionCache() const
     {
-      return &mConditionCache;
+      return mConditionCache;
     }
 
     static Manager *Instance(TMap *entryCache = nullptr, Int_t run = -1);
@@ -281,7 +308,9 @@ class Manager : public TObject
 
     void getLHCPeriodAgainstCvmfsFile(Int_t run, TString &lhcPeriod, Int_t &startRun, Int_t &endRun);
 
-    void cacheCondition(const char *path, Condition *entry);
+    // the cache takes the ownership of entry and returns it. If an object is already cached for the path and
+    // run range of entry, entry is deleted and the cached object returned. With pin the returned object is pinned
+    Condition *cacheCondition(const char *path, Condition *entry, Bool_t pin = kFALSE);
 
     StorageParameters *selectSpecificStorage(const TString &path);
 
@@ -294,7 +323,8 @@ class Manager : public TObject
     TList mFactories;       //! list of registered storage factories
     TMap mActiveStorages;   //! list of active storages
     TMap mSpecificStorages; //! list of detector-specific storages
-    TMap mConditionCache;       //! cache of the retrieved objects
+    ConditionCache mConditionCache; //! cache of the retrieved objects
+    std::mutex mStorageMutex;       //! serializes the retrievals from the storages in getCondition
 
     TList *mIds;       //! List of the retrieved object ConditionId's (to be streamed to file)
     TMap *mStorageMap; //! list of storages (to be streamed to file)
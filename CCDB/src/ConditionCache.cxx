@@ -0,0 +1,301 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// thread-safe LRU cache of the retrieved conditions, keyed by path and run range
+
+#include "CCDB/ConditionCache.h"
+#include <FairLogger.h>     // for LOG
+#include <TBufferFile.h>    // for TBufferFile
+#include "CCDB/Condition.h" // for Condition
+
+using namespace o2::CDB;
+
+ConditionCache::ConditionCache()
+{
+  // constructor
+}
+
+ConditionCache::~ConditionCache()
+{
+  // destructor, deletes the cached objects
+  clear();
+}
+
+ULong64_t ConditionCache::getSerializedSize(const Condition *entry)
+{
+  // size of the streamed object, used for the memory accounting
+
+  TBufferFile buffer(TBuffer::kWrite);
+  buffer.WriteObject(entry);
+  return buffer.Length();
+}
+
+ConditionCache::Shard &ConditionCache::getShard(const std::string &path) const
+{
+  return mShards[std::hash<std::string>()(path) % kNShards];
+}
+
+ConditionCache::ItemList::iterator ConditionCache::find(Shard &shard, const std::string &path, Int_t run) const
+{
+  auto items = shard.byPath.find(path);
+  if (items != shard.byPath.end()) {
+    for (auto item : items->second) {
+      if (item->firstRun <= run && run <= item->lastRun) {
+        return item;
+      }
+    }
+  }
+  return shard.lru.end();
+}
+
+Condition *ConditionCache::get(const std::string &path, Int_t run, Bool_t countMiss, Bool_t pin)
+{
+  Shard &shard = getShard(path);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto item = find(shard, path, run);
+  if (item == shard.lru.end()) {
+    if (countMiss) {
+      shard.misses++;
+    }
+    return nullptr;
+  }
+  shard.hits++;
+  if (pin) {
+    item->pins++;
+  }
+  item->lastUse = ++mClock;
+  shard.lru.splice(shard.lru.begin(), shard.lru, item); // most recently used first, iterators stay valid
+  return item->entry.get();
+}
+
+Bool_t ConditionCache::contains(const std::string &path) const
+{
+  Shard &shard = getShard(path);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  return shard.byPath.count(path) != 0;
+}
+
+void ConditionCache::setBudget(ULong64_t bytes)
+{
+  // the budget is set first: an object added concurrently is either measured by add or found here
+  mBudget = bytes;
+  if (!bytes) {
+    return;
+  }
+  for (auto &shard : mShards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (auto &item : shard.lru) {
+      if (!item.bytes) {
+        item.bytes = getSerializedSize(item.entry.get());
+        mBytes += item.bytes;
+      }
+    }
+  }
+  enforceBudget();
+}
+
+Bool_t ConditionCache::add(const std::string &path, Condition *entry)
+{
+  return getOrAdd(path, entry) == entry;
+}
+
+Condition *ConditionCache::getOrAdd(const std::string &path, Condition *entry, Bool_t pin)
+{
+  const ConditionId &id = entry->getId();
+  // the size is only needed for the budget, streaming big objects is expensive
+  ULong64_t bytes = mBudget ? getSerializedSize(entry) : 0;
+  {
+    Shard &shard = getShard(path);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto &items = shard.byPath[path];
+    for (auto item : items) {
+      if (item->firstRun == id.getFirstRun() && item->lastRun == id.getLastRun()) {
+        if (pin) {
+          item->pins++;
+        }
+        item->lastUse = ++mClock;
+        shard.lru.splice(shard.lru.begin(), shard.lru, item);
+        return item->entry.get();
+      }
+    }
+    if (!bytes && mBudget) {
+      // budget set meanwhile
+      bytes = getSerializedSize(entry);
+    }
+    shard.lru.push_front(
+      Item{ path, id.getFirstRun(), id.getLastRun(), std::unique_ptr<Condition>(entry), bytes, pin ? 1 : 0, ++mClock });
+    items.push_back(shard.lru.begin());
+    mBytes += bytes;
+  }
+  enforceBudget(entry);
+  return entry;
+}
+
+void ConditionCache::erase(Shard &shard, ItemList::iterator item)
+{
+  auto items = shard.byPath.find(item->path);
+  auto &list = items->second;
+  for (size_t i = 0; i < list.size(); i++) {
+    if (list[i] == item) {
+      list.erase(list.begin() + i);
+      break;
+    }
+  }
+  if (list.empty()) {
+    shard.byPath.erase(items);
+  }
+  mBytes -= item->bytes;
+  shard.lru.erase(item);
+}
+
+ConditionCache::ItemList::iterator ConditionCache::findEvictable(Shard &shard, const Condition *keep) const
+{
+  Int_t run = mCurrentRun;
+  for (auto item = shard.lru.end(); item != shard.lru.begin();) {
+    --item;
+    if (item->pins == 0 && !(item->firstRun <= run && run <= item->lastRun) && item->entry.get() != keep) {
+      return item;
+    }
+  }
+  return shard.lru.end();
+}
+
+void ConditionCache::enforceBudget(const Condition *keep)
+{
+  // the oldest evictable objects of the shards are compared by their last use, the shard of the oldest one
+  // is locked again to evict it. If it was used meanwhile, the next oldest of that shard is evicted
+  while (mBudget && mBytes > mBudget) {
+    Shard *oldestShard = nullptr;
+    ULong64_t oldestUse = 0;
+    for (auto &shard : mShards) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto item = findEvictable(shard, keep);
+      if (item != shard.lru.end() && (!oldestShard || item->lastUse < oldestUse)) {
+        oldestShard = &shard;
+        oldestUse = item->lastUse;
+      }
+    }
+    if (!oldestShard) {
+      break;
+    }
+    std::lock_guard<std::mutex> lock(oldestShard->mutex);
+    auto item = findEvictable(*oldestShard, keep);
+    if (item == oldestShard->lru.end()) {
+      continue;
+    }
+    LOG(DEBUG) << "Evicting " << item->path << " [" << item->firstRun << "," << item->lastRun << "], "
+               << item->bytes << " bytes" << FairLogger::endl;
+    erase(*oldestShard, item);
+    oldestShard->evictions++;
+  }
+  if (mBudget && mBytes > mBudget) {
+    LOG(DEBUG) << "Condition cache above budget (" << mBytes << " > " << mBudget << " bytes), all entries in use"
+               << FairLogger::endl;
+  }
+}
+
+Bool_t ConditionCache::pin(const std::string &path, Int_t run)
+{
+  Shard &shard = getShard(path);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto item = find(shard, path, run);
+  if (item == shard.lru.end()) {
+    return kFALSE;
+  }
+  item->pins++;
+  return kTRUE;
+}
+
+void ConditionCache::unpin(const std::string &path, Int_t run)
+{
+  unpin(getShard(path), [&](Shard &shard) { return find(shard, path, run); });
+}
+
+void ConditionCache::unpin(const std::string &path, const Condition *entry)
+{
+  unpin(getShard(path), [&](Shard &shard) {
+    auto items = shard.byPath.find(path);
+    if (items != shard.byPath.end()) {
+      for (auto item : items->second) {
+        if (item->entry.get() == entry) {
+          return item;
+        }
+      }
+    }
+    return shard.lru.end();
+  });
+}
+
+void ConditionCache::unpin(Shard &shard, const std::function<ItemList::iterator(Shard &)> &findItem)
+{
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto item = findItem(shard);
+    if (item == shard.lru.end() || item->pins == 0) {
+      return;
+    }
+    item->pins--;
+  }
+  enforceBudget();
+}
+
+Int_t ConditionCache::remove(const std::function<Bool_t(const std::string &)> &selectPath)
+{
+  Int_t removed = 0;
+  for (auto &shard : mShards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (auto item = shard.lru.begin(); item != shard.lru.end();) {
+      auto current = item++;
+      if (selectPath(current->path)) {
+        erase(shard, current);
+        removed++;
+      }
+    }
+  }
+  return removed;
+}
+
+void ConditionCache::clear()
+{
+  for (auto &shard : mShards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (const auto &item : shard.lru) {
+      mBytes -= item.bytes;
+    }
+    shard.byPath.clear();
+    shard.lru.clear();
+  }
+}
+
+ConditionCache::Statistics ConditionCache::getStatistics() const
+{
+  Statistics statistics;
+  for (const auto &shard : mShards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    statistics.hits += shard.hits;
+    statistics.misses += shard.misses;
+    statistics.evictions += shard.evictions;
+    statistics.entries += shard.lru.size();
+  }
+  statistics.bytes = mBytes;
+  return statistics;
+}
+
+std::vector<std::pair<std::string, Condition *>> ConditionCache::getEntries() const
+{
+  std::vector<std::pair<std::string, Condition *>> entries;
+  for (const auto &shard : mShards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (const auto &item : shard.lru) {
+      entries.emplace_back(item.path, item.entry.get());
+    }
+  }
+  return entries;
+}
@@ -0,0 +1,196 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// in-memory index of the run ranges and versions of the objects stored for one calibration path
+
+#include "CCDB/ConditionIdIndex.h"
+#include <algorithm> // for sort, upper_bound
+#include <set>       // for set
+#include <tuple>     // for tuple
+
+using namespace o2::CDB;
+
+namespace
+{
+bool contains(const ConditionIdIndex::Entry &entry, Int_t firstRun, Int_t lastRun)
+{
+  return entry.firstRun <= firstRun && lastRun <= entry.lastRun;
+}
+
+bool isHigher(const ConditionIdIndex::Entry &a, const ConditionIdIndex::Entry &b)
+{
+  return a.version > b.version || (a.version == b.version && a.subVersion > b.subVersion);
+}
+}
+
+void ConditionIdIndex::add(Int_t firstRun, Int_t lastRun, Int_t version, Int_t subVersion)
+{
+  // objects with an invalid run range are never valid, as in IdRunRange::isSupersetOf
+  if (firstRun < 0 || lastRun < firstRun) {
+    return;
+  }
+  mEntries.push_back(Entry{ firstRun, lastRun, version, subVersion });
+  mBuilt = false;
+}
+
+void ConditionIdIndex::clear()
+{
+  mEntries.clear();
+  mBuilt = false;
+}
+
+void ConditionIdIndex::build() const
+{
+  // rebuild the elementary interval tables for all versions and for each version
+  mVersionEntries.clear();
+  std::vector<Int_t> all(mEntries.size());
+  for (size_t i = 0; i < mEntries.size(); i++) {
+    all[i] = i;
+    mVersionEntries[mEntries[i].version].push_back(i);
+  }
+  buildSegments(all, mAllVersions);
+  mPerVersion.clear();
+  for (const auto &version : mVersionEntries) {
+    buildSegments(version.second, mPerVersion[version.first]);
+  }
+  mBuilt = true;
+}
+
+void ConditionIdIndex::buildSegments(const std::vector<Int_t> &entries, Segments &segments) const
+{
+  // sweep over the run range boundaries keeping the objects valid in the current interval ordered by
+  // version and subVersion
+
+  // (boundary, entry): the entry becomes valid at firstRun and invalid at lastRun+1
+  std::vector<std::pair<Long64_t, Int_t>> boundaries;
+  boundaries.reserve(2 * entries.size());
+  for (auto i : entries) {
+    boundaries.emplace_back(mEntries[i].firstRun, i);
+    boundaries.emplace_back(Long64_t(mEntries[i].lastRun) + 1, i);
+  }
+  std::sort(boundaries.begin(), boundaries.end());
+
+  segments.mStart.clear();
+  segments.mBest.clear();
+  segments.mAmbiguous.clear();
+
+  std::set<std::tuple<Int_t, Int_t, Int_t>> valid; // version, subVersion, entry
+  for (size_t ib = 0; ib < boundaries.size();) {
+    Long64_t start = boundaries[ib].first;
+    for (; ib < boundaries.size() && boundaries[ib].first == start; ib++) {
+      const auto &entry = mEntries[boundaries[ib].second];
+      auto key = std::make_tuple(entry.version, entry.subVersion, boundaries[ib].second);
+      if (start == entry.firstRun) {
+        valid.insert(key);
+      } else {
+        valid.erase(key);
+      }
+    }
+    Int_t best = -1;
+    bool ambiguous = false;
+    if (!valid.empty()) {
+      auto top = valid.rbegin();
+      best = std::get<2>(*top);
+      if (++top != valid.rend()) {
+        ambiguous = std::get<0>(*top) == mEntries[best].version && std::get<1>(*top) == mEntries[best].subVersion;
+      }
+    }
+    if (!segments.mBest.empty() && segments.mBest.back() == best && segments.mAmbiguous.back() == ambiguous) {
+      continue; // same content as the previous interval
+    }
+    segments.mStart.push_back(start);
+    segments.mBest.push_back(best);
+    segments.mAmbiguous.push_back(ambiguous);
+  }
+}
+
+const ConditionIdIndex::Entry *ConditionIdIndex::findInSegments(const Segments &segments, Int_t run,
+                                                                bool &ambiguous) const
+{
+  auto next = std::upper_bound(segments.mStart.begin(), segments.mStart.end(), Long64_t(run));
+  if (next == segments.mStart.begin()) {
+    return nullptr;
+  }
+  size_t segment = next - segments.mStart.begin() - 1;
+  if (segments.mBest[segment] < 0) {
+    return nullptr;
+  }
+  ambiguous = segments.mAmbiguous[segment];
+  return &mEntries[segments.mBest[segment]];
+}
+
+const ConditionIdIndex::Entry *ConditionIdIndex::findHighest(Int_t firstRun, Int_t lastRun, Int_t version,
+                                                             bool &ambiguous) const
+{
+  ambiguous = false;
+  if (firstRun < 0 || lastRun < firstRun) {
+    return nullptr;
+  }
+  if (!mBuilt) {
+    build();
+  }
+
+  if (firstRun == lastRun) {
+    if (version < 0) {
+      return findInSegments(mAllVersions, firstRun, ambiguous);
+    }
+    auto segments = mPerVersion.find(version);
+    return segments == mPerVersion.end() ? nullptr : findInSegments(segments->second, firstRun, ambiguous);
+  }
+
+  const Entry *result = nullptr;
+  auto check = [&](Int_t i) {
+    const auto &entry = mEntries[i];
+    if (!contains(entry, firstRun, lastRun)) {
+      return;
+    }
+    if (!result || isHigher(entry, *result)) {
+      result = &entry;
+      ambiguous = false;
+    } else if (!isHigher(*result, entry)) {
+      ambiguous = true;
+    }
+  };
+  if (version < 0) {
+    for (size_t i = 0; i < mEntries.size(); i++) {
+      check(i);
+    }
+  } else {
+    auto entries = mVersionEntries.find(version);
+    if (entries != mVersionEntries.end()) {
+      for (auto i : entries->second) {
+        check(i);
+      }
+    }
+  }
+  return result;
+}
+
+const ConditionIdIndex::Entry *ConditionIdIndex::find(Int_t firstRun, Int_t lastRun, Int_t version,
+                                                      Int_t subVersion) const
+{
+  if (firstRun < 0 || lastRun < firstRun) {
+    return nullptr;
+  }
+  if (!mBuilt) {
+    build();
+  }
+  auto entries = mVersionEntries.find(version);
+  if (entries == mVersionEntries.end()) {
+    return nullptr;
+  }
+  for (auto i : entries->second) {
+    const auto &entry = mEntries[i];
+    if (entry.subVersion == subVersion && contains(entry, firstRun, lastRun)) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
@@ -27,16 +27,31 @@
 
 #include "CCDB/BackendOCDB.h"
 #include "CCDB/BackendRiak.h"
+#include "CCDB/Condition.h"
 #include "CCDB/ConditionsMQClient.h"
 #include <FairMQLogger.h>
+#include <FairMQParts.h>
 #include <options/FairMQProgOptions.h>
 
 #include "boost/filesystem.hpp"
 
+#include <algorithm>
+
 using namespace o2::CDB;
 using namespace std;
 
-ConditionsMQClient::ConditionsMQClient() : mRunId(0), mParameterName() {}
+namespace
+{
+// "/DET/Calib/Histo/Run2008_2008_v1_s0" to (/DET/Calib/Histo, 2008), as done by the server
+std::pair<std::string, int> parseKey(const std::string& key)
+{
+  std::size_t pos = key.rfind("/");
+  std::size_t pos2 = key.find("_", pos);
+  return { key.substr(0, pos), atoi(key.substr(pos + 4, pos2 - pos - 4).c_str()) };
+}
+}
+
+ConditionsMQClient::ConditionsMQClient() : mRunId(0), mParameterName(), mPrefetchRuns(0) {}
 
 ConditionsMQClient::~ConditionsMQClient() = default;
 
@@ -48,6 +63,7 @@ void ConditionsMQClient::InitTask()
   mOperationType = GetConfig()->GetValue<string>("operation-type");
   mDataSource = GetConfig()->GetValue<string>("data-source");
   mObjectPath = GetConfig()->GetValue<string>("object-path");
+  mPrefetchRuns = GetConfig()->GetValue<int>("prefetch-runs");
 }
 
 void ConditionsMQClient::Run()
@@ -71,6 +87,9 @@ void ConditionsMQClient::Run()
     boost::filesystem::path dataPath(mObjectPath);
     boost::filesystem::recursive_directory_iterator endIterator;
 
+    // OCDB conditions are requested all at once after the traversal
+    std::vector<std::string> keys;
+
     // Traverse the filesystem and retrieve the name of each root found
     if (boost::filesystem::exists(dataPath) && boost::filesystem::is_directory(dataPath)) {
       for (static boost::filesystem::recursive_directory_iterator directoryIterator(dataPath);
@@ -83,7 +102,9 @@ void ConditionsMQClient::Run()
           std::size_t pos = str.rfind(".");
           std::string key = str.substr(0, pos);
 
-          if (mOperationType == "GET") {
+          if (mOperationType == "GET" && mDataSource == "OCDB") {
+            keys.push_back(key);
+          } else if (mOperationType == "GET") {
             std::string* messageString = new string();
             backend->Serialize(messageString, key, mOperationType, mDataSource);
 
@@ -110,6 +131,7 @@ void ConditionsMQClient::Run()
           }
         }
       }
+      getConditions(backend, keys);
     } else {
       LOG(ERROR) << "Path " << mObjectPath << " not existing or not a directory";
     }
@@ -118,3 +140,72 @@ void ConditionsMQClient::Run()
     LOG(DEBUG) << " Time elapsed: " << (endTime - startTime).total_milliseconds() << "ms";
   }
 }
+
+void ConditionsMQClient::getConditions(Backend* backend, const std::vector<std::string>& keys)
+{
+  std::vector<std::string> missing;
+  std::map<std::string, int> lastRuns; // highest requested run per identifier
+  for (const auto& key : keys) {
+    auto identifierRun = parseKey(key);
+    auto lastRun = lastRuns.emplace(identifierRun.first, identifierRun.second).first;
+    lastRun->second = std::max(lastRun->second, identifierRun.second);
+
+    auto prefetched = mPrefetched.find(identifierRun);
+    if (prefetched != mPrefetched.end()) {
+      LOG(DEBUG) << "Condition " << key << " was prefetched";
+      prefetched->second->printConditionMetaData();
+      mPrefetched.erase(prefetched);
+    } else {
+      missing.push_back(key);
+    }
+  }
+  requestConditions(backend, missing);
+
+  if (mPrefetchRuns <= 0) {
+    return;
+  }
+  // the conditions of the next runs are likely to be requested soon
+  std::vector<std::string> upcoming;
+  for (const auto& lastRun : lastRuns) {
+    for (int run = lastRun.second + 1; run <= lastRun.second + mPrefetchRuns; run++) {
+      if (!mPrefetched.count({ lastRun.first, run })) {
+        upcoming.push_back(lastRun.first + "/Run" + std::to_string(run) + "_" + std::to_string(run));
+      }
+    }
+  }
+  auto conditions = requestConditions(backend, upcoming);
+  for (size_t i = 0; i < conditions.size(); i++) {
+    if (conditions[i]) {
+      mPrefetched[parseKey(upcoming[i])] = std::move(conditions[i]);
+    }
+  }
+  LOG(DEBUG) << "Prefetched " << mPrefetched.size() << " conditions for the next " << mPrefetchRuns << " runs";
+}
+
+std::vector<std::unique_ptr<Condition>> ConditionsMQClient::requestConditions(Backend* backend,
+                                                                              const std::vector<std::string>& keys)
+{
+  std::vector<std::unique_ptr<Condition>> conditions(keys.size());
+  if (keys.empty()) {
+    return conditions;
+  }
+
+  std::string* messageString = new string();
+  backend->Serialize(messageString, keys, mOperationType, mDataSource);
+
+  unique_ptr<FairMQMessage> request(fTransportFactory->CreateMessage(
+    const_cast<char*>(messageString->c_str()), messageString->length(), CustomCleanup, messageString));
+  FairMQParts reply;
+
+  if (Send(request, "data-get") > 0 && Receive(reply, "data-get") >= 0) {
+    for (size_t i = 0; i < keys.size() && i < static_cast<size_t>(reply.Size()); i++) {
+      if (reply.At(i)->GetSize() > 0) {
+        LOG(DEBUG) << "Received a condition with a size of " << reply.At(i)->GetSize();
+        conditions[i].reset(backend->UnPack(std::move(reply.At(i))));
+      } else {
+        LOG(ERROR) << "No condition found for " << keys[i];
+      }
+    }
+  }
+  return conditions;
+}
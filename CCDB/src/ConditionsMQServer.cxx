@@ -23,13 +23,17 @@
  */
 
 #include "TMessage.h"
+#include "TROOT.h"
 #include "Rtypes.h"
 
 #include "CCDB/Condition.h"
+#include "CCDB/ConditionId.h"
 #include "CCDB/ConditionsMQServer.h"
 #include "CCDB/IdPath.h"
 #include <FairMQLogger.h>
+#include <FairMQParts.h>
 #include <FairMQPoller.h>
+#include <options/FairMQProgOptions.h>
 
 // Google protocol buffers headers
 #include <google/protobuf/stubs/common.h>
@@ -37,12 +41,25 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include <chrono>
+#include <exception>
+#include <thread>
+#include <vector>
+
 using namespace o2::CDB;
 using std::endl;
 using std::cout;
 using std::string;
 
-ConditionsMQServer::ConditionsMQServer() : ParameterMQServer(), mCdbManager(o2::CDB::Manager::Instance()) {}
+ConditionsMQServer::ConditionsMQServer()
+  : ParameterMQServer(),
+    mCdbManager(o2::CDB::Manager::Instance()),
+    mBlobBytes(0),
+    mBlobBudget(0),
+    mBrokerTimeout(0),
+    mBrokerReplyPending(false)
+{
+}
 
 void ConditionsMQServer::InitTask()
 {
@@ -63,9 +80,20 @@ void ConditionsMQServer::InitTask()
       mCdbManager->setDefaultStorage(GetOutputName().c_str());
     }
   }
+
+  mBlobBudget = ULong64_t(GetConfig()->GetValue<int>("blob-cache-size")) << 20;
+  mBrokerTimeout = GetConfig()->GetValue<int>("broker-timeout");
+
+  // the workers query any run: the conditions are cached for all runs within a budget instead of for the
+  // current run, and pinned while they are streamed
+  mCdbManager->setCacheFlag(kTRUE);
+  mCdbManager->setCacheBudget(ULong64_t(GetConfig()->GetValue<int>("condition-cache-size")) << 20);
+
+  // the conditions are retrieved and streamed by several workers
+  ROOT::EnableThreadSafety();
 }
 
-void free_tmessage(void* data, void* hint) { delete static_cast<TMessage*>(hint); }
+void free_blob(void* data, void* hint) { delete static_cast<std::shared_ptr<TMessage>*>(hint); }
 
 void ConditionsMQServer::ParseDataSource(std::string& dataSource, const std::string& data)
 {
@@ -79,83 +107,143 @@ void ConditionsMQServer::ParseDataSource(std::string& dataSource, const std::str
   delete msgReply;
 }
 
-void ConditionsMQServer::Deserialize(const std::string& messageString, std::string& object)
-{
-  messaging::RequestMessage* requestMessage = new messaging::RequestMessage;
-  requestMessage->ParseFromString(messageString);
-
-  object.assign(requestMessage->key());
-
-  delete requestMessage;
-}
-
 void ConditionsMQServer::Run()
 {
-  std::unique_ptr<FairMQPoller> poller(
-    fTransportFactory->CreatePoller(fChannels, { "data-put", "data-get", "broker-get" }));
+  // a rep socket holds one request at a time: each data-get sub-socket is served by its own worker
+  std::vector<std::thread> workers;
+  for (int i = 0; i < static_cast<int>(fChannels.at("data-get").size()); i++) {
+    workers.emplace_back(&ConditionsMQServer::serveRequests, this, i);
+  }
+
+  std::unique_ptr<FairMQPoller> poller(fTransportFactory->CreatePoller(fChannels, { "data-put" }));
 
   while (CheckCurrentState(RUNNING)) {
 
-    poller->Poll(-1);
+    poller->Poll(100);
 
-    if (poller->CheckInput("data-get", 0)) {
+    if (poller->CheckInput("data-put", 0)) {
       std::unique_ptr<FairMQMessage> input(fTransportFactory->CreateMessage());
 
-      if (Receive(input, "data-get") > 0) {
+      if (Receive(input, "data-put") > 0) {
         std::string serialString(static_cast<char*>(input->GetData()), input->GetSize());
 
-        //LOG(DEBUG) << "Received a GET client message: " << serialString;
+        // LOG(DEBUG) << "Received a PUT client message: " << serialString;
+        LOG(DEBUG) << "Message size: " << input->GetSize();
 
         std::string dataSource;
         ParseDataSource(dataSource, serialString);
 
         if (dataSource == "OCDB") {
-          // Retrieve the key from the serialized message
-          std::string key;
-          Deserialize(serialString, key);
-
-          getFromOCDB(key);
+          LOG(ERROR) << "The GET operation is not supported for the OCDB data source yet";
         } else if (dataSource == "Riak") {
-          // No need to de-serialize, just forward message to the broker
-          fChannels.at("broker-get").at(0).Send(input);
+          fChannels.at("broker-put").at(0).Send(input);
         }
       }
     }
+  }
 
-    if (poller->CheckInput("data-put", 0)) {
-      std::unique_ptr<FairMQMessage> input(fTransportFactory->CreateMessage());
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
 
-      if (Receive(input, "data-put") > 0) {
-        std::string serialString(static_cast<char*>(input->GetData()), input->GetSize());
+void ConditionsMQServer::serveRequests(int index)
+{
+  while (CheckCurrentState(RUNNING)) {
+    std::unique_ptr<FairMQMessage> input(fTransportFactory->CreateMessage());
 
-        // LOG(DEBUG) << "Received a PUT client message: " << serialString;
-        LOG(DEBUG) << "Message size: " << input->GetSize();
+    if (Receive(input, "data-get", index, 100) <= 0) {
+      continue;
+    }
 
-        std::string dataSource;
-        ParseDataSource(dataSource, serialString);
+    messaging::RequestMessage request;
+    request.ParseFromArray(input->GetData(), input->GetSize());
 
-        if (dataSource == "OCDB") {
-          LOG(ERROR) << "The GET operation is not supported for the OCDB data source yet";
-        } else if (dataSource == "Riak") {
-          fChannels.at("broker-put").at(0).Send(input);
+    if (request.datasource() == "OCDB") {
+      if (request.keys_size() > 0) {
+        // one part per key, in the order of the request
+        FairMQParts reply;
+        for (const auto& key : request.keys()) {
+          reply.AddPart(createReply(getFromOCDB(key)));
         }
+        Send(reply, "data-get", index);
+      } else {
+        std::unique_ptr<FairMQMessage> reply(createReply(getFromOCDB(request.key())));
+        Send(reply, "data-get", index);
       }
+    } else if (request.datasource() == "Riak") {
+      // No need to de-serialize, just forward message to the broker
+      std::unique_ptr<FairMQMessage> reply(fTransportFactory->CreateMessage());
+      if (queryBroker(input, reply)) {
+        LOG(DEBUG) << "Received object from broker with a size of: " << reply->GetSize();
+      } else {
+        // the client gets an empty reply, as for a missing condition
+        LOG(ERROR) << "No reply from the broker";
+        reply.reset(fTransportFactory->CreateMessage());
+      }
+      Send(reply, "data-get", index);
+    } else {
+      // the rep socket expects a reply in any case
+      LOG(ERROR) << R"(")" << request.datasource() << R"(" is not a valid Data Source)";
+      std::unique_ptr<FairMQMessage> reply(fTransportFactory->CreateMessage());
+      Send(reply, "data-get", index);
     }
+  }
+}
 
-    if (poller->CheckInput("broker-get", 0)) {
-      std::unique_ptr<FairMQMessage> input(fTransportFactory->CreateMessage());
+bool ConditionsMQServer::queryBroker(std::unique_ptr<FairMQMessage>& request, std::unique_ptr<FairMQMessage>& reply)
+{
+  std::lock_guard<std::mutex> lock(mBrokerMutex);
 
-      if (Receive(input, "broker-get") > 0) {
-        LOG(DEBUG) << "Received object from broker with a size of: " << input->GetSize();
+  // the req socket cannot send before the reply of a timed out request is received
+  if (mBrokerReplyPending) {
+    std::unique_ptr<FairMQMessage> late(fTransportFactory->CreateMessage());
+    if (!receiveFromBroker(late)) {
+      return false;
+    }
+    LOG(WARNING) << "Dropped a late reply from the broker";
+    mBrokerReplyPending = false;
+  }
 
-        fChannels.at("data-get").at(0).Send(input);
-      }
+  if (Send(request, "broker-get") <= 0) {
+    return false;
+  }
+  mBrokerReplyPending = true;
+  if (!receiveFromBroker(reply)) {
+    return false;
+  }
+  mBrokerReplyPending = false;
+  return true;
+}
+
+bool ConditionsMQServer::receiveFromBroker(std::unique_ptr<FairMQMessage>& reply)
+{
+  // short receives, so that the device can be stopped while waiting
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(mBrokerTimeout);
+  while (CheckCurrentState(RUNNING)) {
+    if (Receive(reply, "broker-get", 0, 100) > 0) {
+      return true;
+    }
+    if (std::chrono::steady_clock::now() >= deadline) {
+      LOG(ERROR) << "The broker did not reply within " << mBrokerTimeout << " ms";
+      break;
     }
   }
+  return false;
+}
+
+std::unique_ptr<FairMQMessage> ConditionsMQServer::createReply(const Blob& blob)
+{
+  if (!blob) {
+    return std::unique_ptr<FairMQMessage>(fTransportFactory->CreateMessage());
+  }
+  // the message keeps the serialized condition alive until sent, even if dropped from the cache meanwhile
+  return std::unique_ptr<FairMQMessage>(
+    fTransportFactory->CreateMessage(blob->Buffer(), blob->BufferSize(), free_blob, new Blob(blob)));
 }
 
 // Query OCDB for the condition
-void ConditionsMQServer::getFromOCDB(std::string key)
+ConditionsMQServer::Blob ConditionsMQServer::getFromOCDB(std::string key)
 {
   // Change key from i.e. "/DET/Calib/Histo/Run2008_2008_v1_s0" to (DET/Calib/Histo, 2008)
   // FIXME: This will have to be changed in the future by adapting IdPath and getObject accordingly
@@ -165,23 +253,87 @@ void ConditionsMQServer::getFromOCDB(std::string key)
   std::size_t pos2 = key.find("_");
   int runId = atoi(key.substr(0, pos2).c_str());
 
-  Condition* aCondition = nullptr;
+  Blob blob = getBlob(identifier, runId);
+  if (!blob) {
+    LOG(ERROR) << R"(Could not get a condition for ")" << identifier << R"(" and run )" << runId << "!";
+  }
+  return blob;
+}
 
-  mCdbManager->setRun(runId);
-  aCondition = mCdbManager->getCondition(IdPath(identifier), runId);
+ConditionsMQServer::Blob ConditionsMQServer::getBlob(const std::string& identifier, int runId)
+{
+  std::string blobKey = identifier + "/" + std::to_string(runId);
+  std::promise<Blob> promise;
+  std::shared_future<Blob> blob;
+  bool streamer = false;
+  {
+    std::lock_guard<std::mutex> lock(mBlobMutex);
+    auto found = mBlobs.find(blobKey);
+    if (found != mBlobs.end()) {
+      mBlobLru.splice(mBlobLru.begin(), mBlobLru, found->second.position);
+      blob = found->second.blob;
+    } else {
+      blob = promise.get_future().share();
+      mBlobLru.push_front(blobKey);
+      mBlobs.emplace(blobKey, BlobEntry{ blob, mBlobLru.begin(), 0 });
+      streamer = true;
+    }
+  }
+  if (!streamer) {
+    return blob.get(); // waits for the worker serializing it
+  }
 
+  Blob serialized;
+  Condition* aCondition = nullptr;
+  try {
+    // no setRun: the workers query different runs concurrently. The Manager keeps the ownership of the condition,
+    // pinned in its cache until streamed
+    aCondition = mCdbManager->getCondition(ConditionId(IdPath(identifier), runId, runId), kTRUE, kTRUE);
+    if (aCondition) {
+      LOG(DEBUG) << "Sending following parameter to the client:";
+      aCondition->printConditionMetaData();
+      serialized = std::make_shared<TMessage>(kMESS_OBJECT);
+      serialized->WriteObject(aCondition);
+    }
+  } catch (const std::exception& e) {
+    // the waiting workers get no condition and the entry is dropped below, the next request retries
+    LOG(ERROR) << R"(Failed to stream the condition ")" << identifier << R"(" for run )" << runId << ": " << e.what();
+    serialized.reset();
+  } catch (...) {
+    LOG(ERROR) << R"(Failed to stream the condition ")" << identifier << R"(" for run )" << runId;
+    serialized.reset();
+  }
   if (aCondition) {
-    LOG(DEBUG) << "Sending following parameter to the client:";
-    aCondition->printConditionMetaData();
-    TMessage* tmsg = new TMessage(kMESS_OBJECT);
-    tmsg->WriteObject(aCondition);
-
-    std::unique_ptr<FairMQMessage> message(
-      fTransportFactory->CreateMessage(tmsg->Buffer(), tmsg->BufferSize(), free_tmessage, tmsg));
-
-    fChannels.at("data-get").at(0).Send(message);
+    mCdbManager->unpinCondition(aCondition);
+  }
+  promise.set_value(serialized);
+
+  std::lock_guard<std::mutex> lock(mBlobMutex);
+  auto entry = mBlobs.find(blobKey);
+  if (!serialized) {
+    // not cached, the next request queries the Manager again
+    mBlobLru.erase(entry->second.position);
+    mBlobs.erase(entry);
   } else {
-    LOG(ERROR) << R"(Could not get a condition for ")" << key << R"(" and run )" << runId << "!";
+    entry->second.bytes = serialized->BufferSize();
+    mBlobBytes += entry->second.bytes;
+    evictBlobs();
+  }
+  return serialized;
+}
+
+void ConditionsMQServer::evictBlobs()
+{
+  auto position = mBlobLru.end();
+  while (mBlobBudget && mBlobBytes > mBlobBudget && position != mBlobLru.begin()) {
+    --position;
+    auto entry = mBlobs.find(*position);
+    if (!entry->second.bytes) {
+      continue; // being serialized
+    }
+    mBlobBytes -= entry->second.bytes;
+    mBlobs.erase(entry);
+    position = mBlobLru.erase(position);
   }
 }
 
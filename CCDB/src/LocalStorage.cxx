@@ -241,147 +241,91 @@ ConditionId *LocalStorage::getId(const ConditionId &query)
     return result;
   }
 
-  // otherwise browse in the local filesystem CDB storage
-  TString dirName = Form("%s/%s", mBaseDirectory.Data(), query.getPathString().Data());
-
-  void *dirPtr = gSystem->OpenDirectory(dirName);
-  if (!dirPtr) {
-    LOG(DEBUG) << "Directory <" << (query.getPathString()).Data() << "> not found" << FairLogger::endl;
+  // otherwise look in the index of the objects stored for this path
+  const ConditionIdIndex &index = getIndex(query.getPathString());
+  if (!index.size()) {
+    LOG(DEBUG) << "Directory <" << (query.getPathString()).Data() << "> not found or empty" << FairLogger::endl;
     LOG(DEBUG) << "in DB folder " << mBaseDirectory.Data() << FairLogger::endl;
     return nullptr;
   }
 
-  const char *filename;
-  ConditionId *result = new ConditionId();
-  result->setPath(query.getPathString());
-
-  IdRunRange aIdRunRange;          // the runRange got from filename
-  Int_t aVersion, aSubVersion; // the version and subVersion got from filename
-
-  if (!query.hasVersion()) { // neither version and subversion specified -> look for highest version
-    // and subVersion
-
-    while ((filename = gSystem->GetDirEntry(dirPtr))) { // loop on files
-
-      TString aString(filename);
-      if (aString.BeginsWith('.')) {
-        continue;
-      }
-
-      if (!filenameToId(filename, aIdRunRange, aVersion, aSubVersion)) {
-        continue;
-      }
-      // aIdRunRange, aVersion, aSubVersion filled from filename
-
-      if (!aIdRunRange.isSupersetOf(query.getIdRunRange())) {
-        continue;
-      }
-      // aIdRunRange contains requested run!
-
-      LOG(DEBUG) << "Filename " << filename << " matches\n" << FairLogger::endl;
-
-      if (result->getVersion() < aVersion) {
-        result->setVersion(aVersion);
-        result->setSubVersion(aSubVersion);
-
-        result->setFirstRun(aIdRunRange.getFirstRun());
-        result->setLastRun(aIdRunRange.getLastRun());
-
-      } else if (result->getVersion() == aVersion && result->getSubVersion() < aSubVersion) {
-
-        result->setSubVersion(aSubVersion);
+  const ConditionIdIndex::Entry *entry = nullptr;
+  Bool_t ambiguous = kFALSE;
+  if (!query.hasVersion()) { // neither version and subversion specified -> look for highest version and subVersion
+    entry = index.findHighest(query.getFirstRun(), query.getLastRun(), -1, ambiguous);
+  } else if (!query.hasSubVersion()) { // version specified but not subversion -> look for highest subVersion
+    entry = index.findHighest(query.getFirstRun(), query.getLastRun(), query.getVersion(), ambiguous);
+  } else { // both version and subversion specified
+    entry = index.find(query.getFirstRun(), query.getLastRun(), query.getVersion(), query.getSubVersion());
+  }
 
-        result->setFirstRun(aIdRunRange.getFirstRun());
-        result->setLastRun(aIdRunRange.getLastRun());
-      } else if (result->getVersion() == aVersion && result->getSubVersion() == aSubVersion) {
-        LOG(ERROR) << "More than one object valid for run " << query.getFirstRun() << " version " << aVersion << "_"
-                   << aSubVersion << "!" << FairLogger::endl;
-        gSystem->FreeDirectory(dirPtr);
-        delete result;
-        return nullptr;
-      }
-    }
+  if (ambiguous) {
+    LOG(ERROR) << "More than one object valid for run " << query.getFirstRun() << " version " << entry->version << "_"
+               << entry->subVersion << "!" << FairLogger::endl;
+    return nullptr;
+  }
 
-  } else if (!query.hasSubVersion()) { // version specified but not subversion -> look for highest
-    // subVersion
+  ConditionId *result = new ConditionId();
+  result->setPath(query.getPathString());
+  if (query.hasVersion() && !query.hasSubVersion()) {
     result->setVersion(query.getVersion());
+  }
+  if (entry) {
+    result->setVersion(entry->version);
+    result->setSubVersion(entry->subVersion);
+    result->setFirstRun(entry->firstRun);
+    result->setLastRun(entry->lastRun);
+  }
 
-    while ((filename = gSystem->GetDirEntry(dirPtr))) { // loop on files
-
-      TString aString(filename);
-      if (aString.BeginsWith('.')) {
-        continue;
-      }
+  return result;
+}
 
-      if (!filenameToId(filename, aIdRunRange, aVersion, aSubVersion)) {
-        continue;
-      }
-      // aIdRunRange, aVersion, aSubVersion filled from filename
+const ConditionIdIndex &LocalStorage::getIndex(const TString &path)
+{
+  // index of the objects stored for the path, filled from the directory content on first use
 
-      if (!aIdRunRange.isSupersetOf(query.getIdRunRange())) {
-        continue;
-      }
-      // aIdRunRange contains requested run!
+  auto found = mIndex.find(path.Data());
+  if (found != mIndex.end()) {
+    return found->second;
+  }
+  ConditionIdIndex &index = mIndex[path.Data()];
 
-      if (query.getVersion() != aVersion) {
-        continue;
-      }
-      // aVersion is requested version!
-
-      if (result->getSubVersion() == aSubVersion) {
-        LOG(ERROR) << "More than one object valid for run " << query.getFirstRun() << " version " << aVersion << "_"
-                   << aSubVersion << "!" << FairLogger::endl;
-        gSystem->FreeDirectory(dirPtr);
-        delete result;
-        return nullptr;
-      }
-      if (result->getSubVersion() < aSubVersion) {
+  TString dirName = Form("%s/%s", mBaseDirectory.Data(), path.Data());
+  void *dirPtr = gSystem->OpenDirectory(dirName);
+  if (!dirPtr) {
+    return index;
+  }
 
-        result->setSubVersion(aSubVersion);
+  const char *filename;
+  IdRunRange aIdRunRange;          // the runRange got from filename
+  Int_t aVersion, aSubVersion; // the version and subVersion got from filename
+  while ((filename = gSystem->GetDirEntry(dirPtr))) { // loop on files
 
-        result->setFirstRun(aIdRunRange.getFirstRun());
-        result->setLastRun(aIdRunRange.getLastRun());
-      }
+    TString aString(filename);
+    if (aString.BeginsWith('.')) {
+      continue;
     }
 
-  } else { // both version and subversion specified
-
-    // ConditionId dataId(queryId.getPathString(), -1, -1, -1, -1);
-    // Bool_t result;
-    while ((filename = gSystem->GetDirEntry(dirPtr))) { // loop on files
-
-      TString aString(filename);
-      if (aString.BeginsWith('.')) {
-        continue;
-      }
-
-      if (!filenameToId(filename, aIdRunRange, aVersion, aSubVersion)) {
-        LOG(DEBUG) << "Could not make id from file: " << filename << FairLogger::endl;
-        continue;
-      }
-      // aIdRunRange, aVersion, aSubVersion filled from filename
-
-      if (!aIdRunRange.isSupersetOf(query.getIdRunRange())) {
-        continue;
-      }
-      // aIdRunRange contains requested run!
-
-      if (query.getVersion() != aVersion || query.getSubVersion() != aSubVersion) {
-        continue;
-      }
-      // aVersion and aSubVersion are requested version and subVersion!
-
-      result->setVersion(aVersion);
-      result->setSubVersion(aSubVersion);
-      result->setFirstRun(aIdRunRange.getFirstRun());
-      result->setLastRun(aIdRunRange.getLastRun());
-      break;
+    if (!filenameToId(filename, aIdRunRange, aVersion, aSubVersion)) {
+      continue;
     }
+    index.add(aIdRunRange.getFirstRun(), aIdRunRange.getLastRun(), aVersion, aSubVersion);
   }
-
   gSystem->FreeDirectory(dirPtr);
 
-  return result;
+  LOG(DEBUG) << "Indexed " << index.size() << " objects in " << dirName.Data() << FairLogger::endl;
+  return index;
+}
+
+void LocalStorage::refreshIndex(const char *path)
+{
+  // drop the index of the path (of all paths if nullptr), to be filled again from the directory on next use
+
+  if (path) {
+    mIndex.erase(path);
+  } else {
+    mIndex.clear();
+  }
 }
 
 Condition *LocalStorage::getCondition(const ConditionId &queryId)
@@ -766,6 +710,10 @@ Bool_t LocalStorage::putCondition(Condition *entry, const char *mirrors)
 
   file.Close();
   if (result) {
+    auto index = mIndex.find(id.getPathString().Data());
+    if (index != mIndex.end()) {
+      index->second.add(id.getFirstRun(), id.getLastRun(), id.getVersion(), id.getSubVersion());
+    }
     if (!(id.getPathString().Contains("SHUTTLE/STATUS")))
       LOG(INFO) << R"(CDB object stored into file ")" << filename.Data() << R"(")" << FairLogger::endl;
   }
@@ -884,52 +832,16 @@ void LocalStorage::queryValidFiles()
             }
 
             if (mPathFilter.doesLevel2Contain(level2)) {
-              TString dirName = Form("%s/%s/%s/%s", mBaseDirectory.Data(), level0, level1, level2);
-
-              void *dirPtr = gSystem->OpenDirectory(dirName);
-
-              const char *filename;
-
-              IdRunRange aIdRunRange;                    // the runRange got from filename
-              IdRunRange hvIdRunRange;                   // the runRange of the highest version valid file
-              Int_t aVersion, aSubVersion;           // the version and subVersion got from filename
-              Int_t highestV = -1, highestSubV = -1; // the highest version and subVersion for this calibration type
-
-              while ((filename = gSystem->GetDirEntry(dirPtr))) { // loop on files
-
-                TString aString(filename);
-                if (aString.BeginsWith(".")) {
-                  continue;
-                }
-
-                if (!filenameToId(filename, aIdRunRange, aVersion, aSubVersion)) {
-                  continue;
-                }
-
-                IdRunRange runrg(mRun, mRun);
-                if (!aIdRunRange.isSupersetOf(runrg)) {
-                  continue;
-                }
-
-                // check to keep the highest version/subversion (in case of more than one)
-                if (aVersion > highestV) {
-                  highestV = aVersion;
-                  highestSubV = aSubVersion;
-                  hvIdRunRange = aIdRunRange;
-                } else if (aVersion == highestV) {
-                  if (aSubVersion > highestSubV) {
-                    highestSubV = aSubVersion;
-                    hvIdRunRange = aIdRunRange;
-                  }
-                }
-              }
-              if (highestV >= 0) {
-                IdPath validPath(level0, level1, level2);
-                ConditionId *validId = new ConditionId(validPath, hvIdRunRange, highestV, highestSubV);
+              IdPath validPath(level0, level1, level2);
+
+              // the highest version and subversion valid for mRun (in case of more than one)
+              Bool_t ambiguous = kFALSE;
+              auto entry = getIndex(validPath.getPathString()).findHighest(mRun, mRun, -1, ambiguous);
+              if (entry) {
+                IdRunRange hvIdRunRange(entry->firstRun, entry->lastRun);
+                ConditionId *validId = new ConditionId(validPath, hvIdRunRange, entry->version, entry->subVersion);
                 mValidFileIds.AddLast(validId);
               }
-
-              gSystem->FreeDirectory(dirPtr);
             }
           }
           gSystem->FreeDirectory(level1DirPtr);
@@ -73,12 +73,12 @@ void Manager::initFromCache(TMap *entryCache, Int_t run)
   TPair *pair = nullptr;
 
   while ((pair = dynamic_cast<TPair *>(iter.Next()))) {
-    mConditionCache.Add(pair->Key(), pair->Value());
+    // a duplicate of an entry already cached is deleted
+    cacheCondition(pair->Key()->GetName(), (Condition *) pair->Value());
   }
-  // mCondition is the new owner of the cache
-  mConditionCache.SetOwnerKeyValue(kTRUE, kTRUE);
-  entryCache->SetOwnerKeyValue(kFALSE, kFALSE);
-  LOG(INFO) << mConditionCache.GetEntries() << " cache entries have been loaded" << FairLogger::endl;
+  // mConditionCache is the new owner of the entries
+  entryCache->SetOwnerKeyValue(kTRUE, kFALSE);
+  LOG(INFO) << mConditionCache.getStatistics().entries << " cache entries have been loaded" << FairLogger::endl;
 }
 
 void Manager::dumpToSnapshotFile(const char *snapshotFileName, Bool_t singleKeys) const
@@ -96,30 +96,26 @@ void Manager::dumpToSnapshotFile(const char *snapshotFileName, Bool_t singleKeys
     return;
   }
 
-  LOG(INFO) << "Dumping entriesMap (entries'cache) with " << mConditionCache.GetEntries() << " entries!"
-            << FairLogger::endl;
+  auto entries = mConditionCache.getEntries();
+  LOG(INFO) << "Dumping entriesMap (entries'cache) with " << entries.size() << " entries!" << FairLogger::endl;
   LOG(INFO) << "Dumping entriesList with " << mIds->GetEntries() << "entries!" << FairLogger::endl;
 
   f->cd();
   if (singleKeys) {
-    f->WriteObject(&mConditionCache, "CDBentriesMap");
+    TMap entriesMap;
+    entriesMap.SetName("CDBConditionCache");
+    entriesMap.SetOwnerKeyValue(kTRUE, kFALSE);
+    for (const auto &entry : entries) {
+      entriesMap.Add(new TObjString(entry.first.c_str()), entry.second);
+    }
+    f->WriteObject(&entriesMap, "CDBentriesMap");
     f->WriteObject(mIds, "CDBidsList");
   } else {
     // We write the entries one by one named by their calibration path
-    TIter iter(mConditionCache.GetTable());
-    TPair *pair = nullptr;
-    while ((pair = dynamic_cast<TPair *>(iter.Next()))) {
-      TObjString *os = dynamic_cast<TObjString *>(pair->Key());
-      if (!os) {
-        continue;
-      }
-      TString path = os->GetString();
-      Condition *entry = dynamic_cast<Condition *>(pair->Value());
-      if (!entry) {
-        continue;
-      }
+    for (const auto &entry : entries) {
+      TString path = entry.first.c_str();
       path.ReplaceAll("/", "*");
-      entry->Write(path.Data());
+      entry.second->Write(path.Data());
     }
   }
   f->Close();
@@ -234,9 +230,10 @@ Bool_t Manager::initFromSnapshot(const char *snapshotFileName, Bool_t overwrite)
     if (!correspondingId) {
       LOG(ERROR) << R"(id for ")" << path.Data()
                  << R"(" not found in the snapshot (while entry was). This entry is skipped!)" << FairLogger::endl;
-      break;
+      delete pair->Value();
+      continue;
     }
-    Bool_t cached = mConditionCache.Contains(path.Data());
+    Bool_t cached = mConditionCache.contains(path.Data());
     Bool_t registeredId = kFALSE;
     TIter iter(mIds);
     ConditionId *idT = nullptr;
@@ -253,27 +250,28 @@ Bool_t Manager::initFromSnapshot(const char *snapshotFileName, Bool_t overwrite)
                      << R"(". Removing it before caching from snapshot)" << FairLogger::endl;
         unloadFromCache(path.Data());
       }
-      mConditionCache.Add(pair->Key(), pair->Value());
+      cacheCondition(path.Data(), (Condition *) pair->Value());
       mIds->Add(id);
       nAdded++;
     } else {
       if (cached || registeredId) {
         LOG(WARNING) << R"(An entry was already cached for ")" << path.Data()
                      << R"(". Not adding this object from snapshot)" << FairLogger::endl;
+        delete pair->Value();
       } else {
-        mConditionCache.Add(pair->Key(), pair->Value());
+        cacheCondition(path.Data(), (Condition *) pair->Value());
         mIds->Add(id);
         nAdded++;
       }
     }
   }
 
-  // mCondition is the new owner of the cache
-  mConditionCache.SetOwnerKeyValue(kTRUE, kTRUE);
-  entriesMap->SetOwnerKeyValue(kFALSE, kFALSE);
+  // mConditionCache is the new owner of the entries, the ones not cached were deleted
+  entriesMap->SetOwnerKeyValue(kTRUE, kFALSE);
   mIds->SetOwner(kTRUE);
   idsList->SetOwner(kFALSE);
-  LOG(INFO) << nAdded << " new (entry,id) cached. Total number " << mConditionCache.GetEntries() << FairLogger::endl;
+  LOG(INFO) << nAdded << " new (entry,id) cached. Total number " << mConditionCache.getStatistics().entries
+            << FairLogger::endl;
 
   f->Close();
   delete f;
@@ -320,8 +318,6 @@ Manager::Manager()
   mFactories.SetOwner(1);
   mActiveStorages.SetOwner(1);
   mSpecificStorages.SetOwner(1);
-  mConditionCache.SetName("CDBConditionCache");
-  mConditionCache.SetOwnerKeyValue(kTRUE, kTRUE);
 
   mStorageMap = new TMap();
   mStorageMap->SetOwner(1);
@@ -971,7 +967,7 @@ Condition *Manager::getCondition(const IdPath &path, const IdRunRange &runRange,
   return getCondition(ConditionId(path, runRange, version, subVersion));
 }
 
-Condition *Manager::getCondition(const ConditionId &queryId, Bool_t forceCaching)
+Condition *Manager::getCondition(const ConditionId &queryId, Bool_t forceCaching, Bool_t pin)
 {
   // get an  Condition object from the database
 
@@ -991,20 +987,40 @@ Condition *Manager::getCondition(const ConditionId &queryId, Bool_t forceCaching
   if (mLock && !(mRun >= queryId.getFirstRun() && mRun <= queryId.getLastRun()))
     LOG(FATAL) << "Lock is ON: cannot use different run number than the internal one!" << FairLogger::endl;
 
-  if (mCache && !(mRun >= queryId.getFirstRun() && mRun <= queryId.getLastRun()))
+  if (mCache && !forceCaching && !(mRun >= queryId.getFirstRun() && mRun <= queryId.getLastRun()))
     LOG(WARNING) << "Run number explicitly set in query: CDB cache temporarily disabled!" << FairLogger::endl;
 
+  // the cache is looked up for the current run, or with forceCaching for the run of a single run query
+  Bool_t useCache = kFALSE;
+  Int_t cacheRun = mRun;
+  if (mCache && queryId.getFirstRun() == mRun) {
+    useCache = kTRUE;
+  } else if (mCache && forceCaching && queryId.getFirstRun() == queryId.getLastRun()) {
+    useCache = kTRUE;
+    cacheRun = queryId.getFirstRun();
+  }
+
   Condition *entry = nullptr;
 
   // first look into map of cached objects
-  if (mCache && queryId.getFirstRun() == mRun) {
-    entry = (Condition *) mConditionCache.GetValue(queryId.getPathString());
+  if (useCache) {
+    entry = mConditionCache.get(queryId.getPathString().Data(), cacheRun, kTRUE, pin);
   }
   if (entry) {
     LOG(DEBUG) << "Object " << queryId.getPathString().Data() << " retrieved from cache !!" << FairLogger::endl;
     return entry;
   }
 
+  // storages, snapshot and list of ids are not thread-safe, one retrieval at a time. The object may have been
+  // cached by another thread meanwhile
+  std::lock_guard<std::mutex> lock(mStorageMutex);
+  if (useCache) {
+    entry = mConditionCache.get(queryId.getPathString().Data(), cacheRun, kFALSE, pin);
+    if (entry) {
+      return entry;
+    }
+  }
+
   // if snapshot flag is set, try getting from the snapshot
   // but in the case a specific storage is specified for this path
   StorageParameters *aPar = selectSpecificStorage(queryId.getPathString());
@@ -1015,7 +1031,7 @@ Condition *Manager::getCondition(const ConditionId &queryId, Bool_t forceCaching
         LOG(INFO) << R"(Object ")" << queryId.getPathString().Data() << R"(" retrieved from the snapshot.)"
                   << FairLogger::endl;
         if (queryId.getFirstRun() == mRun) { // no need to check mCache, mSnapshotMode not possible otherwise
-          cacheCondition(queryId.getPathString(), entry);
+          entry = cacheCondition(queryId.getPathString(), entry, pin);
         }
 
         if (!mIds->Contains(&entry->getId())) {
@@ -1060,7 +1076,7 @@ Condition *Manager::getCondition(const ConditionId &queryId, Bool_t forceCaching
   entry = aStorage->getObject(finalQueryId);
 
   if (entry && mCache && (queryId.getFirstRun() == mRun || forceCaching)) {
-    cacheCondition(queryId.getPathString(), entry);
+    entry = cacheCondition(queryId.getPathString(), entry, pin);
   }
 
   if (entry && !mIds->Contains(&entry->getId())) {
@@ -1226,7 +1242,7 @@ ConditionId *Manager::getId(const ConditionId &query)
 
   // first look into map of cached objects
   if (mCache && query.getFirstRun() == mRun) {
-    entry = (Condition *) mConditionCache.GetValue(query.getPathString());
+    entry = mConditionCache.get(query.getPathString().Data(), mRun);
   }
 
   if (entry) {
@@ -1384,15 +1400,19 @@ TList *Manager::getAllObjects(const ConditionId &query)
   }
 
   // caching entries
-  TIter iter(result);
-  Condition *entry = nullptr;
-  while ((entry = dynamic_cast<Condition *>(iter.Next()))) {
+  for (Int_t i = 0; i < result->GetEntries(); i++) {
+    Condition *entry = dynamic_cast<Condition *>(result->At(i));
+    if (!entry) {
+      continue;
+    }
 
     if (!mIds->Contains(&entry->getId())) {
       mIds->Add(entry->getId().Clone());
     }
     if (mCache && (query.getFirstRun() == mRun)) {
-      cacheCondition(entry->getId().getPathString(), entry);
+      // a duplicate of a cached object is deleted by cacheCondition, the cached object takes its place
+      result->RemoveAt(i);
+      result->AddAt(cacheCondition(entry->getId().getPathString(), entry), i);
     }
   }
 
@@ -1489,21 +1509,41 @@ const char *Manager::getMirrorSEs() const
   return mDefaultStorage->getMirrorSEs();
 }
 
-void Manager::cacheCondition(const char *path, Condition *entry)
+Condition *Manager::cacheCondition(const char *path, Condition *entry, Bool_t pin)
 {
-  // cache  Condition. Cache is valid until run number is changed.
+  // cache  Condition. Cache is valid until run number is changed, unless a cache budget is set.
 
-  Condition *chkCondition = dynamic_cast<Condition *>(mConditionCache.GetValue(path));
-
-  if (chkCondition) {
+  Condition *cached = mConditionCache.getOrAdd(path, entry, pin);
+  if (cached != entry) {
     LOG(DEBUG) << "Object " << path << " already in cache !!" << FairLogger::endl;
-    return;
-  } else {
-    LOG(DEBUG) << "Caching entry " << path << FairLogger::endl;
+    delete entry;
+    return cached;
   }
+  LOG(DEBUG) << "Cached entry " << path << ", cache entries: " << mConditionCache.getStatistics().entries
+             << FairLogger::endl;
+  return entry;
+}
 
-  mConditionCache.Add(new TObjString(path), entry);
-  LOG(DEBUG) << "Cache entries: " << mConditionCache.GetEntries() << FairLogger::endl;
+Bool_t Manager::pinCondition(const char *path, Int_t run)
+{
+  // protect the cached object from eviction and from run changes until unpinned
+
+  if (!mConditionCache.pin(path, run < 0 ? mRun : run)) {
+    LOG(WARNING) << R"(Cache does not contain object ")" << path << R"(" for run )" << (run < 0 ? mRun : run)
+                 << FairLogger::endl;
+    return kFALSE;
+  }
+  return kTRUE;
+}
+
+void Manager::unpinCondition(const char *path, Int_t run)
+{
+  mConditionCache.unpin(path, run < 0 ? mRun : run);
+}
+
+void Manager::unpinCondition(const Condition *entry)
+{
+  mConditionCache.unpin(entry->getId().getPathString().Data(), entry);
 }
 
 void Manager::print(Option_t * /*option*/) const
@@ -1532,6 +1572,10 @@ void Manager::print(Option_t * /*option*/) const
   if (mdrainStorage) {
     output += Form("*** drain Storage URI: %s\n", mdrainStorage->getUri().Data());
   }
+  auto statistics = mConditionCache.getStatistics();
+  output += Form("*** Cache: %llu objects, %llu bytes (budget %llu), %llu hits, %llu misses, %llu evictions\n",
+                 statistics.entries, statistics.bytes, mConditionCache.getBudget(), statistics.hits,
+                 statistics.misses, statistics.evictions);
   LOG(INFO) << output.Data() << FairLogger::endl;
 }
 
@@ -1549,6 +1593,7 @@ void Manager::setRun(Int_t run)
   }
 
   mRun = run;
+  mConditionCache.setCurrentRun(run);
 
   if (mRaw) {
     // here the LHCPeriod xml file is parsed; the string containing the correct period is returned;
@@ -1557,13 +1602,16 @@ void Manager::setRun(Int_t run)
       LOG(INFO) << "LHCPeriod alien folder for current run already in memory" << FairLogger::endl;
     } else {
       setDefaultStorageFromRun(mRun);
-      if (mConditionCache.GetEntries() != 0) {
+      if (!mConditionCache.getBudget()) {
         clearCache();
       }
       return;
     }
   }
-  clearCache();
+  // with a budget the cached objects are kept, looked up by run range and evicted when needed
+  if (!mConditionCache.getBudget()) {
+    clearCache();
+  }
   queryStorages();
 }
 
@@ -1571,23 +1619,8 @@ void Manager::clearCache()
 {
   // clear  Condition cache
 
-  LOG(DEBUG) << "Cache entries to be deleted: " << mConditionCache.GetEntries() << FairLogger::endl;
-
-  /*
-  // To clean entries one by one
-  TIter iter(mConditionCache.GetTable());
-  TPair* pair=0;
-  while((pair= dynamic_cast<TPair*> (iter.Next()))){
-
-  TObjString* key = dynamic_cast<TObjString*> (pair->Key());
-   Condition* entry = dynamic_cast< Condition*> (pair->Value());
-  LOG(DEBUG) << "Deleting entry: " << key->GetName() << FairLogger::endl;
-  if (entry) delete entry;
-  delete mConditionCache.Remove(key);
-  }
-  */
-  mConditionCache.DeleteAll();
-  LOG(DEBUG) << "After deleting - Cache entries: " << mConditionCache.GetEntries() << FairLogger::endl;
+  LOG(DEBUG) << "Cache entries to be deleted: " << mConditionCache.getStatistics().entries << FairLogger::endl;
+  mConditionCache.clear();
 }
 
 void Manager::unloadFromCache(const char *path)
@@ -1606,10 +1639,10 @@ void Manager::unloadFromCache(const char *path)
   }
 
   if (!queryPath.isWildcard()) { // path is not wildcard, get it directly from the cache and unload it!
-    if (mConditionCache.Contains(path)) {
+    std::string pathStr(path);
+    if (mConditionCache.contains(pathStr)) {
       LOG(DEBUG) << R"(Unloading object ")" << path << R"(" from cache and from list of ids)" << FairLogger::endl;
-      TObjString pathStr(path);
-      delete mConditionCache.Remove(&pathStr);
+      mConditionCache.remove([&pathStr](const std::string &entryPath) { return entryPath == pathStr; });
       // we do not remove from the list of ConditionId's (it's not very coherent but we leave the
       // id for the benefit of the userinfo)
       /*
@@ -1622,39 +1655,21 @@ void Manager::unloadFromCache(const char *path)
     } else {
       LOG(WARNING) << R"(Cache does not contain object ")" << path << R"("!)" << FairLogger::endl;
     }
-    LOG(DEBUG) << "Cache entries: " << mConditionCache.GetEntries() << FairLogger::endl;
+    LOG(DEBUG) << "Cache entries: " << mConditionCache.getStatistics().entries << FairLogger::endl;
     return;
   }
 
   // path is wildcard: loop on the cache and unload all comprised objects!
-  TIter iter(mConditionCache.GetTable());
-  TPair *pair = nullptr;
-  Int_t removed = 0;
-
-  while ((pair = dynamic_cast<TPair *>(iter.Next()))) {
-    IdPath entryPath = pair->Key()->GetName();
-    if (queryPath.isSupersetOf(entryPath)) {
-      LOG(DEBUG) << R"(Unloading object ")" << entryPath.getPathString().Data() << R"(" from cache and from list of ids)"
-                 << FairLogger::endl;
-      TObjString pathStr(entryPath.getPathString());
-      delete mConditionCache.Remove(&pathStr);
-      removed++;
-
-      // we do not remove from the list of ConditionId's (it's not very coherent but we leave the
-      // id for the benefit of the userinfo)
-      /*
-         TIter iterids(mIds);
-         ConditionId *anId = 0;
-         while((anId = dynamic_cast<ConditionId*> (iterids.Next()))){
-          IdPath aPath = anId->getPath();
-         TString aPathStr = aPath.getPath();
-         if(queryPath.isSupersetOf(aPath)) {
-         delete mIds->Remove(anId);
-         }
-         }*/
+  // we do not remove from the list of ConditionId's (it's not very coherent but we leave the
+  // id for the benefit of the userinfo)
+  Int_t removed = mConditionCache.remove([&queryPath](const std::string &entryPath) {
+    if (!queryPath.isSupersetOf(IdPath(entryPath.c_str()))) {
+      return kFALSE;
     }
-  }
-  LOG(DEBUG) << "Cache entries and ids removed: " << removed << " Remaining: " << mConditionCache.GetEntries()
+    LOG(DEBUG) << R"(Unloading object ")" << entryPath << R"(" from cache and from list of ids)" << FairLogger::endl;
+    return kTRUE;
+  });
+  LOG(DEBUG) << "Cache entries and ids removed: " << removed << " Remaining: " << mConditionCache.getStatistics().entries
              << FairLogger::endl;
 }
 
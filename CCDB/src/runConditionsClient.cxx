@@ -22,7 +22,8 @@ void addCustomOptions(bpo::options_description& options)
   options.add_options()("parameter-name", bpo::value<string>()->default_value("DET/Calib/Histo"), "Parameter Name")(
     "operation-type", bpo::value<string>()->default_value("GET"), "Operation Type")(
     "data-source", bpo::value<string>()->default_value("OCDB"), "Data Source")(
-    "object-path", bpo::value<string>()->default_value("OCDB"), "Object Path");
+    "object-path", bpo::value<string>()->default_value("OCDB"), "Object Path")(
+    "prefetch-runs", bpo::value<int>()->default_value(0), "Number of following runs whose conditions are prefetched");
 }
 
 FairMQDevice* getDevice(const FairMQProgOptions& config) { return new ConditionsMQClient(); }
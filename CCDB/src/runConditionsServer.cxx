@@ -26,7 +26,13 @@ void addCustomOptions(bpo::options_description& options)
     "second-input-type", bpo::value<std::string>()->default_value("ROOT"), "Second input file type (ROOT/ASCII)")(
     "output-name", bpo::value<std::string>()->default_value(""), "Output file name")(
     "output-type", bpo::value<std::string>()->default_value("ROOT"), "Output file type")(
-    "channel-name", bpo::value<std::string>()->default_value("ROOT"), "Output channel name");
+    "channel-name", bpo::value<std::string>()->default_value("ROOT"), "Output channel name")(
+    "blob-cache-size", bpo::value<int>()->default_value(512),
+    "Memory budget in MB of the serialized conditions kept for repeated requests, 0 for no limit")(
+    "condition-cache-size", bpo::value<int>()->default_value(512),
+    "Memory budget in MB of the conditions cached by the CDB manager, 0 for no limit")(
+    "broker-timeout", bpo::value<int>()->default_value(5000),
+    "Time in ms to wait for a reply of the Riak broker");
 }
 
 FairMQDevice* getDevice(const FairMQProgOptions& config) { return new ConditionsMQServer(); }
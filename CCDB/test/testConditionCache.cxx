@@ -0,0 +1,193 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test CCDB ConditionCache
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <TNamed.h>
+#include <TROOT.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CCDB/Condition.h"
+#include "CCDB/ConditionCache.h"
+#include "CCDB/ConditionMetaData.h"
+#include "CCDB/IdPath.h"
+
+namespace o2
+{
+namespace CDB
+{
+namespace
+{
+Condition* makeCondition(const char* path, int firstRun, int lastRun, int size = 1000)
+{
+  return new Condition(new TNamed("payload", std::string(size, 'x').c_str()), IdPath(path), firstRun, lastRun,
+                       new ConditionMetaData(), kTRUE);
+}
+
+ULong64_t conditionSize(int size = 1000)
+{
+  std::unique_ptr<Condition> probe(makeCondition("A/B/C", 0, 0, size));
+  return ConditionCache::getSerializedSize(probe.get());
+}
+}
+
+BOOST_AUTO_TEST_CASE(ConditionCache_lru)
+{
+  ConditionCache cache;
+  auto size = conditionSize();
+  cache.setBudget(3 * size + size / 2);
+  cache.setCurrentRun(1);
+
+  BOOST_CHECK(cache.add("A/B/C", makeCondition("A/B/C", 0, 10))); // valid for the current run
+  BOOST_CHECK(cache.add("A/B/D", makeCondition("A/B/D", 20, 30)));
+  BOOST_CHECK(cache.add("A/B/E", makeCondition("A/B/E", 20, 30)));
+  BOOST_CHECK(cache.get("A/B/D", 25));
+  BOOST_CHECK(cache.pin("A/B/E", 25));
+
+  // over budget: D is the least recently used but C is in use and E pinned
+  BOOST_CHECK(cache.add("A/B/F", makeCondition("A/B/F", 20, 30)));
+  BOOST_CHECK(cache.get("A/B/C", 5));
+  BOOST_CHECK(!cache.get("A/B/C", 11));
+  BOOST_CHECK(!cache.get("A/B/D", 25));
+  BOOST_CHECK(cache.get("A/B/E", 25));
+  BOOST_CHECK(cache.get("A/B/F", 25));
+
+  auto statistics = cache.getStatistics();
+  BOOST_CHECK_EQUAL(statistics.entries, 3);
+  BOOST_CHECK_EQUAL(statistics.evictions, 1);
+  BOOST_CHECK_EQUAL(statistics.hits, 4);
+  BOOST_CHECK_EQUAL(statistics.misses, 2);
+  BOOST_CHECK(statistics.bytes <= cache.getBudget());
+
+  // same path, other run range
+  BOOST_CHECK(cache.add("A/B/C", makeCondition("A/B/C", 11, 20)));
+  BOOST_CHECK(cache.get("A/B/C", 11));
+  auto duplicate = makeCondition("A/B/C", 11, 20);
+  BOOST_CHECK(!cache.add("A/B/C", duplicate));
+  delete duplicate;
+
+  BOOST_CHECK_EQUAL(cache.remove([](const std::string& path) { return path == "A/B/C"; }), 2);
+  BOOST_CHECK(!cache.contains("A/B/C"));
+  cache.clear();
+  BOOST_CHECK_EQUAL(cache.getStatistics().bytes, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ConditionCache_global_lru)
+{
+  ConditionCache cache;
+  auto size = conditionSize();
+  cache.setBudget(5 * size + size / 2);
+
+  // whatever the shards of the paths, the least recently used object overall is evicted
+  std::vector<std::string> paths;
+  for (int i = 0; i < 9; i++) {
+    paths.push_back("DET/Calib/Param" + std::to_string(i));
+  }
+  for (int i = 0; i < 5; i++) {
+    BOOST_CHECK(cache.add(paths[i], makeCondition(paths[i].c_str(), 0, 10)));
+  }
+  BOOST_CHECK(cache.get(paths[0], 5));
+  BOOST_CHECK(cache.get(paths[2], 5));
+
+  // order of use: 1, 3, 4, 0, 2
+  const int evicted[] = { 1, 3, 4, 0 };
+  for (int i = 5; i < 9; i++) {
+    BOOST_CHECK(cache.add(paths[i], makeCondition(paths[i].c_str(), 0, 10)));
+    BOOST_CHECK(!cache.contains(paths[evicted[i - 5]]));
+    BOOST_CHECK_EQUAL(cache.getStatistics().entries, 5);
+  }
+  BOOST_CHECK(cache.contains(paths[2]));
+  BOOST_CHECK_EQUAL(cache.getStatistics().evictions, 4);
+}
+
+BOOST_AUTO_TEST_CASE(ConditionCache_no_budget)
+{
+  ConditionCache cache;
+  auto size = conditionSize();
+
+  // without budget the objects are not streamed for their size
+  auto first = makeCondition("A/B/C", 0, 10);
+  BOOST_CHECK(cache.getOrAdd("A/B/C", first) == first);
+  BOOST_CHECK(cache.add("A/B/D", makeCondition("A/B/D", 0, 10)));
+  BOOST_CHECK_EQUAL(cache.getStatistics().bytes, 0);
+
+  // the object cached before is returned for a duplicate, which stays owned by the caller
+  std::unique_ptr<Condition> duplicate(makeCondition("A/B/C", 0, 10));
+  BOOST_CHECK(cache.getOrAdd("A/B/C", duplicate.get()) == first);
+
+  // the objects are measured when the budget is set, D is now the least recently used
+  cache.setBudget(size + size / 2);
+  auto statistics = cache.getStatistics();
+  BOOST_CHECK_EQUAL(statistics.entries, 1);
+  BOOST_CHECK_EQUAL(statistics.bytes, size);
+  BOOST_CHECK(cache.contains("A/B/C"));
+}
+
+BOOST_AUTO_TEST_CASE(ConditionCache_pinned_lookup)
+{
+  ConditionCache cache;
+  auto size = conditionSize();
+  cache.setBudget(size + size / 2);
+
+  // pinned when added, B is evicted in place of A
+  auto first = makeCondition("A/B/C", 0, 10);
+  BOOST_CHECK(cache.getOrAdd("A/B/C", first, kTRUE) == first);
+  BOOST_CHECK(cache.add("A/B/D", makeCondition("A/B/D", 0, 10)));
+  BOOST_CHECK(cache.add("A/B/E", makeCondition("A/B/E", 0, 10)));
+  BOOST_CHECK(cache.contains("A/B/C"));
+  BOOST_CHECK(!cache.contains("A/B/D"));
+
+  // pinned again by the lookup, the pins are released by object
+  BOOST_CHECK(cache.get("A/B/C", 5, kTRUE, kTRUE) == first);
+  cache.unpin("A/B/C", first);
+  BOOST_CHECK(cache.contains("A/B/C"));
+  BOOST_CHECK(!cache.contains("A/B/E"));
+  cache.unpin("A/B/C", first);
+  BOOST_CHECK(cache.add("A/B/F", makeCondition("A/B/F", 0, 10)));
+  BOOST_CHECK(!cache.contains("A/B/C"));
+  BOOST_CHECK_EQUAL(cache.getStatistics().entries, 1);
+}
+
+BOOST_AUTO_TEST_CASE(ConditionCache_concurrent)
+{
+  ROOT::EnableThreadSafety(); // objects are created and streamed for their size in the threads
+  ConditionCache cache;
+  const int nThreads = 4;
+  auto size = conditionSize(100);
+  cache.setBudget(20 * size);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nThreads; t++) {
+    threads.emplace_back([&cache, t]() {
+      for (int i = 0; i < 2000; i++) {
+        std::string path = "TPC/Calib/Param" + std::to_string((i * 7 + t) % 50);
+        int run = i % 100;
+        if (!cache.get(path, run)) {
+          auto entry = makeCondition(path.c_str(), run, run + 2, 100);
+          if (!cache.add(path, entry)) {
+            delete entry;
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto statistics = cache.getStatistics();
+  BOOST_CHECK_EQUAL(statistics.hits + statistics.misses, nThreads * 2000);
+  // each thread may exceed the budget by the object it just added
+  BOOST_CHECK(statistics.bytes <= cache.getBudget() + nThreads * size);
+}
+}
+}
@@ -0,0 +1,132 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test CCDB ConditionIdIndex
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "CCDB/ConditionIdIndex.h"
+
+namespace o2
+{
+namespace CDB
+{
+namespace
+{
+// reference: scan of all the objects, as done on the directory content
+const ConditionIdIndex::Entry* findHighestByScan(const ConditionIdIndex& index, Int_t firstRun, Int_t lastRun,
+                                                 Int_t version, bool& ambiguous)
+{
+  const ConditionIdIndex::Entry* result = nullptr;
+  ambiguous = false;
+  for (const auto& entry : index.getEntries()) {
+    if (entry.firstRun > firstRun || entry.lastRun < lastRun || (version >= 0 && entry.version != version)) {
+      continue;
+    }
+    if (!result || entry.version > result->version ||
+        (entry.version == result->version && entry.subVersion > result->subVersion)) {
+      result = &entry;
+      ambiguous = false;
+    } else if (entry.version == result->version && entry.subVersion == result->subVersion) {
+      ambiguous = true;
+    }
+  }
+  return result;
+}
+}
+
+BOOST_AUTO_TEST_CASE(ConditionIdIndex_lookup)
+{
+  ConditionIdIndex index;
+  index.add(0, 999999999, 1, 0);
+  index.add(100, 200, 2, 0);
+  index.add(150, 160, 2, 1);
+  index.add(300, 300, 3, 0);
+  index.add(300, 400, 3, 0);
+
+  bool ambiguous = false;
+  auto entry = index.findHighest(50, 50, -1, ambiguous);
+  BOOST_REQUIRE(entry);
+  BOOST_CHECK_EQUAL(entry->version, 1);
+  entry = index.findHighest(155, 155, -1, ambiguous);
+  BOOST_REQUIRE(entry);
+  BOOST_CHECK(entry->version == 2 && entry->subVersion == 1);
+  entry = index.findHighest(155, 155, 1, ambiguous);
+  BOOST_REQUIRE(entry);
+  BOOST_CHECK_EQUAL(entry->version, 1);
+  entry = index.findHighest(140, 170, -1, ambiguous);
+  BOOST_REQUIRE(entry);
+  BOOST_CHECK(entry->version == 2 && entry->subVersion == 0);
+  entry = index.findHighest(300, 300, -1, ambiguous);
+  BOOST_CHECK(entry && ambiguous);
+  entry = index.findHighest(301, 301, -1, ambiguous);
+  BOOST_CHECK(entry && entry->version == 3 && !ambiguous);
+  BOOST_CHECK(!index.findHighest(155, 155, 4, ambiguous));
+  BOOST_CHECK(!index.findHighest(-1, -1, -1, ambiguous));
+  BOOST_CHECK(index.find(155, 155, 2, 0));
+  BOOST_CHECK(!index.find(250, 250, 2, 0));
+}
+
+BOOST_AUTO_TEST_CASE(ConditionIdIndex_benchmark)
+{
+  // thousands of objects with random run ranges, compared with the full scan
+  const int nObjects = 5000, nRuns = 100000, nQueries = 20000;
+  std::mt19937 gen(1234);
+  std::uniform_int_distribution<int> runDist(0, nRuns), lengthDist(0, 2000), versionDist(0, 20), subDist(0, 5);
+
+  ConditionIdIndex index;
+  for (int i = 0; i < nObjects; i++) {
+    int first = runDist(gen);
+    index.add(first, first + lengthDist(gen), versionDist(gen), subDist(gen));
+  }
+
+  std::vector<std::pair<int, int>> queries(nQueries);
+  for (auto& query : queries) {
+    query.first = runDist(gen);
+    query.second = versionDist(gen) < 2 ? versionDist(gen) : -1;
+  }
+
+  bool ambiguous = false, ambiguousRef = false;
+  index.findHighest(0, 0, -1, ambiguous); // build the tables outside of the timing
+  auto start = std::chrono::high_resolution_clock::now();
+  size_t found = 0;
+  for (const auto& query : queries) {
+    found += index.findHighest(query.first, query.first, query.second, ambiguous) != nullptr;
+  }
+  std::chrono::duration<double, std::micro> tIndex = std::chrono::high_resolution_clock::now() - start;
+
+  start = std::chrono::high_resolution_clock::now();
+  size_t foundRef = 0;
+  for (const auto& query : queries) {
+    foundRef += findHighestByScan(index, query.first, query.first, query.second, ambiguousRef) != nullptr;
+  }
+  std::chrono::duration<double, std::micro> tScan = std::chrono::high_resolution_clock::now() - start;
+  BOOST_CHECK_EQUAL(found, foundRef);
+  std::cout << nObjects << " objects, per query: index " << tIndex.count() / nQueries << " us, scan "
+            << tScan.count() / nQueries << " us" << std::endl;
+
+  for (const auto& query : queries) {
+    for (int last : { query.first, query.first + 10 }) {
+      auto entry = index.findHighest(query.first, last, query.second, ambiguous);
+      auto entryRef = findHighestByScan(index, query.first, last, query.second, ambiguousRef);
+      BOOST_REQUIRE_EQUAL(entry == nullptr, entryRef == nullptr);
+      if (entry) {
+        BOOST_CHECK_EQUAL(entry->version, entryRef->version);
+        BOOST_CHECK_EQUAL(entry->subVersion, entryRef->subVersion);
+        BOOST_CHECK_EQUAL(ambiguous, ambiguousRef);
+      }
+    }
+  }
+}
+}
+}
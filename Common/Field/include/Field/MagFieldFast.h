@@ -15,23 +15,38 @@
 #define ALICEO2_FIELD_MAGFIELDFAST_H_
 
 #include <Rtypes.h>
+#include <array>
 #include <string>
+#include <vector>
 
 namespace o2
 {
 namespace field
 {
+class MagneticWrapperChebyshev;
+
 // Fast polynomial parametrization of Alice magnetic field, to be used for reconstruction.
 // Solenoid part fitted by Shuto Yamasaki from AliMagWrapCheb in the |Z|<260Interface and R<500 cm
-// Dipole part: to do
+// Outside of the solenoid part (dipole, muon arm) the field is given by cubic polynomials on a regular
+// grid of cells, fitted to the measured map by BuildGrid with the requested precision
 class MagFieldFast
 {
  public:
   enum { kNSolRRanges = 5, kNSolZRanges = 22, kNQuadrants = 4, kNPolCoefs = 20 };
   enum EDim { kX, kY, kZ, kNDim };
+  static constexpr int kBlockSize = 32; // number of points evaluated together by the batched Field
   struct SolParam {
     float parBxyz[kNDim][kNPolCoefs];
   };
+  /// regular (x,y,z) grid of cells, each one with its own polynomials in the coordinates relative to the cell center
+  struct GridParam {
+    int nCells[kNDim] = { 0, 0, 0 };
+    float xyzMin[kNDim] = { 0.f, 0.f, 0.f };
+    float xyzMax[kNDim] = { 0.f, 0.f, 0.f };
+    float cellSize[kNDim] = { 0.f, 0.f, 0.f };
+    float cellSizeInv[kNDim] = { 0.f, 0.f, 0.f };
+    std::vector<SolParam> cells; // cell (ix,iy,iz) is at ix + nCells[kX]*(iy + nCells[kY]*iz)
+  };
 
   MagFieldFast(const std::string inpFName = "");
   MagFieldFast(float factor, int nomField = 5, const std::string inpFmt = "$(O2_ROOT)/share/Common/maps/sol%dk.txt");
@@ -39,11 +54,26 @@ class MagFieldFast
   ~MagFieldFast() = default;
 
   bool LoadData(const std::string inpFName);
+  bool LoadGridData(const std::string inpFName);
+  bool WriteGridData(const std::string outFName) const;
+
+  /// fit the grid parametrization of the box xyzMin:xyzMax to the measured map, starting from nCells
+  /// and refining the grid until the max deviation is below tolerance (kG) or maxCells is reached
+  bool BuildGrid(const MagneticWrapperChebyshev& map, const float xyzMin[3], const float xyzMax[3], const int nCells[3],
+                 float tolerance, int maxCells = 100000);
+  bool HasGrid() const { return !mGrid.cells.empty(); }
+  const GridParam& getGrid() const { return mGrid; }
 
   bool Field(const double xyz[3], double bxyz[3]) const;
   bool Field(const float xyz[3], float bxyz[3]) const;
   bool GetBcomp(EDim comp, const double xyz[3], double& b) const;
   bool GetBcomp(EDim comp, const float xyz[3], float& b) const;
+  bool Field(const std::array<float, 3>& xyz, std::array<float, 3>& bxyz) const { return Field(xyz.data(), bxyz.data()); }
+
+  /// field at n points, xyz and bxyz are arrays of n triplets. Returns the number of points not covered by
+  /// the parametrization, their field is left untouched and, if provided, their flag ok[i] is set to false
+  int Field(int n, const double* xyz, double* bxyz, bool* ok = nullptr) const;
+  int Field(int n, const float* xyz, float* bxyz, bool* ok = nullptr) const;
 
   bool GetBx(const double xyz[3], double& bx) const { return GetBcomp(kX, xyz, bx); }
   bool GetBx(const float xyz[3], float& bx) const { return GetBcomp(kX, xyz, bx); }
@@ -53,8 +83,21 @@ class MagFieldFast
   bool GetBz(const float xyz[3], float& bz) const { return GetBcomp(kZ, xyz, bz); }
   void setFactorSol(float v = 1.f) { mFactorSol = v; }
   float getFactorSol() const { return mFactorSol; }
+  /// the grid is fitted to the map w/o scaling, factorSol is applied above zSolToDip, factorDip below
+  void setGridFactors(float factorSol, float factorDip, float zSolToDip)
+  {
+    mGridFactorSol = factorSol;
+    mGridFactorDip = factorDip;
+    mGridSolToDipZ = zSolToDip;
+  }
+
  protected:
   bool GetSegment(const float xyz[3], int& zSeg, int& rSeg, int& quadrant) const;
+  bool GetGridCell(const float xyz[3], int& cell, float loc[3]) const;
+  const SolParam* GetParam(const float xyz[3], float loc[3], float& factor) const;
+  template <typename T>
+  int FieldBatch(int n, const T* xyz, T* bxyz, bool* ok) const;
+  void SetupGrid(GridParam& grid, const float xyzMin[3], const float xyzMax[3], const int nCells[3]) const;
   static const float kSolR2Max[kNSolRRanges]; // Rmax2 of each range
   static const float kSolZMax;                // max |Z| for solenoid parametrization
 
@@ -65,9 +108,14 @@ class MagFieldFast
   }
 
   float CalcPol(const float* cf, float x, float y, float z) const;
+  void CalcPol(const float (*cf)[kBlockSize], const float (*xyz)[kBlockSize], int n, float* res) const;
 
   float mFactorSol; // scaling factor
   SolParam mSolPar[kNSolRRanges][kNSolZRanges][kNQuadrants];
+  float mGridFactorSol = 1.f;     // scaling factor of the grid above mGridSolToDipZ
+  float mGridFactorDip = 1.f;     // scaling factor of the grid below mGridSolToDipZ
+  float mGridSolToDipZ = -700.f;  // Z of transition from L3 to Dipole field
+  GridParam mGrid;                //! optional grid parametrization, loaded from text file
 
   ClassDef(MagFieldFast, 1)
 };
@@ -86,6 +134,57 @@ inline float MagFieldFast::CalcPol(const float* cf, float x, float y, float z) c
 
   return val;
 }
+
+inline void MagFieldFast::CalcPol(const float (*cf)[kBlockSize], const float (*xyz)[kBlockSize], int n,
+                                  float* res) const
+{
+  /// calculate polynomials of n<=kBlockSize points, with coefficient i of point j in cf[i][j]
+  const float* __restrict__ px = xyz[kX];
+  const float* __restrict__ py = xyz[kY];
+  const float* __restrict__ pz = xyz[kZ];
+  for (int ip = 0; ip < n; ip++) {
+    float x = px[ip], y = py[ip], z = pz[ip];
+    res[ip] = cf[0][ip] +
+              x * (cf[1][ip] + x * (cf[4][ip] + x * cf[10][ip] + y * cf[11][ip] + z * cf[12][ip]) +
+                   y * (cf[5][ip] + z * cf[14][ip])) +
+              y * (cf[2][ip] + y * (cf[7][ip] + x * cf[13][ip] + y * cf[16][ip] + z * cf[17][ip]) + z * (cf[8][ip])) +
+              z * (cf[3][ip] + z * (cf[9][ip] + x * cf[15][ip] + y * cf[18][ip] + z * cf[19][ip]) + x * (cf[6][ip]));
+  }
+}
+
+inline bool MagFieldFast::GetGridCell(const float xyz[3], int& cell, float loc[3]) const
+{
+  /// get the grid cell of the point and the point coordinates relative to the cell center
+  int id[kNDim];
+  for (int i = 0; i < kNDim; i++) {
+    float d = (xyz[i] - mGrid.xyzMin[i]) * mGrid.cellSizeInv[i];
+    if (d < 0.f || d >= mGrid.nCells[i]) {
+      return false;
+    }
+    id[i] = d;
+    loc[i] = xyz[i] - mGrid.xyzMin[i] - (id[i] + 0.5f) * mGrid.cellSize[i];
+  }
+  cell = id[kX] + mGrid.nCells[kX] * (id[kY] + mGrid.nCells[kY] * id[kZ]);
+  return true;
+}
+
+inline const MagFieldFast::SolParam* MagFieldFast::GetParam(const float xyz[3], float loc[3], float& factor) const
+{
+  /// get the parametrization of the point, the coordinates to use with it and the scaling factor
+  int zSeg, rSeg, quadrant, cell;
+  if (GetSegment(xyz, zSeg, rSeg, quadrant)) {
+    for (int i = 0; i < kNDim; i++) {
+      loc[i] = xyz[i];
+    }
+    factor = mFactorSol;
+    return &mSolPar[rSeg][zSeg][quadrant];
+  }
+  if (GetGridCell(xyz, cell, loc)) {
+    factor = xyz[kZ] > mGridSolToDipZ ? mGridFactorSol : mGridFactorDip;
+    return &mGrid.cells[cell];
+  }
+  return nullptr;
+}
 }
 }
 
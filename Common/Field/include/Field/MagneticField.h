@@ -73,8 +73,10 @@ class MagneticField : public FairField
     /// real field creation is here
     void CreateField();
 
-    /// allow fast field param
-    void        AllowFastField(bool v=true);
+    /// allow fast field param: the solenoid polynomials are always loaded, the grid parametrization of the rest
+    /// of the volume is loaded from gridFmt (formatted with the parameterization name) if available
+    void        AllowFastField(bool v=true,
+                               const std::string gridFmt = "$(O2_ROOT)/share/Common/maps/grid_%s.txt");
     
     /// Virtual methods from FairField
 
@@ -102,6 +104,10 @@ class MagneticField : public FairField
     /// Main interface from TVirtualMagField used in simulation
     void Field(const Double_t* __restrict__ point, Double_t* __restrict__ bField) override;
 
+    /// Method to calculate the field at n points, point and bField are arrays of n triplets.
+    /// The points in the measured map region are evaluated together
+    void Field(Int_t n, const Double_t* __restrict__ point, Double_t* __restrict__ bField);
+
     /// 3d field query alias for Alias Method to calculate the field at point xyz
     void GetBxyz(const Double_t p[3], Double_t* b) override { MagneticField::Field(p,b); }
 
@@ -259,6 +265,9 @@ class MagneticField : public FairField
       mBeamEnergy = energy;
     }
 
+    /// propagate the scaling factors of the measured map to the grid part of the fast field
+    void updateFastFieldFactors();
+
   protected:
     std::unique_ptr<MagneticWrapperChebyshev> mMeasuredMap; //! Measured part of the field map
     std::unique_ptr<MagFieldFast>             mFastField; // ! optional fast parametrization
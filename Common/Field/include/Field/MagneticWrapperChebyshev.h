@@ -20,6 +20,7 @@
 #include <TObjArray.h>                  // for TObjArray
 #include "MathUtils/Chebyshev3D.h"      // for Chebyshev3D
 #include "MathUtils/Chebyshev3DCalc.h"  // for _INC_CREATION_Chebyshev3D_
+#include "MathUtils/Chebyshev3DFlat.h"  // for Chebyshev3DFlat
 #include "Rtypes.h"                     // for Double_t, Int_t, Float_t, etc
 
 class FairLogger;  // lines 16-16
@@ -48,6 +49,9 @@ namespace field {
 ///  getTPCIntegral(double* xyz, double* bxyz);  for cartesian frame
 ///  or getTPCIntegralCylindrical(Double_t *rphiz, Double_t *b); for cylindrical frame
 ///  The units are kiloGauss and cm.
+///  After reading the object from the file buildFlatTables() should be called: the queries then use
+///  contiguous copies of the parameterizations, which are faster and can be evaluated concurrently.
+///  Many points can be evaluated at once with Field(int n, double* xyz, double* bxyz).
 class MagneticWrapperChebyshev : public TNamed
 {
 
@@ -72,6 +76,10 @@ class MagneticWrapperChebyshev : public TNamed
     /// Clears all dynamic parts
     void Clear(const Option_t * = "") override;
 
+    /// Copies the parameterization pieces to the contiguous tables used for the evaluation.
+    /// Done by the copy and loadData, must be called explicitly after reading from the file
+    void buildFlatTables();
+
     Int_t getNumberOfParametersSol() const
     {
       return mNumberOfParameterizationSolenoid;
@@ -209,6 +217,10 @@ class MagneticWrapperChebyshev : public TNamed
     /// it gets it at closest valid point
     virtual void Field(const Double_t *xyz, Double_t *b) const;
 
+    /// Computes field in cartesian coordinates for n points, xyz and b are arrays of n triplets.
+    /// The points of the same parameterization piece are evaluated together
+    void Field(Int_t n, const Double_t *xyz, Double_t *b) const;
+
     /// Computes Bz for the point in cartesian coordinates. If point is outside of the parameterized region
     /// it gets it at closest valid point
     Double_t getBz(const Double_t *xyz) const;
@@ -413,6 +425,11 @@ class MagneticWrapperChebyshev : public TNamed
     Float_t mMaxDipoleZ;     ///< Max Z of Dipole parameterization
     TObjArray *mParameterizationDipole; ///< Parameterization pieces for Dipole field
 
+    o2::mathUtils::Chebyshev3DFlat mFlatSolenoid; //! contiguous copy of the Solenoid parameterization
+    o2::mathUtils::Chebyshev3DFlat mFlatTPC;      //! contiguous copy of the TPCint parameterization
+    o2::mathUtils::Chebyshev3DFlat mFlatTPCRat;   //! contiguous copy of the TpcRatInt parameterization
+    o2::mathUtils::Chebyshev3DFlat mFlatDipole;   //! contiguous copy of the Dipole parameterization
+
     FairLogger *mLogger; //!
     ClassDefOverride(o2::field::MagneticWrapperChebyshev,
     2) // Wrapper class for the set of Chebishev parameterizations of Alice mag.field
@@ -13,11 +13,14 @@
 /// \author ruben.shahoyan@cern.ch
 //
 #include "Field/MagFieldFast.h"
+#include "Field/MagneticWrapperChebyshev.h"
 #include <FairLogger.h>
 #include <TString.h>
 #include <TSystem.h>
+#include <algorithm>
 #include <cmath>
 #include <fstream>
+#include <iomanip>
 #include <sstream>
 
 using namespace o2::field;
@@ -30,6 +33,109 @@ const float MagFieldFast::kSolR2Max[MagFieldFast::kNSolRRanges] = { 80.f * 80.f,
 
 const float MagFieldFast::kSolZMax = 550.0f;
 
+namespace
+{
+// powers of x, y, z of the terms of the polynomial, in the order of MagFieldFast::CalcPol
+const int kPolPow[MagFieldFast::kNPolCoefs][MagFieldFast::kNDim] = {
+  { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, { 2, 0, 0 }, { 1, 1, 0 }, { 1, 0, 1 },
+  { 0, 2, 0 }, { 0, 1, 1 }, { 0, 0, 2 }, { 3, 0, 0 }, { 2, 1, 0 }, { 2, 0, 1 }, { 1, 2, 0 },
+  { 1, 1, 1 }, { 1, 0, 2 }, { 0, 3, 0 }, { 0, 2, 1 }, { 0, 1, 2 }, { 0, 0, 3 }
+};
+const int kNFitPoints = 6;   // number of fit points per dimension in the cell
+const int kNCheckPoints = 5; // number of control points per dimension in the cell
+
+/// solve a*x = b for kNDim right-hand sides by Gaussian elimination with partial pivoting, x is returned in b
+bool solveNormalEquations(double a[MagFieldFast::kNPolCoefs][MagFieldFast::kNPolCoefs],
+                          double b[MagFieldFast::kNDim][MagFieldFast::kNPolCoefs])
+{
+  const int n = MagFieldFast::kNPolCoefs;
+  for (int col = 0; col < n; col++) {
+    int piv = col;
+    for (int row = col + 1; row < n; row++) {
+      if (std::abs(a[row][col]) > std::abs(a[piv][col])) {
+        piv = row;
+      }
+    }
+    if (std::abs(a[piv][col]) < 1e-12) {
+      return false;
+    }
+    if (piv != col) {
+      std::swap(a[piv], a[col]);
+      for (int k = 0; k < MagFieldFast::kNDim; k++) {
+        std::swap(b[k][piv], b[k][col]);
+      }
+    }
+    for (int row = col + 1; row < n; row++) {
+      double f = a[row][col] / a[col][col];
+      for (int j = col; j < n; j++) {
+        a[row][j] -= f * a[col][j];
+      }
+      for (int k = 0; k < MagFieldFast::kNDim; k++) {
+        b[k][row] -= f * b[k][col];
+      }
+    }
+  }
+  for (int row = n; row--;) {
+    for (int k = 0; k < MagFieldFast::kNDim; k++) {
+      double v = b[k][row];
+      for (int j = row + 1; j < n; j++) {
+        v -= a[row][j] * b[k][j];
+      }
+      b[k][row] = v / a[row][row];
+    }
+  }
+  return true;
+}
+
+/// least squares fit of the map field in the cell with cubic polynomials in coordinates relative to the center
+bool fitCell(const o2::field::MagneticWrapperChebyshev& map, const double center[3], const double halfSize[3],
+             MagFieldFast::SolParam& par)
+{
+  const int nc = MagFieldFast::kNPolCoefs, nd = MagFieldFast::kNDim;
+  // the fit is done in coordinates normalized to [-1:1] at the Chebyshev nodes
+  double nodes[kNFitPoints];
+  for (int k = 0; k < kNFitPoints; k++) {
+    nodes[k] = std::cos(M_PI * (k + 0.5) / kNFitPoints);
+  }
+  double ata[nc][nc] = { { 0. } }, atb[nd][nc] = { { 0. } };
+  for (int ix = 0; ix < kNFitPoints; ix++) {
+    for (int iy = 0; iy < kNFitPoints; iy++) {
+      for (int iz = 0; iz < kNFitPoints; iz++) {
+        const double u[nd] = { nodes[ix], nodes[iy], nodes[iz] };
+        double xyz[nd], b[nd], term[nc];
+        for (int i = 0; i < nd; i++) {
+          xyz[i] = center[i] + u[i] * halfSize[i];
+        }
+        map.Field(xyz, b);
+        for (int j = 0; j < nc; j++) {
+          term[j] = std::pow(u[0], kPolPow[j][0]) * std::pow(u[1], kPolPow[j][1]) * std::pow(u[2], kPolPow[j][2]);
+        }
+        for (int j = 0; j < nc; j++) {
+          for (int k = 0; k < nc; k++) {
+            ata[j][k] += term[j] * term[k];
+          }
+          for (int i = 0; i < nd; i++) {
+            atb[i][j] += term[j] * b[i];
+          }
+        }
+      }
+    }
+  }
+  if (!solveNormalEquations(ata, atb)) {
+    return false;
+  }
+  // convert to the coefficients of the polynomial in cm
+  for (int j = 0; j < nc; j++) {
+    double scale = std::pow(halfSize[0], kPolPow[j][0]) * std::pow(halfSize[1], kPolPow[j][1]) *
+                   std::pow(halfSize[2], kPolPow[j][2]);
+    for (int i = 0; i < nd; i++) {
+      par.parBxyz[i][j] = atb[i][j] / scale;
+    }
+  }
+  return true;
+}
+}
+
 //_______________________________________________________________________
 MagFieldFast::MagFieldFast(const string inpFName) : mFactorSol(1.f)
 {
@@ -104,18 +210,217 @@ bool MagFieldFast::LoadData(const string inpFName)
   return true;
 }
 
+//_______________________________________________________________________
+bool MagFieldFast::LoadGridData(const string inpFName)
+{
+  // load grid parametrization from text file
+  TString pth(inpFName.data());
+  gSystem->ExpandPathName(pth);
+  std::ifstream in(pth.Data(), std::ifstream::in);
+  if (in.fail()) {
+    LOG(ERROR) << "Failed to open file " << inpFName << FairLogger::endl;
+    return false;
+  }
+  GridParam grid;
+  std::string line, tag;
+  int nParams = 0, component = -1, header[4] = { -1, -1, -1, -1 }; // iX, iY, iZ, nVal
+  SolParam* curParam = nullptr;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#')
+      continue; // empy or comment
+    std::stringstream ss(line);
+    if (grid.cells.empty()) { // grid definition is expected first
+      int nc[kNDim];
+      float xyzMin[kNDim], xyzMax[kNDim];
+      if (!(ss >> tag >> nc[kX] >> nc[kY] >> nc[kZ] >> xyzMin[kX] >> xyzMin[kY] >> xyzMin[kZ] >> xyzMax[kX] >>
+            xyzMax[kY] >> xyzMax[kZ]) ||
+          tag != "GRID" || nc[kX] < 1 || nc[kY] < 1 || nc[kZ] < 1) {
+        LOG(ERROR) << "Wrong grid definition " << line << FairLogger::endl;
+        return false;
+      }
+      SetupGrid(grid, xyzMin, xyzMax, nc);
+      continue;
+    }
+    int cnt = 0;
+    if (component < 0) {
+      while (cnt < 4 && (ss >> header[cnt++]))
+        ;
+      if (cnt != 4 || header[3] != kNPolCoefs || header[0] < 0 || header[0] >= grid.nCells[kX] || header[1] < 0 ||
+          header[1] >= grid.nCells[kY] || header[2] < 0 || header[2] >= grid.nCells[kZ]) {
+        LOG(ERROR) << "Wrong header " << line << FairLogger::endl;
+        return false;
+      }
+      curParam = &grid.cells[header[0] + grid.nCells[kX] * (header[1] + grid.nCells[kY] * header[2])];
+    } else {
+      while (cnt < header[3] && (ss >> curParam->parBxyz[component][cnt++]))
+        ;
+      if (cnt != header[3]) {
+        LOG(ERROR) << "Wrong data (npar=" << cnt << ") for param " << header[0] << " " << header[1] << " "
+                   << header[2] << " " << header[3] << " " << line << FairLogger::endl;
+        return false;
+      }
+    }
+    component++;
+    if (component > 2) {
+      component = -1; // next header expected
+      nParams++;
+    }
+  }
+  if (grid.cells.empty() || nParams != int(grid.cells.size())) {
+    LOG(ERROR) << "Was expecting " << grid.cells.size() << " params, got " << nParams << " from " << inpFName
+               << FairLogger::endl;
+    return false;
+  }
+  mGrid = std::move(grid);
+  LOG(INFO) << "Loaded " << nParams << " grid params from " << inpFName << FairLogger::endl;
+  return true;
+}
+
+//_______________________________________________________________________
+bool MagFieldFast::WriteGridData(const string outFName) const
+{
+  // store grid parametrization in the text format of LoadGridData
+  if (!HasGrid()) {
+    LOG(ERROR) << "No grid parametrization to write" << FairLogger::endl;
+    return false;
+  }
+  TString pth(outFName.data());
+  gSystem->ExpandPathName(pth);
+  std::ofstream out(pth.Data(), std::ofstream::out);
+  if (out.fail()) {
+    LOG(ERROR) << "Failed to open file " << outFName << FairLogger::endl;
+    return false;
+  }
+  out << "# GRID nX nY nZ xMin yMin zMin xMax yMax zMax, then for each cell: iX iY iZ nPar, followed by\n"
+      << "# nPar coefficients of Bx, By, Bz in coordinates relative to the cell center\n";
+  out << "GRID " << mGrid.nCells[kX] << " " << mGrid.nCells[kY] << " " << mGrid.nCells[kZ];
+  for (int i = 0; i < kNDim; i++) {
+    out << " " << mGrid.xyzMin[i];
+  }
+  for (int i = 0; i < kNDim; i++) {
+    out << " " << mGrid.xyzMax[i];
+  }
+  out << "\n" << std::scientific << std::setprecision(8);
+  for (int iz = 0; iz < mGrid.nCells[kZ]; iz++) {
+    for (int iy = 0; iy < mGrid.nCells[kY]; iy++) {
+      for (int ix = 0; ix < mGrid.nCells[kX]; ix++) {
+        const SolParam& par = mGrid.cells[ix + mGrid.nCells[kX] * (iy + mGrid.nCells[kY] * iz)];
+        out << ix << " " << iy << " " << iz << " " << kNPolCoefs << "\n";
+        for (int comp = 0; comp < kNDim; comp++) {
+          for (int ic = 0; ic < kNPolCoefs; ic++) {
+            out << par.parBxyz[comp][ic] << (ic < kNPolCoefs - 1 ? " " : "\n");
+          }
+        }
+      }
+    }
+  }
+  out.close();
+  if (out.fail()) {
+    LOG(ERROR) << "Failed to write " << outFName << FairLogger::endl;
+    return false;
+  }
+  LOG(INFO) << "Stored " << mGrid.cells.size() << " grid params to " << outFName << FairLogger::endl;
+  return true;
+}
+
+//_______________________________________________________________________
+void MagFieldFast::SetupGrid(GridParam& grid, const float xyzMin[3], const float xyzMax[3], const int nCells[3]) const
+{
+  // define the grid cells
+  for (int i = 0; i < kNDim; i++) {
+    grid.nCells[i] = nCells[i];
+    grid.xyzMin[i] = xyzMin[i];
+    grid.xyzMax[i] = xyzMax[i];
+    grid.cellSize[i] = (xyzMax[i] - xyzMin[i]) / nCells[i];
+    grid.cellSizeInv[i] = 1.f / grid.cellSize[i];
+  }
+  grid.cells.clear();
+  grid.cells.resize(nCells[kX] * nCells[kY] * nCells[kZ]);
+}
+
+//_______________________________________________________________________
+bool MagFieldFast::BuildGrid(const MagneticWrapperChebyshev& map, const float xyzMin[3], const float xyzMax[3],
+                             const int nCells[3], float tolerance, int maxCells)
+{
+  // fit the grid parametrization to the map, doubling the number of cells in each dimension
+  // until the max deviation at the control points of the cells is below the tolerance
+  int nc[kNDim];
+  for (int i = 0; i < kNDim; i++) {
+    if (nCells[i] < 1 || xyzMax[i] <= xyzMin[i]) {
+      LOG(ERROR) << "Wrong grid definition in dimension " << i << FairLogger::endl;
+      return false;
+    }
+    nc[i] = nCells[i];
+  }
+  while (true) {
+    GridParam grid;
+    SetupGrid(grid, xyzMin, xyzMax, nc);
+    float maxDev = 0.f;
+    for (int iz = 0; iz < nc[kZ]; iz++) {
+      for (int iy = 0; iy < nc[kY]; iy++) {
+        for (int ix = 0; ix < nc[kX]; ix++) {
+          const int id[kNDim] = { ix, iy, iz };
+          double center[kNDim], halfSize[kNDim];
+          for (int i = 0; i < kNDim; i++) {
+            halfSize[i] = 0.5 * grid.cellSize[i];
+            center[i] = grid.xyzMin[i] + (2 * id[i] + 1) * halfSize[i];
+          }
+          SolParam& par = grid.cells[ix + nc[kX] * (iy + nc[kY] * iz)];
+          if (!fitCell(map, center, halfSize, par)) {
+            LOG(ERROR) << "Fit failed in cell " << ix << " " << iy << " " << iz << FairLogger::endl;
+            return false;
+          }
+          // compare with the map on the regular grid of control points, including the cell borders
+          for (int jx = 0; jx < kNCheckPoints; jx++) {
+            for (int jy = 0; jy < kNCheckPoints; jy++) {
+              for (int jz = 0; jz < kNCheckPoints; jz++) {
+                const int jd[kNDim] = { jx, jy, jz };
+                double xyz[kNDim], b[kNDim];
+                float loc[kNDim];
+                for (int i = 0; i < kNDim; i++) {
+                  loc[i] = halfSize[i] * (2. * jd[i] / (kNCheckPoints - 1) - 1.);
+                  xyz[i] = center[i] + loc[i];
+                }
+                map.Field(xyz, b);
+                for (int i = 0; i < kNDim; i++) {
+                  float dev = std::abs(CalcPol(par.parBxyz[i], loc[kX], loc[kY], loc[kZ]) - b[i]);
+                  maxDev = std::max(maxDev, dev);
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+    LOG(INFO) << "Grid of " << nc[kX] << "x" << nc[kY] << "x" << nc[kZ] << " cells: max deviation " << maxDev
+              << " kG" << FairLogger::endl;
+    if (maxDev <= tolerance) {
+      mGrid = std::move(grid);
+      return true;
+    }
+    if (8 * grid.cells.size() > size_t(maxCells)) {
+      LOG(ERROR) << "Tolerance " << tolerance << " kG cannot be reached with less than " << maxCells << " cells"
+                 << FairLogger::endl;
+      return false;
+    }
+    for (int i = 0; i < kNDim; i++) {
+      nc[i] *= 2;
+    }
+  }
+}
+
 //_______________________________________________________________________
 bool MagFieldFast::Field(const double xyz[3], double bxyz[3]) const
 {
   // get field
   const float fxyz[3] = { float(xyz[0]), float(xyz[1]), float(xyz[2]) };
-  int zSeg, rSeg, quadrant;
-  if (!GetSegment(fxyz, zSeg, rSeg, quadrant))
+  float loc[3], fact;
+  const SolParam* par = GetParam(fxyz, loc, fact);
+  if (!par)
     return false;
-  const SolParam* par = &mSolPar[rSeg][zSeg][quadrant];
-  bxyz[kX] = CalcPol(par->parBxyz[kX], fxyz[kX], fxyz[kY], fxyz[kZ]) * mFactorSol;
-  bxyz[kY] = CalcPol(par->parBxyz[kY], fxyz[kX], fxyz[kY], fxyz[kZ]) * mFactorSol;
-  bxyz[kZ] = CalcPol(par->parBxyz[kZ], fxyz[kX], fxyz[kY], fxyz[kZ]) * mFactorSol;
+  bxyz[kX] = CalcPol(par->parBxyz[kX], loc[kX], loc[kY], loc[kZ]) * fact;
+  bxyz[kY] = CalcPol(par->parBxyz[kY], loc[kX], loc[kY], loc[kZ]) * fact;
+  bxyz[kZ] = CalcPol(par->parBxyz[kZ], loc[kX], loc[kY], loc[kZ]) * fact;
   //
   return true;
 }
@@ -125,11 +430,11 @@ bool MagFieldFast::GetBcomp(EDim comp, const double xyz[3], double& b) const
 {
   // get field
   const float fxyz[3] = { float(xyz[0]), float(xyz[1]), float(xyz[2]) };
-  int zSeg, rSeg, quadrant;
-  if (!GetSegment(fxyz, zSeg, rSeg, quadrant))
+  float loc[3], fact;
+  const SolParam* par = GetParam(fxyz, loc, fact);
+  if (!par)
     return false;
-  const SolParam* par = &mSolPar[rSeg][zSeg][quadrant];
-  b = CalcPol(par->parBxyz[comp], fxyz[kX], fxyz[kY], fxyz[kZ]) * mFactorSol;
+  b = CalcPol(par->parBxyz[comp], loc[kX], loc[kY], loc[kZ]) * fact;
   //
   return true;
 }
@@ -138,11 +443,11 @@ bool MagFieldFast::GetBcomp(EDim comp, const double xyz[3], double& b) const
 bool MagFieldFast::GetBcomp(EDim comp, const float xyz[3], float& b) const
 {
   // get field
-  int zSeg, rSeg, quadrant;
-  if (!GetSegment(xyz, zSeg, rSeg, quadrant))
+  float loc[3], fact;
+  const SolParam* par = GetParam(xyz, loc, fact);
+  if (!par)
     return false;
-  const SolParam* par = &mSolPar[rSeg][zSeg][quadrant];
-  b = CalcPol(par->parBxyz[comp], xyz[kX], xyz[kY], xyz[kZ]) * mFactorSol;
+  b = CalcPol(par->parBxyz[comp], loc[kX], loc[kY], loc[kZ]) * fact;
   //
   return true;
 }
@@ -151,17 +456,75 @@ bool MagFieldFast::GetBcomp(EDim comp, const float xyz[3], float& b) const
 bool MagFieldFast::Field(const float xyz[3], float bxyz[3]) const
 {
   // get field
-  int zSeg, rSeg, quadrant;
-  if (!GetSegment(xyz, zSeg, rSeg, quadrant))
+  float loc[3], fact;
+  const SolParam* par = GetParam(xyz, loc, fact);
+  if (!par)
     return false;
-  const SolParam* par = &mSolPar[rSeg][zSeg][quadrant];
-  bxyz[kX] = CalcPol(par->parBxyz[kX], xyz[kX], xyz[kY], xyz[kZ]) * mFactorSol;
-  bxyz[kY] = CalcPol(par->parBxyz[kY], xyz[kX], xyz[kY], xyz[kZ]) * mFactorSol;
-  bxyz[kZ] = CalcPol(par->parBxyz[kZ], xyz[kX], xyz[kY], xyz[kZ]) * mFactorSol;
+  bxyz[kX] = CalcPol(par->parBxyz[kX], loc[kX], loc[kY], loc[kZ]) * fact;
+  bxyz[kY] = CalcPol(par->parBxyz[kY], loc[kX], loc[kY], loc[kZ]) * fact;
+  bxyz[kZ] = CalcPol(par->parBxyz[kZ], loc[kX], loc[kY], loc[kZ]) * fact;
   //
   return true;
 }
 
+//_______________________________________________________________________
+int MagFieldFast::Field(int n, const double* xyz, double* bxyz, bool* ok) const
+{
+  // get field at n points
+  return FieldBatch(n, xyz, bxyz, ok);
+}
+
+//_______________________________________________________________________
+int MagFieldFast::Field(int n, const float* xyz, float* bxyz, bool* ok) const
+{
+  // get field at n points
+  return FieldBatch(n, xyz, bxyz, ok);
+}
+
+//_______________________________________________________________________
+template <typename T>
+int MagFieldFast::FieldBatch(int n, const T* xyz, T* bxyz, bool* ok) const
+{
+  // The parametrizations of a block of points are looked up first, then their coefficients are
+  // gathered per component and the polynomials of the block are evaluated in a vectorizable loop
+  float loc[kNDim][kBlockSize], fact[kBlockSize], res[kBlockSize];
+  float coefs[kNPolCoefs][kBlockSize];
+  const SolParam* par[kBlockSize];
+  int index[kBlockSize], nMissing = 0;
+  for (int i = 0; i < n;) {
+    int nb = 0;
+    for (; i < n && nb < kBlockSize; i++) {
+      const float fxyz[3] = { float(xyz[3 * i]), float(xyz[3 * i + 1]), float(xyz[3 * i + 2]) };
+      float l[3];
+      par[nb] = GetParam(fxyz, l, fact[nb]);
+      if (ok) {
+        ok[i] = par[nb] != nullptr;
+      }
+      if (!par[nb]) {
+        nMissing++;
+        continue;
+      }
+      loc[kX][nb] = l[kX];
+      loc[kY][nb] = l[kY];
+      loc[kZ][nb] = l[kZ];
+      index[nb++] = i;
+    }
+    for (int comp = 0; comp < kNDim; comp++) {
+      for (int ip = 0; ip < nb; ip++) {
+        const float* cf = par[ip]->parBxyz[comp];
+        for (int ic = 0; ic < kNPolCoefs; ic++) {
+          coefs[ic][ip] = cf[ic];
+        }
+      }
+      CalcPol(coefs, loc, nb, res);
+      for (int ip = 0; ip < nb; ip++) {
+        bxyz[3 * index[ip] + comp] = res[ip] * fact[ip];
+      }
+    }
+  }
+  return nMissing;
+}
+
 //_______________________________________________________________________
 bool MagFieldFast::GetSegment(const float xyz[3], int& zSeg, int& rSeg, int& quadrant) const
 {
@@ -20,6 +20,7 @@
 #include "FairParamList.h"
 #include "FairRun.h"
 #include "FairRuntimeDb.h"
+#include <vector>                      // for vector
 
 using namespace o2::field;
 
@@ -222,6 +223,7 @@ Bool_t MagneticField::loadParameterization()
   if (!mMeasuredMap) {
     mLogger->Fatal(MESSAGE_ORIGIN, "Did not find field %s in %s\n", getParameterName(), fname);
   }
+  mMeasuredMap->buildFlatTables();
   file->Close();
   delete file;
   return kTRUE;
@@ -252,6 +254,51 @@ void MagneticField::Field(const Double_t * __restrict__ xyz, Double_t * __restri
   }
 }
 
+void MagneticField::Field(Int_t n, const Double_t * __restrict__ xyz, Double_t * __restrict__ b)
+{
+  /*
+   * query field values at n points
+   */
+
+  if (!mMeasuredMap) {
+    for (int i = 0; i < n; i++) {
+      Field(xyz + 3 * i, b + 3 * i);
+    }
+    return;
+  }
+  std::unique_ptr<bool[]> fast;
+  if (mFastField) {
+    fast.reset(new bool[n]);
+    if (!mFastField->Field(n, xyz, b, fast.get())) {
+      return;
+    }
+  }
+  std::vector<Int_t> inMap;
+  std::vector<Double_t> pnt, bMap;
+  for (int i = 0; i < n; i++) {
+    const Double_t *xyzi = xyz + 3 * i;
+    if (fast && fast[i]) {
+      continue;
+    }
+    if (xyzi[2] > mMeasuredMap->getMinZ() && xyzi[2] < mMeasuredMap->getMaxZ()) {
+      inMap.push_back(i);
+      pnt.insert(pnt.end(), xyzi, xyzi + 3);
+    } else {
+      MachineField(xyzi, b + 3 * i);
+    }
+  }
+  bMap.resize(pnt.size());
+  mMeasuredMap->Field(inMap.size(), pnt.data(), bMap.data());
+  for (size_t k = 0; k < inMap.size(); k++) {
+    int i = inMap[k];
+    double fact = (xyz[3 * i + 2] > sSolenoidToDipoleZ || mDipoleOnOffFlag) ? mMultipicativeFactorSolenoid
+                                                                           : mMultipicativeFactorDipole;
+    for (int j = 3; j--;) {
+      b[3 * i + j] = bMap[3 * k + j] * fact;
+    }
+  }
+}
+
 Double_t MagneticField::getBz(const Double_t *xyz) const
 {
   /*
@@ -454,6 +501,7 @@ void MagneticField::setFactorSolenoid(Float_t fc)
       break; // case kConvMap2005: mMultipicativeFactorSolenoid =  fc; break;
   }
   if (mFastField) mFastField->setFactorSol(getFactorSolenoid());
+  updateFastFieldFactors();
 }
 
 void MagneticField::setFactorDipole(Float_t fc)
@@ -469,6 +517,16 @@ void MagneticField::setFactorDipole(Float_t fc)
       mMultipicativeFactorDipole = fc;
       break; // case kConvMap2005: mMultipicativeFactorDipole =  fc; break;
   }
+  updateFastFieldFactors();
+}
+
+void MagneticField::updateFastFieldFactors()
+{
+  if (mFastField) {
+    mFastField->setGridFactors(mMultipicativeFactorSolenoid,
+                               mDipoleOnOffFlag ? mMultipicativeFactorSolenoid : mMultipicativeFactorDipole,
+                               sSolenoidToDipoleZ);
+  }
 }
 
 Double_t MagneticField::getFactorSolenoid() const
@@ -636,11 +694,19 @@ void MagneticField::FillParContainer()
 }
 
 //_____________________________________________________________________________
-void MagneticField::AllowFastField(bool v)
+void MagneticField::AllowFastField(bool v, const std::string gridFmt)
 {
   if (v) {
-    if (!mFastField) mFastField = std::make_unique<MagFieldFast>
-		       (getFactorSolenoid(),mMapType==MagFieldParam::k2kG ? 2:5);
+    if (!mFastField) {
+      mFastField = std::make_unique<MagFieldFast>(getFactorSolenoid(), mMapType == MagFieldParam::k2kG ? 2 : 5);
+      TString pth;
+      pth.Form(gridFmt.data(), getParameterName());
+      gSystem->ExpandPathName(pth);
+      if (gSystem->AccessPathName(pth.Data()) || !mFastField->LoadGridData(pth.Data())) {
+        mLogger->Info(MESSAGE_ORIGIN, "No fast field grid %s, full map is used outside of the solenoid", pth.Data());
+      }
+      updateFastFieldFactors();
+    }
   }
   else {
     mFastField.reset(nullptr);
@@ -16,8 +16,10 @@
 #include <TArrayF.h>     // for TArrayF
 #include <TArrayI.h>     // for TArrayI
 #include <TSystem.h>     // for TSystem, gSystem
+#include <algorithm>    // for upper_bound
 #include <cstdio>       // for printf, fprintf, fclose, fopen, FILE
 #include <cstring>      // for memcpy
+#include <vector>       // for vector
 #include "FairLogger.h"  // for FairLogger, MESSAGE_ORIGIN
 #include "TMath.h"       // for BinarySearch, Sort
 #include "TMathBase.h"   // for Abs
@@ -28,6 +30,16 @@
 using namespace o2::field;
 using namespace o2::mathUtils;
 
+namespace {
+/// Index of the segment containing x among n segments with sorted lower boundaries bnd,
+/// the first (last) one if x is below (above) all of them
+inline int findSegment(const Float_t *bnd, int n, Double_t x)
+{
+  int id = std::upper_bound(bnd, bnd + n, x) - bnd;
+  return id > 0 ? id - 1 : 0;
+}
+}
+
 ClassImp(MagneticWrapperChebyshev)
 
 MagneticWrapperChebyshev::MagneticWrapperChebyshev()
@@ -292,6 +304,7 @@ void MagneticWrapperChebyshev::copyFrom(const MagneticWrapperChebyshev &src)
       mParameterizationDipole->AddAtAndExpand(new Chebyshev3D(*src.getParameterDipole(i)), i);
     }
   }
+  buildFlatTables();
 }
 
 MagneticWrapperChebyshev &MagneticWrapperChebyshev::operator=(const MagneticWrapperChebyshev &rhs)
@@ -305,6 +318,11 @@ MagneticWrapperChebyshev &MagneticWrapperChebyshev::operator=(const MagneticWrap
 
 void MagneticWrapperChebyshev::Clear(const Option_t *)
 {
+  mFlatSolenoid.clear();
+  mFlatTPC.clear();
+  mFlatTPCRat.clear();
+  mFlatDipole.clear();
+
   if (mNumberOfParameterizationSolenoid) {
     mParameterizationSolenoid->SetOwner(kTRUE);
     delete mParameterizationSolenoid;
@@ -437,6 +455,15 @@ void MagneticWrapperChebyshev::Field(const Double_t *xyz, Double_t *b) const
   if (iddip < 0) {
     return;
   }
+  if (mFlatDipole.isBuilt()) {
+#ifndef _BRING_TO_BOUNDARY_
+    if (!mFlatDipole.isInside(iddip, xyz)) {
+      return;
+    }
+#endif
+    mFlatDipole.Eval(iddip, xyz, b);
+    return;
+  }
   Chebyshev3D *par = getParameterDipole(iddip);
 #ifndef _BRING_TO_BOUNDARY_
   if (!par->isInside(xyz)) {
@@ -446,6 +473,104 @@ void MagneticWrapperChebyshev::Field(const Double_t *xyz, Double_t *b) const
   par->Eval(xyz, b);
 }
 
+void MagneticWrapperChebyshev::Field(Int_t n, const Double_t *xyz, Double_t *b) const
+{
+  if ((mNumberOfParameterizationSolenoid && !mFlatSolenoid.isBuilt()) ||
+      (mNumberOfParameterizationDipole && !mFlatDipole.isBuilt())) {
+    for (int i = 0; i < n; i++) {
+      Field(xyz + 3 * i, b + 3 * i);
+    }
+    return;
+  }
+  // find the parameterization piece of each point, pieces of the dipole follow those of the solenoid
+  std::vector<Int_t> piece(n), count(mNumberOfParameterizationSolenoid + mNumberOfParameterizationDipole + 2, 0);
+  std::vector<Double_t> coord(3 * n);
+  for (int i = 0; i < n; i++) {
+    const Double_t *pnt = xyz + 3 * i;
+    Double_t *crd = &coord[3 * i];
+    Int_t id = -1;
+    b[3 * i] = b[3 * i + 1] = b[3 * i + 2] = 0;
+    if (pnt[2] > mMinZSolenoid) {
+      cartesianToCylindrical(pnt, crd);
+      id = findSolenoidSegment(crd);
+#ifndef _BRING_TO_BOUNDARY_
+      if (id >= 0 && !mFlatSolenoid.isInside(id, crd)) {
+        id = -1;
+      }
+#endif
+    } else {
+      std::copy(pnt, pnt + 3, crd);
+      id = findDipoleSegment(crd);
+#ifndef _BRING_TO_BOUNDARY_
+      if (id >= 0 && !mFlatDipole.isInside(id, crd)) {
+        id = -1;
+      }
+#endif
+      if (id >= 0) {
+        id += mNumberOfParameterizationSolenoid;
+      }
+    }
+    piece[i] = id;
+    count[id + 2]++;
+  }
+  // order the points by piece, those outside of the parameterization (id=-1) come first
+  for (size_t ip = 1; ip < count.size(); ip++) {
+    count[ip] += count[ip - 1];
+  }
+  std::vector<Int_t> order(n);
+  for (int i = 0; i < n; i++) {
+    order[count[piece[i] + 1]++] = i;
+  }
+  // evaluate in blocks of points of the same piece, skipping those outside of the parameterization
+  const int kBlock = Chebyshev3DFlat::kBlockSize;
+  Float_t par[3][kBlock], res[3][kBlock];
+  const Float_t *parP[3] = { par[0], par[1], par[2] };
+  Float_t *resP[3] = { res[0], res[1], res[2] };
+  int first = 0;
+  while (first < n && piece[order[first]] < 0) {
+    first++;
+  }
+  while (first < n) {
+    Int_t id = piece[order[first]];
+    int last = first;
+    while (last < n && last - first < kBlock && piece[order[last]] == id) {
+      last++;
+    }
+    int np = last - first;
+    for (int ip = 0; ip < np; ip++) {
+      const Double_t *crd = &coord[3 * order[first + ip]];
+      par[0][ip] = crd[0];
+      par[1][ip] = crd[1];
+      par[2][ip] = crd[2];
+    }
+    bool solenoid = id < mNumberOfParameterizationSolenoid;
+    if (solenoid) {
+      mFlatSolenoid.Eval(id, np, parP, resP);
+    } else {
+      mFlatDipole.Eval(id - mNumberOfParameterizationSolenoid, np, parP, resP);
+    }
+    for (int ip = 0; ip < np; ip++) {
+      int i = order[first + ip];
+      Double_t *bi = b + 3 * i;
+      bi[0] = res[0][ip];
+      bi[1] = res[1][ip];
+      bi[2] = res[2][ip];
+      if (solenoid) {
+        cylindricalToCartesianCylB(&coord[3 * i], bi, bi);
+      }
+    }
+    first = last;
+  }
+}
+
+void MagneticWrapperChebyshev::buildFlatTables()
+{
+  mFlatSolenoid.build(mParameterizationSolenoid, mNumberOfParameterizationSolenoid);
+  mFlatTPC.build(mParameterizationTPC, mNumberOfParameterizationTPC);
+  mFlatTPCRat.build(mParameterizationTPCRat, mNumberOfParameterizationTPCRat);
+  mFlatDipole.build(mParameterizationDipole, mNumberOfParameterizationDipole);
+}
+
 Double_t MagneticWrapperChebyshev::getBz(const Double_t *xyz) const
 {
   Double_t rphiz[3];
@@ -459,6 +584,14 @@ Double_t MagneticWrapperChebyshev::getBz(const Double_t *xyz) const
   if (iddip < 0) {
     return 0.;
   }
+  if (mFlatDipole.isBuilt()) {
+#ifndef _BRING_TO_BOUNDARY_
+    if (!mFlatDipole.isInside(iddip, xyz)) {
+      return 0.;
+    }
+#endif
+    return mFlatDipole.Eval(iddip, xyz, 2);
+  }
   Chebyshev3D *par = getParameterDipole(iddip);
 #ifndef _BRING_TO_BOUNDARY_
   if (!par->isInside(xyz)) {
@@ -519,29 +652,10 @@ Int_t MagneticWrapperChebyshev::findDipoleSegment(const Double_t *xyz) const
 
   Bool_t reCheck = kFALSE;
   while (true) {
-    int ysegBeg = mBeginningOfSegmentsYDipole[zid];
-
-    for (yid = 0; yid < mNumberOfSegmentsYDipole[zid]; yid++) {
-      if (xyz[1] < mCoordinatesSegmentsYDipole[ysegBeg + yid]) {
-        break;
-      }
-    }
-    if (--yid < 0) {
-      yid = 0;
-    }
-    yid += ysegBeg;
-
-    int xsegBeg = mBeginningOfSegmentsXDipole[yid];
-    for (xid = 0; xid < mNumberOfSegmentsXDipole[yid]; xid++) {
-      if (xyz[0] < mCoordinatesSegmentsXDipole[xsegBeg + xid]) {
-        break;
-      }
-    }
-
-    if (--xid < 0) {
-      xid = 0;
-    }
-    xid += xsegBeg;
+    yid = mBeginningOfSegmentsYDipole[zid];
+    yid += findSegment(mCoordinatesSegmentsYDipole + yid, mNumberOfSegmentsYDipole[zid], xyz[1]);
+    xid = mBeginningOfSegmentsXDipole[yid];
+    xid += findSegment(mCoordinatesSegmentsXDipole + xid, mNumberOfSegmentsXDipole[yid], xyz[0]);
 
     // to make sure that due to the precision problems we did not pick the next Zbin
     if (!reCheck && (xyz[2] - mCoordinatesSegmentsZDipole[zid] < 3.e-5) && zid &&
@@ -565,27 +679,10 @@ Int_t MagneticWrapperChebyshev::findSolenoidSegment(const Double_t *rpz) const
 
   Bool_t reCheck = kFALSE;
   while (true) {
-    int psegBeg = mBeginningOfSegmentsPSolenoid[zid];
-    for (pid = 0; pid < mNumberOfSegmentsPSolenoid[zid]; pid++) {
-      if (rpz[1] < mCoordinatesSegmentsPSolenoid[psegBeg + pid]) {
-        break;
-      }
-    }
-    if (--pid < 0) {
-      pid = 0;
-    }
-    pid += psegBeg;
-
-    int rsegBeg = mBeginningOfSegmentsRSolenoid[pid];
-    for (rid = 0; rid < mNumberOfRSegmentsSolenoid[pid]; rid++) {
-      if (rpz[0] < mCoordinatesSegmentsRSolenoid[rsegBeg + rid]) {
-        break;
-      }
-    }
-    if (--rid < 0) {
-      rid = 0;
-    }
-    rid += rsegBeg;
+    pid = mBeginningOfSegmentsPSolenoid[zid];
+    pid += findSegment(mCoordinatesSegmentsPSolenoid + pid, mNumberOfSegmentsPSolenoid[zid], rpz[1]);
+    rid = mBeginningOfSegmentsRSolenoid[pid];
+    rid += findSegment(mCoordinatesSegmentsRSolenoid + rid, mNumberOfRSegmentsSolenoid[pid], rpz[0]);
 
     // to make sure that due to the precision problems we did not pick the next Zbin
     if (!reCheck && (rpz[2] - mCoordinatesSegmentsZSolenoid[zid] < 3.e-5) && zid &&
@@ -609,28 +706,10 @@ Int_t MagneticWrapperChebyshev::findTPCSegment(const Double_t *rpz) const
 
   Bool_t reCheck = kFALSE;
   while (true) {
-    int psegBeg = mBeginningOfSegmentsPTPC[zid];
-
-    for (pid = 0; pid < mNumberOfSegmentsPTPC[zid]; pid++) {
-      if (rpz[1] < mCoordinatesSegmentsPTPC[psegBeg + pid]) {
-        break;
-      }
-    }
-    if (--pid < 0) {
-      pid = 0;
-    }
-    pid += psegBeg;
-
-    int rsegBeg = mBeginningOfSegmentsRTPC[pid];
-    for (rid = 0; rid < mNumberOfRSegmentsTPC[pid]; rid++) {
-      if (rpz[0] < mCoordinatesSegmentsRTPC[rsegBeg + rid]) {
-        break;
-      }
-    }
-    if (--rid < 0) {
-      rid = 0;
-    }
-    rid += rsegBeg;
+    pid = mBeginningOfSegmentsPTPC[zid];
+    pid += findSegment(mCoordinatesSegmentsPTPC + pid, mNumberOfSegmentsPTPC[zid], rpz[1]);
+    rid = mBeginningOfSegmentsRTPC[pid];
+    rid += findSegment(mCoordinatesSegmentsRTPC + rid, mNumberOfRSegmentsTPC[pid], rpz[0]);
 
     // to make sure that due to the precision problems we did not pick the next Zbin
     if (!reCheck && (rpz[2] - mCoordinatesSegmentsZTPC[zid] < 3.e-5) && zid &&
@@ -654,28 +733,10 @@ Int_t MagneticWrapperChebyshev::findTPCRatSegment(const Double_t *rpz) const
 
   Bool_t reCheck = kFALSE;
   while (true) {
-    int psegBeg = mBeginningOfSegmentsPTPCRat[zid];
-
-    for (pid = 0; pid < mNumberOfSegmentsPTPCRat[zid]; pid++) {
-      if (rpz[1] < mCoordinatesSegmentsPTPCRat[psegBeg + pid]) {
-        break;
-      }
-    }
-    if (--pid < 0) {
-      pid = 0;
-    }
-    pid += psegBeg;
-
-    int rsegBeg = mBeginningOfSegmentsRTPCRat[pid];
-    for (rid = 0; rid < mNumberOfRSegmentsTPCRat[pid]; rid++) {
-      if (rpz[0] < mCoordinatesSegmentsRTPCRat[rsegBeg + rid]) {
-        break;
-      }
-    }
-    if (--rid < 0) {
-      rid = 0;
-    }
-    rid += rsegBeg;
+    pid = mBeginningOfSegmentsPTPCRat[zid];
+    pid += findSegment(mCoordinatesSegmentsPTPCRat + pid, mNumberOfSegmentsPTPCRat[zid], rpz[1]);
+    rid = mBeginningOfSegmentsRTPCRat[pid];
+    rid += findSegment(mCoordinatesSegmentsRTPCRat + rid, mNumberOfRSegmentsTPCRat[pid], rpz[0]);
 
     // to make sure that due to the precision problems we did not pick the next Zbin
     if (!reCheck && (rpz[2] - mCoordinatesSegmentsZTPCRat[zid] < 3.e-5) && zid &&
@@ -740,6 +801,15 @@ void MagneticWrapperChebyshev::fieldCylindricalSolenoid(const Double_t *rphiz, D
   if (id < 0) {
     return;
   }
+  if (mFlatSolenoid.isBuilt()) {
+#ifndef _BRING_TO_BOUNDARY_
+    if (!mFlatSolenoid.isInside(id, rphiz)) {
+      return;
+    }
+#endif
+    mFlatSolenoid.Eval(id, rphiz, b);
+    return;
+  }
   Chebyshev3D *par = getParameterSolenoid(id);
 #ifndef _BRING_TO_BOUNDARY_ // exact matching to fitted volume is requested
   if (!par->isInside(rphiz)) {
@@ -756,6 +826,13 @@ Double_t MagneticWrapperChebyshev::fieldCylindricalSolenoidBz(const Double_t *rp
   if (id < 0) {
     return 0.;
   }
+  if (mFlatSolenoid.isBuilt()) {
+#ifndef _BRING_TO_BOUNDARY_
+    return mFlatSolenoid.isInside(id, rphiz) ? mFlatSolenoid.Eval(id, rphiz, 2) : 0;
+#else
+    return mFlatSolenoid.Eval(id, rphiz, 2);
+#endif
+  }
   Chebyshev3D *par = getParameterSolenoid(id);
 #ifndef _BRING_TO_BOUNDARY_
   return par->isInside(rphiz) ? par->Eval(rphiz, 2) : 0;
@@ -776,6 +853,14 @@ void MagneticWrapperChebyshev::getTPCIntegralCylindrical(const Double_t *rphiz,
     b[0] = b[1] = b[2] = 0;
     return;
   }
+  if (mFlatTPC.isBuilt()) {
+    if (mFlatTPC.isInside(id, rphiz)) {
+      mFlatTPC.Eval(id, rphiz, b);
+      return;
+    }
+    b[0] = b[1] = b[2] = 0;
+    return;
+  }
   Chebyshev3D *par = getParameterTPCIntegral(id);
   if (par->isInside(rphiz)) {
     par->Eval(rphiz, b);
@@ -797,6 +882,14 @@ void MagneticWrapperChebyshev::getTPCRatIntegralCylindrical(const Double_t *rphi
     b[0] = b[1] = b[2] = 0;
     return;
   }
+  if (mFlatTPCRat.isBuilt()) {
+    if (mFlatTPCRat.isInside(id, rphiz)) {
+      mFlatTPCRat.Eval(id, rphiz, b);
+      return;
+    }
+    b[0] = b[1] = b[2] = 0;
+    return;
+  }
   Chebyshev3D *par = getParameterTPCRatIntegral(id);
   if (par->isInside(rphiz)) {
     par->Eval(rphiz, b);
@@ -935,6 +1028,7 @@ void MagneticWrapperChebyshev::loadData(const char* inpfile)
   buildTableDipole();
   buildTableTPCIntegral();
   buildTableTPCRatIntegral();
+  buildFlatTables();
 
   printf("Loaded magnetic field \"%s\" from %s\n", GetName(), strf.Data());
 }
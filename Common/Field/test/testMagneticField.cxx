@@ -16,9 +16,12 @@
 #include "Field/MagneticField.h"
 #include "Field/MagFieldFast.h"
 #include <memory>
+#include <vector>
 #include "FairLogger.h"                // for FairLogger, MESSAGE_ORIGIN
 #include <TStopwatch.h>
 #include <TRandom.h>
+#include <TString.h>
+#include <TSystem.h>
 
 using namespace o2::field;
 
@@ -100,3 +103,83 @@ BOOST_AUTO_TEST_CASE(MagneticField_test)
   }
   
 }
+
+BOOST_AUTO_TEST_CASE(MagneticField_batch_test)
+{
+  // the batched query must reproduce the point by point one, in the solenoid and in the dipole regions
+  std::unique_ptr<MagneticField> fld = std::make_unique<MagneticField>
+    ("Maps","Maps", 1., 1., o2::field::MagFieldParam::k5kG);
+
+  const int ntst = 10000;
+  float rnd[3];
+  std::vector<double> xyz(3 * ntst), bxyz(3 * ntst), bbatch(3 * ntst);
+  for (int it = ntst; it--;) {
+    gRandom->RndmArray(3, rnd);
+    xyz[3 * it] = rnd[0] * 450. * TMath::Cos(rnd[1] * TMath::Pi() * 2);
+    xyz[3 * it + 1] = rnd[0] * 450. * TMath::Sin(rnd[1] * TMath::Pi() * 2);
+    xyz[3 * it + 2] = -1200. + rnd[2] * 1700.;
+  }
+
+  TStopwatch swSingle;
+  swSingle.Start();
+  for (int it = ntst; it--;) {
+    fld->Field(&xyz[3 * it], &bxyz[3 * it]);
+  }
+  swSingle.Stop();
+
+  TStopwatch swBatch;
+  swBatch.Start();
+  fld->Field(ntst, xyz.data(), bbatch.data());
+  swBatch.Stop();
+  LOG(INFO) << "Timing: single point queries: " << swSingle.CpuTime() / ntst << " batched: "
+            << swBatch.CpuTime() / ntst << " s/point" << FairLogger::endl;
+
+  // coordinates are mapped in single precision in the batched evaluation
+  for (int i = 3 * ntst; i--;) {
+    BOOST_CHECK_SMALL(bxyz[i] - bbatch[i], 1.e-3);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(MagFieldFast_grid_test)
+{
+  // the grid parametrization of the dipole region must reproduce the full field within the requested tolerance
+  std::unique_ptr<MagneticField> fld = std::make_unique<MagneticField>
+    ("Maps","Maps", 1., 1., o2::field::MagFieldParam::k5kG);
+  std::unique_ptr<MagneticField> fldFast = std::make_unique<MagneticField>
+    ("Maps","Maps", 1., 1., o2::field::MagFieldParam::k5kG);
+
+  const float xyzMin[3] = { -100., -100., -1000. }, xyzMax[3] = { 100., 100., -600. }, tolerance = 0.01;
+  const int nCells[3] = { 2, 2, 4 };
+  MagFieldFast grid;
+  BOOST_REQUIRE(grid.BuildGrid(*fld->getMeasuredMap(), xyzMin, xyzMax, nCells, tolerance));
+
+  // the grid goes through a unique temporary file, removed whatever the outcome of the test
+  TString gridFile("fastFieldGrid");
+  FILE* gridStream = gSystem->TempFileName(gridFile);
+  BOOST_REQUIRE(gridStream != nullptr);
+  fclose(gridStream);
+  std::unique_ptr<TString, void (*)(TString*)> gridFileRemover(&gridFile,
+                                                                 [](TString* name) { gSystem->Unlink(name->Data()); });
+  BOOST_REQUIRE(grid.WriteGridData(gridFile.Data()));
+  fldFast->AllowFastField(true, gridFile.Data());
+  BOOST_REQUIRE(fldFast->getFastField()->HasGrid());
+
+  const int ntst = 10000;
+  float rnd[3];
+  std::vector<double> xyz(3 * ntst), bFull(3 * ntst), bFast(3 * ntst), bBatch(3 * ntst);
+  for (int it = ntst; it--;) {
+    gRandom->RndmArray(3, rnd);
+    for (int i = 0; i < 3; i++) {
+      xyz[3 * it + i] = xyzMin[i] + rnd[i] * (xyzMax[i] - xyzMin[i]);
+    }
+    fld->Field(&xyz[3 * it], &bFull[3 * it]);
+    fldFast->Field(&xyz[3 * it], &bFast[3 * it]);
+  }
+  BOOST_CHECK_EQUAL(fldFast->getFastField()->Field(ntst, xyz.data(), bBatch.data()), 0);
+  fldFast->Field(ntst, xyz.data(), bBatch.data());
+  // the fit is checked at the control points of the cells only
+  for (int i = 3 * ntst; i--;) {
+    BOOST_CHECK_SMALL(bFast[i] - bFull[i], 2. * tolerance);
+    BOOST_CHECK_SMALL(bBatch[i] - bFast[i], 1.e-6);
+  }
+}
@@ -184,6 +184,21 @@ class Chebyshev3D : public TNamed
       return mPrecision;
     }
 
+    Int_t getOutputArrayDimension() const
+    {
+      return mOutputArrayDimension;
+    }
+
+    Float_t getBoundaryMappingScale(int i) const
+    {
+      return mBoundaryMappingScale[i];
+    }
+
+    Float_t getBoundaryMappingOffset(int i) const
+    {
+      return mBoundaryMappingOffset[i];
+    }
+
     void shiftBound(int id, float dif);
 
     void loadData(const char *inpFile);
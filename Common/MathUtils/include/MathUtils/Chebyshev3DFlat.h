@@ -0,0 +1,159 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file Chebyshev3DFlat.h
+/// \brief Definition of the Chebyshev3DFlat class
+
+#ifndef ALICEO2_MATHUTILS_CHEBYSHEV3DFLAT_H_
+#define ALICEO2_MATHUTILS_CHEBYSHEV3DFLAT_H_
+
+#include <vector>
+#include "MathUtils/Chebyshev3DCalc.h" // for _BRING_TO_BOUNDARY_
+#include "Rtypes.h"                    // for Float_t, Double_t, Int_t
+
+class TObjArray;
+
+namespace o2 {
+namespace mathUtils {
+
+/// Set of Chebyshev3D parameterization pieces with the coefficients of all pieces copied to contiguous arrays.
+/// The evaluation is equivalent to Chebyshev3D::Eval but uses no internal temporaries, hence it is const and
+/// can be called concurrently. The block evaluation computes the Clenshaw recurrences of up to kBlockSize
+/// points of the same piece in parallel, in loops the compiler can vectorize.
+class Chebyshev3DFlat
+{
+  public:
+    /// max number of points for the block evaluation
+    static constexpr int kBlockSize = 64;
+    /// max number of rows or columns of the coefficients matrix supported
+    static constexpr int kMaxRowsCols = 64;
+
+    Chebyshev3DFlat() = default;
+
+    /// Copies the first npar Chebyshev3D pieces of the array, returns false if they cannot be represented
+    Bool_t build(const TObjArray* pieces, Int_t npar);
+
+    /// Releases the tables
+    void clear();
+
+    Bool_t isBuilt() const
+    {
+      return !mPieces.empty();
+    }
+
+    Int_t getNumberOfPieces() const
+    {
+      return mPieces.size();
+    }
+
+    /// Checks if the point is inside the validity region of the piece
+    Bool_t isInside(Int_t id, const Double_t* par) const;
+
+    /// Evaluates all output dimensions of the piece
+    void Eval(Int_t id, const Double_t* par, Double_t* res) const;
+
+    /// Evaluates the output dimension idim of the piece
+    Double_t Eval(Int_t id, const Double_t* par, Int_t idim) const;
+
+    /// Evaluates all output dimensions of the piece for n<=kBlockSize points: coordinate i of point j
+    /// is par[i][j], output dimension i of point j is stored in res[i][j]
+    void Eval(Int_t id, Int_t n, const Float_t* const* par, Float_t* const* res) const;
+
+  private:
+    struct Piece {
+      Float_t boundMin[3];
+      Float_t boundMax[3];
+      Float_t mappingOffset[3];
+      Float_t mappingScale[3];
+      Int_t nDim;
+      Int_t calc[3]; ///< index of the calculator of each output dimension
+    };
+
+    struct Calc {
+      Int_t nRows;
+      Int_t rowOffset;  ///< offset of the row data in mColumnsAtRow and mColumnAtRowBeginning
+    };
+
+    Float_t evaluateCalc(const Calc& calc, const Float_t* par) const;
+    void evaluateCalc(const Calc& calc, Int_t n, const Float_t* const* par, Float_t* res) const;
+
+    std::vector<Piece> mPieces;
+    std::vector<Calc> mCalcs;
+    std::vector<Int_t> mColumnsAtRow;        ///< number of significant columns at each row
+    std::vector<Int_t> mColumnAtRowBeginning; ///< beginning of the row in the 2D boundary arrays
+    std::vector<Int_t> mCoefficientBound2D0;  ///< number of significant coefficients for each row/column
+    std::vector<Int_t> mCoefficientBound2D1;  ///< beginning of the coefficients for each row/column in mCoefficients
+    std::vector<Float_t> mCoefficients;       ///< coefficients of all pieces
+};
+
+inline Bool_t Chebyshev3DFlat::isInside(Int_t id, const Double_t* par) const
+{
+  const Piece& pc = mPieces[id];
+  for (int i = 3; i--;) {
+    if (pc.boundMin[i] > par[i] || par[i] > pc.boundMax[i]) {
+      return kFALSE;
+    }
+  }
+  return kTRUE;
+}
+
+inline void Chebyshev3DFlat::Eval(Int_t id, const Double_t* par, Double_t* res) const
+{
+  const Piece& pc = mPieces[id];
+  Float_t x[3];
+  for (int i = 3; i--;) {
+    Double_t xi = (par[i] - pc.mappingOffset[i]) * pc.mappingScale[i];
+#ifdef _BRING_TO_BOUNDARY_
+    xi = xi < -1 ? -1 : (xi > 1 ? 1 : xi);
+#endif
+    x[i] = xi;
+  }
+  for (int i = pc.nDim; i--;) {
+    res[i] = evaluateCalc(mCalcs[pc.calc[i]], x);
+  }
+}
+
+inline Double_t Chebyshev3DFlat::Eval(Int_t id, const Double_t* par, Int_t idim) const
+{
+  const Piece& pc = mPieces[id];
+  Float_t x[3];
+  for (int i = 3; i--;) {
+    Double_t xi = (par[i] - pc.mappingOffset[i]) * pc.mappingScale[i];
+#ifdef _BRING_TO_BOUNDARY_
+    xi = xi < -1 ? -1 : (xi > 1 ? 1 : xi);
+#endif
+    x[i] = xi;
+  }
+  return evaluateCalc(mCalcs[pc.calc[idim]], x);
+}
+
+/// Same recurrences and order of operations as Chebyshev3DCalc::Eval, with stack temporaries
+inline Float_t Chebyshev3DFlat::evaluateCalc(const Calc& calc, const Float_t* par) const
+{
+  if (!calc.nRows) {
+    return 0.;
+  }
+  Float_t tmp1D[kMaxRowsCols], tmp2D[kMaxRowsCols];
+  for (int id0 = calc.nRows; id0--;) {
+    int nCLoc = mColumnsAtRow[calc.rowOffset + id0];
+    int col0 = mColumnAtRowBeginning[calc.rowOffset + id0];
+    for (int id1 = nCLoc; id1--;) {
+      int id = id1 + col0, ncfRC = mCoefficientBound2D0[id];
+      tmp2D[id1] = ncfRC ? Chebyshev3DCalc::chebyshevEvaluation1D(par[2], &mCoefficients[mCoefficientBound2D1[id]], ncfRC)
+                         : 0.0;
+    }
+    tmp1D[id0] = nCLoc > 0 ? Chebyshev3DCalc::chebyshevEvaluation1D(par[1], tmp2D, nCLoc) : 0.0;
+  }
+  return Chebyshev3DCalc::chebyshevEvaluation1D(par[0], tmp1D, calc.nRows);
+}
+}
+}
+
+#endif
@@ -0,0 +1,187 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file Chebyshev3DFlat.cxx
+/// \brief Implementation of the Chebyshev3DFlat class
+
+#include "MathUtils/Chebyshev3DFlat.h"
+#include <FairLogger.h>                  // for FairLogger
+#include <TObjArray.h>                   // for TObjArray
+#include "MathUtils/Chebyshev3D.h"       // for Chebyshev3D
+
+using namespace o2::mathUtils;
+
+namespace {
+/// Clenshaw recurrence for n points with common coefficients
+inline void chebyshevEvaluation1D(const Float_t* __restrict__ x, const Float_t* __restrict__ array, int ncf,
+                                  Float_t* __restrict__ res, int n)
+{
+  if (ncf <= 0) {
+    for (int ip = 0; ip < n; ip++) {
+      res[ip] = 0;
+    }
+    return;
+  }
+  Float_t b0[Chebyshev3DFlat::kBlockSize], b1[Chebyshev3DFlat::kBlockSize];
+  Float_t c = array[--ncf];
+  for (int ip = 0; ip < n; ip++) {
+    b0[ip] = c;
+    b1[ip] = 0;
+  }
+  for (int i = ncf; i--;) {
+    c = array[i];
+    for (int ip = 0; ip < n; ip++) {
+      Float_t b2 = b1[ip];
+      b1[ip] = b0[ip];
+      b0[ip] = c + (x[ip] + x[ip]) * b1[ip] - b2;
+    }
+  }
+  for (int ip = 0; ip < n; ip++) {
+    res[ip] = b0[ip] - x[ip] * b1[ip];
+  }
+}
+
+using BlockRow = Float_t[Chebyshev3DFlat::kBlockSize];
+
+/// Clenshaw recurrence for n points with coefficients array[i][ip] specific to each point
+inline void chebyshevEvaluation1D(const Float_t* __restrict__ x, const BlockRow* __restrict__ array, int ncf,
+                                  Float_t* __restrict__ res, int n)
+{
+  if (ncf <= 0) {
+    for (int ip = 0; ip < n; ip++) {
+      res[ip] = 0;
+    }
+    return;
+  }
+  Float_t b0[Chebyshev3DFlat::kBlockSize], b1[Chebyshev3DFlat::kBlockSize];
+  --ncf;
+  for (int ip = 0; ip < n; ip++) {
+    b0[ip] = array[ncf][ip];
+    b1[ip] = 0;
+  }
+  for (int i = ncf; i--;) {
+    const Float_t* __restrict__ c = array[i];
+    for (int ip = 0; ip < n; ip++) {
+      Float_t b2 = b1[ip];
+      b1[ip] = b0[ip];
+      b0[ip] = c[ip] + (x[ip] + x[ip]) * b1[ip] - b2;
+    }
+  }
+  for (int ip = 0; ip < n; ip++) {
+    res[ip] = b0[ip] - x[ip] * b1[ip];
+  }
+}
+}
+
+Bool_t Chebyshev3DFlat::build(const TObjArray* pieces, Int_t npar)
+{
+  clear();
+  if (!pieces || npar < 1) {
+    return kFALSE;
+  }
+  mPieces.resize(npar);
+  for (int ip = 0; ip < npar; ip++) {
+    const Chebyshev3D* cheb = static_cast<const Chebyshev3D*>(pieces->UncheckedAt(ip));
+    Piece& pc = mPieces[ip];
+    for (int i = 0; i < 3; i++) {
+      pc.boundMin[i] = cheb->getBoundMin(i);
+      pc.boundMax[i] = cheb->getBoundMax(i);
+      pc.mappingOffset[i] = cheb->getBoundaryMappingOffset(i);
+      pc.mappingScale[i] = cheb->getBoundaryMappingScale(i);
+    }
+    pc.nDim = cheb->getOutputArrayDimension();
+    if (pc.nDim > 3) {
+      FairLogger::GetLogger()->Error(MESSAGE_ORIGIN, "Piece %d has %d output dimensions, max 3 supported", ip,
+                                     pc.nDim);
+      clear();
+      return kFALSE;
+    }
+    for (int id = 0; id < pc.nDim; id++) {
+      const Chebyshev3DCalc* cc = cheb->getChebyshevCalc(id);
+      int nRows = cc->getNumberOfRows();
+      if (nRows > kMaxRowsCols || cc->getMaxColumnsAtRow() > kMaxRowsCols) {
+        FairLogger::GetLogger()->Error(MESSAGE_ORIGIN, "Piece %d has too many coefficients: %d rows, %d columns", ip,
+                                       nRows, cc->getMaxColumnsAtRow());
+        clear();
+        return kFALSE;
+      }
+      pc.calc[id] = mCalcs.size();
+      mCalcs.push_back({ nRows, Int_t(mColumnsAtRow.size()) });
+      // store the offsets of the 2D boundary and of the coefficients as absolute indices
+      int bound2DOffset = mCoefficientBound2D0.size(), coefOffset = mCoefficients.size();
+      for (int ir = 0; ir < nRows; ir++) {
+        mColumnsAtRow.push_back(cc->getNumberOfColumnsAtRow()[ir]);
+        mColumnAtRowBeginning.push_back(bound2DOffset + cc->getColAtRowBg()[ir]);
+      }
+      for (int ie = 0; ie < cc->getNumberOfElementsBound2D(); ie++) {
+        mCoefficientBound2D0.push_back(cc->getCoefficientBound2D0()[ie]);
+        mCoefficientBound2D1.push_back(coefOffset + cc->getCoefficientBound2D1()[ie]);
+      }
+      mCoefficients.insert(mCoefficients.end(), cc->getCoefficients(),
+                           cc->getCoefficients() + cc->getNumberOfCoefficients());
+    }
+  }
+  return kTRUE;
+}
+
+void Chebyshev3DFlat::clear()
+{
+  mPieces.clear();
+  mCalcs.clear();
+  mColumnsAtRow.clear();
+  mColumnAtRowBeginning.clear();
+  mCoefficientBound2D0.clear();
+  mCoefficientBound2D1.clear();
+  mCoefficients.clear();
+}
+
+void Chebyshev3DFlat::Eval(Int_t id, Int_t n, const Float_t* const* par, Float_t* const* res) const
+{
+  const Piece& pc = mPieces[id];
+  Float_t x[3][kBlockSize];
+  for (int i = 0; i < 3; i++) {
+    const Float_t* __restrict__ pi = par[i];
+    Float_t* __restrict__ xi = x[i];
+    Float_t offs = pc.mappingOffset[i], scale = pc.mappingScale[i];
+    for (int ip = 0; ip < n; ip++) {
+      Float_t v = (pi[ip] - offs) * scale;
+#ifdef _BRING_TO_BOUNDARY_
+      v = v < -1.f ? -1.f : (v > 1.f ? 1.f : v);
+#endif
+      xi[ip] = v;
+    }
+  }
+  const Float_t* xp[3] = { x[0], x[1], x[2] };
+  for (int i = pc.nDim; i--;) {
+    evaluateCalc(mCalcs[pc.calc[i]], n, xp, res[i]);
+  }
+}
+
+void Chebyshev3DFlat::evaluateCalc(const Calc& calc, Int_t n, const Float_t* const* par, Float_t* res) const
+{
+  if (!calc.nRows) {
+    for (int ip = 0; ip < n; ip++) {
+      res[ip] = 0;
+    }
+    return;
+  }
+  Float_t tmp1D[kMaxRowsCols][kBlockSize], tmp2D[kMaxRowsCols][kBlockSize];
+  for (int id0 = calc.nRows; id0--;) {
+    int nCLoc = mColumnsAtRow[calc.rowOffset + id0];
+    int col0 = mColumnAtRowBeginning[calc.rowOffset + id0];
+    for (int id1 = nCLoc; id1--;) {
+      int id = id1 + col0;
+      const Float_t* coefs = mCoefficients.data() + mCoefficientBound2D1[id];
+      chebyshevEvaluation1D(par[2], coefs, mCoefficientBound2D0[id], tmp2D[id1], n);
+    }
+    chebyshevEvaluation1D(par[1], tmp2D, nCLoc, tmp1D[id0], n);
+  }
+  chebyshevEvaluation1D(par[0], tmp1D, calc.nRows, res, n);
+}
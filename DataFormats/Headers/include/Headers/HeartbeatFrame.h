@@ -19,7 +19,9 @@
 // @brief  Definition of the heartbeat frame layout
 
 #include "Headers/DataHeader.h"
-#include <map>
+#include <algorithm>
+#include <limits>
+#include <numeric>
 #include <vector>
 
 namespace o2 {
@@ -215,6 +217,11 @@ public:
  * to extract information about the individual heartbeatframes in the
  * sequence. An index is created with the slots as rows and the frames
  * as columns.
+ *
+ * The frames of all slots are stored contiguously, sorted by heartbeat
+ * header within a slot, the columns in a sorted vector. A dense table of
+ * the frame position for every slot and column is built on the first
+ * access after new columns have been added.
  */
 template<typename SlotDataT>
 class HeartbeatFrameSequence {
@@ -225,33 +232,18 @@ public:
   using SlotDataType = SlotDataT;
   using ColumnIndexType = HeartbeatHeader;
 
-  /// FrameIndex is composed from HB header and slot number
-  struct FrameIndex {
-    ColumnIndexType columnIndex;
-    unsigned slot;
-
-    bool operator<(const FrameIndex& other) const {
-      // std::map.find uses the logic !(a < b) && !(b < a)
-      // have to combine the two fields in one variable for
-      // comparison
-      uint64_t us = columnIndex;
-      us &= 0x00000fffffffffff;
-      us <<= 20;
-      us |= slot & 0xfffff;
-      uint64_t them = other.columnIndex;
-      them &= 0x00000fffffffffff;
-      them <<= 20;
-      them |= other.slot & 0xfffff;
-      return us < them;
-    }
-  };
-
   /// descriptor pointing to one frame
   struct FrameData {
     const byte* buffer = nullptr;
     size_t size = 0;
   };
 
+  /// frame together with its heartbeat header
+  struct ColumnFrame {
+    ColumnIndexType columnIndex;
+    FrameData data;
+  };
+
   /**
    * Add a new data sequence, the set is parsed recursively
    *
@@ -261,9 +253,7 @@ public:
    * @return number of inserted elements
    */
   size_t addSlot(SlotDataType slotData, byte* seqData, size_t seqSize) {
-    unsigned nFrames = mFrames.size();
-    unsigned currentSlot = mSlotData.size();
-    mSlotData.emplace_back(slotData);
+    std::vector<ColumnFrame> frames;
     using ParserT = o2::Header::ReverseParser<HeartbeatHeader, HeartbeatTrailer>;
     ParserT p;
     p.parse(seqData, seqSize,
@@ -272,31 +262,75 @@ public:
             [](const typename ParserT::TrailerType& t) {
               return t.dataLength + ParserT::envelopeLength;
             },
-            [this, currentSlot](typename ParserT::FrameEntry entry) {
-              // insert the heartbeat header as column index in ascending
-              // order
-              auto position = mColumns.begin();
-              while (position != mColumns.end() && *position < *entry.header) {
-                position++;
-              }
-              if (position == mColumns.end() || *entry.header < *position) {
-                mColumns.emplace(position, *entry.header);
-              }
-
-              // insert frame descriptor under key composed from header and slot
-              auto result = mFrames.emplace(FrameIndex{*entry.header, currentSlot},
-                                            FrameData{entry.payload, entry.length});
-              return result.second;
+            [&frames](typename ParserT::FrameEntry entry) {
+              frames.emplace_back(ColumnFrame{*entry.header, FrameData{entry.payload, entry.length}});
+              return true;
             }
             );
-    return mFrames.size() - nFrames;
+    return addFrames(slotData, std::move(frames));
+  }
+
+  /**
+   * Add a new slot from a list of frames in any order
+   *
+   * A frame with the heartbeat header of a previous frame in the list ends
+   * the slot, it is not inserted together with all the following ones.
+   *
+   * @param slotData   Descriptive data struct for the sequence
+   * @param frames     Frames with their heartbeat headers
+   * @return number of inserted elements
+   */
+  size_t addFrames(SlotDataType slotData, std::vector<ColumnFrame> frames) {
+    std::vector<unsigned> order(frames.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&frames](unsigned a, unsigned b) {
+      return frames[a].columnIndex < frames[b].columnIndex;
+    });
+    size_t nFrames = frames.size();
+    for (size_t i = 1; i < order.size(); ++i) {
+      if (!(frames[order[i - 1]].columnIndex < frames[order[i]].columnIndex)) {
+        nFrames = std::min<size_t>(nFrames, order[i]);
+      }
+    }
+
+    std::vector<ColumnIndexType> newColumns;
+    mSlotOffsets.emplace_back(mFrames.size());
+    for (auto i : order) {
+      if (i >= nFrames) continue;
+      if (!std::binary_search(mColumns.begin(), mColumns.end(), frames[i].columnIndex)) {
+        newColumns.emplace_back(frames[i].columnIndex);
+      }
+      mFrames.emplace_back(frames[i]);
+    }
+    mSlotData.emplace_back(slotData);
+    if (newColumns.empty()) {
+      if (mIndexValid) addToIndex(mSlotData.size() - 1);
+    } else {
+      std::vector<ColumnIndexType> columns;
+      columns.reserve(mColumns.size() + newColumns.size());
+      std::merge(mColumns.begin(), mColumns.end(), newColumns.begin(), newColumns.end(),
+                 std::back_inserter(columns));
+      mColumns.swap(columns);
+      mIndexValid = false;
+    }
+    return nFrames;
+  }
+
+  /// reserve space for the given numbers of slots and frames
+  void reserve(size_t nSlots, size_t nFrames) {
+    mSlotData.reserve(nSlots);
+    mSlotOffsets.reserve(nSlots);
+    mFrames.reserve(nFrames);
   }
 
   /// clear the index, i.e. all internal lists
   void clear() {
     mFrames.clear();
+    mSlotOffsets.clear();
     mColumns.clear();
     mSlotData.clear();
+    mIndex.clear();
+    mIndexValid = true;
   }
 
   /// get number of columns in the created index
@@ -461,25 +495,56 @@ public:
   }
 
 private:
+  static const unsigned kInvalidFrame = std::numeric_limits<unsigned>::max();
+
   /// private access function for the iterators
   bool get(unsigned row, unsigned column, FrameData& data) {
-    if (this->mColumns.size() == 0) return false;
-    auto element = this->mFrames.find(FrameIndex{this->mColumns[column], row});
-    if (element != this->mFrames.end()) {
-      data = element->second;
-      return true;
+    if (row >= mSlotData.size() || column >= mColumns.size()) return false;
+    if (!mIndexValid) buildIndex();
+    auto frame = mIndex[row * mColumns.size() + column];
+    if (frame == kInvalidFrame) return false;
+    data = mFrames[frame].data;
+    return true;
+  }
+
+  /// fill the positions of the frames of one slot in the dense index
+  void addToIndex(size_t slot) {
+    auto nColumns = mColumns.size();
+    mIndex.resize((slot + 1) * nColumns, kInvalidFrame);
+    auto end = slot + 1 < mSlotOffsets.size() ? mSlotOffsets[slot + 1] : mFrames.size();
+    auto column = mColumns.begin();
+    for (auto frame = mSlotOffsets[slot]; frame < end; ++frame) {
+      column = std::lower_bound(column, mColumns.end(), mFrames[frame].columnIndex);
+      mIndex[slot * nColumns + (column - mColumns.begin())] = frame;
+    }
+  }
+
+  void buildIndex() {
+    mIndex.clear();
+    mIndex.reserve(mSlotData.size() * mColumns.size());
+    for (size_t slot = 0; slot < mSlotData.size(); ++slot) {
+      addToIndex(slot);
     }
-    return false;
+    mIndexValid = true;
   }
 
-  /// map of frame descriptors with key composed from header and slot number
-  std::map<FrameIndex, FrameData> mFrames;
+  /// frame descriptors, slot by slot, each slot sorted by heartbeat header
+  std::vector<ColumnFrame> mFrames;
+  /// position of the first frame of each slot
+  std::vector<size_t> mSlotOffsets;
   /// list of indices in row direction
   std::vector<ColumnIndexType> mColumns;
   /// data descriptor of each slot forming the columns
   std::vector<SlotDataType> mSlotData;
+  /// position of the frame for every slot and column, kInvalidFrame if none
+  std::vector<unsigned> mIndex;
+  /// the index is built on demand after columns have been added
+  bool mIndexValid = true;
 };
 
+template<typename SlotDataT>
+const unsigned HeartbeatFrameSequence<SlotDataT>::kInvalidFrame;
+
 };
 };
 #endif
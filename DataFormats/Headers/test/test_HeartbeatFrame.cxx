@@ -161,11 +161,40 @@ BOOST_AUTO_TEST_CASE(test_heartbeat_sequence)
 
   std::cout << "slots: " << seqHandler.getNSlots() << " columns: " << seqHandler.getNColumns() << std::endl;
 
+  // four orbits are populated, 0 and 3 with 2 slots, 1 and 2 with one slot
+  BOOST_REQUIRE(seqHandler.getNColumns() == 4);
+  BOOST_REQUIRE(seqHandler.getNSlots() == 2);
+  unsigned requiredNofSlotsInColumn[] = {2, 1, 1, 2};
+
+  unsigned colidx = 0;
   for (auto columnIt = seqHandler.begin(), end = seqHandler.end();
-       columnIt != end; ++columnIt) {
+       columnIt != end; ++columnIt, ++colidx) {
     std::cout << "---------------------------------------" << std::endl;
+    unsigned nSlots = 0;
     for (auto row : columnIt) {
       o2::Header::hexDump("Entry", row.buffer, row.size);
+      ++nSlots;
+    }
+    BOOST_CHECK(nSlots == requiredNofSlotsInColumn[colidx]);
+  }
+
+  // a slot from frames in any order, the orbit of a previous frame ends it
+  using ColumnFrame = o2::Header::HeartbeatFrameSequence<o2::Header::DataHeader>::ColumnFrame;
+  const byte payload[] = "0123";
+  BOOST_CHECK(seqHandler.addFrames(dh, {ColumnFrame{HeartbeatHeader{0x1100000000000004}, {payload + 1, 1}},
+                                        ColumnFrame{HeartbeatHeader{0x1100000000000002}, {payload, 1}},
+                                        ColumnFrame{HeartbeatHeader{0x1100000000000004}, {payload + 2, 1}}}) == 2);
+  BOOST_CHECK(seqHandler.getNColumns() == 5);
+  BOOST_CHECK(seqHandler.getNSlots() == 3);
+  unsigned requiredNofSlotsAfterAdd[] = {2, 1, 2, 2, 1};
+  colidx = 0;
+  for (auto columnIt = seqHandler.begin(), end = seqHandler.end();
+       columnIt != end; ++columnIt, ++colidx) {
+    unsigned nSlots = 0;
+    for (auto row : columnIt) {
+      BOOST_CHECK(row.buffer != nullptr);
+      ++nSlots;
     }
+    BOOST_CHECK(nSlots == requiredNofSlotsAfterAdd[colidx]);
   }
 }
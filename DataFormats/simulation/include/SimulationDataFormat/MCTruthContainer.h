@@ -17,7 +17,12 @@
 
 #include <TNamed.h>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include <gsl/gsl> // for guideline support library; array_view
 
 namespace o2
@@ -35,6 +40,24 @@ struct MCTruthHeaderElement {
   ClassDefNV(MCTruthHeaderElement, 1);
 };
 
+// the header of the flat binary layout of a MCTruthContainer: it is followed by nHeaders MCTruthHeaderElements
+// and, at the next offset aligned for the TruthElement, by nElements TruthElements
+struct MCTruthFlatHeader {
+  uint32_t version = 1;
+  uint32_t nHeaders = 0;
+  uint32_t nElements = 0;
+  uint32_t elementSize = 0; // sizeof(TruthElement), for consistency checks
+
+  static size_t headersOffset() { return sizeof(MCTruthFlatHeader); }
+
+  template <typename TruthElement>
+  static size_t elementsOffset(size_t nHeaders)
+  {
+    size_t offset = headersOffset() + nHeaders * sizeof(MCTruthHeaderElement);
+    return (offset + alignof(TruthElement) - 1) / alignof(TruthElement) * alignof(TruthElement);
+  }
+};
+
 // a container to hold and manage MC truth information
 // the actual MCtruth type is a generic template type and can be supplied by the user
 // It is meant to manage associations from one "dataobject" identified by an index into an array
@@ -49,6 +72,7 @@ class MCTruthContainer : public TNamed
   std::vector<MCTruthHeaderElement>
     mHeaderArray;                        // the header structure array serves as an index into the actual storage
   std::vector<TruthElement> mTruthArray; // the buffer containing the actual truth information
+  std::vector<std::pair<uint, TruthElement>> mPendingArray; //! elements added out of order, waiting for finalize
 
  public:
   // constructor
@@ -84,20 +108,19 @@ class MCTruthContainer : public TNamed
   {
     mHeaderArray.clear();
     mTruthArray.clear();
+    mPendingArray.clear();
   }
 
   // add element for a particular dataindex
-  // at the moment only strictly consecutive modes are supported
+  // elements for the last or a new dataindex are stored directly (skipped dataindices get no labels),
+  // elements for an earlier dataindex are kept aside and only visible after finalize()
   void addElement(uint dataindex, TruthElement const& element)
   {
-    if (dataindex < mHeaderArray.size()) {
-      // look if we have something for this dataindex already
-      // must currently be the last one
-      if (dataindex != (mHeaderArray.size() - 1)) {
-        throw std::runtime_error("MCTruthContainer: unsupported code path");
-      }
-    } else {
-      assert(dataindex == mHeaderArray.size());
+    if (dataindex + 1 < mHeaderArray.size()) {
+      mPendingArray.emplace_back(dataindex, element);
+      return;
+    }
+    while (dataindex >= mHeaderArray.size()) {
       // add a new one
       mHeaderArray.emplace_back(0, mTruthArray.size());
     }
@@ -106,8 +129,153 @@ class MCTruthContainer : public TNamed
     mTruthArray.emplace_back(element);
   }
 
+  // true if no element added out of order waits for finalize()
+  bool isFinalized() const { return mPendingArray.empty(); }
+
+  // move the elements added out of order to their dataindex, keeping the order of the insertion for each
+  // dataindex; linear in the number of elements
+  void finalize()
+  {
+    if (mPendingArray.empty()) {
+      return;
+    }
+    std::vector<MCTruthHeaderElement> headers(mHeaderArray.size());
+    for (auto& pending : mPendingArray) {
+      headers[pending.first].size++;
+    }
+    uint index = 0;
+    for (size_t i = 0; i < headers.size(); i++) {
+      headers[i].size += mHeaderArray[i].size;
+      headers[i].index = index;
+      index += headers[i].size;
+    }
+    std::vector<TruthElement> truth(index);
+    std::vector<uint> fill(headers.size());
+    for (size_t i = 0; i < headers.size(); i++) {
+      auto begin = mTruthArray.begin() + mHeaderArray[i].index;
+      std::copy(begin, begin + mHeaderArray[i].size, truth.begin() + headers[i].index);
+      fill[i] = headers[i].index + mHeaderArray[i].size;
+    }
+    for (auto& pending : mPendingArray) {
+      truth[fill[pending.first]++] = pending.second;
+    }
+    mHeaderArray.swap(headers);
+    mTruthArray.swap(truth);
+    mPendingArray.clear();
+  }
+
+  // append the labels of another container, its dataindex 0 becoming getIndexedSize() of this one;
+  // used to combine the containers filled by parallel workers for consecutive ranges of data
+  void mergeAtBack(MCTruthContainer<TruthElement> const& other)
+  {
+    if (!other.isFinalized()) {
+      throw std::runtime_error("MCTruthContainer: merging a container which is not finalized");
+    }
+    if (&other == this) {
+      // the arrays would be appended to themselves, merge a copy instead
+      MCTruthContainer<TruthElement> copy(other);
+      mergeAtBack(copy);
+      return;
+    }
+    finalize();
+    uint offset = mTruthArray.size();
+    mHeaderArray.reserve(mHeaderArray.size() + other.mHeaderArray.size());
+    for (auto header : other.mHeaderArray) {
+      header.index += offset;
+      mHeaderArray.push_back(header);
+    }
+    mTruthArray.insert(mTruthArray.end(), other.mTruthArray.begin(), other.mTruthArray.end());
+  }
+
+  // size in bytes of the flat binary layout, see MCTruthFlatHeader
+  size_t getFlatSize() const
+  {
+    return MCTruthFlatHeader::elementsOffset<TruthElement>(mHeaderArray.size()) +
+           mTruthArray.size() * sizeof(TruthElement);
+  }
+
+  // write the flat binary layout to a buffer of at least getFlatSize() bytes, e.g. the payload of a message,
+  // returns the number of bytes written; the content can be accessed in place with MCTruthContainerFlatView
+  size_t flatten(void* buffer, size_t bufferSize) const
+  {
+    static_assert(std::is_trivially_copyable<TruthElement>::value,
+                  "MCTruthContainer: flat layout requires trivially copyable elements");
+    if (!isFinalized()) {
+      throw std::runtime_error("MCTruthContainer: flattening a container which is not finalized");
+    }
+    size_t size = getFlatSize();
+    if (bufferSize < size) {
+      throw std::runtime_error("MCTruthContainer: buffer too small for the flat layout");
+    }
+    MCTruthFlatHeader flatHeader;
+    flatHeader.nHeaders = mHeaderArray.size();
+    flatHeader.nElements = mTruthArray.size();
+    flatHeader.elementSize = sizeof(TruthElement);
+    auto dest = static_cast<char*>(buffer);
+    std::memcpy(dest, &flatHeader, sizeof(flatHeader));
+    std::memcpy(dest + MCTruthFlatHeader::headersOffset(), mHeaderArray.data(),
+                mHeaderArray.size() * sizeof(MCTruthHeaderElement));
+    std::memcpy(dest + MCTruthFlatHeader::elementsOffset<TruthElement>(mHeaderArray.size()), mTruthArray.data(),
+                mTruthArray.size() * sizeof(TruthElement));
+    return size;
+  }
+
+  // write the flat binary layout to a byte vector
+  void flatten(std::vector<char>& buffer) const
+  {
+    buffer.resize(getFlatSize());
+    flatten(buffer.data(), buffer.size());
+  }
+
   ClassDefOverride(MCTruthContainer, 1);
 }; // end class
+
+// read-only access to the flat binary layout of a MCTruthContainer, in place and without copies;
+// the buffer must be aligned for the TruthElement and outlive the view
+template <typename TruthElement>
+class MCTruthContainerFlatView
+{
+ public:
+  MCTruthContainerFlatView() = default;
+
+  MCTruthContainerFlatView(const void* buffer, size_t bufferSize)
+  {
+    if (bufferSize < sizeof(MCTruthFlatHeader)) {
+      throw std::runtime_error("MCTruthContainerFlatView: buffer too small for the header");
+    }
+    MCTruthFlatHeader flatHeader;
+    std::memcpy(&flatHeader, buffer, sizeof(flatHeader));
+    if (flatHeader.elementSize != sizeof(TruthElement)) {
+      throw std::runtime_error("MCTruthContainerFlatView: element size mismatch");
+    }
+    auto src = static_cast<const char*>(buffer);
+    size_t elementsOffset = MCTruthFlatHeader::elementsOffset<TruthElement>(flatHeader.nHeaders);
+    if (bufferSize < elementsOffset + flatHeader.nElements * sizeof(TruthElement)) {
+      throw std::runtime_error("MCTruthContainerFlatView: buffer too small for the content");
+    }
+    mHeaders = gsl::span<const MCTruthHeaderElement>(
+      reinterpret_cast<const MCTruthHeaderElement*>(src + MCTruthFlatHeader::headersOffset()), flatHeader.nHeaders);
+    mElements = gsl::span<const TruthElement>(reinterpret_cast<const TruthElement*>(src + elementsOffset),
+                                              flatHeader.nElements);
+  }
+
+  MCTruthHeaderElement getMCTruthHeader(uint dataindex) const { return mHeaders[dataindex]; }
+  TruthElement const& getElement(uint elementindex) const { return mElements[elementindex]; }
+  size_t getIndexedSize() const { return mHeaders.size(); }
+  size_t getNElements() const { return mElements.size(); }
+
+  gsl::span<const TruthElement> getLabels(int dataindex) const
+  {
+    if (dataindex >= getIndexedSize()) {
+      return gsl::span<const TruthElement>();
+    }
+    return mElements.subspan(mHeaders[dataindex].index, mHeaders[dataindex].size);
+  }
+
+ private:
+  gsl::span<const MCTruthHeaderElement> mHeaders;
+  gsl::span<const TruthElement> mElements;
+};
 }
 }
 
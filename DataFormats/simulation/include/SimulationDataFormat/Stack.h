@@ -20,9 +20,9 @@
 #include "Rtypes.h"
 #include "TMCProcess.h"
 
-#include <map>
 #include <stack>
 #include <utility>
+#include <vector>
 
 class TClonesArray;
 
@@ -212,16 +212,15 @@ class Stack : public FairGenericStack
     /// Array of FairMCTracks containg the tracks written to the output
     TClonesArray *mTracks;
 
-    /// STL map from particle index to storage flag
-    std::map<Int_t, Bool_t> mStoreMap;                //!
-    std::map<Int_t, Bool_t>::iterator mStoreIterator; //!
+    /// Storage flag of each particle, indexed by particle index
+    std::vector<Bool_t> mStoreFlags; //!
 
-    /// STL map from particle index to track index
-    std::map<Int_t, Int_t> mIndexMap;                //!
-    std::map<Int_t, Int_t>::iterator mIndexIterator; //!
+    /// Output track index of each particle (-2 if not stored), indexed by particle index
+    std::vector<Int_t> mTrackIndex; //!
 
-    /// STL map from track index and detector ID to number of MCPoints
-    std::map<std::pair<Int_t, Int_t>, Int_t> mPointsMap; //!
+    /// Number of MCPoints of each particle in each detector, indexed by particle index * number of detectors
+    /// + detector ID
+    std::vector<Int_t> mPointsCount; //!
 
     /// Some indices and counters
     Int_t mIndexOfCurrentTrack;        //! Index of current track
@@ -239,6 +238,9 @@ class Stack : public FairGenericStack
     /// Mark tracks for output using selection criteria
     void SelectTracks();
 
+    /// Output track index for a particle index, -1 for the mother of primaries
+    Int_t getTrackIndex(Int_t iPart) const;
+
     Stack(const Stack &);
 
     Stack &operator=(const Stack &);
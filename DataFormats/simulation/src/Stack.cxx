@@ -13,6 +13,7 @@
 /// \author M. Al-Turany - June 2014
 
 #include "DetectorsBase/DetID.h"
+#include "DetectorsBase/Detector.h"
 #include "SimulationDataFormat/Stack.h"
 #include "SimulationDataFormat/MCTrack.h"
 
@@ -31,19 +32,20 @@
 
 using std::cout;
 using std::endl;
-using std::pair;
 using namespace o2::Data;
 
+namespace {
+constexpr int kNDetectors = o2::Base::DetID::nDetectors;
+}
+
 Stack::Stack(Int_t size)
   : FairGenericStack(),
     mStack(),
     mParticles(new TClonesArray("TParticle", size)),
     mTracks(new TClonesArray("MCTrack", size)),
-    mStoreMap(),
-    mStoreIterator(),
-    mIndexMap(),
-    mIndexIterator(),
-    mPointsMap(),
+    mStoreFlags(),
+    mTrackIndex(),
+    mPointsCount(),
     mIndexOfCurrentTrack(-1),
     mNumberOfPrimaryParticles(0),
     mNumberOfEntriesInParticles(0),
@@ -63,11 +65,9 @@ Stack::Stack(const Stack &rhs)
     mStack(),
     mParticles(nullptr),
     mTracks(nullptr),
-    mStoreMap(),
-    mStoreIterator(),
-    mIndexMap(),
-    mIndexIterator(),
-    mPointsMap(),
+    mStoreFlags(),
+    mTrackIndex(),
+    mPointsCount(),
     mIndexOfCurrentTrack(-1),
     mNumberOfPrimaryParticles(0),
     mNumberOfEntriesInParticles(0),
@@ -154,6 +154,9 @@ void Stack::PushTrack(Int_t toBeDone, Int_t parentId, Int_t pdgCode, Double_t px
     mNumberOfPrimaryParticles++;
   }
 
+  // Reserve the point counters of the new particle
+  mPointsCount.resize(mNumberOfEntriesInParticles * kNDetectors, 0);
+
   // Set argument variable
   ntr = trackId;
 
@@ -244,7 +247,7 @@ void Stack::FillTrackArray()
   }
 
   // Reset index map and number of output tracks
-  mIndexMap.clear();
+  mTrackIndex.assign(mNumberOfEntriesInParticles, -2);
   mNumberOfEntriesInTracks = 0;
 
   // Check tracks for selection criteria
@@ -252,33 +255,18 @@ void Stack::FillTrackArray()
 
   // Loop over mParticles array and copy selected tracks
   for (Int_t iPart = 0; iPart < mNumberOfEntriesInParticles; iPart++) {
-
-    mStoreIterator = mStoreMap.find(iPart);
-    if (mStoreIterator == mStoreMap.end()) {
-      if (mLogger) {
-        mLogger->Fatal(MESSAGE_ORIGIN, "Stack: Particle %i not found in storage map! ", iPart);
-      }
-      Fatal("Stack::FillTrackArray", "Particle not found in storage map.");
-    }
-    Bool_t store = (*mStoreIterator).second;
-
-    if (store) {
+    if (mStoreFlags[iPart]) {
       auto *track = new((*mTracks)[mNumberOfEntriesInTracks]) MCTrack(GetParticle(iPart));
-      mIndexMap[iPart] = mNumberOfEntriesInTracks;
+      mTrackIndex[iPart] = mNumberOfEntriesInTracks;
       // Set the number of points in the detectors for this track
-      for (Int_t iDet = o2::Base::DetID::First; iDet < o2::Base::DetID::nDetectors; iDet++) {
-        pair<Int_t, Int_t> a(iPart, iDet);
-        track->setNumberOfPoints(iDet, mPointsMap[a]);
+      const Int_t *nPoints = &mPointsCount[iPart * kNDetectors];
+      for (Int_t iDet = o2::Base::DetID::First; iDet < kNDetectors; iDet++) {
+        track->setNumberOfPoints(iDet, nPoints[iDet]);
       }
       mNumberOfEntriesInTracks++;
-    } else {
-      mIndexMap[iPart] = -2;
     }
   }
 
-  // Map index for primary mothers
-  mIndexMap[-1] = -1;
-
   // Screen output
   // Print(1);
 }
@@ -295,15 +283,7 @@ void Stack::UpdateTrackIndex(TRefArray *detList)
   // First update mother ID in MCTracks
   for (Int_t i = 0; i < mNumberOfEntriesInTracks; i++) {
     MCTrack *track = (MCTrack *) mTracks->At(i);
-    Int_t iMotherOld = track->getMotherTrackId();
-    mIndexIterator = mIndexMap.find(iMotherOld);
-    if (mIndexIterator == mIndexMap.end()) {
-      if (mLogger) {
-        mLogger->Fatal(MESSAGE_ORIGIN, "Stack: Track index %i not found index map! ", iMotherOld);
-      }
-      Fatal("Stack::UpdateTrackIndex", "Track index not found in map");
-    }
-    track->SetMotherTrackId((*mIndexIterator).second);
+    track->SetMotherTrackId(getTrackIndex(track->getMotherTrackId()));
   }
 
   if (fDetList == nullptr) {
@@ -327,20 +307,17 @@ void Stack::UpdateTrackIndex(TRefArray *detList)
       // Update track index for all MCPoints in the collection
       for (Int_t iPoint = 0; iPoint < nPoints; iPoint++) {
         auto *point = (o2::BaseHit *) hitArray->UncheckedAt(iPoint);
-        Int_t iTrack = point->GetTrackID();
-
-        mIndexIterator = mIndexMap.find(iTrack);
-        if (mIndexIterator == mIndexMap.end()) {
-          if (mLogger) {
-            mLogger->Fatal(MESSAGE_ORIGIN, "Stack: Track index %i not found in index map! ", iTrack);
-          }
-          Fatal("Stack::UpdateTrackIndex", "Track index not found in map");
-        }
-        point->SetTrackID((*mIndexIterator).second);
-        point->SetLink(FairLink("MCTrack", (*mIndexIterator).second));
+        Int_t iTrack = getTrackIndex(point->GetTrackID());
+        point->SetTrackID(iTrack);
+        point->SetLink(FairLink("MCTrack", iTrack));
       }
 
     } // Collections of this detector
+
+    // hits kept in other containers
+    if (auto o2det = dynamic_cast<o2::Base::Detector *>(det)) {
+      o2det->updateHitTrackIndices([this](int iPart) { return getTrackIndex(iPart); });
+    }
   }   // List of active detectors
   if (mLogger) {
     mLogger->Debug(MESSAGE_ORIGIN, "...stack and  %i collections updated.", nColl);
@@ -359,7 +336,7 @@ void Stack::Reset()
   }
   mParticles->Clear();
   mTracks->Clear();
-  mPointsMap.clear();
+  mPointsCount.clear();
 }
 
 void Stack::Register()
@@ -391,26 +368,19 @@ void Stack::Print(Option_t* option) const
 
 void Stack::AddPoint(int iDet)
 {
-  // cout << "Add point for Detektor" << iDet << endl;
-  pair<Int_t, Int_t> a(mIndexOfCurrentTrack, iDet);
-  if (mPointsMap.find(a) == mPointsMap.end()) {
-    mPointsMap[a] = 1;
-  } else {
-    mPointsMap[a]++;
-  }
+  AddPoint(iDet, mIndexOfCurrentTrack);
 }
 
 void Stack::AddPoint(int iDet, Int_t iTrack)
 {
-  if (iTrack < 0) {
+  if (iTrack < 0 || iDet < 0 || iDet >= kNDetectors) {
     return;
   }
-  pair<Int_t, Int_t> a(iTrack, iDet);
-  if (mPointsMap.find(a) == mPointsMap.end()) {
-    mPointsMap[a] = 1;
-  } else {
-    mPointsMap[a]++;
+  size_t index = size_t(iTrack) * kNDetectors + iDet;
+  if (index >= mPointsCount.size()) {
+    mPointsCount.resize((iTrack + 1) * kNDetectors, 0);
   }
+  mPointsCount[index]++;
 }
 
 Int_t Stack::GetCurrentParentTrackNumber() const
@@ -436,69 +406,73 @@ TParticle *Stack::GetParticle(Int_t trackID) const
 
 void Stack::SelectTracks()
 {
-
-  // Clear storage map
-  mStoreMap.clear();
-
-  // LOG(INFO) << "mPointsMap.size(): " << mPointsMap.size() << std::endl;
+  mStoreFlags.assign(mNumberOfEntriesInParticles, kTRUE);
+  mPointsCount.resize(mNumberOfEntriesInParticles * kNDetectors, 0);
 
   // Check particles in the fParticle array
   for (Int_t i = 0; i < mNumberOfEntriesInParticles; i++) {
 
     TParticle *thisPart = GetParticle(i);
-    Bool_t store = kTRUE;
+
+    // Store primaries in any case
+    if (thisPart->GetMother(0) < 0) {
+      continue;
+    }
+    if (!mStoreSecondaries) {
+      mStoreFlags[i] = kFALSE;
+      continue;
+    }
+
+    // Calculate number of points
+    Int_t nPoints = 0;
+    const Int_t *points = &mPointsCount[i * kNDetectors];
+    for (Int_t iDet = o2::Base::DetID::First; iDet < kNDetectors; iDet++) {
+      nPoints += points[iDet];
+    }
 
     // Get track parameters
-    Int_t iMother = thisPart->GetMother(0);
     TLorentzVector p;
     thisPart->Momentum(p);
     Double_t energy = p.E();
     Double_t mass = p.M();
-    //    Double_t mass   = thisPart->GetMass();
     Double_t eKin = energy - mass;
 
-    // Calculate number of points
-    Int_t nPoints = 0;
-    for (Int_t iDet = o2::Base::DetID::First; iDet < o2::Base::DetID::nDetectors; iDet++) {
-      pair<Int_t, Int_t> a(i, iDet);
-      if (mPointsMap.find(a) != mPointsMap.end()) {
-        nPoints += mPointsMap[a];
-      }
-    }
-
-    // Check for cuts (store primaries in any case)
-    if (iMother < 0) {
-      store = kTRUE;
-    } else {
-      if (!mStoreSecondaries) {
-        store = kFALSE;
-      }
-      if (nPoints < mMinPoints) {
-        store = kFALSE;
-      }
-      if (eKin < mEnergyCut) {
-        store = kFALSE;
-      }
+    // Check for cuts
+    if (nPoints < mMinPoints || eKin < mEnergyCut) {
+      mStoreFlags[i] = kFALSE;
     }
-
-    // Set storage flag
-    mStoreMap[i] = store;
   }
 
-  // If flag is set, flag recursively mothers of selected tracks
+  // If flag is set, flag recursively mothers of selected tracks.
+  // Mothers are always pushed before their daughters, hence a single pass from
+  // the last particle propagates the flag to all the ancestors
   if (mStoreMothers) {
-    for (Int_t i = 0; i < mNumberOfEntriesInParticles; i++) {
-      if (mStoreMap[i]) {
+    for (Int_t i = mNumberOfEntriesInParticles; i--;) {
+      if (mStoreFlags[i]) {
         Int_t iMother = GetParticle(i)->GetMother(0);
-        while (iMother >= 0) {
-          mStoreMap[iMother] = kTRUE;
-          iMother = GetParticle(iMother)->GetMother(0);
+        if (iMother >= 0) {
+          mStoreFlags[iMother] = kTRUE;
         }
       }
     }
   }
 }
 
+Int_t Stack::getTrackIndex(Int_t iPart) const
+{
+  // Map index for primary mothers
+  if (iPart == -1) {
+    return -1;
+  }
+  if (iPart < 0 || iPart >= Int_t(mTrackIndex.size())) {
+    if (mLogger) {
+      mLogger->Fatal(MESSAGE_ORIGIN, "Stack: Track index %i not found in index map! ", iPart);
+    }
+    Fatal("Stack::UpdateTrackIndex", "Track index not found in map");
+  }
+  return mTrackIndex[iPart];
+}
+
 FairGenericStack *Stack::CloneStack() const
 {
   return new o2::Data::Stack(*this);
@@ -14,6 +14,7 @@
 #include <boost/test/unit_test.hpp>
 #include "SimulationDataFormat/MCTruthContainer.h"
 #include <algorithm>
+#include <vector>
 
 namespace o2
 {
@@ -63,4 +64,82 @@ BOOST_AUTO_TEST_CASE(MCTruth)
   BOOST_CHECK(view.size() == 0);
 }
 
+BOOST_AUTO_TEST_CASE(MCTruth_OutOfOrder)
+{
+  using TruthElement = long;
+  dataformats::MCTruthContainer<TruthElement> container;
+  container.addElement(0, TruthElement(1));
+  container.addElement(2, TruthElement(20));
+  container.addElement(0, TruthElement(2)); // out of order
+  container.addElement(3, TruthElement(30));
+  container.addElement(2, TruthElement(21)); // out of order
+  container.addElement(3, TruthElement(31));
+  BOOST_CHECK(!container.isFinalized());
+  container.finalize();
+  BOOST_CHECK(container.isFinalized());
+
+  BOOST_CHECK(container.getIndexedSize() == 4);
+  BOOST_CHECK(container.getNElements() == 6);
+  // skipped data index gets no labels
+  BOOST_CHECK(container.getLabels(1).size() == 0);
+  const std::vector<std::vector<TruthElement>> expected = { { 1, 2 }, {}, { 20, 21 }, { 30, 31 } };
+  for (int i = 0; i < 4; i++) {
+    auto view = container.getLabels(i);
+    BOOST_CHECK(std::equal(view.begin(), view.end(), expected[i].begin(), expected[i].end()));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(MCTruth_Merge)
+{
+  using TruthElement = long;
+  dataformats::MCTruthContainer<TruthElement> container1, container2;
+  container1.addElement(0, TruthElement(1));
+  container1.addElement(1, TruthElement(2));
+  container2.addElement(0, TruthElement(10));
+  container2.addElement(0, TruthElement(11));
+  container2.addElement(1, TruthElement(12));
+
+  container1.mergeAtBack(container2);
+  BOOST_CHECK(container1.getIndexedSize() == 4);
+  BOOST_CHECK(container1.getNElements() == 5);
+  BOOST_CHECK(container1.getMCTruthHeader(2).index == 2);
+  BOOST_CHECK(container1.getLabels(2).size() == 2);
+  BOOST_CHECK(container1.getLabels(2)[1] == 11);
+  BOOST_CHECK(container1.getLabels(3)[0] == 12);
+
+  // merging a container with itself duplicates its labels
+  container2.mergeAtBack(container2);
+  BOOST_CHECK(container2.getIndexedSize() == 4);
+  BOOST_CHECK(container2.getNElements() == 6);
+  BOOST_CHECK(container2.getMCTruthHeader(2).index == 3);
+  BOOST_CHECK(container2.getLabels(2).size() == 2);
+  BOOST_CHECK(container2.getLabels(2)[1] == 11);
+  BOOST_CHECK(container2.getLabels(3)[0] == 12);
+}
+
+BOOST_AUTO_TEST_CASE(MCTruth_Flat)
+{
+  using TruthElement = long;
+  dataformats::MCTruthContainer<TruthElement> container;
+  container.addElement(0, TruthElement(1));
+  container.addElement(0, TruthElement(2));
+  container.addElement(1, TruthElement(1));
+  container.addElement(2, TruthElement(10));
+
+  std::vector<char> buffer;
+  container.flatten(buffer);
+  BOOST_CHECK(buffer.size() == container.getFlatSize());
+
+  dataformats::MCTruthContainerFlatView<TruthElement> view(buffer.data(), buffer.size());
+  BOOST_CHECK(view.getIndexedSize() == container.getIndexedSize());
+  BOOST_CHECK(view.getNElements() == container.getNElements());
+  for (int i = 0; i < container.getIndexedSize(); i++) {
+    auto labels = container.getLabels(i);
+    auto flatLabels = view.getLabels(i);
+    BOOST_CHECK(std::equal(labels.begin(), labels.end(), flatLabels.begin(), flatLabels.end()));
+  }
+  BOOST_CHECK(view.getLabels(10).size() == 0);
+  BOOST_CHECK_THROW((dataformats::MCTruthContainerFlatView<int>(buffer.data(), buffer.size())), std::runtime_error);
+}
+
 } // end namespace
@@ -0,0 +1,78 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test Stack class
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "SimulationDataFormat/Stack.h"
+#include "DetectorsBase/Detector.h"
+#include "DetectorsBase/DetID.h"
+#include "TRefArray.h"
+
+namespace
+{
+/// detector keeping its hits outside of TClonesArrays, like the grouped TPC hits
+class HitTrackDetector : public o2::Base::Detector
+{
+ public:
+  HitTrackDetector() : o2::Base::Detector("HitTrack", kTRUE) {}
+  Bool_t ProcessHits(FairVolume* v = nullptr) override { return kFALSE; }
+  void Register() override {}
+  TClonesArray* GetCollection(Int_t iColl) const override { return nullptr; }
+  void Reset() override { mHitTracks.clear(); }
+  void updateHitTrackIndices(const std::function<int(int)>& getTrackIndex) override
+  {
+    for (auto& track : mHitTracks) {
+      track = getTrackIndex(track);
+    }
+  }
+
+  std::vector<int> mHitTracks;
+};
+}
+
+namespace o2
+{
+
+BOOST_AUTO_TEST_CASE(Stack_hit_track_indices)
+{
+  Data::Stack stack;
+  auto push = [&stack](int parent) {
+    int ntr = -1;
+    stack.PushTrack(parent < 0, parent, 211, 0.1, 0.2, 0.3, 1., 0., 0., 0., 0., 0., 0., 0., kPPrimary, ntr, 1., 0);
+    return ntr;
+  };
+  // particle 2 leaves no point and is dropped, the following ones are shifted
+  const int primary = push(-1);
+  const int withHits = push(primary);
+  push(primary);
+  const int lastWithHits = push(primary);
+  BOOST_CHECK_EQUAL(stack.GetNtrack(), 4);
+
+  HitTrackDetector detector;
+  const int detID = o2::Base::DetID::TPC;
+  for (auto track : { primary, withHits, lastWithHits, lastWithHits }) {
+    stack.AddPoint(detID, track);
+    detector.mHitTracks.push_back(track);
+  }
+
+  stack.FillTrackArray();
+
+  TRefArray detectors;
+  detectors.Add(&detector);
+  stack.UpdateTrackIndex(&detectors);
+
+  const std::vector<int> expected{ 0, 1, 2, 2 };
+  BOOST_CHECK_EQUAL_COLLECTIONS(detector.mHitTracks.begin(), detector.mHitTracks.end(), expected.begin(),
+                                expected.end());
+}
+} // namespace o2
@@ -12,6 +12,9 @@
 
 #include <vector>
 #include <array>
+#include <istream>
+#include <ostream>
+#include <string>
 #include "MathUtils/Cartesian3D.h"
 #include "DetectorsBase/DetID.h"
 #include "Rtypes.h"
@@ -62,6 +65,67 @@ class MatrixCache {
 };
 
 
+/// Transform3D matrices of a MatrixCache stored as structure of arrays: each of the 12 elements of the
+/// 3x4 matrices of all sensors, and of their inverses, is a contiguous array. The batched transformations
+/// of points of arbitrary sensors run in a single loop the compiler can vectorize.
+
+class MatrixCacheSoA
+{
+ public:
+  MatrixCacheSoA() = default;
+  ~MatrixCacheSoA() = default;
+  MatrixCacheSoA(const MatrixCacheSoA& src) = delete;
+  MatrixCacheSoA& operator=(const MatrixCacheSoA& src) = delete;
+
+  /// copy the matrices of a filled cache
+  void fill(const MatrixCache<o2::Base::Transform3D>& cache);
+
+  int getSize() const { return mDirect[0].size(); }
+  bool isFilled() const { return !mDirect[0].empty(); }
+
+  /// out[i] = M(sensorID[i]) * in[i], in and out may be the same array
+  template <typename T>
+  void transform(const int* sensorID, const Point3D<T>* in, Point3D<T>* out, int n) const
+  {
+    apply(mDirect, sensorID, in, out, n);
+  }
+
+  /// out[i] = M(sensorID[i])^-1 * in[i], in and out may be the same array
+  template <typename T>
+  void transformInverse(const int* sensorID, const Point3D<T>* in, Point3D<T>* out, int n) const
+  {
+    apply(mInverse, sensorID, in, out, n);
+  }
+
+ private:
+  /// elements in the order of Transform3D::GetComponents: xx xy xz dx yx yy yz dy zx zy zz dz
+  using Elements = std::array<std::vector<double>, 12>;
+
+  template <typename T>
+  static void apply(const Elements& m, const int* sensorID, const Point3D<T>* in, Point3D<T>* out, int n);
+
+  Elements mDirect;
+  Elements mInverse;
+};
+
+//_______________________________________________________
+template <typename T>
+inline void MatrixCacheSoA::apply(const Elements& m, const int* sensorID, const Point3D<T>* in, Point3D<T>* out, int n)
+{
+  const double *__restrict__ xx = m[0].data(), *__restrict__ xy = m[1].data(), *__restrict__ xz = m[2].data(),
+                              *__restrict__ dx = m[3].data();
+  const double *__restrict__ yx = m[4].data(), *__restrict__ yy = m[5].data(), *__restrict__ yz = m[6].data(),
+                              *__restrict__ dy = m[7].data();
+  const double *__restrict__ zx = m[8].data(), *__restrict__ zy = m[9].data(), *__restrict__ zz = m[10].data(),
+                              *__restrict__ dz = m[11].data();
+  for (int i = 0; i < n; i++) {
+    const int s = sensorID[i];
+    const double x = in[i].X(), y = in[i].Y(), z = in[i].Z();
+    out[i].SetCoordinates(xx[s] * x + xy[s] * y + xz[s] * z + dx[s], yx[s] * x + yy[s] * y + yz[s] * z + dy[s],
+                          zx[s] * x + zy[s] * y + zz[s] * z + dz[s]);
+  }
+}
+
 /// Set of MatrixCache vectors for transformations used by detector, to be overriden by
 /// detector class (see ITS GeometryTGeo)
 
@@ -98,6 +162,33 @@ class DetMatrixCache
   bool isBuilt() const {return mSize!=0;}
   int  getSize() const {return mSize;}
 
+  const MatrixCacheSoA& getCacheL2GSoA() const {return mL2GSoA;}
+  const MatrixCacheSoA& getCacheT2LSoA() const {return mT2LSoA;}
+  const MatrixCacheSoA& getCacheT2GSoA() const {return mT2GSoA;}
+
+  // batched transformations of n points of sensors sensorID[i], using the structure of arrays caches,
+  // no check for the matrices cache validity
+  template <typename T>
+  void toGlobal(const int* sensorID, const Point3D<T>* loc, Point3D<T>* glo, int n) const
+  { // local -> global
+    mL2GSoA.transform(sensorID, loc, glo, n);
+  }
+  template <typename T>
+  void toLocal(const int* sensorID, const Point3D<T>* glo, Point3D<T>* loc, int n) const
+  { // global -> local
+    mL2GSoA.transformInverse(sensorID, glo, loc, n);
+  }
+  template <typename T>
+  void toTracking(const int* sensorID, const Point3D<T>* loc, Point3D<T>* tra, int n) const
+  { // local -> tracking
+    mT2LSoA.transformInverse(sensorID, loc, tra, n);
+  }
+  template <typename T>
+  void toGlobalFromTracking(const int* sensorID, const Point3D<T>* tra, Point3D<T>* glo, int n) const
+  { // tracking -> global
+    mT2GSoA.transform(sensorID, tra, glo, n);
+  }
+
   //  protected:
 
   // detector derived class must define its implementation for the method to populate the matrix cache, as an
@@ -106,6 +197,51 @@ class DetMatrixCache
   // with differen mask as  o2::Base::Utils::bit2Mask(T2L), or bit2Mask(L2G,T2L), but for the consistency
   // check the nsens must be always the same.
   virtual void fillMatrixCache(int mask) = 0;
+
+  // copy the L2G, T2L and T2G caches requested in the mask, once filled, to their structure of arrays
+  // version used by the batched transformations. To be called by the fillMatrixCache implementations.
+  void fillMatrixCacheSoA(int mask);
+
+  // Binary snapshot of the filled caches and of the detector layout tables, tagged with the hash of the
+  // geometry and alignment they were produced from (see GeometryManager::getGeometryHash), to set up
+  // the caches in a few ms without TGeo.
+  bool writeSnapshot(const std::string& fileName, ULong64_t geometryHash) const;
+  // fails if the cache was already built, if the snapshot is of another detector or, unless 0 is
+  // passed, of another geometry hash
+  bool readSnapshot(const std::string& fileName, ULong64_t geometryHash = 0);
+
+  // detector layout tables stored in the snapshot after the matrices, to be overriden by detectors
+  // whose indexing is extracted from TGeo
+  virtual void writeSnapshotTables(std::ostream& out) const {}
+  virtual bool readSnapshotTables(std::istream& in) { return true; }
+
+  // helpers for the snapshot tables, for trivially copyable types only
+  template <typename T>
+  static void writeSnapshotValue(std::ostream& out, const T& v)
+  {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+  }
+  template <typename T>
+  static bool readSnapshotValue(std::istream& in, T& v)
+  {
+    return bool(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+  }
+  template <typename T>
+  static void writeSnapshotVector(std::ostream& out, const std::vector<T>& v)
+  {
+    writeSnapshotValue(out, ULong64_t(v.size()));
+    out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+  }
+  template <typename T>
+  static bool readSnapshotVector(std::istream& in, std::vector<T>& v)
+  {
+    ULong64_t n = 0;
+    if (!readSnapshotValue(in, n) || n > (1ul << 32)) {
+      return false;
+    }
+    v.resize(n);
+    return bool(in.read(reinterpret_cast<char*>(v.data()), n * sizeof(T)));
+  }
   
   // before calling fillMatrixCache, detector implementation should set the size of the matrix cache
   void setSize(int s);
@@ -124,6 +260,10 @@ class DetMatrixCache
   MatrixCache<Mat3D> mT2G;                     ///< Tracking to Global matrices (general case)
   MatrixCache<Rot2D> mT2GRot;                  ///< Tracking to Global matrices in case of barrel (simple rotation)
 
+  MatrixCacheSoA mL2GSoA;                      //! Local to Global matrices as structure of arrays
+  MatrixCacheSoA mT2LSoA;                      //! Tracking to Local matrices as structure of arrays
+  MatrixCacheSoA mT2GSoA;                      //! Tracking to Global matrices as structure of arrays
+
   ClassDef(DetMatrixCache,1);
 };
 
@@ -14,6 +14,7 @@
 #ifndef ALICEO2_BASE_DETECTOR_H_
 #define ALICEO2_BASE_DETECTOR_H_
 
+#include <functional>
 #include <map>
 #include <vector>
 #include <memory>
@@ -127,6 +128,10 @@ class Detector : public FairDetector
       return s+ext;
     }
     
+    // called by the stack once the track array is filled, to replace the particle indices stored in the hits
+    // by the indices of the output tracks; needed for hits not exposed as TClonesArray through GetCollection
+    virtual void updateHitTrackIndices(const std::function<int(int)>& getTrackIndex) {}
+
     // static and reusable service function to set tracking parameters in relation to field
     // returns global integration mode (inhomogenety) for the field and the max field value
     // which is required for media creation
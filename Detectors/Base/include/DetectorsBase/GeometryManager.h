@@ -16,6 +16,7 @@
 
 #include <TGeoPhysicalNode.h> // for TGeoPNEntry
 #include <TObject.h>          // for TObject
+#include <string>
 #include "DetectorsBase/DetID.h"
 #include "Rtypes.h" // for Bool_t, GeometryManager::Class, ClassDef, etc
 
@@ -51,6 +52,24 @@ class GeometryManager : public TObject
     return (detid.getMask() << sDetOffset) | (sensid & sSensorMask);
   }
 
+  /// Material budget accumulated along a straight segment
+  struct MatBudget {
+    double meanRho = 0.;  ///< mean density along the segment, g/cm^3
+    double meanX2X0 = 0.; ///< thickness of the segment in units of radiation length
+    double length = -1.;  ///< segment length in cm, negative if the geometry is not available
+
+    double getXRho() const { return meanRho * length; }
+  };
+
+  /// Calculate the material budget of the straight segment between the points (x0,y0,z0) and (x1,y1,z1)
+  /// by stepping through the volumes of the loaded TGeo geometry. Slow, meant for tabulation
+  /// (see MatBudgetLUT) and validation
+  static MatBudget meanMaterialBudget(double x0, double y0, double z0, double x1, double y1, double z1);
+
+  /// Hash of the content of the geometry file and, if given, of the alignment file, to tag the products
+  /// of the geometry such as the matrix cache snapshots. Returns 0 if a file cannot be read
+  static ULong64_t getGeometryHash(const std::string& geomFileName, const std::string& alignFileName = "");
+
   /// Default destructor
   ~GeometryManager() override = default;
 
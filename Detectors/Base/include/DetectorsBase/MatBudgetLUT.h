@@ -0,0 +1,101 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file MatBudgetLUT.h
+/// \brief Tabulated material budget in cylindrical layers, for fast material corrections in tracking
+
+#ifndef ALICEO2_BASE_MATBUDGETLUT_H
+#define ALICEO2_BASE_MATBUDGETLUT_H
+
+#include <string>
+#include <vector>
+#include "MathUtils/Cartesian3D.h"
+#include "DetectorsBase/GeometryManager.h"
+#include "Rtypes.h"
+
+namespace o2
+{
+namespace Base
+{
+
+/// Cylindrical shell rMin<r<rMax, |z|<zMax, binned in (phi,z), storing per bin the mean density and
+/// the inverse radiation length of the material it contains
+struct MatLayerCyl {
+  float rMin = 0.;            ///< inner radius
+  float rMax = 0.;            ///< outer radius
+  float zMax = 0.;            ///< half length
+  int nZ = 0;                 ///< number of z bins
+  int nPhi = 0;               ///< number of phi bins
+  float dZInv = 0.;           ///< inverse z bin size
+  float dPhiInv = 0.;         ///< inverse phi bin size
+  float step = 0.;            ///< integration step, of the order of the bin size
+  std::vector<float> rho;     ///< mean density per bin, g/cm^3
+  std::vector<float> x0Inv;   ///< mean 1/X0 per bin, 1/cm
+
+  int getNBins() const { return nZ * nPhi; }
+  int getBin(float phi, float z) const; ///< bin for phi in [0:2pi] and |z|<zMax
+
+  ClassDefNV(MatLayerCyl, 1);
+};
+
+/// Look-up table of the material budget, made of cylindrical layers filled from the TGeo geometry
+/// (see GeometryManager::meanMaterialBudget). The table is built once, stored to a file and loaded
+/// at the tracking start. Material outside of the layers is neglected. The queries are const
+/// and can be used concurrently
+class MatBudgetLUT
+{
+ public:
+  using MatBudget = GeometryManager::MatBudget;
+
+  MatBudgetLUT() = default;
+  ~MatBudgetLUT() = default;
+
+  /// add layer rMin<r<rMax, |z|<zMax with bins of dZ and dPhi, layers must not overlap
+  void addLayer(float rMin, float rMax, float zMax, float dZ, float dPhi);
+  int getNLayers() const { return mLayers.size(); }
+  const MatLayerCyl& getLayer(int i) const { return mLayers[i]; }
+
+  /// fill the bins from the loaded geometry averaging the budget of nSamples^2 radial rays per bin
+  void populateFromGeometry(int nSamples = 2);
+
+  /// material budget of the straight segment p0-p1
+  MatBudget getMatBudget(const Point3D<float>& p0, const Point3D<float>& p1) const;
+  MatBudget getMatBudget(float x0, float y0, float z0, float x1, float y1, float z1) const;
+  /// material budget of n segments
+  void getMatBudget(int n, const Point3D<float>* p0, const Point3D<float>* p1, MatBudget* budget) const;
+
+  bool writeToFile(const std::string& fileName, const std::string& name = "MatBudgetLUT") const;
+  static MatBudgetLUT* loadFromFile(const std::string& fileName, const std::string& name = "MatBudgetLUT");
+
+ private:
+  void integrateLayer(const MatLayerCyl& lr, const float* p0, const float* d, float len, double& rhoL,
+                      double& x2x0) const;
+
+  std::vector<MatLayerCyl> mLayers; ///< layers sorted in radius
+
+  ClassDefNV(MatBudgetLUT, 1);
+};
+
+//____________________________________________________________
+inline int MatLayerCyl::getBin(float phi, float z) const
+{
+  int iz = (z + zMax) * dZInv, iphi = phi * dPhiInv;
+  if (iz >= nZ) {
+    iz = nZ - 1;
+  }
+  if (iphi >= nPhi) {
+    iphi = nPhi - 1;
+  }
+  return iz * nPhi + iphi;
+}
+}
+}
+
+#endif
@@ -0,0 +1,93 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TrackBlock.h
+/// \brief Block of tracks with covariance stored as structure of arrays, for batched propagation and update
+
+#ifndef ALICEO2_BASE_TRACKBLOCK
+#define ALICEO2_BASE_TRACKBLOCK
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "DetectorsBase/Track.h"
+
+namespace o2 {
+  namespace Base {
+    namespace Track {
+
+      /// Set of TrackParCov stored as structure of arrays. The kernels process all tracks of the
+      /// block in loops the compiler can vectorize and reproduce the results of the TrackParCov
+      /// methods. Each track has a status flag: the kernels skip the tracks flagged as bad and
+      /// flag the ones for which the operation fails (where TrackParCov would return false),
+      /// leaving their parameters unchanged.
+      class TrackParCovBlock {
+        public:
+          TrackParCovBlock() = default;
+          explicit TrackParCovBlock(int n) { Resize(n); }
+
+          int   GetSize()                      const { return mX.size(); }
+          void  Resize(int n);
+          void  Clear() { Resize(0); }
+
+          void  Add(const TrackParCov &trc);
+          void  Set(int i, const TrackParCov &trc);
+          TrackParCov GetTrack(int i)          const;
+
+          bool  IsOK(int i)                    const { return mOK[i]; }
+          void  SetOK(int i, bool v=true)            { mOK[i] = v; }
+          void  SetAllOK();
+          int   GetNOK()                       const;
+
+          float GetX(int i)                    const { return mX[i]; }
+          float GetAlpha(int i)                const { return mAlpha[i]; }
+          float GetParam(int i, int ip)        const { return mP[ip][i]; }
+          float GetCov(int i, int ic)          const { return mC[ic][i]; }
+          const float* GetParams(int ip)       const { return mP[ip].data(); }
+          const float* GetCovs(int ic)         const { return mC[ic].data(); }
+
+          // batched kernels, return the number of tracks still flagged as OK
+          int   Rotate(float alpha);
+          int   Rotate(const float* alpha);
+          int   PropagateTo(float xk, float b);
+          int   PropagateTo(const float* xk, float b);
+          void  GetPredictedChi2(const std::array<const float*,2> &p, const std::array<const float*,3> &cov, float* chi2) const;
+          int   Update(const std::array<const float*,2> &p, const std::array<const float*,3> &cov);
+
+        private:
+          void  CheckCovariance(const uint8_t* __restrict__ active);
+
+          std::vector<float> mX;                              /// X of track evaluation
+          std::vector<float> mAlpha;                          /// track frame angle
+          std::array<std::vector<float>,kNParams> mP;         /// parameters, one array per parameter
+          std::array<std::vector<float>,kCovMatSize> mC;      /// covariance, one array per element
+          std::vector<uint8_t> mOK;                           /// track status
+          std::vector<float> mTmp;                            //! scratch for uniform arguments
+          std::vector<uint8_t> mActive;                       //! scratch for the active tracks
+          std::vector<float> mSnp0;                           //! scratch for the initial snp
+          std::vector<float> mSin, mCos;                      //! scratch for the rotation angles
+      };
+
+      //____________________________________________________________
+      inline TrackParCov TrackParCovBlock::GetTrack(int i) const {
+        // extract the track
+        std::array<float,kNParams> par;
+        std::array<float,kCovMatSize> cov;
+        for (int ip=0;ip<kNParams;ip++) par[ip] = mP[ip][i];
+        for (int ic=0;ic<kCovMatSize;ic++) cov[ic] = mC[ic][i];
+        return TrackParCov(mX[i],mAlpha[i],par,cov);
+      }
+
+    }
+  }
+}
+
+#endif
@@ -23,6 +23,8 @@
 #pragma link C++ class o2::Base::TrackReference+;
 #pragma link C++ class o2::Base::DetID+;
 #pragma link C++ class o2::Base::GeometryManager+;
+#pragma link C++ class o2::Base::MatLayerCyl+;
+#pragma link C++ class o2::Base::MatBudgetLUT+;
 #pragma link C++ class o2::Base::BaseCluster<float>+;
 #pragma link C++ class o2::Base::MatrixCache<o2::Base::Transform3D>+;
 #pragma link C++ class o2::Base::MatrixCache<o2::Base::Rotation2D>+;
@@ -11,6 +11,9 @@
 #include "DetectorsBase/DetMatrixCache.h"
 #include "DetectorsBase/Utils.h"
 #include <TGeoMatrix.h>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 
 using namespace o2::Base;
 using namespace o2::Base::Utils;
@@ -19,6 +22,23 @@ ClassImp(o2::Base::MatrixCache<o2::Base::Transform3D>);
 ClassImp(o2::Base::MatrixCache<o2::Base::Rotation2D>);
 ClassImp(o2::Base::DetMatrixCache);
 
+namespace
+{
+// snapshot layout: header, the 12 components (Transform3D::GetComponents order) of each sensor matrix
+// of the 3D caches flagged in the mask, cos and sin of each T2GRot rotation, size and data of the tables
+constexpr char kSnapshotMagic[8] = { 'O', '2', 'G', 'E', 'O', 'S', 'N', 'P' };
+constexpr UInt_t kSnapshotVersion = 1;
+
+struct SnapshotHeader {
+  char magic[8];
+  UInt_t version;
+  Int_t detID;
+  Int_t nSensors;
+  UInt_t mask; // transformations stored
+  ULong64_t geometryHash;
+};
+}
+
 
 //_______________________________________________________
 void DetMatrixCache::setSize(int s)
@@ -29,3 +49,191 @@ void DetMatrixCache::setSize(int s)
   }
   mSize = s;
 }
+
+//_______________________________________________________
+void MatrixCacheSoA::fill(const MatrixCache<Transform3D>& cache)
+{
+  // copy the matrices and their inverses to the arrays of their elements
+  int n = cache.getSize();
+  for (auto& el : mDirect) {
+    el.resize(n);
+  }
+  for (auto& el : mInverse) {
+    el.resize(n);
+  }
+  for (int i = 0; i < n; i++) {
+    const Transform3D& mat = cache.getMatrix(i);
+    mat.GetComponents(mDirect[0][i], mDirect[1][i], mDirect[2][i], mDirect[3][i], mDirect[4][i], mDirect[5][i],
+                      mDirect[6][i], mDirect[7][i], mDirect[8][i], mDirect[9][i], mDirect[10][i], mDirect[11][i]);
+    mat.Inverse().GetComponents(mInverse[0][i], mInverse[1][i], mInverse[2][i], mInverse[3][i], mInverse[4][i],
+                                mInverse[5][i], mInverse[6][i], mInverse[7][i], mInverse[8][i], mInverse[9][i],
+                                mInverse[10][i], mInverse[11][i]);
+  }
+}
+
+//_______________________________________________________
+void DetMatrixCache::fillMatrixCacheSoA(int mask)
+{
+  // copy the requested filled caches to their structure of arrays version
+  if ((mask & bit2Mask(TransformType::L2G)) && mL2G.isFilled() && !mL2GSoA.isFilled()) {
+    mL2GSoA.fill(mL2G);
+  }
+  if ((mask & bit2Mask(TransformType::T2L)) && mT2L.isFilled() && !mT2LSoA.isFilled()) {
+    mT2LSoA.fill(mT2L);
+  }
+  if ((mask & bit2Mask(TransformType::T2G)) && mT2G.isFilled() && !mT2GSoA.isFilled()) {
+    mT2GSoA.fill(mT2G);
+  }
+}
+
+//_______________________________________________________
+bool DetMatrixCache::writeSnapshot(const std::string& fileName, ULong64_t geometryHash) const
+{
+  // write the filled caches and the detector tables
+  if (!isBuilt()) {
+    LOG(ERROR) << getName() << " matrix cache is not built, no snapshot written" << FairLogger::endl;
+    return false;
+  }
+  std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    LOG(ERROR) << "Failed to open output file " << fileName << FairLogger::endl;
+    return false;
+  }
+  const MatrixCache<Mat3D>* caches3D[3] = { &mL2G, &mT2L, &mT2G };
+  const int types3D[3] = { TransformType::L2G, TransformType::T2L, TransformType::T2G };
+
+  SnapshotHeader header;
+  std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+  header.version = kSnapshotVersion;
+  header.detID = mDetID;
+  header.nSensors = mSize;
+  header.mask = 0;
+  for (int ic = 0; ic < 3; ic++) {
+    if (caches3D[ic]->isFilled()) {
+      header.mask |= bit2Mask(types3D[ic]);
+    }
+  }
+  if (mT2GRot.isFilled()) {
+    header.mask |= bit2Mask(TransformType::T2GRot);
+  }
+  header.geometryHash = geometryHash;
+  writeSnapshotValue(out, header);
+
+  std::vector<double> components(12 * mSize);
+  for (int ic = 0; ic < 3; ic++) {
+    if (!caches3D[ic]->isFilled()) {
+      continue;
+    }
+    for (int i = 0; i < mSize; i++) {
+      caches3D[ic]->getMatrix(i).GetComponents(components.begin() + 12 * i, components.begin() + 12 * (i + 1));
+    }
+    out.write(reinterpret_cast<const char*>(components.data()), components.size() * sizeof(double));
+  }
+  if (mT2GRot.isFilled()) {
+    std::vector<float> rotations(2 * mSize);
+    for (int i = 0; i < mSize; i++) {
+      mT2GRot.getMatrix(i).getComponents(rotations[2 * i], rotations[2 * i + 1]);
+    }
+    out.write(reinterpret_cast<const char*>(rotations.data()), rotations.size() * sizeof(float));
+  }
+
+  std::ostringstream tables;
+  writeSnapshotTables(tables);
+  writeSnapshotValue(out, ULong64_t(tables.str().size()));
+  out << tables.str();
+
+  if (!out) {
+    LOG(ERROR) << "Failed to write the " << getName() << " geometry snapshot to " << fileName << FairLogger::endl;
+    return false;
+  }
+  LOG(INFO) << "Wrote " << getName() << " geometry snapshot of " << mSize << " sensors to " << fileName
+            << FairLogger::endl;
+  return true;
+}
+
+//_______________________________________________________
+bool DetMatrixCache::readSnapshot(const std::string& fileName, ULong64_t geometryHash)
+{
+  // fill the caches and the detector tables from the snapshot
+  if (isBuilt()) {
+    LOG(ERROR) << getName() << " matrix cache is already built, snapshot not loaded" << FairLogger::endl;
+    return false;
+  }
+  std::ifstream in(fileName, std::ios::binary);
+  if (!in) {
+    LOG(ERROR) << "Failed to open input file " << fileName << FairLogger::endl;
+    return false;
+  }
+  SnapshotHeader header;
+  if (!readSnapshotValue(in, header) || std::memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) ||
+      header.version != kSnapshotVersion) {
+    LOG(ERROR) << fileName << " is not a geometry snapshot of version " << kSnapshotVersion << FairLogger::endl;
+    return false;
+  }
+  if (header.detID != mDetID) {
+    LOG(ERROR) << fileName << " is a snapshot of detector " << header.detID << ", not of " << getName()
+               << FairLogger::endl;
+    return false;
+  }
+  if (geometryHash && header.geometryHash != geometryHash) {
+    LOG(ERROR) << fileName << " was produced from another geometry (hash " << header.geometryHash << " instead of "
+               << geometryHash << ")" << FairLogger::endl;
+    return false;
+  }
+  const int n = header.nSensors;
+  if (n < 1) {
+    LOG(ERROR) << fileName << " has no sensors" << FairLogger::endl;
+    return false;
+  }
+
+  MatrixCache<Mat3D>* caches3D[3] = { &mL2G, &mT2L, &mT2G };
+  const int types3D[3] = { TransformType::L2G, TransformType::T2L, TransformType::T2G };
+  std::vector<double> components[3];
+  for (int ic = 0; ic < 3; ic++) {
+    if (header.mask & bit2Mask(types3D[ic])) {
+      components[ic].resize(12 * n);
+      in.read(reinterpret_cast<char*>(components[ic].data()), components[ic].size() * sizeof(double));
+    }
+  }
+  std::vector<float> rotations;
+  if (header.mask & bit2Mask(TransformType::T2GRot)) {
+    rotations.resize(2 * n);
+    in.read(reinterpret_cast<char*>(rotations.data()), rotations.size() * sizeof(float));
+  }
+  ULong64_t tablesSize = 0;
+  if (!readSnapshotValue(in, tablesSize) || tablesSize > (1ul << 32)) {
+    LOG(ERROR) << fileName << " is truncated" << FairLogger::endl;
+    return false;
+  }
+  std::string tablesData(tablesSize, '\0');
+  if (!in.read(&tablesData[0], tablesSize)) {
+    LOG(ERROR) << fileName << " is truncated" << FairLogger::endl;
+    return false;
+  }
+  std::istringstream tables(tablesData);
+  if (!readSnapshotTables(tables)) {
+    LOG(ERROR) << "Failed to read the " << getName() << " tables from " << fileName << FairLogger::endl;
+    return false;
+  }
+
+  setSize(n);
+  for (int ic = 0; ic < 3; ic++) {
+    if (components[ic].empty()) {
+      continue;
+    }
+    caches3D[ic]->setSize(n);
+    for (int i = 0; i < n; i++) {
+      caches3D[ic]->setMatrix(Mat3D(components[ic].begin() + 12 * i, components[ic].begin() + 12 * (i + 1)), i);
+    }
+  }
+  if (!rotations.empty()) {
+    mT2GRot.setSize(n);
+    for (int i = 0; i < n; i++) {
+      mT2GRot.setMatrix(Rot2D(rotations[2 * i], rotations[2 * i + 1]), i);
+    }
+  }
+  fillMatrixCacheSoA(header.mask);
+  LOG(INFO) << "Loaded " << getName() << " geometry snapshot of " << n << " sensors from " << fileName
+            << FairLogger::endl;
+  return true;
+}
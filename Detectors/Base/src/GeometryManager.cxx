@@ -17,14 +17,19 @@
 
 #include "TCollection.h"      // for TIter
 #include "TGeoManager.h"      // for TGeoManager
+#include "TGeoMaterial.h"     // for TGeoMaterial
+#include "TGeoMedium.h"       // for TGeoMedium
 #include "TGeoMatrix.h"       // for TGeoHMatrix
 #include "TGeoNode.h"         // for TGeoNode
 #include "TGeoPhysicalNode.h" // for TGeoPhysicalNode, TGeoPNEntry
 #include "TObjArray.h"        // for TObjArray
 #include "TObject.h"          // for TObject
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef> // for NULL
+#include <fstream>
 
 using namespace o2::Base;
 
@@ -198,3 +203,77 @@ Bool_t GeometryManager::getOriginalMatrix(DetID detid, int sensid, TGeoHMatrix&
 
   return getOriginalMatrix(symname, m);
 }
+
+GeometryManager::MatBudget GeometryManager::meanMaterialBudget(double x0, double y0, double z0, double x1, double y1,
+                                                               double z1)
+{
+  /**
+   * Calculate mean density and thickness in X0 units of the segment between 2 points, by stepping
+   * through the TGeo volumes crossed. The steps stuck at the boundaries are skipped with a small
+   * nudge, neglecting their material
+   **/
+  const double kNudge = 1e-6;
+  MatBudget budget;
+  if (!gGeoManager) {
+    LOG(ERROR) << "No active geometry!" << FairLogger::endl;
+    return budget;
+  }
+  double start[3] = { x0, y0, z0 }, dir[3] = { x1 - x0, y1 - y0, z1 - z0 };
+  double length = std::sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+  budget.length = length;
+  if (length < kNudge) {
+    return budget;
+  }
+  for (int i = 0; i < 3; i++) {
+    dir[i] /= length;
+  }
+
+  double rhoL = 0., x2x0 = 0., done = 0.;
+  TGeoNode* node = gGeoManager->InitTrack(start, dir);
+  while (node && done < length) {
+    TGeoMedium* med = node->GetMedium();
+    TGeoMaterial* mat = med ? med->GetMaterial() : nullptr;
+    double stepMax = length - done;
+    node = gGeoManager->FindNextBoundaryAndStep(stepMax);
+    double step = std::min(gGeoManager->GetStep(), stepMax);
+    if (step < kNudge) {
+      done += std::min(kNudge, stepMax);
+      double pnt[3] = { x0 + dir[0] * done, y0 + dir[1] * done, z0 + dir[2] * done };
+      node = gGeoManager->InitTrack(pnt, dir);
+      continue;
+    }
+    if (mat) {
+      rhoL += mat->GetDensity() * step;
+      x2x0 += step / mat->GetRadLen();
+    }
+    done += step;
+  }
+  budget.meanRho = rhoL / length;
+  budget.meanX2X0 = x2x0;
+  return budget;
+}
+
+//______________________________________________________________________
+ULong64_t GeometryManager::getGeometryHash(const std::string& geomFileName, const std::string& alignFileName)
+{
+  // 64 bit FNV-1a hash of the content of the files
+  ULong64_t hash = 14695981039346656037ull;
+  for (const auto& fileName : { geomFileName, alignFileName }) {
+    if (fileName.empty()) {
+      continue;
+    }
+    std::ifstream in(fileName, std::ios::binary);
+    if (!in) {
+      LOG(ERROR) << "Failed to open " << fileName << " for the geometry hash" << FairLogger::endl;
+      return 0;
+    }
+    char buffer[1 << 16];
+    while (in.read(buffer, sizeof(buffer)) || in.gcount()) {
+      for (std::streamsize i = 0; i < in.gcount(); i++) {
+        hash ^= static_cast<unsigned char>(buffer[i]);
+        hash *= 1099511628211ull;
+      }
+    }
+  }
+  return hash;
+}
@@ -0,0 +1,220 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file MatBudgetLUT.cxx
+/// \brief Implementation of the tabulated material budget
+
+#include "DetectorsBase/MatBudgetLUT.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <TFile.h>
+#include "FairLogger.h"
+
+using namespace o2::Base;
+
+ClassImp(o2::Base::MatLayerCyl);
+ClassImp(o2::Base::MatBudgetLUT);
+
+namespace
+{
+const float kTwoPi = 2.f * M_PI;
+}
+
+//____________________________________________________________
+void MatBudgetLUT::addLayer(float rMin, float rMax, float zMax, float dZ, float dPhi)
+{
+  if (rMin < 0.f || rMax <= rMin || zMax <= 0.f || dZ <= 0.f || dPhi <= 0.f) {
+    LOG(ERROR) << "Wrong layer definition: rMin=" << rMin << " rMax=" << rMax << " zMax=" << zMax << " dZ=" << dZ
+               << " dPhi=" << dPhi << FairLogger::endl;
+    return;
+  }
+  for (const auto& lr : mLayers) {
+    if (rMin < lr.rMax && rMax > lr.rMin) {
+      LOG(ERROR) << "Layer " << rMin << "<r<" << rMax << " overlaps with " << lr.rMin << "<r<" << lr.rMax
+                 << FairLogger::endl;
+      return;
+    }
+  }
+  MatLayerCyl lr;
+  lr.rMin = rMin;
+  lr.rMax = rMax;
+  lr.zMax = zMax;
+  lr.nZ = std::max(1, int(std::ceil(2.f * zMax / dZ)));
+  lr.nPhi = std::max(1, int(std::ceil(kTwoPi / dPhi)));
+  lr.dZInv = lr.nZ / (2.f * zMax);
+  lr.dPhiInv = lr.nPhi / kTwoPi;
+  // sample each crossed bin at least twice
+  float binRPhi = (rMin > 0.f ? rMin : rMax) / lr.dPhiInv;
+  lr.step = 0.5f * std::min({ 1.f / lr.dZInv, binRPhi, rMax - rMin });
+  lr.rho.resize(lr.getNBins(), 0.f);
+  lr.x0Inv.resize(lr.getNBins(), 0.f);
+  auto pos = std::lower_bound(mLayers.begin(), mLayers.end(), lr,
+                              [](const MatLayerCyl& a, const MatLayerCyl& b) { return a.rMin < b.rMin; });
+  mLayers.insert(pos, std::move(lr));
+}
+
+//____________________________________________________________
+void MatBudgetLUT::populateFromGeometry(int nSamples)
+{
+  // average the budget of radial rays crossing each bin
+  nSamples = std::max(1, nSamples);
+  float norm = 1.f / (nSamples * nSamples);
+  for (auto& lr : mLayers) {
+    for (int iz = 0; iz < lr.nZ; iz++) {
+      for (int iphi = 0; iphi < lr.nPhi; iphi++) {
+        double rho = 0., x0Inv = 0.;
+        for (int is = 0; is < nSamples; is++) {
+          float phi = (iphi + (is + 0.5f) / nSamples) / lr.dPhiInv, cs = std::cos(phi), sn = std::sin(phi);
+          for (int js = 0; js < nSamples; js++) {
+            float z = -lr.zMax + (iz + (js + 0.5f) / nSamples) / lr.dZInv;
+            auto budget =
+              GeometryManager::meanMaterialBudget(lr.rMin * cs, lr.rMin * sn, z, lr.rMax * cs, lr.rMax * sn, z);
+            if (budget.length < 0.) {
+              LOG(ERROR) << "Failed to get the material budget from the geometry" << FairLogger::endl;
+              return;
+            }
+            rho += budget.meanRho;
+            x0Inv += budget.meanX2X0 / budget.length;
+          }
+        }
+        int bin = iz * lr.nPhi + iphi;
+        lr.rho[bin] = rho * norm;
+        lr.x0Inv[bin] = x0Inv * norm;
+      }
+    }
+  }
+}
+
+//____________________________________________________________
+MatBudgetLUT::MatBudget MatBudgetLUT::getMatBudget(const Point3D<float>& p0, const Point3D<float>& p1) const
+{
+  return getMatBudget(p0.X(), p0.Y(), p0.Z(), p1.X(), p1.Y(), p1.Z());
+}
+
+//____________________________________________________________
+MatBudgetLUT::MatBudget MatBudgetLUT::getMatBudget(float x0, float y0, float z0, float x1, float y1, float z1) const
+{
+  MatBudget budget;
+  float p0[3] = { x0, y0, z0 }, d[3] = { x1 - x0, y1 - y0, z1 - z0 };
+  float len = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+  budget.length = len;
+  if (len <= 0.f) {
+    return budget;
+  }
+  for (int i = 0; i < 3; i++) {
+    d[i] /= len;
+  }
+  double rhoL = 0., x2x0 = 0.;
+  for (const auto& lr : mLayers) {
+    integrateLayer(lr, p0, d, len, rhoL, x2x0);
+  }
+  budget.meanRho = rhoL / len;
+  budget.meanX2X0 = x2x0;
+  return budget;
+}
+
+//____________________________________________________________
+void MatBudgetLUT::getMatBudget(int n, const Point3D<float>* p0, const Point3D<float>* p1, MatBudget* budget) const
+{
+  for (int i = 0; i < n; i++) {
+    budget[i] = getMatBudget(p0[i], p1[i]);
+  }
+}
+
+//____________________________________________________________
+void MatBudgetLUT::integrateLayer(const MatLayerCyl& lr, const float* p0, const float* d, float len, double& rhoL,
+                                  double& x2x0) const
+{
+  // Integrate the material of the layer along the segment p0+t*d, 0<t<len, with unit d.
+  // The squared radius along the segment is r2(t) = a*t^2 + 2*b*t + c
+  float a = d[0] * d[0] + d[1] * d[1], b = p0[0] * d[0] + p0[1] * d[1], c = p0[0] * p0[0] + p0[1] * p0[1];
+  const float kTiny = 1e-12f;
+  float tOut0 = 0.f, tOut1 = len; // part inside rMax
+  if (a < kTiny) {
+    if (c > lr.rMax * lr.rMax || c < lr.rMin * lr.rMin) {
+      return; // parallel to the beam axis and outside of the layer
+    }
+  } else {
+    float det = b * b - a * (c - lr.rMax * lr.rMax);
+    if (det <= 0.f) {
+      return;
+    }
+    det = std::sqrt(det);
+    tOut0 = std::max(0.f, (-b - det) / a);
+    tOut1 = std::min(len, (-b + det) / a);
+  }
+  if (tOut1 <= tOut0) {
+    return;
+  }
+  float tIn0 = tOut1, tIn1 = tOut1; // part inside rMin, to be excluded
+  if (a >= kTiny && lr.rMin > 0.f) {
+    float det = b * b - a * (c - lr.rMin * lr.rMin);
+    if (det > 0.f) {
+      det = std::sqrt(det);
+      tIn0 = std::max(tOut0, (-b - det) / a);
+      tIn1 = std::min(tOut1, (-b + det) / a);
+      if (tIn1 <= tIn0) {
+        tIn0 = tIn1 = tOut1;
+      }
+    }
+  }
+  const float ranges[2][2] = { { tOut0, tIn0 }, { tIn1, tOut1 } };
+  for (const auto& rng : ranges) {
+    float seg = rng[1] - rng[0];
+    if (seg <= 0.f) {
+      continue;
+    }
+    int nSteps = std::ceil(seg / lr.step);
+    float ds = seg / nSteps;
+    for (int is = 0; is < nSteps; is++) {
+      float t = rng[0] + (is + 0.5f) * ds, z = p0[2] + t * d[2];
+      if (std::abs(z) >= lr.zMax) {
+        continue;
+      }
+      float phi = std::atan2(p0[1] + t * d[1], p0[0] + t * d[0]);
+      if (phi < 0.f) {
+        phi += kTwoPi;
+      }
+      int bin = lr.getBin(phi, z);
+      rhoL += lr.rho[bin] * ds;
+      x2x0 += lr.x0Inv[bin] * ds;
+    }
+  }
+}
+
+//____________________________________________________________
+bool MatBudgetLUT::writeToFile(const std::string& fileName, const std::string& name) const
+{
+  TFile fl(fileName.c_str(), "recreate");
+  if (fl.IsZombie()) {
+    LOG(ERROR) << "Failed to open output file " << fileName << FairLogger::endl;
+    return false;
+  }
+  fl.WriteObjectAny(this, "o2::Base::MatBudgetLUT", name.c_str());
+  fl.Close();
+  return true;
+}
+
+//____________________________________________________________
+MatBudgetLUT* MatBudgetLUT::loadFromFile(const std::string& fileName, const std::string& name)
+{
+  TFile fl(fileName.c_str());
+  if (fl.IsZombie()) {
+    LOG(ERROR) << "Failed to open input file " << fileName << FairLogger::endl;
+    return nullptr;
+  }
+  auto lut = reinterpret_cast<MatBudgetLUT*>(fl.GetObjectChecked(name.c_str(), "o2::Base::MatBudgetLUT"));
+  if (!lut) {
+    LOG(ERROR) << "Failed to load " << name << " from " << fileName << FairLogger::endl;
+  }
+  return lut;
+}
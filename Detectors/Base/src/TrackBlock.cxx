@@ -0,0 +1,438 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include <cmath>
+#include "DetectorsBase/TrackBlock.h"
+
+using std::array;
+using o2::Base::Track::TrackParCov;
+using o2::Base::Track::TrackParCovBlock;
+using namespace o2::Base::Track;
+using namespace o2::Base::Constants;
+
+// the arrays of the block never overlap, let the compiler vectorize the kernels w/o alias checks
+#if defined(__clang__)
+#define TRACKBLOCK_IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define TRACKBLOCK_IVDEP _Pragma("GCC ivdep")
+#else
+#define TRACKBLOCK_IVDEP
+#endif
+
+//______________________________________________________________
+void TrackParCovBlock::Resize(int n)
+{
+  mX.resize(n);
+  mAlpha.resize(n);
+  for (auto &p : mP) p.resize(n);
+  for (auto &c : mC) c.resize(n);
+  mOK.resize(n,1);
+}
+
+//______________________________________________________________
+void TrackParCovBlock::Add(const TrackParCov &trc)
+{
+  int n = GetSize();
+  Resize(n+1);
+  Set(n,trc);
+}
+
+//______________________________________________________________
+void TrackParCovBlock::Set(int i, const TrackParCov &trc)
+{
+  mX[i]     = trc.GetX();
+  mAlpha[i] = trc.GetAlpha();
+  mP[kY][i]    = trc.GetY();
+  mP[kZ][i]    = trc.GetZ();
+  mP[kSnp][i]  = trc.GetSnp();
+  mP[kTgl][i]  = trc.GetTgl();
+  mP[kQ2Pt][i] = trc.GetQ2Pt();
+  const float cov[kCovMatSize] = {
+    trc.GetSigmaY2(),
+    trc.GetSigmaZY(),   trc.GetSigmaZ2(),
+    trc.GetSigmaSnpY(), trc.GetSigmaSnpZ(), trc.GetSigmaSnp2(),
+    trc.GetSigmaTglY(), trc.GetSigmaTglZ(), trc.GetSigmaTglSnp(), trc.GetSigmaTgl2(),
+    trc.GetSigma1PtY(), trc.GetSigma1PtZ(), trc.GetSigma1PtSnp(), trc.GetSigma1PtTgl(), trc.GetSigma1Pt2()
+  };
+  for (int ic=0;ic<kCovMatSize;ic++) mC[ic][i] = cov[ic];
+  mOK[i] = 1;
+}
+
+//______________________________________________________________
+void TrackParCovBlock::SetAllOK()
+{
+  std::fill(mOK.begin(),mOK.end(),1);
+}
+
+//______________________________________________________________
+int TrackParCovBlock::GetNOK() const
+{
+  int nok = 0;
+  for (auto ok : mOK) nok += ok;
+  return nok;
+}
+
+//______________________________________________________________
+int TrackParCovBlock::Rotate(float alpha)
+{
+  mTmp.assign(GetSize(),alpha);
+  return Rotate(mTmp.data());
+}
+
+//______________________________________________________________
+int TrackParCovBlock::Rotate(const float* __restrict__ alpha)
+{
+  // rotate each track to its alpha frame, see TrackParCov::Rotate
+  const int n = GetSize();
+  float* __restrict__ x  = mX.data();
+  float* __restrict__ al = mAlpha.data();
+  float* __restrict__ y  = mP[kY].data();
+  float* __restrict__ sn = mP[kSnp].data();
+  uint8_t* __restrict__ ok = mOK.data();
+  mActive.resize(n);
+  uint8_t* __restrict__ active = mActive.data();
+  float
+    * __restrict__ C00=mC[kSigY2].data(),    * __restrict__ C10=mC[kSigZY].data(),
+    * __restrict__ C20=mC[kSigSnpY].data(),  * __restrict__ C21=mC[kSigSnpZ].data(),  * __restrict__ C22=mC[kSigSnp2].data(),
+    * __restrict__ C30=mC[kSigTglY].data(),  * __restrict__ C32=mC[kSigTglSnp].data(),
+    * __restrict__ C40=mC[kSigQ2PtY].data(), * __restrict__ C42=mC[kSigQ2PtSnp].data();
+  // trigonometry first, the rest of the kernel is vectorizable
+  mSin.resize(n);
+  mCos.resize(n);
+  float* __restrict__ sina = mSin.data();
+  float* __restrict__ cosa = mCos.data();
+  for (int i=0;i<n;i++) {
+    float alp = alpha[i];
+    Utils::BringToPMPi(alp);
+    Utils::sincosf(alp-al[i],sina[i],cosa[i]);
+  }
+  int nok = 0;
+  TRACKBLOCK_IVDEP
+  for (int i=0;i<n;i++) {
+    float alp = alpha[i];
+    Utils::BringToPMPi(alp);
+    float ca=cosa[i],sa=sina[i];
+    float snp = sn[i], csp = sqrtf((1.f-snp)*(1.f+snp)); // Improve precision
+    float tmp = snp*ca - csp*sa;
+    int good = ok[i] & (fabs(snp) <= kAlmost1) & ((csp*ca+snp*sa) >= 0) & (fabs(tmp) <= kAlmost1);
+    float xold = x[i], yold = y[i];
+    al[i] = good ? alp : al[i];
+    x[i]  = good ?  xold*ca + yold*sa : xold;
+    y[i]  = good ? -xold*sa + yold*ca : yold;
+    sn[i] = good ? tmp : snp;
+
+    csp = fabs(csp)<kAlmost0 ? kAlmost0 : csp;
+    float rr = ca+snp/csp*sa;
+    float sca = good ? ca : 1.f, srr = good ? rr : 1.f;
+    C00[i] *= (sca*sca);
+    C10[i] *= sca;
+    C20[i] *= sca*srr;
+    C21[i] *= srr;
+    C22[i] *= srr*srr;
+    C30[i] *= sca;
+    C32[i] *= srr;
+    C40[i] *= sca;
+    C42[i] *= srr;
+    active[i] = good;
+    ok[i] = good;
+    nok += good;
+  }
+  CheckCovariance(active);
+  return nok;
+}
+
+//______________________________________________________________
+int TrackParCovBlock::PropagateTo(float xk, float b)
+{
+  mTmp.assign(GetSize(),xk);
+  return PropagateTo(mTmp.data(),b);
+}
+
+//______________________________________________________________
+int TrackParCovBlock::PropagateTo(const float* __restrict__ xk, float b)
+{
+  //----------------------------------------------------------------
+  // Propagate each track to the plane X=xk[i] (cm) in the field "b" (kG),
+  // see TrackParCov::PropagateTo
+  //----------------------------------------------------------------
+  const int n = GetSize();
+  float* __restrict__ x   = mX.data();
+  float* __restrict__ y   = mP[kY].data();
+  float* __restrict__ z   = mP[kZ].data();
+  float* __restrict__ sn  = mP[kSnp].data();
+  const float* __restrict__ tg  = mP[kTgl].data();
+  const float* __restrict__ q2p = mP[kQ2Pt].data();
+  uint8_t* __restrict__ ok = mOK.data();
+  mActive.resize(n);
+  uint8_t* __restrict__ active = mActive.data();
+  mSnp0.resize(n);
+  float* __restrict__ snp0 = mSnp0.data();
+  float
+    * __restrict__ C00=mC[kSigY2].data(),
+    * __restrict__ C10=mC[kSigZY].data(),    * __restrict__ C11=mC[kSigZ2].data(),
+    * __restrict__ C20=mC[kSigSnpY].data(),  * __restrict__ C21=mC[kSigSnpZ].data(),  * __restrict__ C22=mC[kSigSnp2].data(),
+    * __restrict__ C30=mC[kSigTglY].data(),  * __restrict__ C31=mC[kSigTglZ].data(),  * __restrict__ C32=mC[kSigTglSnp].data(),
+    * __restrict__ C33=mC[kSigTgl2].data(),
+    * __restrict__ C40=mC[kSigQ2PtY].data(), * __restrict__ C41=mC[kSigQ2PtZ].data(), * __restrict__ C42=mC[kSigQ2PtSnp].data(),
+    * __restrict__ C43=mC[kSigQ2PtTgl].data(), * __restrict__ C44=mC[kSigQ2Pt2].data();
+  const bool noField = fabs(b)<kAlmost0;
+  int nok = 0;
+  int nArc = 0;
+  TRACKBLOCK_IVDEP
+  for (int i=0;i<n;i++) {
+    float dx = xk[i]-x[i];
+    float crv = noField ? 0.f : q2p[i]*b*kB2C;
+    float x2r = crv*dx;
+    float f1 = sn[i], f2 = f1 + x2r;
+    float r1 = sqrtf((1.f-f1)*(1.f+f1)), r2 = sqrtf((1.f-f2)*(1.f+f2));
+    int good = ok[i] & ((fabs(dx)<kAlmost0) |
+                         ((fabs(f1) <= kAlmost1) & (fabs(f2) <= kAlmost1) & (fabs(q2p[i]) >= kAlmost0) &
+                          (fabs(r1) >= kAlmost0) & (fabs(r2) >= kAlmost0)));
+    int act = good & (fabs(dx)>=kAlmost0);
+    double dy2dx = (f1+f2)/(r1+r2);
+    float ynew = y[i] + dx*dy2dx;
+    float znew = z[i] + dx*(r2 + f2*dy2dx)*tg[i];
+    int arc = act & !(fabs(x2r)<0.05f);
+    nArc += arc;
+
+    // evaluate matrix in double prec.
+    double rinv  = 1./r1;
+    double r3inv = rinv*rinv*rinv;
+    double f24   = act ? dx*b*kB2C : 0.; // x2r/mC[kQ2Pt];
+    double f02   = act ? dx*r3inv : 0.;
+    double f04   = 0.5*f24*f02;
+    double f12   = f02*tg[i]*f1;
+    double f14   = 0.5*f24*f12;
+    double f13   = act ? dx*rinv : 0.;
+
+    float
+      &c00=C00[i],
+      &c10=C10[i], &c11=C11[i],
+      &c20=C20[i], &c21=C21[i], &c22=C22[i],
+      &c30=C30[i], &c31=C31[i], &c32=C32[i], &c33=C33[i],
+      &c40=C40[i], &c41=C41[i], &c42=C42[i], &c43=C43[i], &c44=C44[i];
+
+    //b = C*ft
+    double b00=f02*c20 + f04*c40, b01=f12*c20 + f14*c40 + f13*c30;
+    double b02=f24*c40;
+    double b10=f02*c21 + f04*c41, b11=f12*c21 + f14*c41 + f13*c31;
+    double b12=f24*c41;
+    double b20=f02*c22 + f04*c42, b21=f12*c22 + f14*c42 + f13*c32;
+    double b22=f24*c42;
+    double b40=f02*c42 + f04*c44, b41=f12*c42 + f14*c44 + f13*c43;
+    double b42=f24*c44;
+    double b30=f02*c32 + f04*c43, b31=f12*c32 + f14*c43 + f13*c33;
+    double b32=f24*c43;
+
+    //a = f*b = f*C*ft
+    double a00=f02*b20+f04*b40,a01=f02*b21+f04*b41,a02=f02*b22+f04*b42;
+    double a11=f12*b21+f14*b41+f13*b31,a12=f12*b22+f14*b42+f13*b32;
+    double a22=f24*b42;
+
+    //F*C*Ft = C + (b + bt + a), the inactive tracks get zero increments
+    c00 += b00 + b00 + a00;
+    c10 += b10 + b01 + a01;
+    c20 += b20 + b02 + a02;
+    c30 += b30;
+    c40 += b40;
+    c11 += b11 + b11 + a11;
+    c21 += b21 + b12 + a12;
+    c31 += b31;
+    c41 += b41;
+    c22 += b22 + b22 + a22;
+    c32 += b32;
+    c42 += b42;
+
+    // Z of the tracks with large dx/R is fixed below
+    x[i]  = act ? xk[i] : x[i];
+    y[i]  = act ? ynew : y[i];
+    z[i]  = act && !arc ? znew : z[i];
+    sn[i] = act ? f2 : f1;
+    snp0[i] = f1;
+    active[i] = act ? (arc ? 2 : 1) : 0;
+    ok[i] = good;
+    nok += good;
+  }
+  if (nArc) {
+    // for small dx/R the linear apporximation of the arc by the segment is OK,
+    // but at large dx/R the error is very large and leads to incorrect Z propagation
+    for (int i=0;i<n;i++) {
+      if (active[i] != 2) continue;
+      float f1 = snp0[i], f2 = sn[i], crv = q2p[i]*b*kB2C;
+      float r1 = sqrtf((1.f-f1)*(1.f+f1)), r2 = sqrtf((1.f-f2)*(1.f+f2));
+      float rot = asinf(r1*f2 - r2*f1); // more economic version from Yura.
+      if (f1*f1+f2*f2>1.f && f1*f2<0.f) {          // special cases of large rotations or large abs angles
+        if (f2>0.f) rot = kPI - rot;    //
+        else       rot = -kPI - rot;
+      }
+      z[i] += tg[i]/crv*rot;
+    }
+  }
+  CheckCovariance(active);
+  return nok;
+}
+
+//______________________________________________
+void TrackParCovBlock::GetPredictedChi2(const array<const float*,2> &p, const array<const float*,3> &cov, float* chi2) const
+{
+  // Estimate the chi2 of the space points "p" with the cov. matrices "cov", see TrackParCov::GetPredictedChi2
+  const int n = GetSize();
+  const float* __restrict__ y = mP[kY].data();
+  const float* __restrict__ z = mP[kZ].data();
+  const float* __restrict__ sy2 = mC[kSigY2].data();
+  const float* __restrict__ szy = mC[kSigZY].data();
+  const float* __restrict__ sz2 = mC[kSigZ2].data();
+  const float* __restrict__ py = p[0];
+  const float* __restrict__ pz = p[1];
+  const float* __restrict__ cyy = cov[0];
+  const float* __restrict__ czy = cov[1];
+  const float* __restrict__ czz = cov[2];
+  float* __restrict__ res = chi2;
+  for (int i=0;i<n;i++) {
+    float sdd = sy2[i] + cyy[i];
+    float sdz = szy[i] + czy[i];
+    float szz = sz2[i] + czz[i];
+    float det = sdd*szz - sdz*sdz;
+    float d = y[i] - py[i];
+    float dz = z[i] - pz[i];
+    res[i] = fabs(det) < kAlmost0 ? kVeryBig : (d*(szz*d - sdz*dz) + dz*(sdd*dz - d*sdz))/det;
+  }
+}
+
+//______________________________________________
+int TrackParCovBlock::Update(const array<const float*,2> &p, const array<const float*,3> &cov)
+{
+  // Update the tracks with the space points "p" having the covariance matrices "cov",
+  // see TrackParCov::Update
+  const int n = GetSize();
+  float* __restrict__ y   = mP[kY].data();
+  float* __restrict__ z   = mP[kZ].data();
+  float* __restrict__ sn  = mP[kSnp].data();
+  float* __restrict__ tg  = mP[kTgl].data();
+  float* __restrict__ q2p = mP[kQ2Pt].data();
+  float
+    * __restrict__ C00=mC[kSigY2].data(),
+    * __restrict__ C10=mC[kSigZY].data(),    * __restrict__ C11=mC[kSigZ2].data(),
+    * __restrict__ C20=mC[kSigSnpY].data(),  * __restrict__ C21=mC[kSigSnpZ].data(),  * __restrict__ C22=mC[kSigSnp2].data(),
+    * __restrict__ C30=mC[kSigTglY].data(),  * __restrict__ C31=mC[kSigTglZ].data(),  * __restrict__ C32=mC[kSigTglSnp].data(),
+    * __restrict__ C33=mC[kSigTgl2].data(),
+    * __restrict__ C40=mC[kSigQ2PtY].data(), * __restrict__ C41=mC[kSigQ2PtZ].data(), * __restrict__ C42=mC[kSigQ2PtSnp].data(),
+    * __restrict__ C43=mC[kSigQ2PtTgl].data(), * __restrict__ C44=mC[kSigQ2Pt2].data();
+  uint8_t* __restrict__ ok = mOK.data();
+  mActive.resize(n);
+  uint8_t* __restrict__ active = mActive.data();
+  const float* __restrict__ py = p[0];
+  const float* __restrict__ pz = p[1];
+  const float* __restrict__ cyy = cov[0];
+  const float* __restrict__ czy = cov[1];
+  const float* __restrict__ czz = cov[2];
+  int nok = 0;
+  TRACKBLOCK_IVDEP
+  for (int i=0;i<n;i++) {
+    float
+      &cm00=C00[i],
+      &cm10=C10[i], &cm11=C11[i],
+      &cm20=C20[i], &cm21=C21[i], &cm22=C22[i],
+      &cm30=C30[i], &cm31=C31[i], &cm32=C32[i], &cm33=C33[i],
+      &cm40=C40[i], &cm41=C41[i], &cm42=C42[i], &cm43=C43[i], &cm44=C44[i];
+
+    double r00=cyy[i]+cm00, r01=czy[i]+cm10, r11=czz[i]+cm11;
+    double det=r00*r11 - r01*r01;
+    int good = ok[i] & (fabs(det) >= kAlmost0);
+    double detI = good ? 1./det : 0.;
+    double tmp=r00;
+    r00 = r11*detI;
+    r11 = tmp*detI;
+    r01 = -r01*detI;
+
+    double k00 = cm00*r00+cm10*r01, k01 = cm00*r01+cm10*r11;
+    double k10 = cm10*r00+cm11*r01, k11 = cm10*r01+cm11*r11;
+    double k20 = cm20*r00+cm21*r01, k21 = cm20*r01+cm21*r11;
+    double k30 = cm30*r00+cm31*r01, k31 = cm30*r01+cm31*r11;
+    double k40 = cm40*r00+cm41*r01, k41 = cm40*r01+cm41*r11;
+
+    double dy = py[i] - y[i], dz = pz[i] - z[i];
+    double sf = sn[i] + k20*dy + k21*dz;
+    good = good & (fabs(sf) <= kAlmost1);
+    // the rejected tracks get zero gain, i.e. no change
+    k00 = good ? k00 : 0.; k01 = good ? k01 : 0.;
+    k10 = good ? k10 : 0.; k11 = good ? k11 : 0.;
+    k20 = good ? k20 : 0.; k21 = good ? k21 : 0.;
+    k30 = good ? k30 : 0.; k31 = good ? k31 : 0.;
+    k40 = good ? k40 : 0.; k41 = good ? k41 : 0.;
+
+    y[i]   += k00*dy + k01*dz;
+    z[i]   += k10*dy + k11*dz;
+    sn[i]   = good ? float(sf) : sn[i];
+    tg[i]  += k30*dy + k31*dz;
+    q2p[i] += k40*dy + k41*dz;
+
+    double c01=cm10, c02=cm20, c03=cm30, c04=cm40;
+    double c12=cm21, c13=cm31, c14=cm41;
+
+    cm00-=k00*cm00+k01*cm10; cm10-=k00*c01+k01*cm11;
+    cm20-=k00*c02+k01*c12;   cm30-=k00*c03+k01*c13;
+    cm40-=k00*c04+k01*c14;
+
+    cm11-=k10*c01+k11*cm11;
+    cm21-=k10*c02+k11*c12;   cm31-=k10*c03+k11*c13;
+    cm41-=k10*c04+k11*c14;
+
+    cm22-=k20*c02+k21*c12;   cm32-=k20*c03+k21*c13;
+    cm42-=k20*c04+k21*c14;
+
+    cm33-=k30*c03+k31*c13;
+    cm43-=k30*c04+k31*c14;
+
+    cm44-=k40*c04+k41*c14;
+
+    active[i] = good;
+    ok[i] = good;
+    nok += good;
+  }
+  CheckCovariance(active);
+  return nok;
+}
+
+//______________________________________________
+void TrackParCovBlock::CheckCovariance(const uint8_t* __restrict__ active)
+{
+  // Force the diagonal elements of the covariance matrices of the active tracks to be positive,
+  // see TrackParCov::CheckCovariance
+  constexpr int kDiag[kNParams] = {kSigY2,kSigZ2,kSigSnp2,kSigTgl2,kSigQ2Pt2};
+  constexpr float kDiagMax[kNParams] = {kCY2max,kCZ2max,kCSnp2max,kCTgl2max,kC1Pt2max};
+  constexpr int kOffDiag[kNParams][kNParams-1] = {
+    {kSigZY,   kSigSnpY,   kSigTglY,   kSigQ2PtY},
+    {kSigZY,   kSigSnpZ,   kSigTglZ,   kSigQ2PtZ},
+    {kSigSnpY, kSigSnpZ,   kSigTglSnp, kSigQ2PtSnp},
+    {kSigTglY, kSigTglZ,   kSigTglSnp, kSigQ2PtTgl},
+    {kSigQ2PtY,kSigQ2PtZ,  kSigQ2PtSnp,kSigQ2PtTgl}
+  };
+  const int n = GetSize();
+  for (int id=0;id<kNParams;id++) {
+    float* __restrict__ diag = mC[kDiag[id]].data();
+    float* __restrict__ off0 = mC[kOffDiag[id][0]].data();
+    float* __restrict__ off1 = mC[kOffDiag[id][1]].data();
+    float* __restrict__ off2 = mC[kOffDiag[id][2]].data();
+    float* __restrict__ off3 = mC[kOffDiag[id][3]].data();
+    const float cmax = kDiagMax[id];
+    for (int i=0;i<n;i++) {
+      float v = active[i] ? fabs(diag[i]) : diag[i];
+      int over = active[i] & (v > cmax);
+      float scl = sqrtf(cmax/v);
+      scl = over ? scl : 1.f;
+      diag[i] = over ? cmax : v;
+      off0[i] *= scl;
+      off1[i] *= scl;
+      off2[i] *= scl;
+      off3[i] *= scl;
+    }
+  }
+}
@@ -0,0 +1,145 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test DetMatrixCache
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include <TGeoMatrix.h>
+#include "DetectorsBase/DetID.h"
+#include "DetectorsBase/DetMatrixCache.h"
+#include "DetectorsBase/Utils.h"
+
+using namespace o2::Base;
+
+namespace
+{
+unsigned int seed = 12345;
+double rnd()
+{
+  seed = seed * 1664525u + 1013904223u;
+  return double(seed >> 8) / double(1 << 24);
+}
+
+// cache filled with rotated and translated matrices
+class TestMatrixCache : public DetMatrixCache
+{
+ public:
+  static constexpr int kNSensors = 100;
+  std::vector<int> mTable;
+
+  TestMatrixCache() : DetMatrixCache(DetID::ITS) {}
+
+  void fillMatrixCache(int mask) override
+  {
+    setSize(kNSensors);
+    for (auto* cache : { &getCacheL2G(), &getCacheT2L(), &getCacheT2G() }) {
+      cache->setSize(kNSensors);
+      for (int i = 0; i < kNSensors; i++) {
+        TGeoHMatrix m;
+        m.RotateZ(360. * rnd());
+        m.RotateX(20. * rnd());
+        double tra[3] = { 100. * rnd() - 50., 100. * rnd() - 50., 100. * rnd() - 50. };
+        m.SetTranslation(tra);
+        cache->setMatrix(Mat3D(m), i);
+      }
+    }
+    fillMatrixCacheSoA(mask);
+  }
+
+  void writeSnapshotTables(std::ostream& out) const override { writeSnapshotVector(out, mTable); }
+  bool readSnapshotTables(std::istream& in) override { return readSnapshotVector(in, mTable); }
+};
+}
+
+BOOST_AUTO_TEST_CASE(DetMatrixCache_batched)
+{
+  TestMatrixCache cache;
+  cache.fillMatrixCache(Utils::bit2Mask(TransformType::L2G, TransformType::T2L, TransformType::T2G));
+  BOOST_CHECK(cache.getCacheL2GSoA().isFilled());
+
+  const int n = 1000;
+  std::vector<int> sensor(n);
+  std::vector<Point3D<float>> in(n), out(n);
+  for (int i = 0; i < n; i++) {
+    sensor[i] = int(rnd() * TestMatrixCache::kNSensors) % TestMatrixCache::kNSensors;
+    in[i].SetCoordinates(20. * rnd() - 10., 20. * rnd() - 10., 20. * rnd() - 10.);
+  }
+
+  auto check = [&](const Point3D<float>& p, const Point3D<float>& q) {
+    BOOST_CHECK_SMALL(p.X() - q.X(), 1e-4f);
+    BOOST_CHECK_SMALL(p.Y() - q.Y(), 1e-4f);
+    BOOST_CHECK_SMALL(p.Z() - q.Z(), 1e-4f);
+  };
+
+  cache.toGlobal(sensor.data(), in.data(), out.data(), n);
+  for (int i = 0; i < n; i++) {
+    check(out[i], cache.getMatrixL2G(sensor[i])(in[i]));
+  }
+  cache.toLocal(sensor.data(), in.data(), out.data(), n);
+  for (int i = 0; i < n; i++) {
+    check(out[i], cache.getMatrixL2G(sensor[i]) ^ (in[i]));
+  }
+  cache.toTracking(sensor.data(), in.data(), out.data(), n);
+  for (int i = 0; i < n; i++) {
+    check(out[i], cache.getMatrixT2L(sensor[i]) ^ (in[i]));
+  }
+  cache.toGlobalFromTracking(sensor.data(), in.data(), out.data(), n);
+  for (int i = 0; i < n; i++) {
+    check(out[i], cache.getMatrixT2G(sensor[i])(in[i]));
+  }
+
+  // in place
+  std::vector<Point3D<float>> inPlace(in);
+  cache.toGlobal(sensor.data(), inPlace.data(), inPlace.data(), n);
+  cache.toLocal(sensor.data(), inPlace.data(), inPlace.data(), n);
+  for (int i = 0; i < n; i++) {
+    check(inPlace[i], in[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DetMatrixCache_snapshot)
+{
+  TestMatrixCache cache;
+  cache.fillMatrixCache(Utils::bit2Mask(TransformType::L2G, TransformType::T2L, TransformType::T2G));
+  cache.mTable = { 1, 2, 3 };
+  const std::string fileName = "testDetMatrixCacheSnapshot.bin";
+  const ULong64_t hash = 0x1234567890abcdefull;
+  BOOST_CHECK(cache.writeSnapshot(fileName, hash));
+
+  TestMatrixCache wrongHash;
+  BOOST_CHECK(!wrongHash.readSnapshot(fileName, hash + 1));
+  BOOST_CHECK(!wrongHash.isBuilt());
+
+  TestMatrixCache loaded;
+  BOOST_CHECK(loaded.readSnapshot(fileName, hash));
+  BOOST_CHECK(loaded.getSize() == cache.getSize());
+  BOOST_CHECK(loaded.mTable == cache.mTable);
+  BOOST_CHECK(loaded.getCacheL2GSoA().isFilled());
+  BOOST_CHECK(!loaded.getCacheT2GRot().isFilled());
+
+  for (int i = 0; i < TestMatrixCache::kNSensors; i++) {
+    double c0[12], c1[12];
+    cache.getMatrixL2G(i).GetComponents(c0, c0 + 12);
+    loaded.getMatrixL2G(i).GetComponents(c1, c1 + 12);
+    for (int j = 0; j < 12; j++) {
+      BOOST_CHECK_EQUAL(c0[j], c1[j]);
+    }
+    cache.getMatrixT2G(i).GetComponents(c0, c0 + 12);
+    loaded.getMatrixT2G(i).GetComponents(c1, c1 + 12);
+    for (int j = 0; j < 12; j++) {
+      BOOST_CHECK_EQUAL(c0[j], c1[j]);
+    }
+  }
+  std::remove(fileName.c_str());
+}
@@ -0,0 +1,134 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test TrackBlock
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+#include "DetectorsBase/TrackBlock.h"
+
+using namespace o2::Base::Track;
+
+namespace
+{
+// deterministic pseudo-random tracks covering the failure cases as well
+std::vector<TrackParCov> makeTracks(int n)
+{
+  std::vector<TrackParCov> tracks;
+  unsigned int seed = 12345;
+  auto rnd = [&seed]() {
+    seed = seed * 1664525u + 1013904223u;
+    return float(seed >> 8) / float(1 << 24);
+  };
+  for (int i = 0; i < n; i++) {
+    float x = 2.f + 40.f * rnd();
+    float alpha = -3.f + 6.f * rnd();
+    std::array<float, kNParams> par{ -5.f + 10.f * rnd(), -20.f + 40.f * rnd(), -0.99f + 1.98f * rnd(),
+                                     -1.f + 2.f * rnd(), (rnd() > 0.5f ? 1.f : -1.f) * (0.1f + 20.f * rnd()) };
+    std::array<float, kCovMatSize> cov{ 1e-2f,
+                                        1e-4f, 1e-2f,
+                                        1e-5f, 1e-6f, 1e-4f,
+                                        1e-6f, 1e-5f, 1e-7f, 1e-4f,
+                                        1e-4f, 1e-5f, 1e-6f, 1e-7f, 1e-2f };
+    tracks.emplace_back(x, alpha, par, cov);
+  }
+  return tracks;
+}
+
+// FMA contraction may differ between the scalar and vectorized code, allow for the rounding
+// differences amplified by the cancellations
+void checkClose(float v0, float v1)
+{
+  BOOST_CHECK_SMALL(v0 - v1, 1e-3f * std::abs(v0) + 1e-6f);
+}
+
+void compare(const TrackParCov& trc, const TrackParCovBlock& block, int i)
+{
+  TrackParCov blk = block.GetTrack(i);
+  checkClose(trc.GetX(), blk.GetX());
+  checkClose(trc.GetAlpha(), blk.GetAlpha());
+  checkClose(trc.GetY(), blk.GetY());
+  checkClose(trc.GetZ(), blk.GetZ());
+  checkClose(trc.GetSnp(), blk.GetSnp());
+  checkClose(trc.GetTgl(), blk.GetTgl());
+  checkClose(trc.GetQ2Pt(), blk.GetQ2Pt());
+  checkClose(trc.GetSigmaY2(), blk.GetSigmaY2());
+  checkClose(trc.GetSigmaZY(), blk.GetSigmaZY());
+  checkClose(trc.GetSigmaSnp2(), blk.GetSigmaSnp2());
+  checkClose(trc.GetSigmaTglSnp(), blk.GetSigmaTglSnp());
+  checkClose(trc.GetSigma1PtSnp(), blk.GetSigma1PtSnp());
+  checkClose(trc.GetSigma1Pt2(), blk.GetSigma1Pt2());
+}
+}
+
+BOOST_AUTO_TEST_CASE(TrackBlock_test)
+{
+  // batched kernels must reproduce the TrackParCov methods, including the failures
+  const int nTracks = 1000;
+  const float bz = 5.f;
+  auto tracks = makeTracks(nTracks);
+  TrackParCovBlock block;
+  for (const auto& trc : tracks) {
+    block.Add(trc);
+  }
+  BOOST_CHECK_EQUAL(block.GetSize(), nTracks);
+
+  std::vector<float> alpha(nTracks), xk(nTracks);
+  std::vector<float> y(nTracks), z(nTracks), sy2(nTracks, 1e-3f), syz(nTracks, 0.f), sz2(nTracks, 2e-3f);
+  std::vector<float> chi2(nTracks);
+  std::vector<bool> ok(nTracks, true);
+  for (int i = 0; i < nTracks; i++) {
+    alpha[i] = tracks[i].GetAlpha() + 0.3f * std::sin(float(i));
+    xk[i] = tracks[i].GetX() + 5.f * std::cos(float(i));
+  }
+
+  int nok = block.Rotate(alpha.data());
+  int nokScalar = 0;
+  for (int i = 0; i < nTracks; i++) {
+    ok[i] = tracks[i].Rotate(alpha[i]);
+    nokScalar += ok[i];
+    BOOST_CHECK_EQUAL(ok[i], block.IsOK(i));
+  }
+  BOOST_CHECK_EQUAL(nok, nokScalar);
+
+  nok = block.PropagateTo(xk.data(), bz);
+  nokScalar = 0;
+  for (int i = 0; i < nTracks; i++) {
+    if (ok[i]) {
+      ok[i] = tracks[i].PropagateTo(xk[i], bz);
+    }
+    nokScalar += ok[i];
+    BOOST_CHECK_EQUAL(ok[i], block.IsOK(i));
+    y[i] = tracks[i].GetY() + 0.1f * std::sin(float(3 * i));
+    z[i] = tracks[i].GetZ() + 0.1f * std::cos(float(3 * i));
+  }
+  BOOST_CHECK_EQUAL(nok, nokScalar);
+
+  block.GetPredictedChi2({ y.data(), z.data() }, { sy2.data(), syz.data(), sz2.data() }, chi2.data());
+  nok = block.Update({ y.data(), z.data() }, { sy2.data(), syz.data(), sz2.data() });
+  nokScalar = 0;
+  for (int i = 0; i < nTracks; i++) {
+    if (ok[i]) {
+      std::array<float, 2> p{ y[i], z[i] };
+      std::array<float, 3> cov{ sy2[i], syz[i], sz2[i] };
+      checkClose(tracks[i].GetPredictedChi2(p, cov), chi2[i]);
+      ok[i] = tracks[i].Update(p, cov);
+    }
+    nokScalar += ok[i];
+    BOOST_CHECK_EQUAL(ok[i], block.IsOK(i));
+    compare(tracks[i], block, i);
+  }
+  BOOST_CHECK_EQUAL(nok, nokScalar);
+  BOOST_CHECK(nok > 0 && nok < nTracks);
+}
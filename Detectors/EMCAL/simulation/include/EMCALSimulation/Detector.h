@@ -149,6 +149,17 @@ class Detector : public o2::Base::Detector
   ///
   void CreateAlFrontPlate(const std::string_view mother = "EMOD", const std::string_view child = "ALFP");
 
+  ///
+  /// Build the lookup tables from the volume ids and copy numbers to the absolute cell ids,
+  /// to be called once the geometry is constructed
+  ///
+  void BuildCellLookupTables();
+
+  ///
+  /// Absolute cell id of the current step from the copy numbers of the volumes in the current path
+  ///
+  Int_t GetCurrentCellID();
+
   ///
   /// Calculate the amount of light seen by the APD for a given track segment (charged particles only)
   /// Calculation done according to Bricks law
@@ -171,6 +182,14 @@ class Detector : public o2::Base::Detector
   Int_t mCurrentTrackID;      //!<! ID of the current track
   Int_t mCurrentCellID;       //!<! ID of the current cell
   Hit* mCurrentHit;           //!<! current summed energy
+  Bool_t mCurrentCellValid;   //!<! track did not leave the current cell since its last step
+
+  // Lookup tables for the cell id
+  std::vector<Int_t> mSMOffsetByVolID; //!<! supermodule index offset of each supermodule type, by volume id
+  std::vector<Int_t> mCellIDTable;     //!<! absolute cell id by supermodule, module, tower in phi and eta
+  Int_t mNModulesInSM;                 //!<! number of modules in the tables per supermodule
+  Int_t mNPhiInModule;                 //!<! number of towers in phi in a module
+  Int_t mNEtaInModule;                 //!<! number of towers in eta in a module
 
   Double_t mSampleWidth; //!<! sample width = double(g->GetECPbRadThick()+g->GetECScintThick());
   Double_t mSmodPar0;    //!<! x size of super module
@@ -44,6 +44,12 @@ Detector::Detector(Bool_t active)
     mCurrentTrackID(-1),
     mCurrentCellID(-1),
     mCurrentHit(nullptr),
+    mCurrentCellValid(kFALSE),
+    mSMOffsetByVolID(),
+    mCellIDTable(),
+    mNModulesInSM(0),
+    mNPhiInModule(0),
+    mNEtaInModule(0),
     mSampleWidth(0.),
     mSmodPar0(0.),
     mSmodPar1(0.),
@@ -66,7 +72,11 @@ Detector::Detector(Bool_t active)
     mSampleWidth += 2. * geo->GetTrd1BondPaperThick();
 }
 
-void Detector::Initialize() { o2::Base::Detector::Initialize(); }
+void Detector::Initialize()
+{
+  o2::Base::Detector::Initialize();
+  BuildCellLookupTables();
+}
 
 void Detector::EndOfEvent() { Reset(); }
 
@@ -105,46 +115,31 @@ Bool_t Detector::ProcessHits(FairVolume* v)
 {
   // TODO Implement handling of parents and primary particle
   auto* mcapp = TVirtualMC::GetMC();
+  // Consecutive steps of a track stay in the same cell as long as the track does not enter a new volume;
+  // this has to be checked also for the steps without energy deposit
+  if (mcapp->IsTrackEntering() || mcapp->IsNewTrack())
+    mCurrentCellValid = kFALSE;
   Double_t eloss = mcapp->Edep();
   if (eloss < DBL_EPSILON)
     return false; // only process hits which actually deposit some energy in the EMCAL
   Geometry* geom = GetGeometry();
-  // Obtain detector ID
-  // This is not equal to the volume ID of the fair volume
-  // EMCAL geometry implementation in VMC works with a copy of the volume and placing it n-times into the mother volume
-  // via translation / rotation, so the copy index is the index of a tower / module / supermodule node within a mother
-  // volume Additional care needs to be taken for the supermodule index: The copy is connected to a certain supermodule
-  // type, which differs for various parts of the detector
-  Int_t copyEta, copyPhi, copyMod, copySmod;
-  mcapp->CurrentVolID(copyEta);       // Tower in module - x-direction
-  mcapp->CurrentVolOffID(1, copyPhi); // Tower in module - y-direction
-  mcapp->CurrentVolOffID(3, copyMod); // Module in supermodule
-  mcapp->CurrentVolOffID(
-    4, copySmod); // Supermodule in EMCAL - attention, with respect to a given supermodule type (offsets needed)
-  std::string smtype(mcapp->CurrentVolOffName(4));
-  int offset(0);
-  if (smtype == "SM3rd") {
-    offset = 10;
-  } else if (smtype == "DCSM") {
-    offset = 12;
-  } else if (smtype == "DCEXT") {
-    offset = 18;
-  }
-  LOG(DEBUG3) << "Supermodule copy " << copySmod << ", module copy " << copyMod << ", y-dir " << copyPhi << ", x-dir "
-              << copyEta << ", supermodule ID " << copySmod + offset - 1 << std::endl;
-  LOG(DEBUG3) << "path " << mcapp->CurrentVolPath() << std::endl;
-  LOG(DEBUG3) << "Name of the supermodule type " << mcapp->CurrentVolOffName(4) << ", Module name "
-              << mcapp->CurrentVolOffName(3) << std::endl;
 
-  Int_t partID = mcapp->GetStack()->GetCurrentTrackNumber(),
-        parent = mcapp->GetStack()->GetCurrentTrack()->GetMother(0),
-        detID = geom->GetAbsCellId(offset + copySmod - 1, copyMod - 1, copyPhi - 1, copyEta - 1);
+  Int_t partID = mcapp->GetStack()->GetCurrentTrackNumber();
 
   Double_t lightyield(eloss);
   if (mcapp->TrackCharge())
     lightyield = CalculateLightYield(eloss, mcapp->TrackStep(), mcapp->TrackCharge());
   lightyield /= geom->GetSampling();
 
+  if (mCurrentCellValid && partID == mCurrentTrackID && mCurrentHit) {
+    // Same track inside the same cell: no geometry query needed
+    mCurrentHit->SetEnergyLoss(mCurrentHit->GetEnergyLoss() + lightyield);
+    return true;
+  }
+
+  Int_t detID = GetCurrentCellID();
+  mCurrentCellValid = kTRUE;
+
   if (partID != mCurrentTrackID || detID != mCurrentCellID || !mCurrentHit) {
     // Condition for new hit:
     // - Processing different track
@@ -155,6 +150,7 @@ Bool_t Detector::ProcessHits(FairVolume* v)
     mcapp->TrackPosition(posX, posY, posZ);
     mcapp->TrackMomentum(momX, momY, momZ, energy);
     Double_t estart = mcapp->Etot(), time = mcapp->TrackTime() * 1e9; // time in ns
+    Int_t parent = mcapp->GetStack()->GetCurrentTrack()->GetMother(0);
 
     /// check handling of primary particles
     mCurrentHit =
@@ -172,6 +168,75 @@ Bool_t Detector::ProcessHits(FairVolume* v)
   return true;
 }
 
+Int_t Detector::GetCurrentCellID()
+{
+  // Obtain detector ID
+  // This is not equal to the volume ID of the fair volume
+  // EMCAL geometry implementation in VMC works with a copy of the volume and placing it n-times into the mother volume
+  // via translation / rotation, so the copy index is the index of a tower / module / supermodule node within a mother
+  // volume Additional care needs to be taken for the supermodule index: The copy is connected to a certain supermodule
+  // type, which differs for various parts of the detector
+  auto* mcapp = TVirtualMC::GetMC();
+  Int_t copyEta, copyPhi, copyMod, copySmod;
+  mcapp->CurrentVolID(copyEta);                        // Tower in module - x-direction
+  mcapp->CurrentVolOffID(1, copyPhi);                  // Tower in module - y-direction
+  mcapp->CurrentVolOffID(3, copyMod);                  // Module in supermodule
+  Int_t smVolID = mcapp->CurrentVolOffID(4, copySmod); // Supermodule in EMCAL - attention, with respect to a given
+                                                       // supermodule type (offsets needed)
+  Int_t offset = (smVolID >= 0 && smVolID < Int_t(mSMOffsetByVolID.size())) ? mSMOffsetByVolID[smVolID] : 0;
+  LOG(DEBUG3) << "Supermodule copy " << copySmod << ", module copy " << copyMod << ", y-dir " << copyPhi << ", x-dir "
+              << copyEta << ", supermodule ID " << copySmod + offset - 1 << std::endl;
+  LOG(DEBUG3) << "path " << mcapp->CurrentVolPath() << std::endl;
+  LOG(DEBUG3) << "Name of the supermodule type " << mcapp->CurrentVolOffName(4) << ", Module name "
+              << mcapp->CurrentVolOffName(3) << std::endl;
+
+  Int_t iSM = offset + copySmod - 1, iMod = copyMod - 1, iPhi = copyPhi - 1, iEta = copyEta - 1;
+  if (iSM >= 0 && iMod >= 0 && iPhi >= 0 && iEta >= 0 && iMod < mNModulesInSM && iPhi < mNPhiInModule &&
+      iEta < mNEtaInModule) {
+    size_t index = ((size_t(iSM) * mNModulesInSM + iMod) * mNPhiInModule + iPhi) * mNEtaInModule + iEta;
+    if (index < mCellIDTable.size())
+      return mCellIDTable[index];
+  }
+  return GetGeometry()->GetAbsCellId(iSM, iMod, iPhi, iEta);
+}
+
+void Detector::BuildCellLookupTables()
+{
+  // Supermodule index offsets of the supermodule types, with respect to the copy number
+  mSMOffsetByVolID.clear();
+  const std::pair<const char*, Int_t> smoffsets[] = { { "SM3rd", 10 }, { "DCSM", 12 }, { "DCEXT", 18 } };
+  for (auto& smoffset : smoffsets) {
+    if (!gGeoManager || !gGeoManager->GetVolume(smoffset.first))
+      continue;
+    Int_t volID = TVirtualMC::GetMC()->VolId(smoffset.first);
+    if (volID < 0)
+      continue;
+    if (volID >= Int_t(mSMOffsetByVolID.size()))
+      mSMOffsetByVolID.resize(volID + 1, 0);
+    mSMOffsetByVolID[volID] = smoffset.second;
+  }
+
+  // Absolute cell ids, negative for the combinations not present in the geometry
+  Geometry* geom = GetGeometry();
+  Int_t nSM = geom->GetNumberOfSuperModules();
+  mNModulesInSM = geom->GetNPhi() * geom->GetNZ();
+  mNPhiInModule = geom->GetNPHIdiv();
+  mNEtaInModule = geom->GetNETAdiv();
+  mCellIDTable.assign(size_t(nSM) * mNModulesInSM * mNPhiInModule * mNEtaInModule, -1);
+  auto cellID = mCellIDTable.begin();
+  for (Int_t iSM = 0; iSM < nSM; iSM++) {
+    for (Int_t iMod = 0; iMod < mNModulesInSM; iMod++) {
+      for (Int_t iPhi = 0; iPhi < mNPhiInModule; iPhi++) {
+        for (Int_t iEta = 0; iEta < mNEtaInModule; iEta++) {
+          *cellID++ = geom->GetAbsCellId(iSM, iMod, iPhi, iEta);
+        }
+      }
+    }
+  }
+  LOG(DEBUG) << "EMCAL cell lookup table with " << mCellIDTable.size() << " entries, " << mSMOffsetByVolID.size()
+             << " supermodule volumes" << FairLogger::endl;
+}
+
 Hit* Detector::AddHit(Int_t trackID, Int_t parentID, Int_t primary, Double_t initialEnergy, Int_t detID,
                       const Point3D<float>& pos, const Vector3D<float>& mom, Double_t time, Double_t eLoss)
 {
@@ -223,6 +288,7 @@ void Detector::Reset()
   mCurrentTrackID = -1;
   mCurrentCellID = -1;
   mCurrentHit = nullptr;
+  mCurrentCellValid = kFALSE;
 }
 
 Geometry* Detector::GetGeometry()
@@ -62,6 +62,10 @@ class GeometryTGeo : public o2::ITSMFT::GeometryTGeo
 
   // adopt the unique instance from external raw pointer (to be used only to read saved instance from file)
   static void adopt(GeometryTGeo* raw); 
+
+  // create the unique instance from a geometry snapshot (see DetMatrixCache::writeSnapshot), without TGeo.
+  // Returns nullptr if the snapshot cannot be used
+  static GeometryTGeo* instanceFromSnapshot(const std::string& fileName, ULong64_t geometryHash = 0);
   
   // constructor
   // ATTENTION: this class is supposed to behave as a singleton, but to make it root-persistent
@@ -90,6 +94,10 @@ class GeometryTGeo : public o2::ITSMFT::GeometryTGeo
 
   /// Exract ITS parameters from TGeo
   void Build(int loadTrans=0) override;
+
+  // layout tables and tracking frames stored in the geometry snapshot
+  void writeSnapshotTables(std::ostream& out) const override;
+  bool readSnapshotTables(std::istream& in) override;
   
   int getNumberOfChipRowsPerModule(int lay) const { return mNumberOfChipRowsPerModule[lay]; }
   int getNumberOfChipColsPerModule(int lay) const
@@ -90,6 +90,53 @@ void GeometryTGeo::adopt(GeometryTGeo* raw)
   sInstance = std::unique_ptr<o2::ITS::GeometryTGeo>(raw);
 }
 
+//__________________________________________________________________________
+GeometryTGeo* GeometryTGeo::instanceFromSnapshot(const std::string& fileName, ULong64_t geometryHash)
+{
+  if (sInstance) {
+    LOG(WARNING) << "o2::ITS::GeometryTGeo instance exists, snapshot " << fileName << " is not loaded"
+                 << FairLogger::endl;
+    return sInstance.get();
+  }
+  std::unique_ptr<GeometryTGeo> geom(new GeometryTGeo(false));
+  if (!geom->readSnapshot(fileName, geometryHash)) {
+    return nullptr;
+  }
+  sInstance = std::move(geom);
+  return sInstance.get();
+}
+
+//__________________________________________________________________________
+void GeometryTGeo::writeSnapshotTables(std::ostream& out) const
+{
+  writeSnapshotValue(out, mNumberOfLayers);
+  for (const auto* table : { &mNumberOfStaves, &mNumberOfHalfStaves, &mNumberOfModules, &mNumberOfChipsPerModule,
+                             &mNumberOfChipRowsPerModule, &mNumberOfChipsPerHalfStave, &mNumberOfChipsPerStave,
+                             &mNumberOfChipsPerLayer, &mLastChipIndex }) {
+    writeSnapshotVector(out, *table);
+  }
+  writeSnapshotValue(out, mLayerToWrapper);
+  writeSnapshotVector(out, mCacheRefX);
+  writeSnapshotVector(out, mCacheRefAlpha);
+}
+
+//__________________________________________________________________________
+bool GeometryTGeo::readSnapshotTables(std::istream& in)
+{
+  if (!readSnapshotValue(in, mNumberOfLayers)) {
+    return false;
+  }
+  for (auto* table : { &mNumberOfStaves, &mNumberOfHalfStaves, &mNumberOfModules, &mNumberOfChipsPerModule,
+                       &mNumberOfChipRowsPerModule, &mNumberOfChipsPerHalfStave, &mNumberOfChipsPerStave,
+                       &mNumberOfChipsPerLayer, &mLastChipIndex }) {
+    if (!readSnapshotVector(in, *table) || int(table->size()) != mNumberOfLayers) {
+      return false;
+    }
+  }
+  return readSnapshotValue(in, mLayerToWrapper) && readSnapshotVector(in, mCacheRefX) &&
+         readSnapshotVector(in, mCacheRefAlpha);
+}
+
 //__________________________________________________________________________
 int GeometryTGeo::getChipIndex(int lay, int sta, int chipInStave) const
 {
@@ -435,6 +482,8 @@ void GeometryTGeo::fillMatrixCache(int mask)
     }
   }
     
+  // structure of arrays copies for the batched transformations
+  fillMatrixCacheSoA(mask);
 }
 
 //__________________________________________________________________________
@@ -24,7 +24,9 @@
 
 #include "ITSReconstruction/CAaux.h"
 #include "ITSReconstruction/CATrackingStation.h"
+#include "ITSReconstruction/TaskPool.h"
 #include "DetectorsBase/Track.h"
+#include "DetectorsBase/MatBudgetLUT.h"
 
 namespace o2 {
   namespace ITS {
@@ -42,11 +44,16 @@ namespace o2 {
           void UnloadClusters();
           // Possibly, other public functions
           float    GetMaterialBudget(const double* p0, const double* p1, double& x2x0, double& rhol) const;
+          // Material budget table used in the refit instead of the rough layer thicknesses, not owned
+          void     SetMatBudgetLUT(const o2::Base::MatBudgetLUT* lut) { mMatBudgetLUT = lut; }
           bool     GetSAonly() const { return mSAonly; }
           void     SetChi2Cut(float cut) { mChi2Cut = cut; }
           void     SetPhiCut(float cut) { mPhiCut = cut; }
           void     SetSAonly(bool sa = true) { mSAonly = sa; }
           void     SetZCut(float cut) { mZCut = cut; }
+          // The output does not depend on the number of threads: the per-chunk results are merged in order
+          void     SetNumberOfThreads(int n) { mPool.setNumberOfThreads(n); }
+          int      GetNumberOfThreads() const { return mPool.getNumberOfThreads(); }
           //
           float    GetX() const { return mVertex[0]; }
           float    GetY() const { return mVertex[1]; }
@@ -59,6 +66,7 @@ namespace o2 {
           bool   CellParams(int l, const Cluster& c1, const Cluster& c2, const Cluster& c3, float &curv, std::array<float,3> &np);
           void   CellsTreeTraversal(std::vector<Road> &roads, const int &iD, const int &doubl);
           void   FindTracksCA(int iteration);
+          bool   FitRoad(const Road& road, std::vector<Track>& candidates);
           void   MakeCells(int iteration);
           bool   RefitAt(float xx, Track* t);
           void   SetCuts(int it);
@@ -69,8 +77,8 @@ namespace o2 {
           float                 mChi2Cut;
           float                 mPhiCut;
           float                 mZCut;
-          std::vector<Doublets>      mDoublets[6];
-          std::vector<Cell>          mCells[5];
+          Doublets              mDoublets[6];
+          Cells                 mCells[5];
           std::vector<Track>         mCandidates[4];
           bool                  mSAonly;             // true if the standalone tracking only
           // Cuts
@@ -87,9 +95,13 @@ namespace o2 {
           float mVertex[3];
           float mBz;
           //
+          TaskPool              mPool;               // worker threads for the CA stages
+          const o2::Base::MatBudgetLUT* mMatBudgetLUT; // tabulated material budget, if any
+          //
           static const float              mkChi2Cut;      // chi2 cut during track merging
           static const int                mkNumberOfIterations;
           static const float              mkR[7];
+          static const int                mkChunkSize;    // number of clusters/doublets/cells per task
           //
       };
     } // namespace CA
@@ -69,6 +69,7 @@ namespace o2 {
           void GetBinZPhi(int ipz,int &iz,int &iphi) const {iz = GetBinZ(ipz); iphi=GetBinPhi(ipz);}
           //
           int  SelectClusters(float zmin,float zmax,float phimin,float phimax);
+          int  SelectClusters(float zmin,float zmax,float phimin,float phimax,std::vector<int>& ids) const;
           int  GetNFoundBins()                  const {return mFoundBins.size();}
           int  GetFoundBin(int i)               const {return mFoundBins[i];}
           int  GetFoundBinClusters(int i, int &first)  const;
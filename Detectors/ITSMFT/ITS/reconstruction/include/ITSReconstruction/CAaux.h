@@ -21,33 +21,25 @@ namespace o2 {
   namespace ITS {
     namespace CA {
 
-      class Cell {
+      /// Cells built out of the doublets of two adjacent layer pairs, stored as structure of arrays.
+      /// The neighbours of each cell are kept in the compressed row format.
+      class Cells {
         public:
-          Cell(int xx = 0u,int yy = 0u, int zz = 0u, int dd0 = 0,
-              int dd1 = 0, float curv = 0.f, std::array<float,3> n = {0.f});
-
-          int x() const { return mVector[0]; }
-          int y() const { return mVector[1]; }
-          int z() const { return mVector[2]; }
-          int d0() const { return md0; }
-          int d1() const { return md1; }
-          int GetLevel() const { return mVector[3]; }
-          float GetCurvature() const { return m1OverR; }
-          std::array<float,3>& GetN() { return mN; }
-
-          void SetLevel(int lev) { mVector[3] = lev; }
-
-          int operator()(const int i) { return mVector[4 + i]; }
-
-          std::vector<int>::size_type NumberOfNeighbours() { return (mVector.size() - 4u); }
-
-          bool Combine(Cell &neigh, int idd);
-
-        private:
-          float m1OverR;
-          int md0,md1;
-          std::array<float,3> mN;
-          std::vector<int> mVector;
+          int NumberOfNeighbours(int i) const { return neighFirst.empty() ? 0 : neighFirst[i + 1] - neighFirst[i]; }
+          int Neighbour(int i, int iN) const { return neighbours[neighFirst[i] + iN]; }
+          size_t size() const { return x.size(); }
+
+          void add(int xx, int yy, int zz, int dd0, int dd1, float c, const std::array<float,3>& n);
+          void append(const Cells& other);
+          void clear();
+
+          std::vector<int> x, y, z;        // cluster indices on the 3 layers
+          std::vector<int> d0, d1;         // indices of the inner and outer doublets
+          std::vector<int> level;          // length of the longest chain of neighbours
+          std::vector<float> curv;         // curvature
+          std::vector<float> n0, n1, n2;   // normal of the circle plane in the paraboloid space
+          std::vector<int> neighFirst;     // first entry in neighbours for each cell, size()+1 entries
+          std::vector<int> neighbours;     // neighbour cells on the previous layer
       };
 
       class Road {
@@ -72,6 +64,10 @@ namespace o2 {
             return Elements[i];
           }
 
+          int operator[] (const int &i) const {
+            return Elements[i];
+          }
+
           void ResetElements() {
             for ( int i=0; i<5; ++i )
               Elements[i] = -1;
@@ -120,15 +116,32 @@ namespace o2 {
           float mChi2;
       };
 
+      /// Doublets of a pair of layers, stored as structure of arrays
       class Doublets {
         public:
-          Doublets(int xx = 0, int yy = 0, float tL = 0.f, float ph = 0.f)
-            : x((int)xx)
-              , y((int)yy)
-              , tanL(tL)
-              , phi(ph) {}
-          int x,y;
-          float tanL, phi;
+          size_t size() const { return x.size(); }
+
+          void add(int xx, int yy, float tL, float ph) {
+            x.push_back(xx);
+            y.push_back(yy);
+            tanL.push_back(tL);
+            phi.push_back(ph);
+          }
+          void append(const Doublets& other) {
+            x.insert(x.end(), other.x.begin(), other.x.end());
+            y.insert(y.end(), other.y.begin(), other.y.end());
+            tanL.insert(tanL.end(), other.tanL.begin(), other.tanL.end());
+            phi.insert(phi.end(), other.phi.begin(), other.phi.end());
+          }
+          void clear() {
+            x.clear();
+            y.clear();
+            tanL.clear();
+            phi.clear();
+          }
+
+          std::vector<int> x, y;          // cluster indices on the inner and outer layers
+          std::vector<float> tanL, phi;   // dip angle and direction
       };
 
       struct Sensor  { // info on sensor
@@ -20,8 +20,11 @@
 //    The pattern recongintion based on the "cooked covariance" approach
 //-------------------------------------------------------------------------
 
+#include <array>
+#include <cmath>
 #include <vector>
 #include "ITSBase/GeometryTGeo.h"
+#include "ITSReconstruction/TaskPool.h"
 #include "MathUtils/Cartesian3D.h"
 
 class TClonesArray;
@@ -68,8 +71,17 @@ class CookedTracker
   Double_t getBz() const;
   void setBz(Double_t bz) { mBz = bz; }
 
-  void setNumberOfThreads(Int_t n) { mNumOfThreads=n; }
+  void setNumberOfThreads(Int_t n) { mNumOfThreads=n; mPool.setNumberOfThreads(n); }
   Int_t getNumberOfThreads() const { return mNumOfThreads; }
+
+  /// number of seeding layer clusters processed per dynamically scheduled chunk, 0 for automatic
+  void setSeedChunkSize(Int_t n) { mSeedChunkSize=n; }
+  Int_t getSeedChunkSize() const { return mSeedChunkSize; }
+
+  /// processing phases timed for each event
+  enum TimerPhase { kLoadTime, kTrackTime, kOutputTime, kNTimers };
+  /// wall time (s) spent in a given phase of the last processed event
+  Double_t getTiming(Int_t phase) const { return mTimings[phase]; }
   
   // These functions must be implemented
   void process(const TClonesArray& clusters, TClonesArray& tracks);
@@ -100,7 +112,10 @@ class CookedTracker
   const o2::ITS::GeometryTGeo* mGeom = nullptr; /// interface to geometry
   
   Int_t mNumOfThreads; ///< Number of tracking threads
-  
+  Int_t mSeedChunkSize = 0; ///< Number of seeding clusters per scheduled chunk
+  TaskPool mPool;           ///< Persistent worker threads
+  std::array<Double_t, kNTimers> mTimings{}; ///< Per-phase timings of the last event
+
   Double_t mBz;///< Effective Z-component of the magnetic field (kG)
   Double_t mX; ///< X-coordinate of the primary vertex
   Double_t mY; ///< Y-coordinate of the primary vertex
@@ -125,24 +140,44 @@ class CookedTracker::Layer
   Bool_t insertCluster(o2::ITSMFT::Cluster* c);
   void setR(Double_t r) { mR = r; }
   void unloadClusters();
-  void selectClusters(std::vector<Int_t> &s, Float_t phi, Float_t dy, Float_t z, Float_t dz);
-  Int_t findClusterIndex(Double_t z) const;
+  void selectClusters(std::vector<Int_t> &s, Float_t phi, Float_t dy, Float_t z, Float_t dz) const;
+  void selectClustersInWindow(std::vector<Int_t> &s, Float_t phi, Float_t slope, Float_t xRef, Float_t dphi,
+                              Float_t zMin, Float_t zMax) const;
   Float_t getR() const { return mR; }
   o2::ITSMFT::Cluster* getCluster(Int_t i) const { return mClusters[i]; }
   Float_t getAlphaRef(Int_t i) const { return mAlphaRef[i]; }
   Float_t getClusterPhi(Int_t i) const { return mPhi[i]; }
+  Float_t getClusterZ(Int_t i) const { return mZ[i]; }
+  Point3D<float> getClusterXYZGloRot(Int_t i) const { return Point3D<float>(mXGlo[i], mYGlo[i], mZ[i]); }
   Int_t getNumberOfClusters() const { return mClusters.size(); }
   void  setGeometry(o2::ITS::GeometryTGeo* geom) { mGeom = geom; }
 
  protected:
-  enum {kNSectors=21};
+  enum {kNPhiBins=128, kNZBins=128, kNCells=kNPhiBins*kNZBins};
+  enum {kBlockSize=64}; ///< number of clusters checked at once in the window selection
+
+  Int_t getPhiBin(Float_t phi) const { return phi*kNPhiBins/(2*M_PI); }
+  Int_t getZBin(Float_t z) const {
+    Int_t b = (z - mZMin)*mInvZBinWidth;
+    return b < 0 ? 0 : (b >= kNZBins ? kNZBins - 1 : b);
+  }
 
   Float_t mR; ///< mean radius of this layer
   const o2::ITS::GeometryTGeo* mGeom = nullptr; /// interface to geometry
+  Float_t mZMin = 0.;                      ///< lower z edge of the cluster grid
+  Float_t mZMax = 0.;                      ///< upper z edge of the cluster grid
+  Float_t mInvZBinWidth = 0.;              ///< inverse z bin width of the cluster grid
+  Float_t mXMin = 0.;                      ///< min. tracking frame X of the clusters
+  Float_t mXMax = 0.;                      ///< max. tracking frame X of the clusters
+  // the clusters and their cached coordinates are stored in the (phi,z) cell order
   std::vector<o2::ITSMFT::Cluster*>mClusters;          ///< All clusters
   std::vector<Float_t> mAlphaRef;          ///< alpha of the reference plane
   std::vector<Float_t> mPhi;               ///< cluster phi
-  std::vector<Int_t> mSectors[kNSectors];  ///< Cluster indices sector-by-sector
+  std::vector<Float_t> mZ;                 ///< cluster z
+  std::vector<Float_t> mXTrk;              ///< cluster X in the tracking frame
+  std::vector<Float_t> mXGlo;              ///< cluster global X
+  std::vector<Float_t> mYGlo;              ///< cluster global Y
+  std::vector<Int_t> mCellFirst;           ///< index of the 1st cluster of each (phi,z) cell, kNCells+1 entries
 };
 }
 }
@@ -0,0 +1,72 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TaskPool.h
+/// \brief Definition of the persistent worker pool used by the ITS trackers
+
+#ifndef ALICEO2_ITS_TASKPOOL_H
+#define ALICEO2_ITS_TASKPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace o2
+{
+namespace ITS
+{
+/// \class TaskPool
+/// \brief Set of worker threads kept alive between events
+///
+/// The calling thread participates in parallelFor, so a pool created for
+/// n threads starts n-1 workers and a pool of 1 thread runs everything serially.
+class TaskPool
+{
+ public:
+  /// Range function: (participant ID, first, last)
+  using RangeFunction = std::function<void(int, int, int)>;
+
+  explicit TaskPool(int nThreads = 1);
+  TaskPool(const TaskPool&) = delete;
+  TaskPool& operator=(const TaskPool&) = delete;
+  ~TaskPool();
+
+  /// total number of threads, including the calling one
+  int getNumberOfThreads() const { return mWorkers.size() + 1; }
+
+  /// restart the pool with a different number of threads
+  void setNumberOfThreads(int nThreads);
+
+  /// queue a task for an asynchronous execution by one of the workers
+  std::future<void> submit(std::function<void()> task);
+
+  /// process [0,n) in chunks of chunkSize, dynamically distributed over all threads;
+  /// returns when all chunks are done
+  void parallelFor(int n, int chunkSize, const RangeFunction& func);
+
+ private:
+  void start(int nThreads);
+  void stop();
+  void workerLoop();
+
+  std::vector<std::thread> mWorkers;
+  std::deque<std::packaged_task<void()>> mQueue;
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  bool mStop = false;
+};
+}
+}
+
+#endif /* ALICEO2_ITS_TASKPOOL_H */
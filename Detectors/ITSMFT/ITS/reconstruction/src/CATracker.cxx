@@ -52,6 +52,7 @@ using std::array;
 // tolerance for layer on-surface check
 const float Tracker::mkChi2Cut =  600.f;
 const int Tracker::mkNumberOfIterations =  2;
+const int Tracker::mkChunkSize = 256;
 const float Tracker::mkR[7] = {2.33959,3.14076,3.91924,19.6213,24.5597,34.388,39.3329};
 //
 const float kmaxDCAxy[5] = {0.05f,0.04f,0.05f,0.2f,0.4f};
@@ -86,7 +87,9 @@ const float kDoublPhi1 = 0.2f;
   ,mCDCAxy()
   ,mCDN()
    ,mCDP()
-   ,mCDZ() {
+   ,mCDZ()
+   ,mPool(1)
+   ,mMatBudgetLUT(nullptr) {
      // This default constructor needs to be provided
    }
 
@@ -150,9 +153,9 @@ void Tracker::CellsTreeTraversal(vector<Road> &roads,
   const int currentN = roads.back().N;
 
   // [2] loop on the neighbours of the current cell
-  for (size_t iN = 0; iN < mCells[doubl][iD].NumberOfNeighbours(); ++iN) {
+  for (int iN = 0; iN < mCells[doubl].NumberOfNeighbours(iD); ++iN) {
     const int currD = doubl - 1;
-    const int neigh = mCells[doubl][iD](iN);
+    const int neigh = mCells[doubl].Neighbour(iD,iN);
 
     // [3] for each neighbour one road
     if (iN > 0) {
@@ -163,7 +166,7 @@ void Tracker::CellsTreeTraversal(vector<Road> &roads,
     CellsTreeTraversal(roads,neigh,currD);
   }
 
-  mCells[doubl][iD].SetLevel(0u); // Level = -1
+  mCells[doubl].level[iD] = 0; // Level = -1
 }
 
 int Tracker::Clusters2Tracks() {
@@ -258,15 +261,16 @@ void Tracker::FindTracksCA(int iteration) {
     // Road finding. For each cell at level $(level) a loop on their neighbours to start building
     // the roads.
     for (int iCL = 4; iCL >= level - 1; --iCL) {
-      for (size_t iCell = 0; iCell < mCells[iCL].size(); ++iCell) {
-        if (mCells[iCL][iCell].GetLevel() != level)
+      Cells& cells = mCells[iCL];
+      for (size_t iCell = 0; iCell < cells.size(); ++iCell) {
+        if (cells.level[iCell] != level)
           continue;
         // [1] Add current cell to road
         roads.emplace_back(iCL,iCell);
         // [2] Loop on current cell neighbours
-        for(size_t iN = 0; iN < mCells[iCL][iCell].NumberOfNeighbours(); ++iN) {
+        for(int iN = 0; iN < cells.NumberOfNeighbours(iCell); ++iN) {
           const int currD = iCL - 1;
-          const int neigh = mCells[iCL][iCell](iN);
+          const int neigh = cells.Neighbour(iCell,iN);
           // [3] if more than one neighbour => more than one road, one road for each neighbour
           if(iN > 0) {
             roads.emplace_back(iCL,iCell);
@@ -274,52 +278,66 @@ void Tracker::FindTracksCA(int iteration) {
           // [4] Essentially the neighbour became the current cell and then go to [1]
           CellsTreeTraversal(roads,neigh,currD);
         }
-        mCells[iCL][iCell].SetLevel(0u); // Level = -1
+        cells.level[iCell] = 0; // Level = -1
       }
     }
 
-    // Roads fitting
-    for (size_t iR = 0; iR < roads.size(); ++iR) {
-      if (roads[iR].N != level)
-        continue;
-      int indices[7] = {-1};
-      int first = -1,last = -1;
-      for(int i = 0; i < 5; ++i) {
-        if (roads[iR][i] < 0)
-          continue;
-
-        if (first < 0) {
-          indices[i] = mCells[i][roads[iR][i]].x();
-          indices[i + 1] = mCells[i][roads[iR][i]].y();
-          first = i;
-        }
-        indices[i + 2] = mCells[i][roads[iR][i]].z();
-        last = i;
+    // Roads fitting: the roads are independent, the candidates of each chunk are appended in order
+    const int nRoads = roads.size();
+    vector<vector<Track>> chunkCandidates((nRoads + mkChunkSize - 1) / mkChunkSize);
+    mPool.parallelFor(nRoads, mkChunkSize, [&](int, int first, int last) {
+      vector<Track>& candidates = chunkCandidates[first / mkChunkSize];
+      for (int iR = first; iR < last; ++iR) {
+        if (roads[iR].N == level)
+          FitRoad(roads[iR], candidates);
       }
-      const int mid = (last + first) / 2;
-      const Cluster& cl0 = (*mLayer[first])[mCells[first][roads[iR][first]].x()];
-      const Cluster& cl1 = (*mLayer[mid + 1])[mCells[mid][roads[iR][mid]].y()];
-      const Cluster& cl2 = (*mLayer[last + 2])[mCells[last][roads[iR][last]].z()];
-      // Init track parameters
-      float cv  = Curvature(cl0.x,cl0.y,cl1.x,cl1.y,cl2.x,cl2.y);
-      float tgl = TanLambda(cl0.x,cl0.y,cl2.x,cl2.y,cl0.z,cl2.z);
-
-      ITSDetInfo_t det = (*mLayer[last + 2]).GetDetInfo(cl2.detid);
-      float x = det.xTF + cl2.x; // I'd like to avoit using AliITSUClusterPix...
-      float alp = det.phiTF;
-      std::array<float,5> par {cl2.y,cl2.z,0,tgl,cv};
-      std::array<float,15> cov {
-        5.f*5.f,
-        0.f,  5.f*5.f,
-        0.f,  0.f  , 0.7f*0.7f,
-        0.f,  0.f,   0.f,       0.7f*0.7f,
-        0.f,  0.f,   0.f,       0.f,       10.f
-      };
-      Track tt{x,alp,par,cov,indices};
-      if (RefitAt(2.1, &tt))
-        mCandidates[level - 2].push_back(tt);
+    });
+    for (auto& candidates : chunkCandidates)
+      mCandidates[level - 2].insert(mCandidates[level - 2].end(), candidates.begin(), candidates.end());
+  }
+}
+
+bool Tracker::FitRoad(const Road& road, vector<Track>& candidates) {
+  // Build the track candidate out of the cells of the road and refit it
+  int indices[7];
+  std::fill_n(indices, 7, -1);
+  int first = -1,last = -1;
+  for(int i = 0; i < 5; ++i) {
+    if (road[i] < 0)
+      continue;
+
+    if (first < 0) {
+      indices[i] = mCells[i].x[road[i]];
+      indices[i + 1] = mCells[i].y[road[i]];
+      first = i;
     }
+    indices[i + 2] = mCells[i].z[road[i]];
+    last = i;
   }
+  const int mid = (last + first) / 2;
+  const Cluster& cl0 = (*mLayer[first])[mCells[first].x[road[first]]];
+  const Cluster& cl1 = (*mLayer[mid + 1])[mCells[mid].y[road[mid]]];
+  const Cluster& cl2 = (*mLayer[last + 2])[mCells[last].z[road[last]]];
+  // Init track parameters
+  float cv  = Curvature(cl0.x,cl0.y,cl1.x,cl1.y,cl2.x,cl2.y);
+  float tgl = TanLambda(cl0.x,cl0.y,cl2.x,cl2.y,cl0.z,cl2.z);
+
+  ITSDetInfo_t det = (*mLayer[last + 2]).GetDetInfo(cl2.detid);
+  float x = det.xTF + cl2.x; // I'd like to avoit using AliITSUClusterPix...
+  float alp = det.phiTF;
+  std::array<float,5> par {cl2.y,cl2.z,0,tgl,cv};
+  std::array<float,15> cov {
+    5.f*5.f,
+    0.f,  5.f*5.f,
+    0.f,  0.f  , 0.7f*0.7f,
+    0.f,  0.f,   0.f,       0.7f*0.7f,
+    0.f,  0.f,   0.f,       0.f,       10.f
+  };
+  Track tt{x,alp,par,cov,indices};
+  if (!RefitAt(2.1, &tt))
+    return false;
+  candidates.push_back(tt);
+  return true;
 }
 
 int Tracker::LoadClusters() {
@@ -336,122 +354,182 @@ int Tracker::LoadClusters() {
 }
 
 void Tracker::MakeCells(int iteration) {
+  // All the stages run on the thread pool over chunks of clusters (i.e. phi slices, since the
+  // clusters are sorted in phi), doublets or cells. The outputs of the chunks are merged in
+  // order, so the result does not depend on the number of threads.
 
   SetCuts(iteration);
-  if (iteration >= 1) {
-    for (int i = 0; i < 5; ++i)
-      vector<Cell>().swap(mCells[i]);
-    for (int i = 0; i < 6; ++i)
-      vector<Doublets>().swap(mDoublets[i]);
-  }
+  for (int i = 0; i < 5; ++i)
+    mCells[i].clear();
+  for (int i = 0; i < 6; ++i)
+    mDoublets[i].clear();
 
   // Trick to speed up the navigation of the doublets array. The lookup table is build like:
   // dLUT[l][i] = n;
   // where n is the index inside mDoublets[l+1] of the first doublets that uses the point
   // mLayer[l+1][i]
   vector<int> dLUT[5];
+  for (int iL = 0; iL < 5; ++iL)
+    dLUT[iL].assign(mLayer[iL + 1]->GetNClusters(),-1);
+
+  // Doublets: tasks over the chunks of clusters of all the layer pairs
+  struct DoubletsTask {
+    int layer, first, last;
+    Doublets doublets;
+  };
+  vector<DoubletsTask> dTasks;
   for (int iL = 0; iL < 6; ++iL) {
-    if (mLayer[iL]->GetNClusters() == 0) continue;
-    if (iL < 5)
-      dLUT[iL].resize((*mLayer[iL + 1]).GetNClusters(),-1);
-    if (dLUT[iL - 1].size() == 0u)
-      continue;
-    for (int iC = 0; iC < mLayer[iL]->GetNClusters(); ++iC) {
+    const int nCl = mLayer[iL]->GetNClusters();
+    if (nCl == 0 || mLayer[iL + 1]->GetNClusters() == 0) continue;
+    for (int iC = 0; iC < nCl; iC += mkChunkSize)
+      dTasks.push_back({iL, iC, std::min(iC + mkChunkSize, nCl), Doublets()});
+  }
+  mPool.parallelFor(dTasks.size(), 1, [&](int, int it, int) {
+    DoubletsTask& task = dTasks[it];
+    const int iL = task.layer;
+    const TrackingStation& layer1 = *mLayer[iL + 1];
+    vector<int> ids;
+    for (int iC = task.first; iC < task.last; ++iC) {
       const ClsInfo_t& cls = mLayer[iL]->GetClusterInfo(iC);
       if (mUsedClusters[iL][iC]) {
         continue;
       }
       const float tanL = (cls.z - GetZ()) / cls.r;
       const float extz = tanL * (mkR[iL + 1] - cls.r) + cls.z;
-      const int nClust = mLayer[iL + 1]->SelectClusters(extz - 2 * mCZ, extz + 2 * mCZ,
-          cls.phi - mCPhi, cls.phi + mCPhi);
+      layer1.SelectClusters(extz - 2 * mCZ, extz + 2 * mCZ, cls.phi - mCPhi, cls.phi + mCPhi, ids);
       bool first = true;
 
-      for (int iC2 = 0; iC2 < nClust; ++iC2) {
-        const int iD2 = mLayer[iL + 1]->GetNextClusterInfoID();
-        const ClsInfo_t& cls2 = mLayer[iL + 1]->GetClusterInfo(iD2);
-        if (mUsedClusters[iL + 1][iC2]) {
+      for (int iD2 : ids) {
+        const ClsInfo_t& cls2 = layer1.GetClusterInfo(iD2);
+        if (mUsedClusters[iL + 1][iD2]) {
           continue;
         }
         const float dz = tanL * (cls2.r - cls.r) + cls.z - cls2.z;
         if (fabs(dz) < mCDZ[iL] && CompareAngles(cls.phi, cls2.phi, mCPhi)) {
           if (first && iL > 0) {
-            dLUT[iL - 1][iC] = mDoublets[iL].size();
+            dLUT[iL - 1][iC] = task.doublets.size(); // local index, shifted after the merging
             first = false;
           }
           const float dTanL = (cls.z - cls2.z) / (cls.r - cls2.r);
           const float phi = atan2(cls.y - cls2.y, cls.x - cls2.x);
-          mDoublets[iL].emplace_back(iC,iD2,dTanL,phi);
+          task.doublets.add(iC,iD2,dTanL,phi);
         }
       }
-      mLayer[iL + 1]->ResetFoundIterator();
     }
+  });
+  for (auto& task : dTasks) {
+    const int offset = mDoublets[task.layer].size();
+    if (task.layer > 0) {
+      vector<int>& lut = dLUT[task.layer - 1];
+      for (int iC = task.first; iC < task.last; ++iC)
+        if (lut[iC] >= 0) lut[iC] += offset;
+    }
+    mDoublets[task.layer].append(task.doublets);
   }
 
-  // Trick to speed up the navigation of the cells array. The lookup table is build like:
-  // tLUT[l][i] = n;
-  // where n is the index inside mCells[l+1] of the first cells that uses the doublet
-  // mDoublets[l+1][i]
-  vector<int> tLUT[4];
-  tLUT[0].resize(mDoublets[1].size(),-1);
-  tLUT[1].resize(mDoublets[2].size(),-1);
-  tLUT[2].resize(mDoublets[3].size(),-1);
-  tLUT[3].resize(mDoublets[4].size(),-1);
-
+  // Cells: tasks over the chunks of inner doublets of all the doublet pairs. The doublets of the
+  // outer layer sharing the point are contiguous, the cheap angular cuts are evaluated on them
+  // as a block before the more expensive checks.
+  struct CellsTask {
+    int layer, first, last;
+    Cells cells;
+  };
+  vector<CellsTask> cTasks;
   for (int iD = 0; iD < 5; ++iD) {
-    if (mDoublets[iD + 1].size() == 0u || mDoublets[iD].size() == 0u) continue;
-
-    for (size_t iD0 = 0; iD0 < mDoublets[iD].size(); ++iD0) {
-      const int idx = mDoublets[iD][iD0].y;
-      bool first = true;
-      if (dLUT[iD][idx] == -1) continue;
-      for (size_t iD1 = dLUT[iD][idx]; iD1 < mDoublets[iD + 1].size(); ++iD1) {
-        if (idx != mDoublets[iD + 1][iD1].x) break;
-        if (fabs(mDoublets[iD][iD0].tanL - mDoublets[iD + 1][iD1].tanL) < mCDTanL &&
-            fabs(mDoublets[iD][iD0].phi - mDoublets[iD + 1][iD1].phi) < mCDPhi) {
-          const float tan = 0.5f * (mDoublets[iD][iD0].tanL + mDoublets[iD + 1][iD1].tanL);
-          const float extz = -tan * (*mLayer[iD])[mDoublets[iD][iD0].x].r +
-            (*mLayer[iD])[mDoublets[iD][iD0].x].z;
-          if (fabs(extz - GetZ()) < mCDCAz[iD]) {
-            float curv = 0.f;
-            array<float,3> n {0.f};
-            if (CellParams(iD,(*mLayer[iD])[mDoublets[iD][iD0].x],(*mLayer[iD + 1])[mDoublets[iD][iD0].y],
-                  (*mLayer[iD + 2])[mDoublets[iD + 1][iD1].y],curv,n)) {
-              if (first && iD > 0) {
-                tLUT[iD - 1][iD0] = mCells[iD].size();
-                first = false;
-              }
-              mCells[iD].emplace_back(mDoublets[iD][iD0].x,mDoublets[iD][iD0].y,
-                    mDoublets[iD + 1][iD1].y,iD0,iD1,curv,n);
-            }
+    const int nD = mDoublets[iD].size();
+    if (nD == 0 || mDoublets[iD + 1].size() == 0u) continue;
+    for (int iD0 = 0; iD0 < nD; iD0 += mkChunkSize)
+      cTasks.push_back({iD, iD0, std::min(iD0 + mkChunkSize, nD), Cells()});
+  }
+  mPool.parallelFor(cTasks.size(), 1, [&](int, int it, int) {
+    CellsTask& task = cTasks[it];
+    const int iD = task.layer;
+    const Doublets& inner = mDoublets[iD];
+    const Doublets& outer = mDoublets[iD + 1];
+    const int nOuter = outer.size();
+    vector<char> mask;
+    for (int iD0 = task.first; iD0 < task.last; ++iD0) {
+      const int idx = inner.y[iD0];
+      const int begin = dLUT[iD][idx];
+      if (begin == -1) continue;
+      int end = begin;
+      while (end < nOuter && outer.x[end] == idx) ++end;
+      const float tanL0 = inner.tanL[iD0], phi0 = inner.phi[iD0];
+      const float* tanL1 = &outer.tanL[begin];
+      const float* phi1 = &outer.phi[begin];
+      const int n = end - begin;
+      mask.resize(n);
+      for (int k = 0; k < n; ++k)
+        mask[k] = (fabs(tanL0 - tanL1[k]) < mCDTanL) & (fabs(phi0 - phi1[k]) < mCDPhi);
+      const ClsInfo_t& cl0 = (*mLayer[iD])[inner.x[iD0]];
+      for (int k = 0; k < n; ++k) {
+        if (!mask[k]) continue;
+        const int iD1 = begin + k;
+        const float tan = 0.5f * (tanL0 + tanL1[k]);
+        const float extz = -tan * cl0.r + cl0.z;
+        if (fabs(extz - GetZ()) < mCDCAz[iD]) {
+          float curv = 0.f;
+          array<float,3> n {0.f};
+          if (CellParams(iD,cl0,(*mLayer[iD + 1])[idx],(*mLayer[iD + 2])[outer.y[iD1]],curv,n)) {
+            task.cells.add(inner.x[iD0],idx,outer.y[iD1],iD0,iD1,curv,n);
           }
         }
       }
     }
-  }
+  });
+  for (auto& task : cTasks)
+    mCells[task.layer].append(task.cells);
 
   // Adjacent cells: cells that share 2 points. In the following code adjacent cells are combined.
   // If they meet some requirements (~ same curvature, ~ same n) the innermost cell id is added
   // to the list of neighbours of the outermost cell. When the cell is added to the neighbours of
   // the outermost cell the "level" of the latter is set to the level of the innermost one + 1.
   // ( only if $(level of the innermost) + 1 > $(level of the outermost) )
+  // The layers are processed in sequence, the outermost cells of each layer in parallel.
   for (int iD = 0; iD < 4; ++iD) {
-    if (mCells[iD + 1].size() == 0u || tLUT[iD].size() == 0u) continue; // TODO: dealing with holes
-    for (size_t c0 = 0; c0 < mCells[iD].size(); ++c0) {
-      const int idx = mCells[iD][c0].d1();
-      if (tLUT[iD][idx] == -1) continue;
-      for (size_t c1 = tLUT[iD][idx]; c1 < mCells[iD + 1].size(); ++c1) {
-        if (idx != mCells[iD + 1][c1].d0()) break;
-        auto& n0 = mCells[iD][c0].GetN();
-        auto& n1 = mCells[iD + 1][c1].GetN();
-        const float dn2 = ((n0[0] - n1[0]) * (n0[0] - n1[0]) + (n0[1] - n1[1]) * (n0[1] - n1[1]) +
-            (n0[2] - n1[2]) * (n0[2] - n1[2]));
-        const float dp = fabs(mCells[iD][c0].GetCurvature() - mCells[iD + 1][c1].GetCurvature());
-        if (dn2 < mCDN[iD] && dp < mCDP[iD]) {
-          mCells[iD + 1][c1].Combine(mCells[iD][c0], c0);
+    const Cells& cells0 = mCells[iD];
+    Cells& cells1 = mCells[iD + 1];
+    const int nCells1 = cells1.size();
+    cells1.neighFirst.assign(nCells1 + 1, 0);
+    cells1.neighbours.clear();
+    if (nCells1 == 0 || cells0.size() == 0u) continue; // TODO: dealing with holes
+
+    // inner cells grouped by their outer doublet, in increasing order
+    const int nD = mDoublets[iD + 1].size();
+    vector<int> byD1First(nD + 1, 0), byD1(cells0.size());
+    for (int d1 : cells0.d1) byD1First[d1 + 1]++;
+    for (int i = 0; i < nD; ++i) byD1First[i + 1] += byD1First[i];
+    {
+      vector<int> pos(byD1First.begin(), byD1First.end() - 1);
+      for (size_t c0 = 0; c0 < cells0.size(); ++c0) byD1[pos[cells0.d1[c0]]++] = c0;
+    }
+
+    vector<vector<int>> chunkNeighbours((nCells1 + mkChunkSize - 1) / mkChunkSize);
+    mPool.parallelFor(nCells1, mkChunkSize, [&](int, int first, int last) {
+      vector<int>& neighbours = chunkNeighbours[first / mkChunkSize];
+      for (int c1 = first; c1 < last; ++c1) {
+        const int idx = cells1.d0[c1];
+        for (int i = byD1First[idx]; i < byD1First[idx + 1]; ++i) {
+          const int c0 = byD1[i];
+          const float dn2 = ((cells0.n0[c0] - cells1.n0[c1]) * (cells0.n0[c0] - cells1.n0[c1]) +
+              (cells0.n1[c0] - cells1.n1[c1]) * (cells0.n1[c0] - cells1.n1[c1]) +
+              (cells0.n2[c0] - cells1.n2[c1]) * (cells0.n2[c0] - cells1.n2[c1]));
+          const float dp = fabs(cells0.curv[c0] - cells1.curv[c1]);
+          if (dn2 < mCDN[iD] && dp < mCDP[iD] &&
+              cells1.y[c1] == cells0.z[c0] && cells1.x[c1] == cells0.y[c0]) { // Cells sharing two points
+            neighbours.push_back(c0);
+            cells1.neighFirst[c1 + 1]++;
+            if (cells0.level[c0] + 1 > cells1.level[c1])
+              cells1.level[c1] = cells0.level[c0] + 1;
+          }
         }
       }
-    }
+    });
+    for (int c1 = 0; c1 < nCells1; ++c1)
+      cells1.neighFirst[c1 + 1] += cells1.neighFirst[c1];
+    cells1.neighbours.reserve(cells1.neighFirst[nCells1]);
+    for (auto& neighbours : chunkNeighbours)
+      cells1.neighbours.insert(cells1.neighbours.end(), neighbours.begin(), neighbours.end());
   }
 }
 
@@ -490,6 +568,20 @@ int Tracker::PropagateBack() {
   return 0;
 }
 
+float Tracker::GetMaterialBudget(const double* p0, const double* p1, double& x2x0, double& rhol) const {
+  // Material budget of the straight segment p0-p1, from the table if available, otherwise
+  // from the geometry. Returns the segment length, negative if the budget is not available
+  o2::Base::GeometryManager::MatBudget budget;
+  if (mMatBudgetLUT) {
+    budget = mMatBudgetLUT->getMatBudget(p0[0], p0[1], p0[2], p1[0], p1[1], p1[2]);
+  } else {
+    budget = o2::Base::GeometryManager::meanMaterialBudget(p0[0], p0[1], p0[2], p1[0], p1[1], p1[2]);
+  }
+  x2x0 = budget.meanX2X0;
+  rhol = budget.getXRho();
+  return budget.length;
+}
+
 bool Tracker::RefitAt(float xx, Track *track) {
   // This function refits the track "t" at the position "x" using
   // the clusters from "c"
@@ -509,7 +601,9 @@ bool Tracker::RefitAt(float xx, Track *track) {
     step = -1;
   }
 
+  const float mass = 1.39569997787475586e-01; // pion mass
   for (int i = from; i != to; i += step) {
+    Point3D<float> xyz0 = t->GetXYZ();
     int idx = index[i];
     if (idx >= 0) {
       const Cluster &cl = (*mLayer[i])[idx];
@@ -528,10 +622,15 @@ bool Tracker::RefitAt(float xx, Track *track) {
         return false;
       }
     }
+    if (mMatBudgetLUT) {
+      // the budget is integrated along the actual path, no angular correction needed
+      auto budget = mMatBudgetLUT->getMatBudget(xyz0, t->GetXYZ());
+      t->CorrectForMaterial(budget.meanX2X0, - step * budget.getXRho(), mass, false);
+      continue;
+    }
     float xx0 = (i > 2) ? 0.008 : 0.003;  // Rough layer thickness
     float x0  = 9.36; // Radiation length of Si [cm]
     float rho = 2.33; // Density of Si [g/cm^3]
-    float mass = 1.39569997787475586e-01; // pion mass
     t->CorrectForMaterial(xx0, - step * xx0 * x0 * rho, mass, true);
   }
 
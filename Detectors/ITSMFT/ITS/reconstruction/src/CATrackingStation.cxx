@@ -44,6 +44,7 @@ using namespace o2::ITS::CA;
 using o2::Base::Constants::k2PI;
 using o2::Base::Utils::BringTo02Pi;
 using o2::ITSMFT::Hit;
+using std::vector;
 
 TrackingStation::TrackingStation() :
   mID(-1)
@@ -313,6 +314,33 @@ int TrackingStation::SelectClusters(float zmin,float zmax,float phimin,float phi
   return mNFoundClusters;
 }
 
+int TrackingStation::SelectClusters(float zmin,float zmax,float phimin,float phimax,vector<int>& ids) const {
+  // thread-safe version of the query: fill the ids of the clusters in the requested region
+  // in the same order as provided by the GetNextClusterInfoID iterator
+  ids.clear();
+  if (!mNOccBins) return 0;
+  if (zmax < mZMin || zmin > mZMax || zmin > zmax) return 0;
+  int zbmin = GetZBin(zmin);
+  if (zbmin < 0) zbmin = 0;
+  int zbmax = GetZBin(zmax);
+  if (zbmax >= mNZBins) zbmax = mNZBins - 1;
+  BringTo02Pi(phimin);
+  BringTo02Pi(phimax);
+  const int phibmin = GetPhiBin(phimin);
+  int nbcheck = GetPhiBin(phimax) - phibmin + 1;
+  if (nbcheck <= 0) nbcheck += mNPhiBins + 1; // wrapping around 0-2pi
+  for (int ip0 = 0;ip0 < nbcheck;ip0++) {
+    int ip = phibmin + ip0;
+    if (ip >= mNPhiBins) ip -= mNPhiBins;
+    const int binMin = GetBinIndex(zbmin,ip), binMax = binMin + zbmax - zbmin;
+    for (int binID = binMin;binID <= binMax;binID++) {
+      const ClBinInfo_t& binInfo = mBins[binID];
+      for (int ic = 0;ic < binInfo.ncl;ic++) ids.push_back(binInfo.first + ic);
+    }
+  }
+  return ids.size();
+}
+
 int TrackingStation::GetNextClusterInfoID() {
   if (mFoundBinIterator < 0) return 0;
   int currBin = mFoundBins[mFoundBinIterator];
@@ -15,24 +15,46 @@ using namespace o2::ITS::CA;
 using o2::Base::Constants::kPI;
 using std::array;
 
-Cell::Cell(int xx,int yy, int zz, int dd0, int dd1, float curv, array<float,3> n)
-  : m1OverR{curv},
-  md0{dd0},
-  md1{dd1},
-  mN{n[0],n[1],n[2]},
-  mVector{xx,yy,zz,1u} {
+void Cells::add(int xx, int yy, int zz, int dd0, int dd1, float c, const array<float,3>& n) {
+  x.push_back(xx);
+  y.push_back(yy);
+  z.push_back(zz);
+  d0.push_back(dd0);
+  d1.push_back(dd1);
+  level.push_back(1);
+  curv.push_back(c);
+  n0.push_back(n[0]);
+  n1.push_back(n[1]);
+  n2.push_back(n[2]);
 }
 
-bool Cell::Combine(Cell &neigh, int idd) {
-  // From outside inward
-  if (this->y() == neigh.z() && this->x() == neigh.y()) { // Cells sharing two points
-    mVector.push_back(idd);
-    if (neigh.GetLevel() + 1 > GetLevel()) {
-      SetLevel(neigh.GetLevel() + 1u);
-    }
-    return true;
-  }
-  return false;
+void Cells::append(const Cells& other) {
+  // append cells w/o neighbours
+  x.insert(x.end(), other.x.begin(), other.x.end());
+  y.insert(y.end(), other.y.begin(), other.y.end());
+  z.insert(z.end(), other.z.begin(), other.z.end());
+  d0.insert(d0.end(), other.d0.begin(), other.d0.end());
+  d1.insert(d1.end(), other.d1.begin(), other.d1.end());
+  level.insert(level.end(), other.level.begin(), other.level.end());
+  curv.insert(curv.end(), other.curv.begin(), other.curv.end());
+  n0.insert(n0.end(), other.n0.begin(), other.n0.end());
+  n1.insert(n1.end(), other.n1.begin(), other.n1.end());
+  n2.insert(n2.end(), other.n2.begin(), other.n2.end());
+}
+
+void Cells::clear() {
+  x.clear();
+  y.clear();
+  z.clear();
+  d0.clear();
+  d1.clear();
+  level.clear();
+  curv.clear();
+  n0.clear();
+  n1.clear();
+  n2.clear();
+  neighFirst.clear();
+  neighbours.clear();
 }
 
 Track::Track(float x, float a, array<float,Base::Track::kNParams> p, array<float,Base::Track::kCovMatSize> c, int *cl) :
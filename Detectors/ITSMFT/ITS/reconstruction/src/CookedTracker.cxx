@@ -16,7 +16,7 @@
 //                     A stand-alone ITS tracker
 //    The pattern recongintion based on the "cooked covariance" approach
 //-------------------------------------------------------------------------
-#include <future>
+#include <algorithm>
 #include <chrono>
 
 #include <TClonesArray.h>
@@ -72,7 +72,7 @@ const Int_t kminNumberOfClusters = 4;
 
 CookedTracker::Layer CookedTracker::sLayers[CookedTracker::kNLayers];
 
-CookedTracker::CookedTracker(Int_t n) : mNumOfThreads(n), mBz(0.)
+CookedTracker::CookedTracker(Int_t n) : mNumOfThreads(n), mPool(n), mBz(0.)
 {
   //--------------------------------------------------------------------
   // This default constructor needs to be provided
@@ -302,62 +302,46 @@ void CookedTracker::makeSeeds(std::vector<CookedTrack> &seeds, Int_t first, Int_
   const Double_t maxC = TMath::Abs(getBz() * kB2C / kminPt);
   const Double_t kpWin = TMath::ASin(0.5 * maxC * layer1.getR()) - TMath::ASin(0.5 * maxC * layer2.getR());
 
-  //Int_t nClusters1 = layer1.getNumberOfClusters();
-  Int_t nClusters2 = layer2.getNumberOfClusters();
-  Int_t nClusters3 = layer3.getNumberOfClusters();
+  std::vector<Int_t> selec2, selec3;
+  selec2.reserve(layer2.getNumberOfClusters() / 100);
+  selec3.reserve(layer3.getNumberOfClusters() / 100);
 
   for (Int_t n1 = first; n1 < last; n1++) {
-    Cluster* c1 = layer1.getCluster(n1);
     //
-    // Int_t lab=c1->getLabel(0);
+    // Int_t lab=layer1.getCluster(n1)->getLabel(0);
     //    
-    Double_t z1 = c1->getZ();
-    auto xyz1 = c1->getXYZGloRot(*mGeom);
+    Double_t z1 = layer1.getClusterZ(n1);
+    auto xyz1 = layer1.getClusterXYZGloRot(n1);
     Double_t r1 = xyz1.rho(), phi1 = layer1.getClusterPhi(n1);
     
     Double_t zr2 = zv + layer2.getR() / r1 * (z1 - zv);
-    Int_t start2 = layer2.findClusterIndex(zr2 - kzWin);
+    selec2.clear();
+    layer2.selectClustersInWindow(selec2, phi1, 0., 0., kpWin, zr2 - kzWin, zr2 + kzWin); // check in Z and Phi
 
-    for (Int_t n2 = start2; n2 < nClusters2; n2++) {
+    for (auto n2 : selec2) {
       Cluster* c2 = layer2.getCluster(n2);
       //
       // if (c2->getLabel(0)!=lab) continue;
       //
-      Double_t z2 = c2->getZ();
-      if (z2 > (zr2 + kzWin))
-        break; // check in Z
-
-      Double_t phi2 = layer2.getClusterPhi(n2);
-      if (TMath::Abs(phi2 - phi1) > kpWin)
-        continue; // check in Phi
-
-      auto xyz2 = c2->getXYZGloRot(*mGeom);
+      Double_t z2 = layer2.getClusterZ(n2);
+      auto xyz2 = layer2.getClusterXYZGloRot(n2);
       Double_t r2 = xyz2.rho();
       Double_t crv = f1(xyz1.X(), xyz1.Y(), xyz2.X(), xyz2.Y(), getX(), getY());
 
       Double_t zr3 = z1 + (layer3.getR() - r1) / (r2 - r1) * (z2 - z1);
       Double_t dz = kzWin / 2;
-      
-      Int_t start3 = layer3.findClusterIndex(zr3 - dz);
-      for (Int_t n3 = start3; n3 < nClusters3; n3++) {
-        Cluster* c3 = layer3.getCluster(n3);
+
+      // check in Z and in Phi, extrapolated along the circle to the X of each cluster
+      selec3.clear();
+      layer3.selectClustersInWindow(selec3, phi1, 0.5 * crv, r1, kpWin / 100, zr3 - dz, zr3 + dz);
+      for (auto n3 : selec3) {
         //
-        // if (c3->getLabel(0)!=lab) continue;
+        // if (layer3.getCluster(n3)->getLabel(0)!=lab) continue;
         //
-        Double_t z3 = c3->getZ();
-	if (z3 > (zr3 + dz))
-          break; // check in Z
-
-        Double_t r3 = c3->getX();
-        Double_t phir3 = phi1 + 0.5 * crv * (r3 - r1);
-        Double_t phi3 = layer3.getClusterPhi(n3);
-        if (TMath::Abs(phir3 - phi3) > kpWin / 100)
-          continue; // check in Phi
-
 	Point3Df txyz2 = c2->getXYZ(); // tracking coordinates
 	//	txyz2.SetX(layer2.getXRef(n2));  // The clusters are already in the tracking frame
 
-	auto xyz3 = c3->getXYZGloRot(*mGeom);
+	auto xyz3 = layer3.getClusterXYZGloRot(n3);
 
 	CookedTrack seed = cookSeed(xyz1, xyz3, txyz2, layer2.getR(), layer3.getR(), layer2.getAlphaRef(n2), getBz());
 
@@ -529,35 +513,44 @@ void CookedTracker::process(const TClonesArray& clusters, TClonesArray& tracks)
 
   auto end = std::chrono::system_clock::now();
   std::chrono::duration<double> diff = end-start;
+  mTimings[kLoadTime] = diff.count();
   LOG(INFO)<<"Loading time: "<<diff.count()<<" s"<<FairLogger::endl;
 
-
-  std::vector<std::future<std::vector<CookedTrack>>> futures(mNumOfThreads);
-  std::vector<std::vector<CookedTrack>> seedArray(mNumOfThreads);
-  
+  // The seeding layer clusters are processed in chunks picked up dynamically
+  // by the pool threads, each chunk filling its own track buffer
   Int_t numOfClusters = sLayers[kSeedingLayer1].getNumberOfClusters();
-  for (Int_t t=0,first=0; t<mNumOfThreads; t++) {
-    Int_t rem = t < (numOfClusters % mNumOfThreads) ? 1 : 0;
-    Int_t last = first + (numOfClusters/mNumOfThreads) + rem;
-    futures[t] = std::async(std::launch::async, &CookedTracker::trackInThread, this, first, last);
-    first = last;
+  Int_t chunkSize = mSeedChunkSize;
+  if (chunkSize <= 0) {
+    chunkSize = std::max(1, numOfClusters / (8 * mPool.getNumberOfThreads()));
   }
-  
+  std::vector<std::vector<CookedTrack>> chunkTracks((numOfClusters + chunkSize - 1) / chunkSize);
+  mPool.parallelFor(numOfClusters, chunkSize, [this, chunkSize, &chunkTracks](int, int first, int last) {
+    chunkTracks[first / chunkSize] = trackInThread(first, last);
+  });
+
+  auto endTrack = std::chrono::system_clock::now();
+  diff = endTrack-end;
+  mTimings[kTrackTime] = diff.count();
+
+  // merge the chunk buffers in the chunk order, independent of the scheduling
   Int_t nSeeds = 0, ngood=0;
-  for (Int_t t=0; t<mNumOfThreads; t++) {
-    seedArray[t] = futures[t].get();
-    nSeeds += seedArray[t].size();
-    for (auto &track : seedArray[t]) {
+  for (auto &seeds : chunkTracks) {
+    nSeeds += seeds.size();
+    for (auto &track : seeds) {
       if (track.getNumberOfClusters() < kminNumberOfClusters) continue;
       Label label = track.getLabel();
       if (label.getTrackID() >= 0) ngood++;
       new (tracks[tracks.GetEntriesFast()]) CookedTrack(track);
     }
+    std::vector<CookedTrack>().swap(seeds);
   }
 
   end = std::chrono::system_clock::now();
+  diff = end-endTrack;
+  mTimings[kOutputTime] = diff.count();
   diff = end-start;
-  LOG(INFO)<<"Processing time: "<<diff.count()<<" s"<<FairLogger::endl;
+  LOG(INFO)<<"Processing time: "<<diff.count()<<" s (tracking "<<mTimings[kTrackTime]<<" s, output "
+	   <<mTimings[kOutputTime]<<" s)"<<FairLogger::endl;
 
   if (nSeeds)
     LOG(INFO)<<"CookedTracker::process(), good_tracks:/seeds: "<< ngood << '/' << nSeeds
@@ -727,15 +720,8 @@ void CookedTracker::loadClusters(const TClonesArray& clusters)
       continue;
   }
 
-  std::vector<std::future<void>> fut;
-  for (Int_t l = 0; l < kNLayers; l+=mNumOfThreads) {
-    for (Int_t t = 0; t < mNumOfThreads; t++) {
-      if (l+t >= kNLayers) break;
-      auto f=std::async(std::launch::async, &CookedTracker::Layer::init, sLayers+(l+t));
-      fut.push_back(std::move(f));
-    }
-    for (Int_t t = 0; t < fut.size(); t++) fut[t].wait();
-  }
+  // initialise the layers on the pool threads, the outer (most populated) ones first
+  mPool.parallelFor(kNLayers, 1, [](int, int first, int) { sLayers[kNLayers - 1 - first].init(); });
 }
 
 void CookedTracker::unloadClusters()
@@ -767,30 +753,64 @@ CookedTracker::Layer::Layer() : mR(0)
 void CookedTracker::Layer::init()
 {
   //--------------------------------------------------------------------
-  // Sort clusters and cache their reference plane info in a thread
+  // Distribute clusters over the (phi,z) cells and cache their
+  // reference plane info and coordinates in a thread
   //--------------------------------------------------------------------
-  std::sort(std::begin(mClusters), std::end(mClusters),
-     [](const Cluster *c1, const Cluster *c2){ return (c1->getZ() < c2->getZ()); }
-  );
+  Int_t m=mClusters.size();
+  mCellFirst.assign(kNCells + 1, 0);
+  if (!m) return;
 
+  std::vector<Float_t> phi(m), xGlo(m), yGlo(m);
+  std::vector<Int_t> cell(m);
+  mZMin = mZMax = mClusters[0]->getZ();
+  mXMin = mXMax = mClusters[0]->getX();
   Double_t r = 0.;
-  const Float_t pi2 = 2. * TMath::Pi();
-  Int_t m=mClusters.size();
   for (Int_t i = 0; i < m; i++) {
     Cluster* c = mClusters[i];
-    //Float_t xRef, aRef; 
-    //mGeom->getSensorXAlphaRefPlane(c->getSensorID(),xRef, aRef);
-    mAlphaRef.push_back( mGeom->getSensorRefAlpha(c->getSensorID()) );
     auto xyz = c->getXYZGloRot(*mGeom);
-    r += xyz.rho();    
-    Float_t phi = xyz.Phi();
-    BringTo02Pi(phi); 
-    mPhi.push_back(phi);
-    Int_t s=phi*kNSectors/pi2;
-    mSectors[s].push_back(i);
+    r += xyz.rho();
+    Float_t p = xyz.Phi();
+    BringTo02Pi(p);
+    phi[i] = p;
+    xGlo[i] = xyz.X();
+    yGlo[i] = xyz.Y();
+    mZMin = std::min(mZMin, c->getZ());
+    mZMax = std::max(mZMax, c->getZ());
+    mXMin = std::min(mXMin, c->getX());
+    mXMax = std::max(mXMax, c->getX());
   }
+  mR = r/m;
+  mInvZBinWidth = kNZBins / (mZMax - mZMin + 1e-4);
 
-  if (m) mR = r/m;
+  // counting sort of the clusters by the cell index
+  for (Int_t i = 0; i < m; i++) {
+    Int_t ip = getPhiBin(phi[i]);
+    if (ip >= kNPhiBins) ip = kNPhiBins - 1;
+    cell[i] = ip * kNZBins + getZBin(mClusters[i]->getZ());
+    mCellFirst[cell[i] + 1]++;
+  }
+  for (Int_t ic = 0; ic < kNCells; ic++) mCellFirst[ic + 1] += mCellFirst[ic];
+
+  std::vector<Cluster*> clusters(m);
+  std::vector<Int_t> fill(mCellFirst.begin(), mCellFirst.end() - 1);
+  mAlphaRef.resize(m);
+  mPhi.resize(m);
+  mZ.resize(m);
+  mXTrk.resize(m);
+  mXGlo.resize(m);
+  mYGlo.resize(m);
+  for (Int_t i = 0; i < m; i++) {
+    Int_t j = fill[cell[i]]++;
+    Cluster* c = mClusters[i];
+    clusters[j] = c;
+    mAlphaRef[j] = mGeom->getSensorRefAlpha(c->getSensorID());
+    mPhi[j] = phi[i];
+    mZ[j] = c->getZ();
+    mXTrk[j] = c->getX();
+    mXGlo[j] = xGlo[i];
+    mYGlo[j] = yGlo[i];
+  }
+  mClusters.swap(clusters);
 }
 
 void CookedTracker::Layer::unloadClusters()
@@ -801,7 +821,11 @@ void CookedTracker::Layer::unloadClusters()
   mClusters.clear();
   mAlphaRef.clear();
   mPhi.clear();
-  for (Int_t s=0; s<kNSectors; s++) mSectors[s].clear();
+  mZ.clear();
+  mXTrk.clear();
+  mXGlo.clear();
+  mYGlo.clear();
+  mCellFirst.clear();
 }
 
 Bool_t CookedTracker::Layer::insertCluster(Cluster* c)
@@ -813,53 +837,50 @@ Bool_t CookedTracker::Layer::insertCluster(Cluster* c)
   return kTRUE;
 }
 
-Int_t CookedTracker::Layer::findClusterIndex(Double_t z) const
+void
+CookedTracker::Layer::selectClusters(std::vector<Int_t>&selec, Float_t phi, Float_t dy, Float_t z, Float_t dz) const
 {
   //--------------------------------------------------------------------
-  // This function returns the index of the first cluster with its fZ >= "z".
+  // This function selects clusters within the "road"
   //--------------------------------------------------------------------
-  auto found = std::upper_bound(std::begin(mClusters), std::end(mClusters), z,
-    [](Double_t zc, const Cluster *c){ return (zc < c->getZ()); }
-  );
-  return found - std::begin(mClusters);
+  selectClustersInWindow(selec, phi, 0., 0., dy / mR, z - dz, z + dz);
 }
 
-void
-CookedTracker::Layer::selectClusters(std::vector<Int_t>&selec, Float_t phi, Float_t dy, Float_t z, Float_t dz)
+void CookedTracker::Layer::selectClustersInWindow(std::vector<Int_t>& selec, Float_t phi, Float_t slope, Float_t xRef,
+                                                  Float_t dphi, Float_t zMin, Float_t zMax) const
 {
   //--------------------------------------------------------------------
-  // This function selects clusters within the "road"
-  //--------------------------------------------------------------------
-  Float_t zMin = z - dz;
-  Float_t zMax = z + dz;
-
-  const Float_t pi2 = 2. * TMath::Pi();
-  Float_t dphi = dy / mR;
-  
-  Float_t phiMin = phi - dphi;
-  Float_t phiMax = phi + dphi;
-  Float_t phiRange[2]{phiMin, phiMax};
-
-  Int_t n=0;
-  Int_t sector=-1;
-  for (auto phiM : phiRange) {
-    Int_t s = phiM*kNSectors/pi2;
-    if (s<0) s+=kNSectors;
-    else if (s>=kNSectors) s-=kNSectors;
-    
-    if (s==sector) break;
-    sector=s;
-
-    auto cmp = [this](Double_t zc, Int_t ic){ return (zc < mClusters[ic]->getZ()); };
-    auto imin = std::upper_bound(std::begin(mSectors[s]), std::end(mSectors[s]), zMin, cmp); 
-    auto imax = std::upper_bound(imin, std::end(mSectors[s]), zMax, cmp);
-    for ( ; imin != imax; imin++) {
-      Int_t i = *imin; 
-      Float_t cphi = mPhi[i];
-      if (cphi <= phiMin) continue;
-      if (cphi > phiMax) continue;
-    
-      selec.push_back(i);
+  // This function selects clusters with zMin <= z <= zMax and
+  // |phi + slope*(x - xRef) - phiCluster| <= dphi, x being the cluster
+  // X in the tracking frame. Each (phi,z) cell row is a contiguous span
+  // of the SoA cluster arrays, checked in blocks w/o branches.
+  //--------------------------------------------------------------------
+  if (mClusters.empty() || zMax < mZMin || zMin > mZMax) return;
+
+  const Float_t pi = TMath::Pi(), pi2 = 2. * TMath::Pi();
+  // phi window covering all possible X of the clusters
+  Float_t phiLow = phi + std::min(slope * (mXMin - xRef), slope * (mXMax - xRef)) - dphi;
+  Float_t phiUp = phi + std::max(slope * (mXMin - xRef), slope * (mXMax - xRef)) + dphi;
+  Int_t ipLow = std::floor(phiLow * kNPhiBins / pi2), ipUp = std::floor(phiUp * kNPhiBins / pi2);
+  if (ipUp - ipLow >= kNPhiBins) ipUp = ipLow + kNPhiBins - 1;
+  Int_t izLow = getZBin(zMin), izUp = getZBin(zMax);
+
+  UChar_t accept[kBlockSize];
+  for (Int_t ip = ipLow; ip <= ipUp; ip++) {
+    Int_t cellPhi = ((ip % kNPhiBins) + kNPhiBins) % kNPhiBins;
+    Int_t first = mCellFirst[cellPhi * kNZBins + izLow], last = mCellFirst[cellPhi * kNZBins + izUp + 1];
+    for (Int_t block = first; block < last; block += kBlockSize) {
+      Int_t n = std::min(Int_t(kBlockSize), last - block);
+      const Float_t *cphi = &mPhi[block], *cz = &mZ[block], *cx = &mXTrk[block];
+      for (Int_t i = 0; i < n; i++) {
+        Float_t d = cphi[i] - phi - slope * (cx[i] - xRef);
+        d -= pi2 * (d > pi);
+        d += pi2 * (d < -pi);
+        accept[i] = (std::abs(d) <= dphi) & (cz[i] >= zMin) & (cz[i] <= zMax);
+      }
+      for (Int_t i = 0; i < n; i++) {
+        if (accept[i]) selec.push_back(block + i);
+      }
     }
   }
 }
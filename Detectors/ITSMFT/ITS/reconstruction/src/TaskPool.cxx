@@ -0,0 +1,126 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TaskPool.cxx
+/// \brief Implementation of the persistent worker pool used by the ITS trackers
+
+#include <algorithm>
+#include <atomic>
+
+#include "ITSReconstruction/TaskPool.h"
+
+using namespace o2::ITS;
+
+//_____________________________________________________________________
+TaskPool::TaskPool(int nThreads)
+{
+  start(nThreads);
+}
+
+//_____________________________________________________________________
+TaskPool::~TaskPool()
+{
+  stop();
+}
+
+//_____________________________________________________________________
+void TaskPool::setNumberOfThreads(int nThreads)
+{
+  if (nThreads == getNumberOfThreads()) {
+    return;
+  }
+  stop();
+  start(nThreads);
+}
+
+//_____________________________________________________________________
+void TaskPool::start(int nThreads)
+{
+  mStop = false;
+  for (int i = 1; i < nThreads; i++) {
+    mWorkers.emplace_back(&TaskPool::workerLoop, this);
+  }
+}
+
+//_____________________________________________________________________
+void TaskPool::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mCondition.notify_all();
+  for (auto& w : mWorkers) {
+    w.join();
+  }
+  mWorkers.clear();
+}
+
+//_____________________________________________________________________
+void TaskPool::workerLoop()
+{
+  while (true) {
+    std::packaged_task<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondition.wait(lock, [this] { return mStop || !mQueue.empty(); });
+      if (mQueue.empty()) {
+        return; // stopped and nothing left to do
+      }
+      task = std::move(mQueue.front());
+      mQueue.pop_front();
+    }
+    task();
+  }
+}
+
+//_____________________________________________________________________
+std::future<void> TaskPool::submit(std::function<void()> task)
+{
+  std::packaged_task<void()> pt(std::move(task));
+  auto fut = pt.get_future();
+  if (mWorkers.empty()) {
+    pt(); // no workers, execute in place
+    return fut;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mQueue.push_back(std::move(pt));
+  }
+  mCondition.notify_one();
+  return fut;
+}
+
+//_____________________________________________________________________
+void TaskPool::parallelFor(int n, int chunkSize, const RangeFunction& func)
+{
+  if (n <= 0) {
+    return;
+  }
+  if (chunkSize < 1) {
+    chunkSize = 1;
+  }
+  std::atomic<int> next(0);
+  auto worker = [&next, n, chunkSize, &func](int id) {
+    for (int first = next.fetch_add(chunkSize); first < n; first = next.fetch_add(chunkSize)) {
+      func(id, first, std::min(first + chunkSize, n));
+    }
+  };
+  int nChunks = (n + chunkSize - 1) / chunkSize;
+  int nHelpers = std::min(int(mWorkers.size()), nChunks - 1);
+  std::vector<std::future<void>> helpers;
+  for (int i = 0; i < nHelpers; i++) {
+    helpers.push_back(submit([&worker, i] { worker(i + 1); }));
+  }
+  worker(0);
+  for (auto& h : helpers) {
+    h.get();
+  }
+}
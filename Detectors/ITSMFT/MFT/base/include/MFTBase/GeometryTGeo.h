@@ -52,6 +52,10 @@ class GeometryTGeo : public o2::ITSMFT::GeometryTGeo
   // adopt the unique instance from external raw pointer (to be used only to read saved instance from file)
   static void adopt(GeometryTGeo* raw); 
 
+  // create the unique instance from a geometry snapshot (see DetMatrixCache::writeSnapshot), without TGeo.
+  // Returns nullptr if the snapshot cannot be used
+  static GeometryTGeo* instanceFromSnapshot(const std::string& fileName, ULong64_t geometryHash = 0);
+
   // constructor
   // ATTENTION: this class is supposed to behave as a singleton, but to make it 
   // root-persistent we must define public default constructor.
@@ -77,6 +81,10 @@ class GeometryTGeo : public o2::ITSMFT::GeometryTGeo
   /// Exract MFT parameters from TGeo
   void Build(int loadTrans=0) override;
 
+  // layout tables stored in the geometry snapshot
+  void writeSnapshotTables(std::ostream& out) const override;
+  bool readSnapshotTables(std::istream& in) override;
+
   static const Char_t* getMFTVolPattern()       { return sVolumeName.c_str(); }
   static const Char_t* getMFTHalfPattern()      { return sHalfName.c_str(); }
   static const Char_t* getMFTDiskPattern()      { return sDiskName.c_str(); }
@@ -138,6 +146,9 @@ class GeometryTGeo : public o2::ITSMFT::GeometryTGeo
   /// From matrix index to ladder ID
   Int_t getLadder(Int_t index) const;
 
+  /// Creates the MFT to ITS convention matrix, once
+  void buildTransMFT2ITS();
+
   /// In a disk start numbering the sensors from zero
   Int_t getFirstSensorIndex(Int_t disk) const { return (disk == 0) ? 0 : mLastSensorIndex[disk - 1] + 1; }
 
@@ -162,7 +173,7 @@ class GeometryTGeo : public o2::ITSMFT::GeometryTGeo
   static std::string sLadderName;          ///< 
   static std::string sSensorName;          ///< 
  
-  TGeoHMatrix* mTransMFT2ITS;        ///< transformation due to the different conventions
+  TGeoHMatrix* mTransMFT2ITS = nullptr; ///< transformation due to the different conventions
 
  private:
   static std::unique_ptr<o2::MFT::GeometryTGeo> sInstance;   ///< singleton instance 
@@ -157,9 +157,7 @@ void GeometryTGeo::Build(Int_t loadTrans)
   // yITS =  0   0  +1 * yMFT
   // zITS   +1   0   0   zMFT
   //
-  mTransMFT2ITS = new TGeoHMatrix();
-  mTransMFT2ITS->RotateY(-90.);
-  mTransMFT2ITS->RotateZ(-90.);
+  buildTransMFT2ITS();
 
   fillMatrixCache(loadTrans);
  
@@ -181,6 +179,75 @@ void GeometryTGeo::Build(Int_t loadTrans)
   */
 }
 
+//__________________________________________________________________________
+GeometryTGeo* GeometryTGeo::instanceFromSnapshot(const std::string& fileName, ULong64_t geometryHash)
+{
+  if (sInstance) {
+    LOG(WARNING) << "o2::MFT::GeometryTGeo instance exists, snapshot " << fileName << " is not loaded"
+                 << FairLogger::endl;
+    return sInstance.get();
+  }
+  std::unique_ptr<GeometryTGeo> geom(new GeometryTGeo(false));
+  if (!geom->readSnapshot(fileName, geometryHash)) {
+    return nullptr;
+  }
+  sInstance = std::move(geom);
+  return sInstance.get();
+}
+
+//__________________________________________________________________________
+void GeometryTGeo::writeSnapshotTables(std::ostream& out) const
+{
+  writeSnapshotValue(out, mTotalNumberOfSensors);
+  writeSnapshotValue(out, mNumberOfHalves);
+  writeSnapshotVector(out, mNumberOfDisks);
+  writeSnapshotVector(out, mNumberOfLaddersPerDisk);
+  writeSnapshotVector(out, mLastSensorIndex);
+  for (const auto* table : { &mNumberOfLadders, &mLadderIndex2Id, &mLadderId2Index }) {
+    writeSnapshotValue(out, ULong64_t(table->size()));
+    for (const auto& row : *table) {
+      writeSnapshotVector(out, row);
+    }
+  }
+}
+
+//__________________________________________________________________________
+bool GeometryTGeo::readSnapshotTables(std::istream& in)
+{
+  if (!readSnapshotValue(in, mTotalNumberOfSensors) || !readSnapshotValue(in, mNumberOfHalves) ||
+      !readSnapshotVector(in, mNumberOfDisks) || !readSnapshotVector(in, mNumberOfLaddersPerDisk) ||
+      !readSnapshotVector(in, mLastSensorIndex)) {
+    return false;
+  }
+  for (auto* table : { &mNumberOfLadders, &mLadderIndex2Id, &mLadderId2Index }) {
+    ULong64_t nRows = 0;
+    if (!readSnapshotValue(in, nRows) || nRows != mLastSensorIndex.size()) {
+      return false;
+    }
+    table->resize(nRows);
+    for (auto& row : *table) {
+      if (!readSnapshotVector(in, row)) {
+        return false;
+      }
+    }
+  }
+  // same convention matrix as in Build
+  buildTransMFT2ITS();
+  return true;
+}
+
+//__________________________________________________________________________
+void GeometryTGeo::buildTransMFT2ITS()
+{
+  // a geometry built again or read from a snapshot keeps the matrix of the first build
+  if (mTransMFT2ITS) {
+    return;
+  }
+  mTransMFT2ITS = new TGeoHMatrix();
+  mTransMFT2ITS->RotateY(-90.);
+  mTransMFT2ITS->RotateZ(-90.);
+}
+
 //__________________________________________________________________________
 Int_t GeometryTGeo::extractNumberOfSensorsPerLadder(Int_t half, Int_t disk, Int_t ladder) const
 {
@@ -444,6 +511,8 @@ void GeometryTGeo::fillMatrixCache(Int_t mask)
     }    
   }
 
+  // structure of arrays copies for the batched transformations
+  fillMatrixCacheSoA(mask);
 }
 
 //__________________________________________________________________________
@@ -0,0 +1,126 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file AlpideCoder.h
+/// \brief Definition of the ALPIDE data format encoder/decoder
+#ifndef ALICEO2_ITSMFT_ALPIDECODER_H
+#define ALICEO2_ITSMFT_ALPIDECODER_H
+
+#include <Rtypes.h>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ITSMFTReconstruction/PixelReader.h"
+
+namespace o2
+{
+namespace ITSMFT
+{
+
+/// \class AlpideCoder
+/// \brief Converts chip pixel data to/from the ALPIDE data format
+///
+/// The raw stream is a sequence of pages, each starting with RawPageHeader.
+/// The page payload is a sequence of chip blocks: ChipFrameHeader carrying the
+/// full chip ID and readout frame, followed by the native ALPIDE words
+/// (CHIP HEADER, REGION HEADER, DATA SHORT/LONG, CHIP TRAILER). A chip block
+/// never straddles pages.
+class AlpideCoder {
+
+ public:
+
+  /// ALPIDE data words, identified by the leading byte
+  enum RecordType : UChar_t {
+    kUnknown = 0,
+    kIdle,
+    kChipHeader,
+    kChipTrailer,
+    kChipEmpty,
+    kRegionHeader,
+    kDataShort,
+    kDataLong,
+    kBusyOn,
+    kBusyOff
+  };
+
+  static constexpr UChar_t IDLE = 0xff;
+  static constexpr UChar_t BUSYON = 0xf1;
+  static constexpr UChar_t BUSYOFF = 0xf0;
+  static constexpr UChar_t CHIPHEADER = 0xa0;   ///< 1010<chip id[3:0]>, followed by bunch counter
+  static constexpr UChar_t CHIPTRAILER = 0xb0;  ///< 1011<readout flags[3:0]>
+  static constexpr UChar_t CHIPEMPTY = 0xe0;    ///< 1110<chip id[3:0]>, followed by bunch counter
+  static constexpr UChar_t REGIONHEADER = 0xc0; ///< 110<region id[4:0]>
+  static constexpr UChar_t DATASHORT = 0x40;    ///< 01<encoder id[3:0]><addr[9:0]>
+  static constexpr UChar_t DATALONG = 0x00;     ///< 00<encoder id[3:0]><addr[9:0]> 0<hitmap[6:0]>
+
+  static constexpr int NRegions = 32;           ///< regions per chip
+  static constexpr int NDColInReg = 16;         ///< double columns (priority encoders) per region
+  static constexpr int NColInReg = 2 * NDColInReg;
+  static constexpr int HitMapSize = 7;          ///< number of pixels following the DATA LONG address
+
+  static constexpr UInt_t PageMagic = 0xa1de0001; ///< magic word + format version
+  static constexpr int DefaultPageSize = 8192;
+
+  /// Header opening every raw page
+  struct RawPageHeader {
+    UInt_t magic = PageMagic;
+    UInt_t pageSize = 0;   ///< total page size in bytes, including this header
+    UInt_t nChips = 0;     ///< number of chip blocks in the page
+    UInt_t pageID = 0;     ///< running page counter
+  };
+
+  /// Header opening every chip block
+  struct ChipFrameHeader {
+    UShort_t chipID = 0;   ///< global chip id
+    UShort_t flags = 0;    ///< reserved
+    UInt_t roFrame = 0;    ///< readout frame ID
+  };
+
+  /// Size in bytes of each data word, indexed by RecordType
+  static constexpr std::array<UChar_t, kBusyOff + 1> RecordSize{ { 1, 1, 2, 1, 2, 1, 2, 3, 1, 1 } };
+
+  /// Type of the data word starting with a given byte
+  static RecordType getRecordType(UChar_t b) { return static_cast<RecordType>(sRecordTable[b]); }
+
+  /// Convert pixel row/column to region, encoder (double column in the region) and address
+  static void pixel2Address(UShort_t row, UShort_t col, int& region, int& encoder, int& address)
+  {
+    region = col / NColInReg;
+    encoder = (col % NColInReg) >> 1;
+    address = (row << 1) | ((col & 0x1) ^ (row & 0x1));
+  }
+
+  /// Row of the pixel with given address in the double column
+  static UShort_t address2Row(int address) { return address >> 1; }
+
+  /// Column of the pixel with given address, encoder and region
+  static UShort_t address2Col(int region, int encoder, int address)
+  {
+    return region * NColInReg + (encoder << 1) + ((address & 0x1) ^ ((address >> 1) & 0x1));
+  }
+
+  /// Encode all chip data provided by the reader into the buffer, return number of bytes added
+  static size_t encode(PixelReader& reader, std::vector<UChar_t>& buffer, int pageSize = DefaultPageSize);
+
+  /// Encode single chip data to the buffer, return number of bytes added
+  static size_t encodeChip(const PixelReader::ChipPixelData& chipData, std::vector<UChar_t>& buffer);
+
+  /// Encode all chip data provided by the reader and write it to the file
+  static Bool_t encodeToFile(PixelReader& reader, const std::string& fileName, int pageSize = DefaultPageSize);
+
+ private:
+  /// lookup table of record types for the 1st byte of the data word
+  static const std::array<UChar_t, 256> sRecordTable;
+};
+}
+}
+
+#endif /* ALICEO2_ITSMFT_ALPIDECODER_H */
@@ -14,6 +14,8 @@
 #define ALICEO2_ITSMFT_PIXELREADER_H
 
 #include <Rtypes.h>
+#include <string>
+#include <vector>
 #include "ITSMFTBase/Digit.h"
 #include "SimulationDataFormat/MCCompLabel.h"
 
@@ -105,9 +107,45 @@ class DigitPixelReader : public PixelReader {
 /// \class RawPixelReader
 /// \brief RawPixelReader class for the ITS. Feeds raw data to the Cluster Finder
 ///
+/// Decodes ALPIDE raw pages (see AlpideCoder) in place, from a memory-mapped file
+/// or from externally owned memory (e.g. framework message), w/o copying the data
 class RawPixelReader : public PixelReader {
  public:
+  RawPixelReader() = default;
+  ~RawPixelReader() override;
+
+  /// rewind to the beginning of the raw data
+  void init() override {
+    mOffset = 0;
+    mPageEnd = 0;
+  }
+
   Bool_t getNextChipData(ChipPixelData &chipData) override;
+
+  /// set externally owned raw data buffer, it must be alive until the reader is done
+  void setRawData(const UChar_t* data, size_t size);
+
+  /// memory-map raw data file
+  Bool_t openInput(const std::string& fileName);
+  void closeInput();
+
+ private:
+  Bool_t openNextPage();
+  Bool_t decodeChip(ChipPixelData &chipData);
+
+  void flushOddColumn(ChipPixelData &chipData) {
+    // odd column pixels of the double column are added after the even ones
+    chipData.pixels.insert(chipData.pixels.end(), mOddColumn.begin(), mOddColumn.end());
+    mOddColumn.clear();
+  }
+
+  const UChar_t* mData = nullptr;  ///< raw data (not owned unless memory-mapped)
+  size_t mSize = 0;                ///< raw data size
+  size_t mOffset = 0;              ///< current position in the raw data
+  size_t mPageEnd = 0;             ///< end of the current page
+  void*  mMappedData = nullptr;    ///< memory-mapped input file
+  size_t mMappedSize = 0;          ///< memory-mapped input file size
+  std::vector<PixelData> mOddColumn; ///< buffer for the odd column pixels of current double column
 };
 
 
@@ -0,0 +1,190 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file AlpideCoder.cxx
+/// \brief Implementation of the ALPIDE data format encoder
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "FairLogger.h" // for LOG
+
+#include "ITSMFTReconstruction/AlpideCoder.h"
+#include "ITSMFTBase/SegmentationAlpide.h"
+
+using namespace o2::ITSMFT;
+using Segmentation = o2::ITSMFT::SegmentationAlpide;
+
+constexpr UChar_t AlpideCoder::IDLE;
+constexpr UChar_t AlpideCoder::BUSYON;
+constexpr UChar_t AlpideCoder::BUSYOFF;
+constexpr UChar_t AlpideCoder::CHIPHEADER;
+constexpr UChar_t AlpideCoder::CHIPTRAILER;
+constexpr UChar_t AlpideCoder::CHIPEMPTY;
+constexpr UChar_t AlpideCoder::REGIONHEADER;
+constexpr UChar_t AlpideCoder::DATASHORT;
+constexpr UChar_t AlpideCoder::DATALONG;
+constexpr std::array<UChar_t, AlpideCoder::kBusyOff + 1> AlpideCoder::RecordSize;
+
+namespace
+{
+std::array<UChar_t, 256> buildRecordTable()
+{
+  std::array<UChar_t, 256> table;
+  for (int b = 0; b < 256; b++) {
+    AlpideCoder::RecordType tp = AlpideCoder::kUnknown;
+    if (b == AlpideCoder::IDLE) {
+      tp = AlpideCoder::kIdle;
+    } else if (b == AlpideCoder::BUSYON) {
+      tp = AlpideCoder::kBusyOn;
+    } else if (b == AlpideCoder::BUSYOFF) {
+      tp = AlpideCoder::kBusyOff;
+    } else if ((b & 0xf0) == AlpideCoder::CHIPHEADER) {
+      tp = AlpideCoder::kChipHeader;
+    } else if ((b & 0xf0) == AlpideCoder::CHIPTRAILER) {
+      tp = AlpideCoder::kChipTrailer;
+    } else if ((b & 0xf0) == AlpideCoder::CHIPEMPTY) {
+      tp = AlpideCoder::kChipEmpty;
+    } else if ((b & 0xe0) == AlpideCoder::REGIONHEADER) {
+      tp = AlpideCoder::kRegionHeader;
+    } else if ((b & 0xc0) == AlpideCoder::DATASHORT) {
+      tp = AlpideCoder::kDataShort;
+    } else if ((b & 0xc0) == AlpideCoder::DATALONG) {
+      tp = AlpideCoder::kDataLong;
+    }
+    table[b] = tp;
+  }
+  return table;
+}
+}
+
+const std::array<UChar_t, 256> AlpideCoder::sRecordTable = buildRecordTable();
+
+//______________________________________________________________________________
+size_t AlpideCoder::encodeChip(const PixelReader::ChipPixelData& chipData, std::vector<UChar_t>& buffer)
+{
+  // encode single chip data as ChipFrameHeader + ALPIDE data words
+  size_t start = buffer.size();
+  ChipFrameHeader chipHeader;
+  chipHeader.chipID = chipData.chipID;
+  chipHeader.roFrame = chipData.roFrame;
+  buffer.resize(start + sizeof(ChipFrameHeader));
+  memcpy(&buffer[start], &chipHeader, sizeof(ChipFrameHeader));
+
+  UChar_t bunchCounter = chipData.roFrame & 0xff;
+  if (chipData.pixels.empty()) {
+    buffer.push_back(CHIPEMPTY | (chipData.chipID & 0xf));
+    buffer.push_back(bunchCounter);
+    return buffer.size() - start;
+  }
+  buffer.push_back(CHIPHEADER | (chipData.chipID & 0xf));
+  buffer.push_back(bunchCounter);
+
+  // sort hits in the readout order: region, encoder, address
+  std::vector<UInt_t> keys;
+  keys.reserve(chipData.pixels.size());
+  for (const auto& pix : chipData.pixels) {
+    if (pix.row >= Segmentation::NRows || pix.col >= Segmentation::NCols) {
+      LOG(ERROR) << "Skipping pixel " << pix.row << ":" << pix.col << " outside of chip " << chipData.chipID
+                 << FairLogger::endl;
+      continue;
+    }
+    int region, encoder, address;
+    pixel2Address(pix.row, pix.col, region, encoder, address);
+    keys.push_back((region << 14) | (encoder << 10) | address);
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  int prevRegion = -1;
+  for (size_t ih = 0; ih < keys.size(); ih++) {
+    int region = keys[ih] >> 14, encoder = (keys[ih] >> 10) & 0xf, address = keys[ih] & 0x3ff;
+    if (region != prevRegion) {
+      buffer.push_back(REGIONHEADER | region);
+      prevRegion = region;
+    }
+    // collect following hits of the same double column within the hitmap span
+    UChar_t hitMap = 0;
+    while (ih + 1 < keys.size() && (keys[ih + 1] >> 10) == (keys[ih] >> 10)) {
+      int dist = (keys[ih + 1] & 0x3ff) - address;
+      if (dist > HitMapSize) {
+        break;
+      }
+      hitMap |= 0x1 << (dist - 1);
+      ih++;
+    }
+    UChar_t head = (encoder << 2) | (address >> 8);
+    if (hitMap) {
+      buffer.push_back(DATALONG | head);
+      buffer.push_back(address & 0xff);
+      buffer.push_back(hitMap);
+    } else {
+      buffer.push_back(DATASHORT | head);
+      buffer.push_back(address & 0xff);
+    }
+  }
+  buffer.push_back(CHIPTRAILER);
+  return buffer.size() - start;
+}
+
+//______________________________________________________________________________
+size_t AlpideCoder::encode(PixelReader& reader, std::vector<UChar_t>& buffer, int pageSize)
+{
+  // encode all chips provided by the reader into a sequence of pages not exceeding
+  // pageSize, unless a single chip block does not fit in it
+  size_t start = buffer.size(), pageStart = start;
+  RawPageHeader page;
+  page.pageID = 0;
+
+  auto closePage = [&buffer, &page, &pageStart]() {
+    page.pageSize = buffer.size() - pageStart;
+    memcpy(&buffer[pageStart], &page, sizeof(RawPageHeader));
+  };
+
+  buffer.resize(pageStart + sizeof(RawPageHeader));
+  PixelReader::ChipPixelData chipData;
+  reader.init();
+  while (reader.getNextChipData(chipData)) {
+    size_t chipStart = buffer.size();
+    encodeChip(chipData, buffer);
+    if (page.nChips && buffer.size() - pageStart > size_t(pageSize)) {
+      // move the chip block to the new page
+      buffer.resize(chipStart);
+      closePage();
+      page.pageID++;
+      page.nChips = 0;
+      pageStart = chipStart;
+      buffer.resize(pageStart + sizeof(RawPageHeader));
+      encodeChip(chipData, buffer);
+    }
+    page.nChips++;
+  }
+  if (page.nChips) {
+    closePage();
+  } else {
+    buffer.resize(pageStart);
+  }
+  return buffer.size() - start;
+}
+
+//______________________________________________________________________________
+Bool_t AlpideCoder::encodeToFile(PixelReader& reader, const std::string& fileName, int pageSize)
+{
+  std::vector<UChar_t> buffer;
+  encode(reader, buffer, pageSize);
+  std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+  if (!out.good()) {
+    LOG(ERROR) << "Failed to open raw data output file " << fileName << FairLogger::endl;
+    return kFALSE;
+  }
+  out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+  LOG(INFO) << "Wrote " << buffer.size() << " bytes of ALPIDE raw data to " << fileName << FairLogger::endl;
+  return out.good();
+}
@@ -12,8 +12,15 @@
 /// \brief Implementation of the ITS pixel reader class
 
 #include <TClonesArray.h>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "FairLogger.h" // for LOG
 
 #include "ITSMFTReconstruction/PixelReader.h"
+#include "ITSMFTReconstruction/AlpideCoder.h"
 
 using namespace o2::ITSMFT;
 using o2::ITSMFT::Digit;
@@ -44,8 +51,178 @@ Bool_t DigitPixelReader::getNextChipData(PixelReader::ChipPixelData &chipData)
   return kTRUE;
 }
   
+//______________________________________________________________________________
+RawPixelReader::~RawPixelReader()
+{
+  closeInput();
+}
+
+//______________________________________________________________________________
+void RawPixelReader::setRawData(const UChar_t* data, size_t size)
+{
+  closeInput();
+  mData = data;
+  mSize = size;
+  init();
+}
+
+//______________________________________________________________________________
+Bool_t RawPixelReader::openInput(const std::string& fileName)
+{
+  closeInput();
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG(ERROR) << "Failed to open raw data file " << fileName << FairLogger::endl;
+    return kFALSE;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    LOG(ERROR) << "Failed to stat raw data file " << fileName << FairLogger::endl;
+    close(fd);
+    return kFALSE;
+  }
+  if (st.st_size > 0) {
+    void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      LOG(ERROR) << "Failed to memory-map raw data file " << fileName << FairLogger::endl;
+      close(fd);
+      return kFALSE;
+    }
+    madvise(mapped, st.st_size, MADV_SEQUENTIAL);
+    mMappedData = mapped;
+    mMappedSize = st.st_size;
+  }
+  close(fd);
+  mData = static_cast<const UChar_t*>(mMappedData);
+  mSize = mMappedSize;
+  init();
+  return kTRUE;
+}
+
+//______________________________________________________________________________
+void RawPixelReader::closeInput()
+{
+  if (mMappedData) {
+    munmap(mMappedData, mMappedSize);
+    mMappedData = nullptr;
+    mMappedSize = 0;
+  }
+  mData = nullptr;
+  mSize = 0;
+  init();
+}
+
 //______________________________________________________________________________
 Bool_t RawPixelReader::getNextChipData(PixelReader::ChipPixelData &chipData)
 {
+  chipData.clear();
+  while (true) {
+    if (mOffset >= mPageEnd && !openNextPage()) {
+      return kFALSE;
+    }
+    if (!decodeChip(chipData)) {
+      mOffset = mPageEnd = mSize; // corrupted data, stop decoding
+      return kFALSE;
+    }
+    if (!chipData.pixels.empty()) {
+      return kTRUE; // empty chip frames are not passed to the clusterer
+    }
+  }
+}
+
+//______________________________________________________________________________
+Bool_t RawPixelReader::openNextPage()
+{
+  if (mOffset + sizeof(AlpideCoder::RawPageHeader) > mSize) {
+    return kFALSE;
+  }
+  AlpideCoder::RawPageHeader page;
+  memcpy(&page, mData + mOffset, sizeof(AlpideCoder::RawPageHeader));
+  if (page.magic != AlpideCoder::PageMagic || page.pageSize < sizeof(AlpideCoder::RawPageHeader) ||
+      mOffset + page.pageSize > mSize) {
+    LOG(ERROR) << "Corrupted raw page at offset " << mOffset << ": magic 0x" << std::hex << page.magic << std::dec
+               << " size " << page.pageSize << FairLogger::endl;
+    mOffset = mPageEnd = mSize;
+    return kFALSE;
+  }
+  mPageEnd = mOffset + page.pageSize;
+  mOffset += sizeof(AlpideCoder::RawPageHeader);
   return kTRUE;
 }
+
+//______________________________________________________________________________
+Bool_t RawPixelReader::decodeChip(PixelReader::ChipPixelData &chipData)
+{
+  // decode single chip block, pixels are filled in the column-major order
+  if (mOffset + sizeof(AlpideCoder::ChipFrameHeader) > mPageEnd) {
+    LOG(ERROR) << "Truncated chip header at offset " << mOffset << FairLogger::endl;
+    return kFALSE;
+  }
+  AlpideCoder::ChipFrameHeader chipHeader;
+  memcpy(&chipHeader, mData + mOffset, sizeof(AlpideCoder::ChipFrameHeader));
+  mOffset += sizeof(AlpideCoder::ChipFrameHeader);
+  chipData.chipID = chipHeader.chipID;
+  chipData.roFrame = chipHeader.roFrame;
+  chipData.timeStamp = 0.;
+  mOddColumn.clear();
+
+  int region = -1, dcol = -1;
+  while (mOffset < mPageEnd) {
+    const UChar_t* word = mData + mOffset;
+    auto type = AlpideCoder::getRecordType(word[0]);
+    if (mOffset + AlpideCoder::RecordSize[type] > mPageEnd) {
+      LOG(ERROR) << "Truncated ALPIDE word 0x" << std::hex << int(word[0]) << std::dec << " at offset " << mOffset
+                 << FairLogger::endl;
+      return kFALSE;
+    }
+    mOffset += AlpideCoder::RecordSize[type];
+    switch (type) {
+      case AlpideCoder::kRegionHeader:
+        region = word[0] & 0x1f;
+        break;
+      case AlpideCoder::kDataShort:
+      case AlpideCoder::kDataLong: {
+        if (region < 0) {
+          LOG(ERROR) << "ALPIDE data word w/o region header for chip " << chipData.chipID << FairLogger::endl;
+          return kFALSE;
+        }
+        int encoder = (word[0] >> 2) & 0xf;
+        int address = ((word[0] & 0x3) << 8) | word[1];
+        int newDCol = region * AlpideCoder::NDColInReg + encoder;
+        if (newDCol != dcol) {
+          flushOddColumn(chipData);
+          dcol = newDCol;
+        }
+        int hitMap = type == AlpideCoder::kDataLong ? (word[2] << 1) | 0x1 : 0x1;
+        for (; hitMap; hitMap >>= 1, address++) {
+          if (!(hitMap & 0x1)) {
+            continue;
+          }
+          UShort_t row = AlpideCoder::address2Row(address), col = AlpideCoder::address2Col(region, encoder, address);
+          if (col & 0x1) {
+            mOddColumn.emplace_back(row, col);
+          } else {
+            chipData.pixels.emplace_back(row, col);
+          }
+        }
+        break;
+      }
+      case AlpideCoder::kChipTrailer:
+        flushOddColumn(chipData);
+        return kTRUE;
+      case AlpideCoder::kChipEmpty:
+        return kTRUE;
+      case AlpideCoder::kChipHeader:
+      case AlpideCoder::kIdle:
+      case AlpideCoder::kBusyOn:
+      case AlpideCoder::kBusyOff:
+        break;
+      default:
+        LOG(ERROR) << "Unknown ALPIDE word 0x" << std::hex << int(word[0]) << std::dec << " for chip "
+                   << chipData.chipID << FairLogger::endl;
+        return kFALSE;
+    }
+  }
+  LOG(ERROR) << "Missing trailer for chip " << chipData.chipID << FairLogger::endl;
+  return kFALSE;
+}
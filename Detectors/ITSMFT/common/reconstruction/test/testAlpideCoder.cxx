@@ -0,0 +1,88 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test AlpideCoder
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <vector>
+#include "ITSMFTReconstruction/AlpideCoder.h"
+#include "ITSMFTReconstruction/PixelReader.h"
+
+using namespace o2::ITSMFT;
+
+namespace
+{
+/// reader serving predefined chip data
+class VectorPixelReader : public PixelReader
+{
+ public:
+  std::vector<ChipPixelData> chips;
+  void init() override { mIdx = 0; }
+  Bool_t getNextChipData(ChipPixelData& chipData) override
+  {
+    if (mIdx >= chips.size()) {
+      return kFALSE;
+    }
+    chipData.chipID = chips[mIdx].chipID;
+    chipData.roFrame = chips[mIdx].roFrame;
+    chipData.pixels = chips[mIdx].pixels;
+    mIdx++;
+    return kTRUE;
+  }
+
+ private:
+  size_t mIdx = 0;
+};
+}
+
+BOOST_AUTO_TEST_CASE(AlpideCoder_roundtrip)
+{
+  VectorPixelReader input;
+  for (int ich = 0; ich < 50; ich++) {
+    PixelReader::ChipPixelData chip;
+    chip.chipID = ich * 37;
+    chip.roFrame = ich / 10;
+    // column-major ordered pixels, with clusters to exercise DATA LONG words
+    for (int col = ich; col < 1023; col += 97 + ich) {
+      for (int row = (col * 7) % 500; row < (col * 7) % 500 + (col % 5) + 1; row++) {
+        chip.pixels.emplace_back(row, col);
+        chip.pixels.emplace_back(row, col + 1);
+      }
+    }
+    std::sort(chip.pixels.begin(), chip.pixels.end(), [](const PixelReader::PixelData& a,
+                                                         const PixelReader::PixelData& b) {
+      return a.col < b.col || (a.col == b.col && a.row < b.row);
+    });
+    input.chips.push_back(chip);
+  }
+
+  std::vector<UChar_t> raw;
+  size_t size = AlpideCoder::encode(input, raw, 1024);
+  BOOST_CHECK(size == raw.size());
+
+  RawPixelReader reader;
+  reader.setRawData(raw.data(), raw.size());
+  PixelReader::ChipPixelData chip;
+  size_t nChips = 0;
+  while (reader.getNextChipData(chip)) {
+    BOOST_REQUIRE(nChips < input.chips.size());
+    const auto& ref = input.chips[nChips++];
+    BOOST_CHECK(chip.chipID == ref.chipID);
+    BOOST_CHECK(chip.roFrame == ref.roFrame);
+    BOOST_REQUIRE(chip.pixels.size() == ref.pixels.size());
+    for (size_t ip = 0; ip < ref.pixels.size(); ip++) {
+      BOOST_CHECK(chip.pixels[ip].row == ref.pixels[ip].row);
+      BOOST_CHECK(chip.pixels[ip].col == ref.pixels[ip].col);
+    }
+  }
+  BOOST_CHECK(nChips == input.chips.size());
+}
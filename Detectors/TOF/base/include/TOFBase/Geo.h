@@ -12,6 +12,7 @@
 #define ALICEO2_TOF_GEO_H
 
 #include "Rtypes.h"
+#include <vector>
 
 namespace o2
 {
@@ -19,6 +20,9 @@ namespace tof
 {
 /// \class Geo
 /// \brief TOF geo parameters (only statics)
+/// The global -> sector frame transformations and the strip frame translations are precomputed, and a table
+/// binned in the z of the plate frame gives the few strips a point can belong to. The pad positions are tabulated
+/// by channel index from the geometry, once, at the first getPos call: the geometry must be loaded by then.
 class Geo
 {
  public:
@@ -31,10 +35,15 @@ class Geo
 
   static void antiRotate(Float_t* xyz, Double_t rotationAngles[6]);
   static void getDetID(Float_t* pos, Int_t* det);
+  static void getDetID(Int_t n, const Float_t* pos, Int_t* det); // n points: pos[3*i+j] -> det[5*i+j]
   static Int_t getIndex(const Int_t * detId); // Get channel index from det Id (for calibration mainly)
   static void getVolumeIndices(Int_t index, Int_t *detId); // Get volume index from channel index
+  static void getVolumeIndices(Int_t n, const Int_t* index, Int_t* detId); // n channels: index[i] -> detId[5*i+j]
 
-  static void getPos(Int_t* det, Float_t* pos);
+  // the pad positions are false, with pos set to 0, for a pad which is not in the geometry
+  static Bool_t getPos(const Int_t* det, Float_t* pos);
+  static Bool_t getPosFromIndex(Int_t index, Float_t* pos);     // pad position from the channel index
+  static Bool_t getPos(Int_t n, const Int_t* index, Float_t* pos); // n channels: index[i] -> pos[3*i+j], all found
   static void getVolumePath(const Int_t* ind, Char_t* path);
   static Int_t getStripNumberPerSM(Int_t iplate, Int_t istrip);
 
@@ -51,6 +60,7 @@ class Geo
 
   static constexpr Int_t NSECTORS = 18;
   static constexpr Int_t NPLATES = 5;
+  static constexpr Int_t NCHANNELS = NSECTORS * NSTRIPXSECTOR * NPADZ * NPADX;
 
   static constexpr Float_t MAXHZTOF = 370.6;      // Max half z-size of TOF (cm)
   static constexpr Float_t ZLENA = MAXHZTOF * 2.; // length (cm) of the A module
@@ -216,6 +226,10 @@ class Geo
   static constexpr Float_t WGLFZ = 7.;            // z dimension of GLASS Layer
   static constexpr Float_t HSENSMY = 0.0105;      // height of Sensitive Layer
 
+  static constexpr Float_t STRIPZBINWIDTH = 1.;                                 // z bin of the strip lookup (cm)
+  static constexpr Int_t NSTRIPZBINS = static_cast<Int_t>(ZLENA / STRIPZBINWIDTH) + 1; // z bins of the strip lookup
+  static constexpr Int_t NMAXSTRIPCANDIDATES = 4; // max number of strips overlapping a z bin
+
  private:
   static void Init();
 
@@ -227,9 +241,20 @@ class Geo
   static void fromGlobalToSector(Float_t* pos, Int_t isector); // change coords to Sector reference
   static Int_t fromPlateToStrip(Float_t* pos, Int_t iplate); // change coord to Strip reference and return strip number
 
+  static void initPadPositions();
+
   static Bool_t mToBeIntit;
   static Float_t mRotationMatrixSector[NSECTORS + 1][3][3]; // rotation matrixes
   static Float_t mRotationMatrixPlateStrip[NPLATES][NMAXNSTRIP][3][3];
+  static Float_t mRotationMatrixGlobalToPlate[NSECTORS][3][3]; // global -> FLTA frame: rotation
+  static Float_t mTranslationGlobalToPlate[NSECTORS][3];       // global -> FLTA frame: translation after rotation
+  static Float_t mStripTranslation[NPLATES][NMAXNSTRIP][3];    // FLTA frame -> strip frame: translation before rotation
+  static Short_t mStripCandidates[NPLATES][NSTRIPZBINS][NMAXSTRIPCANDIDATES]; // strips overlapping a z bin, -1 ends
+  static Int_t mPlateOfStrip[NSTRIPXSECTOR];                   // plate of the strip number in the sector
+  static Int_t mStripInPlate[NSTRIPXSECTOR];                   // strip number in the plate of the strip in the sector
+
+  static std::vector<Float_t> mPadPositions; // 3 coordinates of the pad center by channel index
+  static std::vector<Bool_t> mPadInGeometry; // whether the pad of the channel index is in the geometry
 
   ClassDefNV(Geo, 1);
 };
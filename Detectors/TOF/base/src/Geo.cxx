@@ -12,6 +12,8 @@
 #include "TGeoManager.h"
 #include "TMath.h"
 #include "FairLogger.h"
+#include <algorithm>
+#include <mutex>
 
 ClassImp(o2::tof::Geo);
 
@@ -26,6 +28,37 @@ constexpr Float_t Geo::ROOF2PARAMETERS[3];
 Bool_t Geo::mToBeIntit = kTRUE;
 Float_t Geo::mRotationMatrixSector[NSECTORS + 1][3][3];
 Float_t Geo::mRotationMatrixPlateStrip[NPLATES][NMAXNSTRIP][3][3];
+Float_t Geo::mRotationMatrixGlobalToPlate[NSECTORS][3][3];
+Float_t Geo::mTranslationGlobalToPlate[NSECTORS][3];
+Float_t Geo::mStripTranslation[NPLATES][NMAXNSTRIP][3];
+Short_t Geo::mStripCandidates[NPLATES][NSTRIPZBINS][NMAXSTRIPCANDIDATES];
+Int_t Geo::mPlateOfStrip[NSTRIPXSECTOR];
+Int_t Geo::mStripInPlate[NSTRIPXSECTOR];
+std::vector<Float_t> Geo::mPadPositions;
+std::vector<Bool_t> Geo::mPadInGeometry;
+
+namespace
+{
+std::once_flag padPositionsInit; // the pad positions are tabulated by the first getPos call of any thread
+
+constexpr Float_t HGLFY = Geo::HFILIY + 2 * Geo::HGLASSY; // heigth of GLASS+FISHLINE  Layer
+constexpr Float_t HSTRIPY = 2. * Geo::HHONY + 2. * Geo::HPCBY + 4. * Geo::HRGLY + 2. * HGLFY + Geo::HCPCBY; // 3.11
+
+Int_t getNStrips(Int_t iplate)
+{
+  switch (iplate) {
+    case 0:
+    case 4:
+      return Geo::NSTRIPC;
+    case 1:
+    case 3:
+      return Geo::NSTRIPB;
+    case 2:
+      return Geo::NSTRIPA;
+  }
+  return 0;
+}
+}
 
 void Geo::Init()
 {
@@ -98,9 +131,100 @@ void Geo::Init()
     }
   }
 
+  // global -> B071/B074/B075 = BTO1/2/3 -> FTOA = FLTA reference frame in one step:
+  // x' = R_NSECTORS * (R_isector * x - step) = M * x - R_NSECTORS * step
+  const Double_t step[3] = { 0., 0., (RMAX + RMIN) * 0.5 };
+  for (Int_t isector = 0; isector < NSECTORS; isector++) {
+    for (Int_t ii = 0; ii < 3; ii++) {
+      Double_t t = 0.;
+      for (Int_t jj = 0; jj < 3; jj++) {
+        Double_t m = 0.;
+        for (Int_t kk = 0; kk < 3; kk++)
+          m += mRotationMatrixSector[NSECTORS][ii][kk] * mRotationMatrixSector[isector][kk][jj];
+        mRotationMatrixGlobalToPlate[isector][ii][jj] = m;
+        t += mRotationMatrixSector[NSECTORS][ii][jj] * step[jj];
+      }
+      mTranslationGlobalToPlate[isector][ii] = t;
+    }
+  }
+
+  // FTOA/B/C = FLTA/B/C reference frame -> FSTR reference frame: translation, and the z bins of the FLTA frame
+  // overlapped by the volume accepted for each strip, from its corners transformed back
+  for (Int_t iplate = 0; iplate < NPLATES; iplate++) {
+    for (Int_t ibin = 0; ibin < NSTRIPZBINS; ibin++)
+      std::fill_n(mStripCandidates[iplate][ibin], NMAXSTRIPCANDIDATES, -1);
+    for (Int_t istrip = 0; istrip < getNStrips(iplate); istrip++) {
+      Float_t* stripStep = mStripTranslation[iplate][istrip];
+      stripStep[0] = 0.;
+      stripStep[1] = getHeights(iplate, istrip);
+      stripStep[2] = -getDistances(iplate, istrip);
+      Float_t zMin = ZLENA, zMax = -ZLENA;
+      for (Int_t corner = 0; corner < 8; corner++) {
+        const Float_t local[3] = { (corner & 1 ? 0.5f : -0.5f) * STRIPLENGTH, (corner & 2 ? 0.5f : -0.5f) * HSTRIPY,
+                                   (corner & 4 ? 0.5f : -0.5f) * WCPCBZ };
+        // the strip rotation is orthogonal: its inverse is the transposed matrix
+        Float_t z = stripStep[2];
+        for (Int_t jj = 0; jj < 3; jj++)
+          z += mRotationMatrixPlateStrip[iplate][istrip][jj][2] * local[jj];
+        zMin = std::min(zMin, z);
+        zMax = std::max(zMax, z);
+      }
+      constexpr Float_t margin = 0.01; // against the rounding of the strip frame coordinates
+      Int_t binMin = std::max(0, static_cast<Int_t>((zMin - margin + ZLENA * 0.5) / STRIPZBINWIDTH));
+      Int_t binMax = std::min(NSTRIPZBINS - 1, static_cast<Int_t>((zMax + margin + ZLENA * 0.5) / STRIPZBINWIDTH));
+      for (Int_t ibin = binMin; ibin <= binMax; ibin++) {
+        Short_t* candidates = mStripCandidates[iplate][ibin];
+        Int_t icand = 0;
+        while (icand < NMAXSTRIPCANDIDATES && candidates[icand] >= 0)
+          icand++;
+        if (icand == NMAXSTRIPCANDIDATES) {
+          LOG(FATAL) << "tof::Geo::Init: more than " << NMAXSTRIPCANDIDATES << " strips of plate " << iplate
+                     << " in z bin " << ibin << FairLogger::endl;
+          return;
+        }
+        candidates[icand] = istrip;
+      }
+    }
+  }
+
+  for (Int_t iplate = 0, stripOffset = 0; iplate < NPLATES; stripOffset += getNStrips(iplate++)) {
+    for (Int_t istrip = 0; istrip < getNStrips(iplate); istrip++) {
+      mPlateOfStrip[stripOffset + istrip] = iplate;
+      mStripInPlate[stripOffset + istrip] = istrip;
+    }
+  }
+
   mToBeIntit = kFALSE;
 }
 
+void Geo::initPadPositions()
+{
+  mPadPositions.assign(3 * NCHANNELS, 0.);
+  mPadInGeometry.assign(NCHANNELS, kFALSE);
+  if (!gGeoManager) {
+    LOG(ERROR) << "tof::Geo::initPadPositions: no TGeo, no pad position is available" << FairLogger::endl;
+    return;
+  }
+  Int_t det[5], nMissing = 0;
+  Char_t path[200];
+  for (Int_t index = 0; index < NCHANNELS; index++) {
+    getVolumeIndices(index, det);
+    getVolumePath(det, path);
+    // the strips in front of the PHOS holes are not in the geometry
+    if (!gGeoManager->CheckPath(path)) {
+      nMissing++;
+      continue;
+    }
+    gGeoManager->cd(path);
+    const Double_t* tr = gGeoManager->GetCurrentMatrix()->GetTranslation();
+    for (Int_t ii = 0; ii < 3; ii++)
+      mPadPositions[3 * index + ii] = tr[ii];
+    mPadInGeometry[index] = kTRUE;
+  }
+  LOG(INFO) << "tof::Geo: tabulated the positions of " << NCHANNELS - nMissing << " pads, " << nMissing
+            << " pads not in the geometry" << FairLogger::endl;
+}
+
 void Geo::getVolumePath(const Int_t* ind, Char_t* path)
 {
   //--------------------------------------------------------------------
@@ -148,25 +272,60 @@ void Geo::getVolumePath(const Int_t* ind, Char_t* path)
   snprintf(path, 2 * kSize, "%s/%s/%s", string1, string2, string3);
 }
 
-void Geo::getPos(Int_t* det, Float_t* pos)
+Bool_t Geo::getPos(const Int_t* det, Float_t* pos)
 {
   //
   // Returns space point coor (x,y,z) (cm)  for Detector
   // Indices  (iSect,iPlate,iStrip,iPadX,iPadZ)
   //
-  Char_t path[200];
-  getVolumePath(det, path);
-  if (!gGeoManager) {
-    printf("ERROR: no TGeo\n");
+  if (det[0] >= 0 && det[0] < NSECTORS && det[1] >= 0 && det[1] < NPLATES && det[2] >= 0 &&
+      det[2] < getNStrips(det[1]) && det[3] >= 0 && det[3] < NPADZ && det[4] >= 0 && det[4] < NPADX) {
+    return getPosFromIndex(getIndex(det), pos);
+  }
+  LOG(ERROR) << "tof::Geo::getPos: invalid pad " << det[0] << " " << det[1] << " " << det[2] << " " << det[3]
+             << " " << det[4] << FairLogger::endl;
+  pos[0] = pos[1] = pos[2] = 0.;
+  return kFALSE;
+}
+
+Bool_t Geo::getPosFromIndex(Int_t index, Float_t* pos)
+{
+  std::call_once(padPositionsInit, initPadPositions);
+  if (index < 0 || index >= NCHANNELS || !mPadInGeometry[index]) {
+    pos[0] = pos[1] = pos[2] = 0.;
+    return kFALSE;
+  }
+  const Float_t* tabulated = &mPadPositions[3 * index];
+  pos[0] = tabulated[0];
+  pos[1] = tabulated[1];
+  pos[2] = tabulated[2];
+  return kTRUE;
+}
+
+Bool_t Geo::getPos(Int_t n, const Int_t* index, Float_t* pos)
+{
+  Bool_t allFound = kTRUE;
+  for (Int_t i = 0; i < n; i++) {
+    if (!getPosFromIndex(index[i], pos + 3 * i))
+      allFound = kFALSE;
   }
-  gGeoManager->cd(path);
-  TGeoHMatrix global;
-  global = *gGeoManager->GetCurrentMatrix();
-  const Double_t* tr = global.GetTranslation();
-
-  pos[0] = tr[0];
-  pos[1] = tr[1];
-  pos[2] = tr[2];
+  return allFound;
+}
+
+void Geo::getDetID(Int_t n, const Float_t* pos, Int_t* det)
+{
+  if (mToBeIntit)
+    Init();
+  for (Int_t i = 0; i < n; i++) {
+    Float_t posLocal[3] = { pos[3 * i], pos[3 * i + 1], pos[3 * i + 2] };
+    getDetID(posLocal, det + 5 * i);
+  }
+}
+
+void Geo::getVolumeIndices(Int_t n, const Int_t* index, Int_t* detId)
+{
+  for (Int_t i = 0; i < n; i++)
+    getVolumeIndices(index[i], detId + 5 * i);
 }
 
 void Geo::getDetID(Float_t* pos, Int_t* det)
@@ -199,31 +358,18 @@ void Geo::getVolumeIndices(Int_t index, Int_t *detId)
   //
   // Retrieve volume indices from the calibration channel index 
   //
+  if (mToBeIntit)
+    Init();
+
   Int_t npadxstrip = NPADX*NPADZ;
 
   detId[0] = index/npadxstrip/NSTRIPXSECTOR;
 
   Int_t dummyStripPerModule = 
     ( index - ( NSTRIPXSECTOR*npadxstrip*detId[0]) ) / npadxstrip;
-  if (dummyStripPerModule<NSTRIPC) {
-    detId[1] = 0;
-    detId[2] = dummyStripPerModule;
-  }
-  else if (dummyStripPerModule>=NSTRIPC && dummyStripPerModule<NSTRIPC+NSTRIPB) {
-    detId[1] = 1;
-    detId[2] = dummyStripPerModule-NSTRIPC;
-  }
-  else if (dummyStripPerModule>=NSTRIPC+NSTRIPB && dummyStripPerModule<NSTRIPC+NSTRIPB+NSTRIPA) {
-    detId[1] = 2;
-    detId[2] = dummyStripPerModule-NSTRIPC-NSTRIPB;
-  }
-  else if (dummyStripPerModule>=NSTRIPC+NSTRIPB+NSTRIPA && dummyStripPerModule<NSTRIPC+NSTRIPB+NSTRIPA+NSTRIPB) {
-    detId[1] = 3;
-    detId[2] = dummyStripPerModule-NSTRIPC-NSTRIPB-NSTRIPA;
-  }
-  else if (dummyStripPerModule>=NSTRIPC+NSTRIPB+NSTRIPA+NSTRIPB && dummyStripPerModule<NSTRIPXSECTOR) {
-    detId[1] = 4;
-    detId[2] = dummyStripPerModule-NSTRIPC-NSTRIPB-NSTRIPA-NSTRIPB;
+  if (dummyStripPerModule >= 0 && dummyStripPerModule < NSTRIPXSECTOR) {
+    detId[1] = mPlateOfStrip[dummyStripPerModule];
+    detId[2] = mStripInPlate[dummyStripPerModule];
   }
 
   Int_t padPerStrip = ( index - ( NSTRIPXSECTOR*npadxstrip*detId[0]) ) - dummyStripPerModule*npadxstrip;
@@ -325,14 +471,12 @@ void Geo::fromGlobalToSector(Float_t* pos, Int_t isector)
     return;
   }
 
-  // ALICE reference frame -> B071/B074/B075 = BTO1/2/3 reference frame
-  rotateToSector(pos, isector);
-
-  Float_t step[3] = { 0., 0., static_cast<Float_t>((RMAX + RMIN) * 0.5) };
-  translate(pos, step);
-
-  // B071/B074/B075 = BTO1/2/3 reference frame -> FTOA = FLTA reference frame
-  rotateToSector(pos, NSECTORS);
+  // ALICE reference frame -> B071/B074/B075 = BTO1/2/3 reference frame -> FTOA = FLTA reference frame
+  const Float_t(*rotation)[3] = mRotationMatrixGlobalToPlate[isector];
+  const Float_t* translation = mTranslationGlobalToPlate[isector];
+  Float_t xyz[3] = { pos[0], pos[1], pos[2] };
+  for (Int_t ii = 0; ii < 3; ii++)
+    pos[ii] = xyz[0] * rotation[ii][0] + xyz[1] * rotation[ii][1] + xyz[2] * rotation[ii][2] - translation[ii];
 }
 
 Int_t Geo::fromPlateToStrip(Float_t* pos, Int_t iplate)
@@ -341,34 +485,19 @@ Int_t Geo::fromPlateToStrip(Float_t* pos, Int_t iplate)
     return -1;
   }
 
-  Int_t nstrips = 0;
-  switch (iplate) {
-    case 0:
-    case 4:
-      nstrips = NSTRIPC;
-      break;
-    case 1:
-    case 3:
-      nstrips = NSTRIPB;
-      break;
-    case 2:
-      nstrips = NSTRIPA;
-      break;
-  }
-
-  constexpr Float_t HGLFY = HFILIY + 2 * HGLASSY; // heigth of GLASS+FISHLINE  Layer
-  constexpr Float_t HSTRIPY = 2. * HHONY + 2. * HPCBY + 4. * HRGLY + 2. * HGLFY + HCPCBY; // 3.11
+  // only the strips overlapping the z bin of the point are tested, in increasing order
+  Int_t zbin = static_cast<Int_t>((pos[2] + ZLENA * 0.5) / STRIPZBINWIDTH);
+  zbin = std::max(0, std::min(NSTRIPZBINS - 1, zbin));
+  const Short_t* candidates = mStripCandidates[iplate][zbin];
 
   Float_t step[3];
 
   // FTOA/B/C = FLTA/B/C reference frame -> FSTR reference frame
-  for (Int_t istrip = 0; istrip < nstrips; istrip++) {
+  for (Int_t icand = 0; icand < NMAXSTRIPCANDIDATES && candidates[icand] >= 0; icand++) {
+    Int_t istrip = candidates[icand];
     Float_t posLoc2[3] = { pos[0], pos[1], pos[2] };
 
-    step[0] = 0.;
-    step[1] = getHeights(iplate, istrip);
-    step[2] = -getDistances(iplate, istrip);
-    translate(posLoc2, step);
+    translate(posLoc2, mStripTranslation[iplate][istrip]);
 
     rotateToStrip(posLoc2, iplate, istrip);
 
@@ -0,0 +1,149 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTOFGeo.cxx
+/// \brief Compares the tabulated TOF pad positions with the positions navigated in the geometry
+
+#define BOOST_TEST_MODULE Test TOF Geo
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoMatrix.h"
+#include "TGeoMedium.h"
+#include "TGeoVolume.h"
+#include "TOFBase/Geo.h"
+
+namespace o2
+{
+namespace tof
+{
+namespace
+{
+/// Volume hierarchy with the node names of the TOF pad paths (see Geo::getVolumePath) for the sectors 0 and 13;
+/// sector 13 is in front of the PHOS hole, without the strips of the central plate
+void buildTestGeometry()
+{
+  auto geometry = new TGeoManager("tofGeoTest", "TOF pad paths");
+  auto medium = new TGeoMedium("vacuum", 1, new TGeoMaterial("vacuum", 0, 0, 0));
+  auto box = [medium](const std::string& name) { return gGeoManager->MakeBox(name.c_str(), medium, 500, 500, 500); };
+
+  auto pad = box("FPAD");
+  auto padRow = box("FSEZ");
+  for (Int_t padx = 0; padx < Geo::NPADX; padx++) {
+    padRow->AddNode(pad, padx + 1, new TGeoTranslation(2.5 * padx - 60., 0., 0.));
+  }
+  auto sensitive = box("FSEN");
+  for (Int_t padz = 0; padz < Geo::NPADZ; padz++) {
+    sensitive->AddNode(padRow, padz + 1, new TGeoTranslation(0., 0., 3.5 * padz - 1.75));
+  }
+  auto pcb = box("FPCB");
+  pcb->AddNode(sensitive, 1, new TGeoTranslation(0., 0.1, 0.));
+  auto strip = box("FSTR");
+  strip->AddNode(pcb, 1, new TGeoTranslation(0., -0.2, 0.));
+
+  // copy numbers of the strips of the plates C, B, A, B, C
+  const Int_t firstCopy[Geo::NPLATES + 1] = { 1, 1 + Geo::NSTRIPC, 1 + Geo::NSTRIPC + Geo::NSTRIPB,
+                                              1 + Geo::NSTRIPC + Geo::NSTRIPB + Geo::NSTRIPA,
+                                              1 + Geo::NSTRIPC + 2 * Geo::NSTRIPB + Geo::NSTRIPA,
+                                              1 + Geo::NSTRIPXSECTOR };
+  auto plates = [&](const char* name, Int_t firstPlate, Int_t lastPlate) {
+    auto module = box(std::string("FTO") + name);
+    auto layer = box(std::string("FLT") + name);
+    for (Int_t copy = firstCopy[firstPlate]; copy < firstCopy[lastPlate + 1]; copy++) {
+      layer->AddNode(strip, copy, new TGeoCombiTrans(0., 1. + 0.01 * copy, 7. * copy - 320.,
+                                                     new TGeoRotation("", 0., 0.2 * copy - 9., 0.)));
+    }
+    module->AddNode(layer, 0, new TGeoTranslation(0., 0.5, 0.));
+    return module;
+  };
+
+  auto cave = box("cave");
+  auto frame = box("B077");
+  cave->AddNode(frame, 1);
+  for (Int_t sector : { 0, 13 }) {
+    auto segment = box("BSEGMO" + std::to_string(sector));
+    auto tof = box("BTOF" + std::to_string(sector));
+    if (sector == 0) {
+      tof->AddNode(plates("A", 0, Geo::NPLATES - 1), 0);
+    } else {
+      tof->AddNode(plates("B", 0, 1), 0);
+      tof->AddNode(plates("C", 3, 4), 0);
+    }
+    segment->AddNode(tof, 1, new TGeoTranslation(0., 0., 1.5));
+    frame->AddNode(segment, 1, new TGeoCombiTrans(0., 380., 0., new TGeoRotation("", 20. * sector, 0., 0.)));
+  }
+  geometry->SetTopVolume(cave);
+  geometry->CloseGeometry();
+}
+}
+
+BOOST_AUTO_TEST_CASE(TOFGeo_padPositions)
+{
+  buildTestGeometry();
+
+  std::vector<Int_t> indices;
+  std::vector<Float_t> expected;
+  Int_t nFound = 0;
+  for (Int_t sector : { 0, 1, 13 }) {
+    for (Int_t plate = 0; plate < Geo::NPLATES; plate++) {
+      const Int_t nStrips = (plate == 2) ? Geo::NSTRIPA : (plate % 4 == 0 ? Geo::NSTRIPC : Geo::NSTRIPB);
+      for (Int_t strip : { 0, nStrips / 2, nStrips - 1 }) {
+        for (Int_t padz = 0; padz < Geo::NPADZ; padz++) {
+          for (Int_t padx : { 0, 17, Geo::NPADX - 1 }) {
+            Int_t det[5] = { sector, plate, strip, padz, padx };
+
+            // the computation the table replaces: navigation to the pad path
+            Char_t path[200];
+            Geo::getVolumePath(det, path);
+            const Bool_t inGeometry = gGeoManager->CheckPath(path);
+            BOOST_CHECK_EQUAL(inGeometry, sector == 0 || (sector == 13 && plate != 2));
+            Float_t navigated[3] = { 0., 0., 0. };
+            if (inGeometry) {
+              gGeoManager->cd(path);
+              const Double_t* tr = gGeoManager->GetCurrentMatrix()->GetTranslation();
+              for (Int_t i = 0; i < 3; i++) {
+                navigated[i] = tr[i];
+              }
+              nFound++;
+            }
+
+            Float_t pos[3];
+            BOOST_CHECK_EQUAL(Geo::getPos(det, pos), inGeometry);
+            for (Int_t i = 0; i < 3; i++) {
+              BOOST_CHECK_SMALL(pos[i] - navigated[i], 1e-3f);
+            }
+            indices.push_back(Geo::getIndex(det));
+            expected.insert(expected.end(), navigated, navigated + 3);
+          }
+        }
+      }
+    }
+  }
+  BOOST_CHECK(nFound > 0);
+
+  // the batched lookup reports the missing pads too
+  std::vector<Float_t> batched(3 * indices.size());
+  BOOST_CHECK(!Geo::getPos(Int_t(indices.size()), indices.data(), batched.data()));
+  for (size_t i = 0; i < batched.size(); i++) {
+    BOOST_CHECK_SMALL(batched[i] - expected[i], 1e-3f);
+  }
+
+  Float_t pos[3];
+  BOOST_CHECK(!Geo::getPosFromIndex(-1, pos));
+  BOOST_CHECK(!Geo::getPosFromIndex(Geo::NCHANNELS, pos));
+  Int_t invalid[5] = { 0, Geo::NPLATES, 0, 0, 0 };
+  BOOST_CHECK(!Geo::getPos(invalid, pos));
+}
+} // namespace tof
+} // namespace o2
@@ -15,14 +15,15 @@
 #include "DetectorsBase/Detector.h"   // for Detector
 #include "Rtypes.h"          // for Int_t, Double32_t, Double_t, Bool_t, etc
 #include "TLorentzVector.h"  // for TLorentzVector
-#include "TClonesArray.h"
 #include "TString.h"
-#include "FairLink.h"
 
 #include "TPCSimulation/Point.h"
 #include "TPCBase/Sector.h"
 
+#include <vector>
+
 class FairVolume;  // lines 10-10
+class TClonesArray;
 
 namespace o2 {
 namespace TPC {
@@ -63,14 +64,16 @@ class Detector: public o2::Base::Detector {
     /** Gets the produced collections */
     TClonesArray* GetCollection(Int_t iColl) const override ;
 
+    /** Replaces the particle indices of the hits by the indices of the stored tracks */
+    void updateHitTrackIndices(const std::function<int(int)>& getTrackIndex) override;
+
     /**      has to be called after each event to reset the containers      */
     void   Reset() override;
 
     /**      Create the detector geometry        */
     void ConstructGeometry() override;
 
-    /**      This method is an example of how to add your own point
-     *       of type DetectorPoint to the clones array
+    /**      Adds a point to the point collection (used without TPC_GROUPED_HITS)
     */
     Point* addHit(float x, float y, float z, float time, float nElectrons, float trackID, float detID);
     
@@ -97,8 +100,6 @@ class Detector: public o2::Base::Detector {
      *  any optional action in your detector during the transport.
     */
 
-    void   CopyClones( TClonesArray* cl1,  TClonesArray* cl2 ,
-                               Int_t offset) override {;}
     void   SetSpecialPhysicsCuts() override;// {;}
     void   EndOfEvent() override;
     void   FinishPrimary() override {;}
@@ -131,11 +132,15 @@ class Detector: public o2::Base::Detector {
     /** Define the sensitive volumes of the geometry */
     void DefineSensitiveVolumes();
 
-    /** container for data points */
-    TClonesArray*  mPointCollection;
-    TClonesArray*  mHitGroupCollection;    //! container that keeps track-grouped hits
-    TClonesArray*  mHitsPerSectorCollection[Sector::MAXSECTOR];
+    /// starts a new group of hits of the track in the sector, reusing a group of a previous event if any
+    HitGroup& newHitGroup(int sectorID, int trackID);
 
+    /** container for data points */
+    std::vector<Point>*    mPoints;                                     //! hits, when not grouped
+    std::vector<HitGroup>* mHitsPerSectorCollection[Sector::MAXSECTOR]; //! track-grouped hits of each sector
+    std::vector<HitGroup>  mSpareHitGroups;  //! groups of the previous events, kept for their memory
+    int mCurrentTrackID = -1;                //! track of the last hit group
+    int mCurrentSectorID = -1;               //! sector of the last hit group
     TString mGeoFileName;                  ///< Name of the file containing the TPC geometry
     size_t mEventNr;                       //!< current event number
 
@@ -150,11 +155,8 @@ class Detector: public o2::Base::Detector {
 inline
 Point* Detector::addHit(float x, float y, float z, float time, float nElectrons, float trackID, float detID)
 {
-  TClonesArray& clref = *mPointCollection;
-  Int_t size = clref.GetEntriesFast();
-  Point *point = new(clref[size]) Point(x, y, z, time, nElectrons, trackID, detID);
-  point->SetLink(FairLink(-1, mEventNr, mMCTrackBranchId, trackID));
-  return point;
+  mPoints->emplace_back(x, y, z, time, nElectrons, trackID, detID);
+  return &mPoints->back();
 }
 
 template<typename T>
@@ -22,13 +22,14 @@
 #include "TPCBase/ParameterGas.h"
 
 #include "TPCBase/Mapper.h"
+#include "TPCSimulation/Point.h"
 
 #include <cmath>
+#include <vector>
 
 using std::vector;
 
 class TTree;
-class TClonesArray;
 
 namespace o2 {
 namespace TPC {
@@ -71,7 +72,12 @@ class Digitizer {
     /// Steer conversion of points to digits
     /// \param points Container with TPC points
     /// \return digits container
-    DigitContainer *Process(TClonesArray *points);
+    DigitContainer *Process(const std::vector<Point> &points);
+
+    /// Steer conversion of the track-grouped hits of a sector to digits
+    /// \param hitGroups Container with the hit groups
+    /// \return digits container
+    DigitContainer *Process(const std::vector<HitGroup> &hitGroups);
 
     DigitContainer *getDigitContainer() const { return mDigitContainer; }
 
@@ -121,6 +127,16 @@ class Digitizer {
     Digitizer(const Digitizer &);
     Digitizer &operator=(const Digitizer &);
 
+    /// Drift, amplification and signal formation of the electrons of one hit
+    /// \param hit Hit, with the number of electrons as energy loss
+    /// \param MCTrackID MC track producing the hit
+    /// \param eventTime Time of the event in us
+    template <typename Hit>
+    void processHit(const Hit &hit, int MCTrackID, float eventTime);
+
+    /// Time of the current event in us
+    float getEventTime() const;
+
     DigitContainer          *mDigitContainer;   ///< Container for the Digits
 
     std::unique_ptr<TTree>  mDebugTreePRF;      ///< Output tree for the output after the PRF
@@ -20,10 +20,12 @@
 #include "FairTask.h"
 #include "FairLogger.h"
 #include "TPCSimulation/Digitizer.h"
+#include "TPCSimulation/Point.h"
 #include "TPCBase/Sector.h"
 #include "SimulationDataFormat/MCTruthContainer.h"
 
 #include <TClonesArray.h>
+#include <vector>
 
 namespace o2 {
 namespace TPC { 
@@ -74,7 +76,8 @@ class DigitizerTask : public FairTask{
     Digitizer           *mDigitizer;    ///< Digitization process
     DigitContainer      *mDigitContainer;
       
-    TClonesArray        *mPointsArray;  ///< Array of detector hits, passed to the digitization
+    const std::vector<Point> *mPointsArray; ///< Array of detector hits, passed to the digitization
+    std::vector<Point>  mPointsFromFile;    ///< Hits read from the external hit file
     TClonesArray        *mDigitsArray;  ///< Array of the Digits, passed from the digitization
     o2::dataformats::MCTruthContainer<o2::MCCompLabel> mMCTruthArray; ///< Array for MCTruth information associated to digits in mDigitsArrray. Passed from the digitization
     TClonesArray        *mDigitsDebugArray;  ///< Array of the Digits, for debugging purposes only, passed from the digitization
@@ -86,7 +89,7 @@ class DigitizerTask : public FairTask{
     bool                mDigitDebugOutput;    ///< Switch for the debug output of the DigitMC
     int                 mHitSector=-1; ///< which sector to treat
 
-    TClonesArray        *mSectorHitsArray[Sector::MAXSECTOR];
+    const std::vector<HitGroup> *mSectorHitsArray[Sector::MAXSECTOR]; ///< Track-grouped hits of each sector
 
     ClassDefOverride(DigitizerTask, 1);
 };
@@ -17,7 +17,7 @@
 #include <vector>
 
 // this decides if TPC hits are grouped into
-// a LinkableHitGroup container
+// HitGroup containers
 #define TPC_GROUPED_HITS 1
 
 namespace o2 {
@@ -50,145 +50,56 @@ class ElementalHit {
 
 // a higher order hit class encapsulating
 // a set of elemental hits belonging to the same trackid (and sector)
-// construct used to do less MC truth linking and to save memory
-// this hitcontainer is linkable with FairLinks,
-// and can be stored as element of a TClonesArray into a branch
-class LinkableHitGroup : public o2::BaseHit {
+// construct used to do less MC truth linking and to save memory;
+// it is a plain class stored in a std::vector per sector, with the hits as columns
+class HitGroup {
 public:
-  LinkableHitGroup() :
-#ifdef HIT_AOS
-  mHits()
-#else
-  mHitsXVctr(),
-  mHitsYVctr(),
-  mHitsZVctr(),
-  mHitsTVctr(),
-  mHitsEVctr(),
-  mHitsX(nullptr),
-  mHitsY(nullptr),
-  mHitsZ(nullptr),
-  mHitsT(nullptr),
-  mHitsE(nullptr),
-  mSize(0)
-#endif
-    {
-    }
-
-  LinkableHitGroup(int trackID) :
-#ifdef HIT_AOS
-  mHits()
-#else
-  mHitsXVctr(),
-  mHitsYVctr(),
-  mHitsZVctr(),
-  mHitsTVctr(),
-  mHitsEVctr(),
-  mHitsX(nullptr),
-  mHitsY(nullptr),
-  mHitsZ(nullptr),
-  mHitsT(nullptr),
-  mHitsE(nullptr),
-  mSize(0)
-#endif
-  {
-    SetTrackID(trackID);
-  }
+  HitGroup() = default; // for ROOT IO
+
+  HitGroup(int trackID) : mTrackID(trackID) {}
 
-  ~LinkableHitGroup() override = default;
+  int GetTrackID() const { return mTrackID; }
+  void setTrackID(int trackID) { mTrackID = trackID; }
 
   void addHit(float x, float y, float z, float time, short e) {
-#ifdef HIT_AOS
-    mHits.emplace_back(x,y,z,time,e);
-#else
-    mHitsXVctr.emplace_back(x);
-    mHitsYVctr.emplace_back(y);
-    mHitsZVctr.emplace_back(z);
-    mHitsTVctr.emplace_back(time);
-    mHitsEVctr.emplace_back(e);
-    mSize=mHitsXVctr.size();
-    mHitsX=&mHitsXVctr[0];
-    mHitsY=&mHitsYVctr[0];
-    mHitsZ=&mHitsZVctr[0];
-    mHitsT=&mHitsTVctr[0];
-    mHitsE=&mHitsEVctr[0];
-#endif
+    mHitsX.emplace_back(x);
+    mHitsY.emplace_back(y);
+    mHitsZ.emplace_back(z);
+    mHitsT.emplace_back(time);
+    mHitsE.emplace_back(e);
   }
 
   size_t getSize() const {
-#ifdef HIT_AOS
-    return mHits.size();
-#else
-    return mSize;
-#endif
+    return mHitsX.size();
   }
 
   ElementalHit getHit(size_t index) const {
-#ifdef HIT_AOS
-    // std::vector storage
-    return mHits[index];
-#else
     return ElementalHit(mHitsX[index],mHitsY[index],mHitsZ[index],mHitsT[index],mHitsE[index]);
-#endif
   }
 
-  // the Clear method of TObject
-  // called for instance from TClonesArray->Clear("C")
-  void Clear(Option_t */*option*/) override {
-#ifdef HIT_AOS
-    mHits.clear();
-#else
-    mHitsXVctr.clear();
-    mHitsYVctr.clear();
-    mHitsZVctr.clear();
-    mHitsTVctr.clear();
-    mHitsEVctr.clear();
-#endif
-    shrinkToFit();
-  }
-
-  void shrinkToFit() {
-    // shrink all the containers to have exactly the required size
-    // might improve overall memory consumption
-#ifdef HIT_AOS
-    // std::vector storage
-    mHits.shrink_to_fit();
-#else
-    mHitsXVctr.shrink_to_fit();
-    mHitsYVctr.shrink_to_fit();
-    mHitsZVctr.shrink_to_fit();
-    mHitsTVctr.shrink_to_fit();
-    mHitsEVctr.shrink_to_fit();
-    mHitsX=&mHitsXVctr[0];
-    mHitsY=&mHitsYVctr[0];
-    mHitsZ=&mHitsZVctr[0];
-    mHitsT=&mHitsTVctr[0];
-    mHitsE=&mHitsEVctr[0];
-    mSize=mHitsXVctr.size();
-#endif
+  // empties the group for a new track, keeping the allocated memory
+  void reset(int trackID) {
+    mTrackID = trackID;
+    mHitsX.clear();
+    mHitsY.clear();
+    mHitsZ.clear();
+    mHitsT.clear();
+    mHitsE.clear();
   }
 
   // in future we might want to have a method
   // FitAndCompress()
   // which does a track fit and produces a parametrized hit
   // (such as done in a similar form in AliRoot)
-public:
-#ifdef HIT_AOS
-  std::vector<o2::TPC::ElementalHit> mHits; // the hits for this group
-#else
-  std::vector<float> mHitsXVctr; //! do not stream this (just for memory handling convenience)
-  std::vector<float> mHitsYVctr; //! do not stream this
-  std::vector<float> mHitsZVctr; //! do not stream this
-  std::vector<float> mHitsTVctr; //! do not stream this
-  std::vector<short> mHitsEVctr; //! do not stream this
-  // let us stream ordinary buffers for compression AND ROOT IO/speed!!
-  Int_t mSize;
-  float* mHitsX = nullptr; //[mSize]
-  float* mHitsY = nullptr; //[mSize]
-  float* mHitsZ = nullptr; //[mSize]
-  float* mHitsT = nullptr; //[mSize]
-  short* mHitsE = nullptr; //[mSize]
-#endif
-  ClassDefOverride(LinkableHitGroup, 1);
+private:
+  int mTrackID = -1;
+  std::vector<float> mHitsX;
+  std::vector<float> mHitsY;
+  std::vector<float> mHitsZ;
+  std::vector<float> mHitsT;
+  std::vector<short> mHitsE;
+
+  ClassDefNV(HitGroup, 1);
 };
 
 class Point : public o2::BasicXYZEHit<float>
@@ -214,11 +125,6 @@ class Point : public o2::BasicXYZEHit<float>
     /// Output to screen
     void Print(const Option_t* opt) const override;
 
-  private:
-    /// Copy constructor
-    Point(const Point& point);
-    Point operator=(const Point& point);
-
   ClassDefOverride(o2::TPC::Point,1)
 };
 
@@ -16,7 +16,6 @@
 
 #include "FairVolume.h"         // for FairVolume
 
-#include "TClonesArray.h"       // for TClonesArray
 #include "TVirtualMC.h"         // for TVirtualMC, gMC
 
 #include <cstddef>             // for NULL
@@ -31,7 +30,6 @@
 #include "FairLogger.h"
 
 #include "TSystem.h"
-#include "TClonesArray.h"
 #include "TVirtualMC.h"
 
 #include "TFile.h"
@@ -65,44 +63,34 @@ using namespace o2::TPC;
 Detector::Detector()
   : o2::Base::Detector("TPC", kTRUE),
     mSimulationType(SimulationType::Other),
-    mPointCollection(new TClonesArray("o2::TPC::Point")),
-    mHitGroupCollection(new TClonesArray("o2::TPC::LinkableHitGroup")),
+    mPoints(new std::vector<Point>),
     mGeoFileName(),
     mEventNr(0)
 {
   for(int i=0;i<Sector::MAXSECTOR;++i){
-    mHitsPerSectorCollection[i]=new TClonesArray("o2::TPC::LinkableHitGroup");
-    mHitsPerSectorCollection[i]->BypassStreamer(true);
+    mHitsPerSectorCollection[i]=new std::vector<HitGroup>;
   }
 }
 
 Detector::Detector(Bool_t active)
   : o2::Base::Detector("TPC", active),
     mSimulationType(SimulationType::Other),
-    mPointCollection(new TClonesArray("o2::TPC::Point")),
-    mHitGroupCollection(new TClonesArray("o2::TPC::LinkableHitGroup")),
+    mPoints(new std::vector<Point>),
     mGeoFileName(),
     mEventNr(0)
 {
   for(int i=0;i<Sector::MAXSECTOR;++i){
-    mHitsPerSectorCollection[i]=new TClonesArray("o2::TPC::LinkableHitGroup");
-    mHitsPerSectorCollection[i]->BypassStreamer(true);
+    mHitsPerSectorCollection[i]=new std::vector<HitGroup>;
   }
 }
 
 
 Detector::~Detector()
 {
-  if (mPointCollection) {
-    mPointCollection->Delete();
-    delete mPointCollection;
-  }
-#ifdef TPC_GROUPED_HITS
+  delete mPoints;
   for(int i=0;i<Sector::MAXSECTOR;++i){
-    mHitsPerSectorCollection[i]->Delete();
     delete mHitsPerSectorCollection[i];
   }
-#endif
   std::cout << "Produced hits " << mHitCounter << "\n";
   std::cout << "Produced electrons " << mElectronCounter << "\n";
   std::cout << "Stepping called " << mStepCounter << "\n";
@@ -290,37 +278,13 @@ Bool_t  Detector::ProcessHits(FairVolume* vol)
   int sectorID = static_cast<int>(Sector::ToSector(position.X(), position.Y(), position.Z()));
 
 #ifdef TPC_GROUPED_HITS
-  static int oldTrackId = trackID;
-  static int oldDetId = detID;
-  static int groupCounter = 0;
-  static int oldSectorId = sectorID;
-
-  //  a new group is starting -> put it into the container
-  static LinkableHitGroup *currentgroup = nullptr;
-  if (groupCounter == 0) {
-    //TClonesArray& clref = *mHitGroupCollection;
-    TClonesArray& clref = *mHitsPerSectorCollection[sectorID];
-
-    // push-back in place
-    Int_t size = clref.GetEntriesFast();
-    currentgroup = new(clref[size]) LinkableHitGroup(trackID);
-
-    // set the MC truth link for this group
-    currentgroup->SetLink(FairLink(-1, mEventNr, mMCTrackBranchId, trackID)); 
-  }
-  if ( trackID == oldTrackId && oldSectorId == sectorID ){
-    groupCounter++;
-    mHitCounter++;
-    mElectronCounter+=nel;
-    currentgroup->addHit(position.X(), position.Y(), position.Z(), time, nel);
-  }
-  // finish group
-  else {
-    currentgroup->shrinkToFit();
-    oldTrackId = trackID;
-    oldSectorId = sectorID;
-    groupCounter = 0;
+  //  a new group is starting when the track or the sector changes
+  if (trackID != mCurrentTrackID || sectorID != mCurrentSectorID) {
+    newHitGroup(sectorID, trackID);
   }
+  mHitCounter++;
+  mElectronCounter+=nel;
+  mHitsPerSectorCollection[sectorID]->back().addHit(position.X(), position.Y(), position.Z(), time, nel);
 #else
   //  LOG(INFO) << "#" << position.X() << " " << position.Y() << " atan2 value: " << 180/(M_PI)*atan2(position.Y(), position.X()) << " S" << static_cast<int>(ToSector(position.X(), position.Y()))  << "\n";
   addHit(position.X(),  position.Y(),  position.Z(), time, nel, trackID, detID);
@@ -340,15 +304,25 @@ Bool_t  Detector::ProcessHits(FairVolume* vol)
   return kTRUE;
 }
   
-void Detector::EndOfEvent()
+HitGroup& Detector::newHitGroup(int sectorID, int trackID)
 {
-  mHitGroupCollection->Clear();
-  for(int i=0;i<Sector::MAXSECTOR;++i) {
-    // passing "C" since objects contain other pointer data
-    // which needs to be cleaned up
-    mHitsPerSectorCollection[i]->Clear("C");
+  auto& groups = *mHitsPerSectorCollection[sectorID];
+  if (mSpareHitGroups.empty()) {
+    groups.emplace_back(trackID);
+  }
+  else {
+    groups.emplace_back(std::move(mSpareHitGroups.back()));
+    mSpareHitGroups.pop_back();
+    groups.back().reset(trackID);
   }
-  mPointCollection->Clear();
+  mCurrentTrackID = trackID;
+  mCurrentSectorID = sectorID;
+  return groups.back();
+}
+
+void Detector::EndOfEvent()
+{
+  Reset();
   ++mEventNr;
 }
 
@@ -361,41 +335,48 @@ void Detector::Register()
   */
   auto *mgr=FairRootManager::Instance();
 #ifdef TPC_GROUPED_HITS
-  mgr->Register(addNameTo("GroupedHits").data(), GetName(), mHitGroupCollection, kTRUE);
   for (int i=0;i<Sector::MAXSECTOR;++i) {
     TString name;
     name.Form("%sHitsSector%d", GetName(), i);
-    mgr->Register(name.Data(), GetName(), mHitsPerSectorCollection[i], kTRUE);
+    mgr->RegisterAny(name.Data(), mHitsPerSectorCollection[i], kTRUE);
   }
 #else
-  mgr->Register(addNameTo("Point").data(), GetName(), mPointCollection, kTRUE);
+  mgr->RegisterAny(addNameTo("Point").data(), mPoints, kTRUE);
 #endif
   mMCTrackBranchId=mgr->GetBranchId("MCTrack");
 }
 
 TClonesArray* Detector::GetCollection(Int_t iColl) const
 {
-#ifdef TPC_GROUPED_HITS
-  if (iColl == 0) { return mHitGroupCollection; }
-  else if (iColl < 19) {
-    return mHitsPerSectorCollection[iColl-1];
+  LOG(WARNING) << "GetCollection interface no longer supported" << FairLogger::endl;
+  return nullptr;
+}
+
+void Detector::updateHitTrackIndices(const std::function<int(int)>& getTrackIndex)
+{
+  // the hits are not exposed through GetCollection, the stack remaps them here
+  for (int i = 0; i < Sector::MAXSECTOR; ++i) {
+    for (auto& group : *mHitsPerSectorCollection[i]) {
+      group.setTrackID(getTrackIndex(group.GetTrackID()));
+    }
+  }
+  for (auto& point : *mPoints) {
+    point.SetTrackID(getTrackIndex(point.GetTrackID()));
   }
-#else
-  if (iColl == 0) { return mPointCollection; }
-#endif
-  else { return nullptr; }
 }
 
 void Detector::Reset()
 {
-#ifdef TPC_GROUPED_HITS
-  mHitGroupCollection->Clear();
+  // the groups go back to the spare ones with their memory, the containers keep their capacity
   for(int i=0;i<Sector::MAXSECTOR;++i) {
-    mHitsPerSectorCollection[i]->Clear();
+    for (auto& group : *mHitsPerSectorCollection[i]) {
+      mSpareHitGroups.emplace_back(std::move(group));
+    }
+    mHitsPerSectorCollection[i]->clear();
   }
-#else
-  mPointCollection->Clear();
-#endif
+  mPoints->clear();
+  mCurrentTrackID = -1;
+  mCurrentSectorID = -1;
 }
 
 void Detector::ConstructGeometry()
@@ -12,7 +12,6 @@
 /// \brief Implementation of the ALICE TPC digitizer
 /// \author Andi Mathis, TU München, andreas.mathis@ph.tum.de
 
-#include <TClonesArray.h>
 #include "TPCSimulation/Digitizer.h"
 #include "TPCSimulation/ElectronTransport.h"
 #include "TPCSimulation/GEMAmplification.h"
@@ -23,6 +22,7 @@
 #include "TPCBase/Mapper.h"
 
 #include "FairLogger.h"
+#include "FairRootManager.h"
 
 ClassImp(o2::TPC::Digitizer)
 
@@ -51,15 +51,39 @@ void Digitizer::init()
 //  mDebugTreePRF->Branch("GEMresponse", &GEMresponse, "CRU:timeBin:row:pad:nElectrons");
 }
 
-DigitContainer *Digitizer::Process(TClonesArray *points)
+DigitContainer *Digitizer::Process(const std::vector<Point> &points)
+{
+  const float eventTime = getEventTime();
+  for(auto &point : points) {
+    processHit(point, point.GetTrackID(), eventTime);
+  }
+  return mDigitContainer;
+}
+
+DigitContainer *Digitizer::Process(const std::vector<HitGroup> &hitGroups)
+{
+  const float eventTime = getEventTime();
+  for(auto &inputgroup : hitGroups) {
+    const int MCTrackID = inputgroup.GetTrackID();
+    for(size_t hitindex = 0; hitindex<inputgroup.getSize(); ++hitindex){
+      processHit(inputgroup.getHit(hitindex), MCTrackID, eventTime);
+    }
+  }
+  return mDigitContainer;
+}
+
+float Digitizer::getEventTime() const
+{
+  FairRootManager *mgr = FairRootManager::Instance();
+  return ( mIsContinuous) ? mgr->GetEventTime() * 0.001 : 0.f; /// transform in us
+}
+
+template <typename Hit>
+void Digitizer::processHit(const Hit &hit, int MCTrackID, float eventTime)
 {
-//  mDigitContainer->reset();
   const static Mapper& mapper = Mapper::instance();
   const static ParameterDetector &detParam = ParameterDetector::defaultInstance();
   const static ParameterElectronics &eleParam = ParameterElectronics::defaultInstance();
-  FairRootManager *mgr = FairRootManager::Instance();
-
-  const float eventTime = ( mIsContinuous) ? mgr->GetEventTime() * 0.001 : 0.f; /// transform in us
 
   /// \todo static_thread for thread savety?
   static GEMAmplification gemAmplification;
@@ -70,96 +94,75 @@ DigitContainer *Digitizer::Process(TClonesArray *points)
   static std::vector<float> signalArray;
   signalArray.resize(nShapedPoints);
 
-  static size_t hitCounter=0;
-  for(auto pointObject : *points) {
-#ifdef TPC_GROUPED_HITS
-    auto *inputgroup = static_cast<LinkableHitGroup*>(pointObject);
-    const int MCTrackID = inputgroup->GetTrackID();
-    for(size_t hitindex = 0; hitindex<inputgroup->getSize(); ++hitindex){
-      ElementalHit eh = inputgroup->getHit(hitindex);
-      auto *inputpoint = &eh;
-#else
-    Point *inputpoint = static_cast<Point *>(pointObject);
-    const int MCTrackID = inputpoint->GetTrackID();
-#endif
-
-    const GlobalPosition3D posEle(inputpoint->GetX(), inputpoint->GetY(), inputpoint->GetZ());
-
-    // The energy loss stored is really nElectrons
-    const int nPrimaryElectrons = static_cast<int>(inputpoint->GetEnergyLoss());
-
-    /// Loop over electrons
-    /// \todo can be vectorized?
-    /// \todo split transport and signal formation in two separate loops?
-    for(int iEle=0; iEle < nPrimaryElectrons; ++iEle) {
-
-      /// Drift and Diffusion
-      const GlobalPosition3D posEleDiff = electronTransport.getElectronDrift(posEle);
-
-      /// \todo Time management in continuous mode (adding the time of the event?)
-      const float driftTime = getTime(posEleDiff.Z()) + inputpoint->GetTime() * 0.001; /// in us
-      const float absoluteTime = driftTime + eventTime;
-
-      /// Attachment
-      if(electronTransport.isElectronAttachment(driftTime)) continue;
-
-      /// Remove electrons that end up outside the active volume
-      /// \todo should go to mapper?
-      if(fabs(posEleDiff.Z()) > detParam.getTPClength()) continue;
-
-      const DigitPos digiPadPos = mapper.findDigitPosFromGlobalPosition(posEleDiff);
-      if(!digiPadPos.isValid()) continue;
-
-      const int nElectronsGEM = gemAmplification.getStackAmplification();
-      if ( nElectronsGEM ==0 ) continue;
-
-      /// Loop over all individual pads with signal due to pad response function
-      /// Currently the PRF is not applied yet due to some problems with the mapper
-      /// which results in most of the cases in a normalized pad response = 0
-      /// \todo Problems of the mapper to be fixed
-      /// \todo Mapper should provide a functionality which finds the adjacent pads of a given pad
-      // for(int ipad = -2; ipad<3; ++ipad) {
-      //   for(int irow = -2; irow<3; ++irow) {
-      //     PadPos padPos(digiPadPos.getPadPos().getRow() + irow, digiPadPos.getPadPos().getPad() + ipad);
-      //     DigitPos digiPos(digiPadPos.getCRU(), padPos);
-
-      DigitPos digiPos = digiPadPos;
-      if (!digiPos.isValid()) continue;
-      // const float normalizedPadResponse = padResponse.getPadResponse(posEleDiff, digiPos);
-
-      const float normalizedPadResponse = 1.f;
-      if (normalizedPadResponse <= 0) continue;
-      const int pad = digiPos.getPadPos().getPad();
-      const int row = digiPos.getPadPos().getRow();
-
-      if(mDebugFlagPRF) {
-        /// \todo Write out the debug output
-        GEMresponse.CRU = digiPos.getCRU().number();
-        GEMresponse.time = absoluteTime;
-        GEMresponse.row = row;
-        GEMresponse.pad = pad;
-        GEMresponse.nElectrons = nElectronsGEM * normalizedPadResponse;
-        //mDebugTreePRF->Fill();
-      }
-
-      const float ADCsignal = SAMPAProcessing::getADCvalue(nElectronsGEM * normalizedPadResponse);
-      SAMPAProcessing::getShapedSignal(ADCsignal, absoluteTime, signalArray);
-      for(float i=0; i<nShapedPoints; ++i) {
-        const float time = absoluteTime + i * eleParam.getZBinWidth();
-        mDigitContainer->addDigit(MCTrackID, digiPos.getCRU().number(), getTimeBinFromTime(time), row, pad, signalArray[i]);
-      }
-
-      // }
-      // }
-      /// end of loop over prf
+  const GlobalPosition3D posEle(hit.GetX(), hit.GetY(), hit.GetZ());
+
+  // The energy loss stored is really nElectrons
+  const int nPrimaryElectrons = static_cast<int>(hit.GetEnergyLoss());
+
+  /// Loop over electrons
+  /// \todo can be vectorized?
+  /// \todo split transport and signal formation in two separate loops?
+  for(int iEle=0; iEle < nPrimaryElectrons; ++iEle) {
+
+    /// Drift and Diffusion
+    const GlobalPosition3D posEleDiff = electronTransport.getElectronDrift(posEle);
+
+    /// \todo Time management in continuous mode (adding the time of the event?)
+    const float driftTime = getTime(posEleDiff.Z()) + hit.GetTime() * 0.001; /// in us
+    const float absoluteTime = driftTime + eventTime;
+
+    /// Attachment
+    if(electronTransport.isElectronAttachment(driftTime)) continue;
+
+    /// Remove electrons that end up outside the active volume
+    /// \todo should go to mapper?
+    if(fabs(posEleDiff.Z()) > detParam.getTPClength()) continue;
+
+    const DigitPos digiPadPos = mapper.findDigitPosFromGlobalPosition(posEleDiff);
+    if(!digiPadPos.isValid()) continue;
+
+    const int nElectronsGEM = gemAmplification.getStackAmplification();
+    if ( nElectronsGEM ==0 ) continue;
+
+    /// Loop over all individual pads with signal due to pad response function
+    /// Currently the PRF is not applied yet due to some problems with the mapper
+    /// which results in most of the cases in a normalized pad response = 0
+    /// \todo Problems of the mapper to be fixed
+    /// \todo Mapper should provide a functionality which finds the adjacent pads of a given pad
+    // for(int ipad = -2; ipad<3; ++ipad) {
+    //   for(int irow = -2; irow<3; ++irow) {
+    //     PadPos padPos(digiPadPos.getPadPos().getRow() + irow, digiPadPos.getPadPos().getPad() + ipad);
+    //     DigitPos digiPos(digiPadPos.getCRU(), padPos);
+
+    DigitPos digiPos = digiPadPos;
+    if (!digiPos.isValid()) continue;
+    // const float normalizedPadResponse = padResponse.getPadResponse(posEleDiff, digiPos);
+
+    const float normalizedPadResponse = 1.f;
+    if (normalizedPadResponse <= 0) continue;
+    const int pad = digiPos.getPadPos().getPad();
+    const int row = digiPos.getPadPos().getRow();
+
+    if(mDebugFlagPRF) {
+      /// \todo Write out the debug output
+      GEMresponse.CRU = digiPos.getCRU().number();
+      GEMresponse.time = absoluteTime;
+      GEMresponse.row = row;
+      GEMresponse.pad = pad;
+      GEMresponse.nElectrons = nElectronsGEM * normalizedPadResponse;
+      //mDebugTreePRF->Fill();
     }
-    /// end of loop over electrons
-    ++hitCounter;
-#ifdef TPC_GROUPED_HITS
+
+    const float ADCsignal = SAMPAProcessing::getADCvalue(nElectronsGEM * normalizedPadResponse);
+    SAMPAProcessing::getShapedSignal(ADCsignal, absoluteTime, signalArray);
+    for(float i=0; i<nShapedPoints; ++i) {
+      const float time = absoluteTime + i * eleParam.getZBinWidth();
+      mDigitContainer->addDigit(MCTrackID, digiPos.getCRU().number(), getTimeBinFromTime(time), row, pad, signalArray[i]);
     }
-#endif
-  }
-  /// end of loop over points
 
-  return mDigitContainer;
+    // }
+    // }
+    /// end of loop over prf
+  }
+  /// end of loop over electrons
 }
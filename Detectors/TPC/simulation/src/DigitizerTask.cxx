@@ -37,6 +37,7 @@ DigitizerTask::DigitizerTask(int sectorid)
     mDigitizer(nullptr),
     mDigitContainer(nullptr),
     mPointsArray(nullptr),
+    mPointsFromFile(),
     mDigitsArray(nullptr),
     mMCTruthArray(),
     mDigitsDebugArray(nullptr),
@@ -56,10 +57,6 @@ DigitizerTask::~DigitizerTask()
   delete mDigitizer;
   delete mDigitsArray;
   delete mDigitsDebugArray;
-  if (mHitFileName.size()) {
-    mPointsArray->Delete();
-    delete mPointsArray;
-  }
 
   //CALLGRIND_STOP_INSTRUMENTATION;
   //CALLGRIND_DUMP_STATS;
@@ -81,7 +78,7 @@ InitStatus DigitizerTask::Init()
     std::stringstream sectornamestr;
     sectornamestr << "TPCHitsSector" << mHitSector;
     LOG(INFO) << "FETCHING HITS FOR SECTOR " << mHitSector << "\n";
-    mSectorHitsArray[mHitSector] = dynamic_cast<TClonesArray *>(mgr->GetObject(sectornamestr.str().c_str()));
+    mSectorHitsArray[mHitSector] = mgr->InitObjectAs<const std::vector<HitGroup>*>(sectornamestr.str().c_str());
   }
   else {
     // in case we are treating all sectors
@@ -89,12 +86,12 @@ InitStatus DigitizerTask::Init()
       std::stringstream sectornamestr;
       sectornamestr << "TPCHitsSector" << s;
       LOG(INFO) << "FETCHING HITS FOR SECTOR " << s << "\n";
-      mSectorHitsArray[s] = dynamic_cast<TClonesArray *>(mgr->GetObject(sectornamestr.str().c_str()));
+      mSectorHitsArray[s] = mgr->InitObjectAs<const std::vector<HitGroup>*>(sectornamestr.str().c_str());
     }
   }
 #else
-  mPointsArray = dynamic_cast<TClonesArray *>(mgr->GetObject("TPCPoint")); //TODO: does mPointsArray need to be deleted?
-  if (!mPointsArray) {
+  mPointsArray = mgr->InitObjectAs<const std::vector<Point>*>("TPCPoint");
+  if (!mPointsArray && !mHitFileName.size()) {
     LOG(ERROR) << "TPC points not registered in the FairRootManager. Exiting ..." << FairLogger::endl;
     return kERROR;
   }
@@ -142,16 +139,20 @@ void DigitizerTask::Exec(Option_t *option)
     // treat all sectors
     for (int s=0; s<Sector::MAXSECTOR; ++s){
       LOG(DEBUG) << "Processing sector " << s << "\n";
-      mDigitContainer = mDigitizer->Process(mSectorHitsArray[s]);
+      if (mSectorHitsArray[s]) {
+        mDigitContainer = mDigitizer->Process(*mSectorHitsArray[s]);
+      }
     }
   }
   else {
     // treat only chosen sector
-    mDigitContainer = mDigitizer->Process(mSectorHitsArray[mHitSector]);
+    if (mSectorHitsArray[mHitSector]) {
+      mDigitContainer = mDigitizer->Process(*mSectorHitsArray[mHitSector]);
+    }
   }
 
 #else
-  mDigitContainer = mDigitizer->Process(mPointsArray);
+  mDigitContainer = mDigitizer->Process(*mPointsArray);
 #endif
   mDigitContainer->fillOutputContainer(mDigitsArray, mMCTruthArray, mDigitsDebugArray, eventTime, mIsContinuousReadout);
 }
@@ -193,14 +194,8 @@ void DigitizerTask::fillHitArrayFromFile()
   tIn->SetBranchAddress("fY",      &fY     );
   tIn->SetBranchAddress("fZ",      &fZ     );
 
-  if (eventNumber==0) {
-    mPointsArray = new TClonesArray("o2::TPC::Point");
-  }
-  else {
-    mPointsArray->Clear();
-  }
-
-  TClonesArray &dummy = *mPointsArray;
+  mPointsFromFile.clear();
+  mPointsArray = &mPointsFromFile;
 
 
 //   printf("%p: %d\n", tIn, tIn->GetEntries());
@@ -211,11 +206,10 @@ void DigitizerTask::fillHitArrayFromFile()
     if (fEvent>eventNumber) break;
 //     printf("Filling hit %d (event %d)\n", ihit, fEvent);
 
-    const int size = dummy.GetEntriesFast();
-    new(dummy[size]) Point(fX, fY, fZ, fTime, fQ, fTrack, 98);
+    mPointsFromFile.emplace_back(fX, fY, fZ, fTime, fQ, fTrack, 98);
   }
 
-  printf("Converted hits: %d\n", dummy.GetEntriesFast());
+  printf("Converted hits: %zu\n", mPointsFromFile.size());
   delete tIn;
   ++eventNumber;
 }
@@ -39,9 +39,11 @@
 #pragma link C++ class o2::TPC::HwFixedPoint+;
 #pragma link C++ class o2::TPC::PadResponse+;
 #pragma link C++ class o2::TPC::Point+;
+#pragma link C++ class std::vector<o2::TPC::Point>+;
 #pragma link C++ class o2::TPC::ElementalHit+;
 #pragma link C++ class std::vector<o2::TPC::ElementalHit>+;
-#pragma link C++ class o2::TPC::LinkableHitGroup+;
+#pragma link C++ class o2::TPC::HitGroup+;
+#pragma link C++ class std::vector<o2::TPC::HitGroup>+;
 #pragma link C++ class o2::TPC::SAMPAProcessing+;
 
 #pragma link C++ class std::vector<o2::TPC::Cluster>+;
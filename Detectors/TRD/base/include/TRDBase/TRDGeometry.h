@@ -13,6 +13,7 @@
 
 #include <string>
 #include <vector>
+#include "DetectorsBase/DetMatrixCache.h"
 
 class TGeoHMatrix;
 
@@ -22,21 +23,28 @@ namespace trd
 {
 class TRDPadPlane;
 
-class TRDGeometry
+class TRDGeometry : public o2::Base::DetMatrixCache
 {
  public:
   enum { kNlayer = 6, kNstack = 5, kNsector = 18, kNdet = 540, kNdets = 30 };
 
   TRDGeometry();
-  ~TRDGeometry();
+  ~TRDGeometry() override;
 
   void CreateGeometry(std::vector<int> const& idtmed);
   int IsVersion() { return 1; }
   bool IsHole(int la, int st, int se) const;
   bool IsOnBoundary(int det, float y, float z, float eps = 0.5) const;
   bool RotateBack(int det, const double* const loc, double* glb) const;
+  bool Rotate(int det, const double* const glb, double* loc) const;
+  // n points of chambers det[i]: loc[3*i+j] <-> glb[3*i+j]
+  void RotateBack(int n, const int* det, const double* loc, double* glb) const;
+  void Rotate(int n, const int* det, const double* glb, double* loc) const;
 
-  // bool           ChamberInGeometry(int det);
+  // Chamber (TGeo assembly UTxx) to global matrices in L2G, sector tracking frame (the local frame of RotateBack)
+  // to chamber and to global in T2L, T2G and T2GRot, for the kNdet chambers
+  void fillMatrixCache(int mask) override;
+  bool ChamberInGeometry(int det) const;
 
   void AssembleChamber(int ilayer, int istack);
   void CreateFrame(std::vector<int> const& idtmed);
@@ -203,11 +211,12 @@ class TRDGeometry
 
  private:
   std::vector<std::string> mSensitiveVolumeNames; //!< vector keeping track of sensitive TRD volumes
+  std::vector<bool> mChamberInGeometry;           //!< chambers found in TGeo by fillMatrixCache
 
   // helper function to create volumes and registering them automatically
   void createVolume(const char* name, const char* shape, int nmed, float* upar, int np);
 
-  ClassDefNV(TRDGeometry, 1) //  TRD geometry class
+  ClassDefOverride(TRDGeometry, 2) //  TRD geometry class
 };
 } // end namespace trd
 } // end namespace o2
@@ -172,6 +172,8 @@ class TRDPadPlane
   double mAnodeWireOffset; //  Distance of first anode wire from pad edge
 
  private:
+  int FindPadRow(double z, double offset) const;
+
   TRDPadPlane(const TRDPadPlane& p);
   TRDPadPlane& operator=(const TRDPadPlane& p);
 
@@ -9,6 +9,7 @@
 // or submit itself to any jurisdiction.
 
 #include <TGeoManager.h>
+#include <TGeoMatrix.h>
 #include <TGeoPhysicalNode.h>
 #include <TMath.h>
 #include <TVirtualMC.h>
@@ -16,11 +17,30 @@
 #include <FairLogger.h>
 //#include "AliAlignObjParams.h"
 
+#include "DetectorsBase/Utils.h"
 #include "TRDBase/TRDGeometry.h"
 #include "TRDBase/TRDPadPlane.h"
 
 using namespace o2::trd;
 
+namespace
+{
+// rotations of the sector frames (local frame of RotateBack) to the global frame
+struct SectorRotations {
+  double cos[TRDGeometry::kNsector];
+  double sin[TRDGeometry::kNsector];
+  SectorRotations()
+  {
+    for (int isector = 0; isector < TRDGeometry::kNsector; isector++) {
+      float phi = 2.0 * TMath::Pi() / (float)TRDGeometry::kNsector * ((float)isector + 0.5);
+      cos[isector] = TMath::Cos(phi);
+      sin[isector] = TMath::Sin(phi);
+    }
+  }
+};
+const SectorRotations sSectorRotations;
+}
+
 //_____________________________________________________________________________
 
 //
@@ -185,7 +205,7 @@ TObjArray* TRDGeometry::fgClusterMatrixArray = nullptr;
 std::vector<TRDPadPlane*>* TRDGeometry::fgPadPlaneArray;
 
 //_____________________________________________________________________________
-TRDGeometry::TRDGeometry()
+TRDGeometry::TRDGeometry() : DetMatrixCache(o2::Base::DetID::TRD)
 {
   //
   // TRDGeometry default constructor
@@ -2704,15 +2724,197 @@ bool TRDGeometry::RotateBack(int det, const double* const loc, double* glb) cons
   //
 
   int sector = GetSector(det);
-  float phi = 2.0 * TMath::Pi() / (float)fgkNsector * ((float)sector + 0.5);
+  double cs = sSectorRotations.cos[sector];
+  double sn = sSectorRotations.sin[sector];
 
-  glb[0] = loc[0] * TMath::Cos(phi) - loc[1] * TMath::Sin(phi);
-  glb[1] = loc[0] * TMath::Sin(phi) + loc[1] * TMath::Cos(phi);
+  glb[0] = loc[0] * cs - loc[1] * sn;
+  glb[1] = loc[0] * sn + loc[1] * cs;
   glb[2] = loc[2];
 
   return true;
 }
 
+//_____________________________________________________________________________
+bool TRDGeometry::Rotate(int det, const double* const glb, double* loc) const
+{
+  //
+  // Inverse of RotateBack: transforms the coordinates of the ALICE restframe <glb>
+  // into the local frame coordinates <loc> of a chamber
+  //
+
+  int sector = GetSector(det);
+  double cs = sSectorRotations.cos[sector];
+  double sn = sSectorRotations.sin[sector];
+
+  loc[0] = glb[0] * cs + glb[1] * sn;
+  loc[1] = -glb[0] * sn + glb[1] * cs;
+  loc[2] = glb[2];
+
+  return true;
+}
+
+//_____________________________________________________________________________
+void TRDGeometry::RotateBack(int n, const int* det, const double* loc, double* glb) const
+{
+  //
+  // RotateBack for n points, loc and glb must not overlap
+  //
+
+  for (int i = 0; i < n; i++) {
+    int sector = GetSector(det[i]);
+    double cs = sSectorRotations.cos[sector];
+    double sn = sSectorRotations.sin[sector];
+    const double* l = loc + 3 * i;
+    double* g = glb + 3 * i;
+    g[0] = l[0] * cs - l[1] * sn;
+    g[1] = l[0] * sn + l[1] * cs;
+    g[2] = l[2];
+  }
+}
+
+//_____________________________________________________________________________
+void TRDGeometry::Rotate(int n, const int* det, const double* glb, double* loc) const
+{
+  //
+  // Rotate for n points, glb and loc must not overlap
+  //
+
+  for (int i = 0; i < n; i++) {
+    int sector = GetSector(det[i]);
+    double cs = sSectorRotations.cos[sector];
+    double sn = sSectorRotations.sin[sector];
+    const double* g = glb + 3 * i;
+    double* l = loc + 3 * i;
+    l[0] = g[0] * cs + g[1] * sn;
+    l[1] = -g[0] * sn + g[1] * cs;
+    l[2] = g[2];
+  }
+}
+
+//_____________________________________________________________________________
+void TRDGeometry::fillMatrixCache(int mask)
+{
+  //
+  // Populates the matrix caches of the requested transformations for all chambers.
+  // The chamber matrices are taken from TGeo, the chambers not in the geometry
+  // (switched off super modules, holes) keep identity matrices
+  //
+
+  using o2::Base::TransformType;
+  using o2::Base::Utils::bit2Mask;
+
+  if (mSize < 1) {
+    setSize(kNdet);
+  }
+
+  bool needL2G = (mask & bit2Mask(TransformType::L2G)) && !getCacheL2G().isFilled();
+  bool needT2L = (mask & bit2Mask(TransformType::T2L)) && !getCacheT2L().isFilled();
+  bool needT2G = (mask & bit2Mask(TransformType::T2G)) && !getCacheT2G().isFilled();
+  bool needT2GRot = (mask & bit2Mask(TransformType::T2GRot)) && !getCacheT2GRot().isFilled();
+
+  // tracking (sector) frame to global
+  std::vector<TGeoHMatrix> t2g(kNdet);
+  for (int isector = 0; isector < kNsector; isector++) {
+    double cs = sSectorRotations.cos[isector];
+    double sn = sSectorRotations.sin[isector];
+    const double rotation[9] = { cs, -sn, 0., sn, cs, 0., 0., 0., 1. };
+    TGeoHMatrix rot;
+    rot.SetRotation(rotation);
+    for (int idet = 0; idet < kNlayer * kNstack; idet++) {
+      t2g[isector * kNlayer * kNstack + idet] = rot;
+    }
+  }
+
+  if (needL2G || needT2L) {
+    if (!gGeoManager) {
+      LOG(ERROR) << "TRD: no TGeo, cannot load the chamber matrices" << FairLogger::endl;
+      needL2G = needT2L = false;
+    }
+  }
+
+  if (needL2G || needT2L) {
+    LOG(INFO) << "Loading TRD chamber matrices from TGeo" << FairLogger::endl;
+    if (needL2G) {
+      getCacheL2G().setSize(kNdet);
+    }
+    if (needT2L) {
+      getCacheT2L().setSize(kNdet);
+    }
+    mChamberInGeometry.assign(kNdet, false);
+    const int kTag = 200;
+    char path[kTag];
+    int nMissing = 0;
+    for (int idet = 0; idet < kNdet; idet++) {
+      int isector = GetSector(idet);
+      int ism = 1; // super module type, see CreateGeometry
+      switch (isector) {
+        case 17:
+          ism = 4;
+          break;
+        case 13:
+        case 14:
+        case 15:
+          ism = 3;
+          break;
+        case 11:
+        case 12:
+          ism = 2;
+          break;
+      }
+      snprintf(path, kTag, "/cave_1/B077_1/BSEGMO%d_1/BTRD%d_1/UTR%d_1/UTS%d_1/UTI%d_1/UT%02d_1", isector, isector, ism,
+               ism, ism, GetDetectorSec(GetLayer(idet), GetStack(idet)));
+      if (!gGeoManager->CheckPath(path)) {
+        nMissing++;
+        continue;
+      }
+      gGeoManager->cd(path);
+      TGeoHMatrix l2g(*gGeoManager->GetCurrentMatrix());
+      mChamberInGeometry[idet] = true;
+      if (needL2G) {
+        getCacheL2G().setMatrix(Mat3D(l2g), idet);
+      }
+      if (needT2L) {
+        TGeoHMatrix t2l = l2g.Inverse();
+        t2l.Multiply(&t2g[idet]);
+        getCacheT2L().setMatrix(Mat3D(t2l), idet);
+      }
+    }
+    if (nMissing) {
+      LOG(INFO) << "TRD: " << nMissing << " chambers are not in the geometry" << FairLogger::endl;
+    }
+  }
+
+  if (needT2G) {
+    auto& cacheT2G = getCacheT2G();
+    cacheT2G.setSize(kNdet);
+    for (int idet = 0; idet < kNdet; idet++) {
+      cacheT2G.setMatrix(Mat3D(t2g[idet]), idet);
+    }
+  }
+
+  if (needT2GRot) {
+    auto& cacheT2GRot = getCacheT2GRot();
+    cacheT2GRot.setSize(kNdet);
+    for (int idet = 0; idet < kNdet; idet++) {
+      int isector = GetSector(idet);
+      cacheT2GRot.setMatrix(Rot2D(sSectorRotations.cos[isector], sSectorRotations.sin[isector]), idet);
+    }
+  }
+
+  fillMatrixCacheSoA(mask);
+}
+
+//_____________________________________________________________________________
+bool TRDGeometry::ChamberInGeometry(int det) const
+{
+  //
+  // Checks whether the given detector is part of the current geometry,
+  // valid after fillMatrixCache was called for L2G or T2L
+  //
+
+  return det >= 0 && det < (int)mChamberInGeometry.size() && mChamberInGeometry[det];
+}
+
 //_____________________________________________________________________________
 int TRDGeometry::GetDetectorSec(int layer, int stack)
 {
@@ -2978,23 +3180,6 @@ TGeoHMatrix *TRDGeometry::GetClusterMatrix(int det)
 }
 */
 
-/*
-//_____________________________________________________________________________
-bool TRDGeometry::ChamberInGeometry(int det)
-{
-  //
-  // Checks whether the given detector is part of the current geometry
-  //
-
-  if (!GetClusterMatrix(det)) {
-    return false;
-  }
-  else {
-    return true;
-  }
-
-}
-*/
 
 //_____________________________________________________________________________
 bool TRDGeometry::IsHole(int /*la*/, int st, int se) const
@@ -23,6 +23,7 @@
 
 #include "TRDBase/TRDPadPlane.h"
 #include <TMath.h>
+#include <algorithm>
 
 using namespace o2::trd;
 
@@ -167,38 +168,39 @@ void TRDPadPlane::SetTiltingAngle(double t)
 }
 
 //_____________________________________________________________________________
-int TRDPadPlane::GetPadRowNumber(double z) const
+int TRDPadPlane::FindPadRow(double z, double offset) const
 {
   //
-  // Finds the pad row number for a given z-position in local supermodule system
+  // Last row with its border (shifted by offset) above z, for z in the pad plane.
+  // The row is guessed from the inner pad pitch and corrected on the borders
   //
 
   int row = 0;
-  int nabove = 0;
-  int nbelow = 0;
-  int middle = 0;
+  double pitch = mLengthIPad + mRowSpacing;
+  if ((mNrows > 1) && (pitch > 0)) {
+    row = 1 + (int)((mPadRow[1] + offset - z) / pitch);
+    row = std::max(0, std::min(mNrows - 1, row));
+  }
+  while ((row + 1 < mNrows) && (z <= (mPadRow[row + 1] + offset))) {
+    row++;
+  }
+  while ((row > 0) && (z > (mPadRow[row] + offset))) {
+    row--;
+  }
+  return row;
+}
+
+//_____________________________________________________________________________
+int TRDPadPlane::GetPadRowNumber(double z) const
+{
+  //
+  // Finds the pad row number for a given z-position in local supermodule system
+  //
 
   if ((z > GetRow0()) || (z < GetRowEnd())) {
-    row = -1;
-
-  } else {
-    nabove = mNrows + 1;
-    nbelow = 0;
-    while (nabove - nbelow > 1) {
-      middle = (nabove + nbelow) / 2;
-      if (z == (mPadRow[middle - 1] + mPadRowSMOffset)) {
-        row = middle;
-      }
-      if (z > (mPadRow[middle - 1] + mPadRowSMOffset)) {
-        nabove = middle;
-      } else {
-        nbelow = middle;
-      }
-    }
-    row = nbelow - 1;
+    return -1;
   }
-
-  return row;
+  return FindPadRow(z, mPadRowSMOffset);
 }
 
 //_____________________________________________________________________________
@@ -208,66 +210,36 @@ int TRDPadPlane::GetPadRowNumberROC(double z) const
   // Finds the pad row number for a given z-position in local ROC system
   //
 
-  int row = 0;
-  int nabove = 0;
-  int nbelow = 0;
-  int middle = 0;
-
   if ((z > GetRow0ROC()) || (z < GetRowEndROC())) {
-    row = -1;
-
-  } else {
-    nabove = mNrows + 1;
-    nbelow = 0;
-    while (nabove - nbelow > 1) {
-      middle = (nabove + nbelow) / 2;
-      if (z == mPadRow[middle - 1]) {
-        row = middle;
-      }
-      if (z > mPadRow[middle - 1]) {
-        nabove = middle;
-      } else {
-        nbelow = middle;
-      }
-    }
-    row = nbelow - 1;
+    return -1;
   }
-
-  return row;
+  return FindPadRow(z, 0.0);
 }
 
 //_____________________________________________________________________________
 int TRDPadPlane::GetPadColNumber(double rphi) const
 {
   //
-  // Finds the pad column number for a given rphi-position
+  // Finds the pad column number for a given rphi-position.
+  // The column is guessed from the inner pad pitch and corrected on the borders
   //
 
-  int col = 0;
-  int nabove = 0;
-  int nbelow = 0;
-  int middle = 0;
-
   if ((rphi < GetCol0()) || (rphi > GetColEnd())) {
-    col = -1;
-
-  } else {
-    nabove = mNcols;
-    nbelow = 0;
-    while (nabove - nbelow > 1) {
-      middle = (nabove + nbelow) / 2;
-      if (rphi == mPadCol[middle]) {
-        col = middle;
-      }
-      if (rphi > mPadCol[middle]) {
-        nbelow = middle;
-      } else {
-        nabove = middle;
-      }
-    }
-    col = nbelow;
+    return -1;
   }
 
+  int col = 0;
+  double pitch = mWidthIPad + mColSpacing;
+  if ((mNcols > 1) && (pitch > 0)) {
+    col = 1 + (int)((rphi - mPadCol[1]) / pitch);
+    col = std::max(0, std::min(mNcols - 1, col));
+  }
+  while ((col + 1 < mNcols) && (rphi > mPadCol[col + 1])) {
+    col++;
+  }
+  while ((col > 0) && (rphi <= mPadCol[col])) {
+    col--;
+  }
   return col;
 }
 
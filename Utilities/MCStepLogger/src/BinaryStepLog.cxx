@@ -0,0 +1,398 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//  @file   BinaryStepLog.cxx
+//  @brief  fixed-size binary step records, their asynchronous writer and the offline reader
+
+#include <BinaryStepLog.h>
+#include <TMCProcess.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+namespace o2
+{
+namespace
+{
+// applies f to the member pointer of each column, in the order of the file
+template <typename F>
+void forEachColumn(F&& f)
+{
+  f(&BinaryStepRecord::stepid);
+  f(&BinaryStepRecord::trackID);
+  f(&BinaryStepRecord::pdg);
+  f(&BinaryStepRecord::volId);
+  f(&BinaryStepRecord::copyNo);
+  f(&BinaryStepRecord::x);
+  f(&BinaryStepRecord::y);
+  f(&BinaryStepRecord::z);
+  f(&BinaryStepRecord::E);
+  f(&BinaryStepRecord::step);
+  f(&BinaryStepRecord::nsecondaries);
+  f(&BinaryStepRecord::kind);
+  f(&BinaryStepRecord::stopped);
+  f(&BinaryStepRecord::secondaryprocesses);
+}
+
+void appendString(std::string& payload, std::string const& s)
+{
+  uint32_t length = s.size();
+  payload.append(reinterpret_cast<const char*>(&length), sizeof(length));
+  payload.append(s);
+}
+
+bool readString(const char*& pos, const char* end, std::string& s)
+{
+  uint32_t length;
+  if (end - pos < long(sizeof(length))) {
+    return false;
+  }
+  std::memcpy(&length, pos, sizeof(length));
+  pos += sizeof(length);
+  if (end - pos < long(length)) {
+    return false;
+  }
+  s.assign(pos, length);
+  pos += length;
+  return true;
+}
+
+const std::string kUnknown = "UNKNOWN";
+}
+
+BinaryStepWriter::BinaryStepWriter(std::string const& filename,
+                                   std::vector<std::pair<std::string, std::string>> const& volumes)
+  : mOut(filename, std::ios::binary | std::ios::trunc), mId(sInstances++)
+{
+  if (!mOut.is_open()) {
+    std::cerr << "[MCLOGGER:] CANNOT OPEN " << filename << "\n";
+    return;
+  }
+  mOut.write(kBinaryStepLogMagic, sizeof(kBinaryStepLogMagic));
+  std::string payload;
+  for (size_t id = 0; id < volumes.size(); ++id) {
+    uint32_t volId = id;
+    payload.append(reinterpret_cast<const char*>(&volId), sizeof(volId));
+    appendString(payload, volumes[id].first);
+    appendString(payload, volumes[id].second);
+  }
+  writeChunk(BinaryStepChunkHeader::kVolumes, volumes.size(), payload);
+  mGood = mOut.good();
+  mPending.reserve(kChunkSize);
+  mThread = std::thread(&BinaryStepWriter::run, this);
+}
+
+constexpr int BinaryStepRecord::kMaxSecondaryProcesses;
+constexpr size_t BinaryStepWriter::kRingSize;
+constexpr size_t BinaryStepWriter::kChunkSize;
+std::atomic<int> BinaryStepWriter::sInstances{ 0 };
+
+BinaryStepWriter::~BinaryStepWriter()
+{
+  if (mThread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStop = true;
+    }
+    mCondition.notify_one();
+    mThread.join();
+  }
+}
+
+BinaryStepWriter::Ring* BinaryStepWriter::threadRing()
+{
+  // the ring is registered once per thread and writer; the writer keeps it alive
+  thread_local int owner = -1;
+  thread_local Ring* ring = nullptr;
+  if (owner != mId) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRings.emplace_back(new Ring);
+    ring = mRings.back().get();
+    owner = mId;
+  }
+  return ring;
+}
+
+void BinaryStepWriter::push(BinaryStepRecord const& record)
+{
+  Ring* ring = threadRing();
+  size_t head = ring->head.load(std::memory_order_relaxed);
+  while (head - ring->tail.load(std::memory_order_acquire) >= kRingSize) {
+    std::this_thread::yield(); // the writer thread is behind
+  }
+  ring->buffer[head & (kRingSize - 1)] = record;
+  ring->head.store(head + 1, std::memory_order_release);
+}
+
+void BinaryStepWriter::endEvent()
+{
+  {
+    // the records pushed after this call belong to the next event
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEndOfEvents.emplace_back(ringHeads());
+  }
+  mCondition.notify_one();
+}
+
+std::vector<size_t> BinaryStepWriter::ringHeads() const
+{
+  std::vector<size_t> heads;
+  for (auto& ring : mRings) {
+    heads.push_back(ring->head.load(std::memory_order_acquire));
+  }
+  return heads;
+}
+
+void BinaryStepWriter::drainRings(std::vector<size_t> const& heads)
+{
+  std::vector<Ring*> rings;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto& ring : mRings) {
+      rings.push_back(ring.get());
+    }
+  }
+  // the rings registered after the snapshot of the heads are drained at the next call
+  for (size_t i = 0; i < heads.size(); ++i) {
+    auto ring = rings[i];
+    size_t tail = ring->tail.load(std::memory_order_relaxed);
+    size_t head = heads[i];
+    for (; tail != head; ++tail) {
+      mPending.push_back(ring->buffer[tail & (kRingSize - 1)]);
+      if (mPending.size() == kChunkSize) {
+        ring->tail.store(tail + 1, std::memory_order_release);
+        writeRecords();
+      }
+    }
+    ring->tail.store(tail, std::memory_order_release);
+  }
+}
+
+void BinaryStepWriter::run()
+{
+  while (true) {
+    std::vector<std::vector<size_t>> endOfEvents;
+    std::vector<size_t> heads;
+    bool stop = false;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      // the producers are polled to keep the notification out of the stepping
+      mCondition.wait_for(lock, std::chrono::milliseconds(2), [this] { return mStop || !mEndOfEvents.empty(); });
+      std::swap(endOfEvents, mEndOfEvents);
+      // the later ends of event see at least these heads, hence the drain does not cross them
+      heads = ringHeads();
+      stop = mStop;
+    }
+    for (auto const& eventHeads : endOfEvents) {
+      drainRings(eventHeads);
+      writeRecords();
+      writeChunk(BinaryStepChunkHeader::kEndOfEvent, 0, std::string());
+    }
+    drainRings(heads);
+    if (stop || mPending.size() >= kChunkSize / 2) {
+      writeRecords();
+    }
+    if (!endOfEvents.empty() || stop) {
+      mOut.flush();
+    }
+    if (stop) {
+      break;
+    }
+  }
+}
+
+void BinaryStepWriter::writeRecords()
+{
+  if (mPending.empty()) {
+    return;
+  }
+  mColumns.clear();
+  forEachColumn([this](auto member) {
+    using T = std::remove_reference_t<decltype(std::declval<BinaryStepRecord&>().*member)>;
+    for (auto const& record : mPending) {
+      mColumns.append(reinterpret_cast<const char*>(&(record.*member)), sizeof(T));
+    }
+  });
+  writeChunk(BinaryStepChunkHeader::kRecords, mPending.size(), mColumns);
+  mPending.clear();
+}
+
+void BinaryStepWriter::writeChunk(BinaryStepChunkHeader::Type type, uint32_t nEntries, std::string const& payload)
+{
+  BinaryStepChunkHeader header;
+  header.type = type;
+  header.nEntries = nEntries;
+  header.size = payload.size();
+  mOut.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  mOut.write(payload.data(), payload.size());
+  if (!mOut.good() && mGood) {
+    std::cerr << "[MCLOGGER:] FAILED TO WRITE STEP RECORDS\n";
+    mGood = false;
+  }
+}
+
+BinaryStepReader::BinaryStepReader(std::string const& filename) : mIn(filename, std::ios::binary)
+{
+  char magic[sizeof(kBinaryStepLogMagic)];
+  if (!mIn.read(magic, sizeof(magic)) || std::memcmp(magic, kBinaryStepLogMagic, sizeof(magic)) != 0) {
+    std::cerr << "[MCLOGGER:] " << filename << " IS NOT A BINARY STEP LOG\n";
+    return;
+  }
+  mGood = true;
+}
+
+bool BinaryStepReader::nextEvent(std::vector<BinaryStepRecord>& records)
+{
+  records.clear();
+  BinaryStepChunkHeader header;
+  bool hasData = false;
+  while (mGood && mIn.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    switch (header.type) {
+      case BinaryStepChunkHeader::kVolumes:
+        mGood = readVolumes(header.nEntries, header.size);
+        break;
+      case BinaryStepChunkHeader::kRecords:
+        mGood = readRecords(header.nEntries, header.size, records);
+        hasData = true;
+        break;
+      case BinaryStepChunkHeader::kEndOfEvent:
+        return true;
+      default:
+        std::cerr << "[MCLOGGER:] UNKNOWN CHUNK TYPE " << header.type << "\n";
+        mGood = false;
+    }
+  }
+  // records of an unfinished event
+  return mGood && hasData;
+}
+
+bool BinaryStepReader::readVolumes(uint32_t nEntries, uint64_t size)
+{
+  std::string payload(size, '\0');
+  if (!mIn.read(&payload[0], size)) {
+    return false;
+  }
+  const char *pos = payload.data(), *end = pos + size;
+  for (uint32_t i = 0; i < nEntries; ++i) {
+    uint32_t volId;
+    std::string volName, moduleName;
+    if (end - pos < long(sizeof(volId))) {
+      return false;
+    }
+    std::memcpy(&volId, pos, sizeof(volId));
+    pos += sizeof(volId);
+    if (!readString(pos, end, volName) || !readString(pos, end, moduleName)) {
+      return false;
+    }
+    if (volId >= mVolumeNames.size()) {
+      mVolumeNames.resize(volId + 1);
+      mModuleNames.resize(volId + 1);
+    }
+    mVolumeNames[volId] = volName;
+    mModuleNames[volId] = moduleName;
+  }
+  return true;
+}
+
+bool BinaryStepReader::readRecords(uint32_t nEntries, uint64_t size, std::vector<BinaryStepRecord>& records)
+{
+  std::string payload(size, '\0');
+  if (!mIn.read(&payload[0], size)) {
+    return false;
+  }
+  size_t first = records.size(), offset = 0;
+  records.resize(first + nEntries);
+  bool ok = true;
+  forEachColumn([&](auto member) {
+    using T = std::remove_reference_t<decltype(std::declval<BinaryStepRecord&>().*member)>;
+    if (!ok || offset + nEntries * sizeof(T) > size) {
+      ok = false;
+      return;
+    }
+    for (uint32_t i = 0; i < nEntries; ++i) {
+      std::memcpy(&(records[first + i].*member), payload.data() + offset, sizeof(T));
+      offset += sizeof(T);
+    }
+  });
+  return ok;
+}
+
+std::string const& BinaryStepReader::getVolumeName(int volId) const
+{
+  return volId >= 0 && volId < int(mVolumeNames.size()) && !mVolumeNames[volId].empty() ? mVolumeNames[volId]
+                                                                                         : kUnknown;
+}
+
+std::string const& BinaryStepReader::getModuleName(int volId) const
+{
+  return volId >= 0 && volId < int(mModuleNames.size()) && !mModuleNames[volId].empty() ? mModuleNames[volId]
+                                                                                         : kUnknown;
+}
+
+BinaryStepEventSummary BinaryStepReader::summarize(std::vector<BinaryStepRecord> const& records)
+{
+  BinaryStepEventSummary summary;
+  std::vector<int> tracks, pdgs;
+  for (auto const& record : records) {
+    auto& volume = summary.volumes[record.volId];
+    if (record.kind == BinaryStepRecord::kField) {
+      summary.fieldCalls++;
+      volume.fieldCalls++;
+      continue;
+    }
+    summary.steps++;
+    volume.steps++;
+    volume.secondaries += record.nsecondaries;
+    int nStored = std::min<int>(record.nsecondaries, BinaryStepRecord::kMaxSecondaryProcesses);
+    for (int i = 0; i < nStored; ++i) {
+      volume.processes[record.secondaryprocesses[i]]++;
+    }
+    tracks.push_back(record.trackID);
+    pdgs.push_back(record.pdg);
+  }
+  for (auto* v : { &tracks, &pdgs }) {
+    std::sort(v->begin(), v->end());
+  }
+  summary.tracks = std::unique(tracks.begin(), tracks.end()) - tracks.begin();
+  summary.pdgs = std::unique(pdgs.begin(), pdgs.end()) - pdgs.begin();
+  return summary;
+}
+
+void BinaryStepReader::print(BinaryStepEventSummary const& summary, std::ostream& out) const
+{
+  out << "[STEPLOGGER]: did " << summary.steps << " steps \n";
+  out << "[STEPLOGGER]: transported " << summary.tracks << " different tracks \n";
+  out << "[STEPLOGGER]: transported " << summary.pdgs << " different types \n";
+  for (auto const& p : summary.volumes) {
+    if (!p.second.steps) {
+      continue;
+    }
+    out << "[STEPLOGGER]: VolName " << getVolumeName(p.first) << " MODULE " << getModuleName(p.first) << " COUNT "
+        << p.second.steps << " SECONDARIES " << p.second.secondaries << " ";
+    for (auto const& proc : p.second.processes) {
+      const char* name = proc.first < kMaxMCProcess ? TMCProcessName[proc.first] : "UNKNOWN";
+      out << "P[" << name << "]:" << proc.second << "\t";
+    }
+    out << "\n";
+  }
+  if (summary.fieldCalls) {
+    out << "[FIELDLOGGER]: did " << summary.fieldCalls << " steps \n";
+    for (auto const& p : summary.volumes) {
+      if (p.second.fieldCalls) {
+        out << "[FIELDLOGGER]: VolName " << getVolumeName(p.first) << " COUNT " << p.second.fieldCalls << "\n";
+      }
+    }
+  }
+  out << "[STEPLOGGER]: ----- END OF EVENT ------\n";
+}
+}
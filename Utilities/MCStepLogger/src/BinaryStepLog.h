@@ -0,0 +1,162 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//  @file   BinaryStepLog.h
+//  @brief  fixed-size binary step records, their asynchronous writer and the offline reader
+
+#ifndef O2_BINARYSTEPLOG
+#define O2_BINARYSTEPLOG
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace o2
+{
+// one MC step or magnetic field call, of fixed size to be passed through the rings without allocations
+struct BinaryStepRecord {
+  enum Kind : uint8_t { kStep = 0, kField = 1 };
+  static constexpr int kMaxSecondaryProcesses = 8; // production processes kept for the first secondaries
+
+  int64_t stepid = -1; // for field calls: the step during which the call was done
+  int32_t trackID = -1;
+  int32_t pdg = 0;
+  int32_t volId = -1;
+  int32_t copyNo = -1;
+  float x = 0.;
+  float y = 0.;
+  float z = 0.;
+  float E = 0.; // for field calls: the absolute value of the field
+  float step = 0.;
+  uint16_t nsecondaries = 0;
+  uint8_t kind = kStep;
+  uint8_t stopped = 0;
+  uint8_t secondaryprocesses[kMaxSecondaryProcesses] = {};
+};
+
+// Layout of the columnar file: a file header followed by chunks. A chunk starts with a
+// BinaryStepChunkHeader; the record chunks contain each record member as a contiguous column,
+// in the order of the members of BinaryStepRecord, the volume chunk contains the names of the volumes
+// and modules as id, length-prefixed volume name, length-prefixed module name
+struct BinaryStepChunkHeader {
+  enum Type : uint32_t { kRecords = 0, kEndOfEvent = 1, kVolumes = 2 };
+  uint32_t type = kRecords;
+  uint32_t nEntries = 0;
+  uint64_t size = 0; // bytes following the header
+};
+
+constexpr char kBinaryStepLogMagic[8] = { 'O', '2', 'S', 'T', 'E', 'P', 'S', '1' };
+
+// Writes the records pushed concurrently by the transport threads to the columnar file.
+// Each producing thread gets its own lock-free single-producer single-consumer ring, registered at
+// its first push; a background thread drains the rings into column buffers and writes them out
+class BinaryStepWriter
+{
+ public:
+  static constexpr size_t kRingSize = 1 << 14;  // records per thread ring, power of 2
+  static constexpr size_t kChunkSize = 1 << 16; // max records per chunk of the file
+
+  BinaryStepWriter(std::string const& filename, std::vector<std::pair<std::string, std::string>> const& volumes);
+  ~BinaryStepWriter();
+
+  bool good() const { return mGood; }
+
+  // add a record, blocks only while the ring of the calling thread is full
+  void push(BinaryStepRecord const& record);
+
+  // mark the end of an event: the records pushed before are written before the marker
+  void endEvent();
+
+ private:
+  struct Ring {
+    std::array<BinaryStepRecord, kRingSize> buffer;
+    std::atomic<size_t> head{ 0 }; // next slot to be written by the producer
+    std::atomic<size_t> tail{ 0 }; // next slot to be read by the writer thread
+  };
+
+  Ring* threadRing();
+  void run();
+  std::vector<size_t> ringHeads() const; // to be called with mMutex locked
+  // moves the records of the rings to mPending, up to the given head of each ring
+  void drainRings(std::vector<size_t> const& heads);
+  void writeRecords();
+  void writeChunk(BinaryStepChunkHeader::Type type, uint32_t nEntries, std::string const& payload);
+
+  std::ofstream mOut;
+  const int mId; // identifies the rings of this writer in the threads
+  bool mGood = false;
+  std::vector<BinaryStepRecord> mPending; // drained records waiting to be written, writer thread only
+  std::string mColumns;                   // column buffer, writer thread only
+
+  std::mutex mMutex; // protects mRings and mEndOfEvents
+  std::condition_variable mCondition;
+  std::vector<std::unique_ptr<Ring>> mRings;
+  std::vector<std::vector<size_t>> mEndOfEvents; // heads of the rings at each end of event not yet written
+  bool mStop = false;
+  std::thread mThread;
+
+  static std::atomic<int> sInstances;
+};
+
+// statistics of one event aggregated from the records, per volume id
+struct BinaryStepEventSummary {
+  struct VolumeSummary {
+    long steps = 0;
+    long secondaries = 0;
+    long fieldCalls = 0;
+    std::map<int, long> processes; // production process of the secondaries -> count
+  };
+  long steps = 0;
+  long fieldCalls = 0;
+  long tracks = 0; // distinct track ids
+  long pdgs = 0;   // distinct particle types
+  std::map<int, VolumeSummary> volumes;
+};
+
+// Reads a file written by BinaryStepWriter
+class BinaryStepReader
+{
+ public:
+  BinaryStepReader(std::string const& filename);
+
+  bool good() const { return mGood; }
+
+  // read the records of the next event, returns false at the end of the file
+  bool nextEvent(std::vector<BinaryStepRecord>& records);
+
+  std::string const& getVolumeName(int volId) const;
+  std::string const& getModuleName(int volId) const;
+
+  // per volume statistics of the records of an event
+  static BinaryStepEventSummary summarize(std::vector<BinaryStepRecord> const& records);
+
+  // print the summary in the format of the interactive step logger
+  void print(BinaryStepEventSummary const& summary, std::ostream& out) const;
+
+ private:
+  bool readVolumes(uint32_t nEntries, uint64_t size);
+  bool readRecords(uint32_t nEntries, uint64_t size, std::vector<BinaryStepRecord>& records);
+
+  std::ifstream mIn;
+  bool mGood = false;
+  std::vector<std::string> mVolumeNames;
+  std::vector<std::string> mModuleNames;
+};
+}
+#endif
@@ -25,6 +25,7 @@
 //  @since  2017-06-29
 //  @brief  A logging service for MCSteps (hooking into Stepping of TVirtualMCApplication's)
 
+#include <BinaryStepLog.h>
 #include <StepInfo.h>
 #include <TBranch.h>
 #include <TClonesArray.h>
@@ -38,6 +39,8 @@
 #include <sstream>
 
 #include <dlfcn.h>
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -69,6 +72,100 @@ const char* getVolMapFile()
   }
 }
 
+const char* getBinaryLogFileName()
+{
+  if (const char* f = std::getenv("MCSTEPLOG_BINFILE")) {
+    return f;
+  } else {
+    return "MCStepLoggerOutput.bin";
+  }
+}
+
+// splits a comma separated list
+std::vector<std::string> splitList(const char* list)
+{
+  std::vector<std::string> tokens;
+  std::istringstream ss(list);
+  std::string token;
+  while (std::getline(ss, token, ',')) {
+    if (!token.empty()) {
+      tokens.push_back(token);
+    }
+  }
+  return tokens;
+}
+
+// selection of the logged steps, configured via env variables:
+// MCSTEPLOG_SAMPLE_EVERY=N logs one step out of N,
+// MCSTEPLOG_SAMPLE_PDG=pdg1,pdg2,... logs only the steps of these particles,
+// MCSTEPLOG_SAMPLE_VOLUMES=vol1,vol2,... logs only the steps in these volumes
+class StepSampling
+{
+  int mEvery = 1;
+  std::vector<int> mPDGs;           // sorted, empty means all
+  std::vector<bool> mVolumes;       // accepted volume ids, empty means all
+  bool mActive = false;
+
+ public:
+  StepSampling()
+  {
+    if (const char* every = std::getenv("MCSTEPLOG_SAMPLE_EVERY")) {
+      mEvery = std::max(1, std::atoi(every));
+    }
+    if (const char* pdgs = std::getenv("MCSTEPLOG_SAMPLE_PDG")) {
+      for (auto& pdg : splitList(pdgs)) {
+        mPDGs.push_back(std::atoi(pdg.c_str()));
+      }
+      std::sort(mPDGs.begin(), mPDGs.end());
+    }
+    if (const char* volumes = std::getenv("MCSTEPLOG_SAMPLE_VOLUMES")) {
+      // the logger is initialized after the geometry, hence the volume ids are known
+      auto mc = TVirtualMC::GetMC();
+      for (auto& name : splitList(volumes)) {
+        int id = mc ? mc->VolId(name.c_str()) : -1;
+        if (id < 0) {
+          std::cerr << "[MCLOGGER:] UNKNOWN VOLUME " << name << " IN SAMPLING\n";
+          continue;
+        }
+        if (id >= int(mVolumes.size())) {
+          mVolumes.resize(id + 1, false);
+        }
+        mVolumes[id] = true;
+      }
+      if (mVolumes.empty()) {
+        mVolumes.push_back(false); // nothing to accept
+      }
+    }
+    mActive = mEvery > 1 || !mPDGs.empty() || !mVolumes.empty();
+    if (mActive) {
+      std::cerr << "[MCLOGGER:] SAMPLING EVERY " << mEvery << " STEPS, " << mPDGs.size() << " PDGS, "
+                << std::count(mVolumes.begin(), mVolumes.end(), true) << " VOLUMES\n";
+    }
+  }
+
+  // to be called for every step or field call, counter is the number of calls seen so far
+  bool accept(TVirtualMC* mc, long& counter) const
+  {
+    if (!mActive) {
+      return true;
+    }
+    if (counter++ % mEvery) {
+      return false;
+    }
+    if (!mPDGs.empty() && !std::binary_search(mPDGs.begin(), mPDGs.end(), mc->TrackPid())) {
+      return false;
+    }
+    if (!mVolumes.empty()) {
+      int copyNo;
+      auto id = mc->CurrentVolID(copyNo);
+      if (id < 0 || id >= int(mVolumes.size()) || !mVolumes[id]) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
 // initializes a mapping from volumename to detector
 // used for step resolution to detectors
 void initVolumeMap()
@@ -104,6 +201,44 @@ void initVolumeMap()
   }
 }
 
+// the writer of the binary format, shared by the step and field loggers; enabled via MCSTEPLOG_BINARY
+BinaryStepWriter* binarywriter = nullptr;
+
+void initBinaryWriter()
+{
+  if (!std::getenv("MCSTEPLOG_BINARY") || binarywriter) {
+    return;
+  }
+  // table of the volume names and their modules, written once at the beginning of the file
+  std::vector<std::pair<std::string, std::string>> volumes;
+  if (auto mc = TVirtualMC::GetMC()) {
+    volumes.resize(mc->NofVolumes() + 1);
+    for (int id = 1; id <= mc->NofVolumes(); ++id) {
+      volumes[id].first = mc->VolName(id);
+      if (StepInfo::volnametomodulemap) {
+        auto iter = StepInfo::volnametomodulemap->find(volumes[id].first);
+        if (iter != StepInfo::volnametomodulemap->end()) {
+          volumes[id].second = iter->second;
+        }
+      }
+    }
+  }
+  std::cerr << "[MCLOGGER:] WRITING BINARY STEP RECORDS TO " << getBinaryLogFileName() << "\n";
+  binarywriter = new BinaryStepWriter(getBinaryLogFileName(), volumes);
+  if (!binarywriter->good()) {
+    // without a writer thread the rings would fill up and block the stepping, log as without MCSTEPLOG_BINARY
+    std::cerr << "[MCLOGGER:] BINARY STEP RECORDS DISABLED\n";
+    delete binarywriter;
+    binarywriter = nullptr;
+    return;
+  }
+  // the destructor writes the remaining records and joins the writer thread
+  std::atexit([]() {
+    delete binarywriter;
+    binarywriter = nullptr;
+  });
+}
+
 template <typename T>
 void flushToTTree(const char* branchname, T* address)
 {
@@ -134,6 +269,8 @@ class FieldLogger
   std::map<int, std::string> idtovolname;
   bool mTTreeIO = false;
   std::vector<MagCallInfo> callcontainer;
+  StepSampling mSampling;
+  long mSeen = 0; // number of calls seen, for the sampling
 
  public:
   FieldLogger()
@@ -147,6 +284,21 @@ class FieldLogger
 
   void addStep(TVirtualMC* mc, const double* x, const double* b)
   {
+    if (!mSampling.accept(mc, mSeen)) {
+      return;
+    }
+    if (binarywriter) {
+      BinaryStepRecord record;
+      record.kind = BinaryStepRecord::kField;
+      record.stepid = StepInfo::stepcounter;
+      record.volId = mc->CurrentVolID(record.copyNo);
+      record.x = x[0];
+      record.y = x[1];
+      record.z = x[2];
+      record.E = std::sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+      binarywriter->push(record);
+      return;
+    }
     if (mTTreeIO) {
       callcontainer.emplace_back(mc, x[0], x[1], x[2], b[0], b[1], b[2]);
       return;
@@ -176,7 +328,9 @@ class FieldLogger
 
   void flush()
   {
-    if (mTTreeIO) {
+    if (binarywriter) {
+      // the end of event is marked by the step logger
+    } else if (mTTreeIO) {
       flushToTTree("Calls", &callcontainer);
     } else {
       std::cerr << "[FIELDLOGGER]: did " << counter << " steps \n";
@@ -204,6 +358,8 @@ class StepLogger
 
   std::vector<StepInfo> container;
   bool mTTreeIO = false;
+  StepSampling mSampling;
+  long mSeen = 0; // number of steps seen, for the sampling
 
  public:
   StepLogger()
@@ -219,7 +375,12 @@ class StepLogger
 
   void addStep(TVirtualMC* mc)
   {
-    if (mTTreeIO) {
+    if (!mSampling.accept(mc, mSeen)) {
+      return;
+    }
+    if (binarywriter) {
+      addBinaryStep(mc);
+    } else if (mTTreeIO) {
       container.emplace_back(mc);
     } else {
       assert(mc);
@@ -264,6 +425,30 @@ class StepLogger
     }
   }
 
+  // fills the fixed-size record, without any lookup structure
+  void addBinaryStep(TVirtualMC* mc)
+  {
+    BinaryStepRecord record;
+    record.stepid = ++StepInfo::stepcounter;
+    record.trackID = mc->GetStack()->GetCurrentTrackNumber();
+    record.pdg = mc->TrackPid();
+    record.volId = mc->CurrentVolID(record.copyNo);
+    double x, y, z;
+    mc->TrackPosition(x, y, z);
+    record.x = x;
+    record.y = y;
+    record.z = z;
+    record.E = mc->Etot();
+    record.step = mc->TrackStep();
+    int nsecondaries = mc->NSecondaries();
+    record.nsecondaries = std::min(nsecondaries, 0xffff);
+    for (int i = 0; i < std::min(nsecondaries, int(BinaryStepRecord::kMaxSecondaryProcesses)); ++i) {
+      record.secondaryprocesses[i] = mc->ProdProcess(i);
+    }
+    record.stopped = mc->IsTrackStop();
+    binarywriter->push(record);
+  }
+
   void clear()
   {
     stepcounter = 0;
@@ -291,7 +476,9 @@ class StepLogger
 
   void flush()
   {
-    if (!mTTreeIO) {
+    if (binarywriter) {
+      binarywriter->endEvent();
+    } else if (!mTTreeIO) {
       std::cerr << "[STEPLOGGER]: did " << stepcounter << " steps \n";
       std::cerr << "[STEPLOGGER]: transported " << trackset.size() << " different tracks \n";
       std::cerr << "[STEPLOGGER]: transported " << pdgset.size() << " different types \n";
@@ -397,6 +584,8 @@ extern "C" void initLogger()
   // initializes the logging instances
   o2::logger = new o2::StepLogger();
   o2::fieldlogger = new o2::FieldLogger();
+  // after the step logger which loads the volume -> module mapping
+  o2::initBinaryWriter();
 }
 
 extern "C" void flushLog()
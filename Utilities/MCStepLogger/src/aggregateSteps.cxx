@@ -0,0 +1,32 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//  @file   aggregateSteps.cxx
+//  @brief  prints the per event summaries of a binary step log, as done by the interactive logger
+
+#include "BinaryStepLog.h"
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+  if (argc != 2) {
+    std::cerr << "usage: " << argv[0] << " <binary step log>\n";
+    return 1;
+  }
+  o2::BinaryStepReader reader(argv[1]);
+  if (!reader.good()) {
+    return 1;
+  }
+  std::vector<o2::BinaryStepRecord> records;
+  while (reader.nextEvent(records)) {
+    reader.print(o2::BinaryStepReader::summarize(records), std::cout);
+  }
+  return reader.good() ? 0 : 1;
+}
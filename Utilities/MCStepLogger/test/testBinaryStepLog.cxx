@@ -0,0 +1,130 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//  @file   testBinaryStepLog.cxx
+//  @brief  roundtrip of the binary step records through the writer and the reader
+
+#define BOOST_TEST_MODULE Test MCStepLogger BinaryStepLog
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <TMCProcess.h>
+#include <cstdio>
+#include <sstream>
+#include "../src/BinaryStepLog.h"
+
+namespace
+{
+const std::string kFileName = "testBinaryStepLog.bin";
+
+o2::BinaryStepRecord makeStep(int64_t stepid, int trackID, int pdg, int volId, uint16_t nsecondaries)
+{
+  o2::BinaryStepRecord record;
+  record.stepid = stepid;
+  record.trackID = trackID;
+  record.pdg = pdg;
+  record.volId = volId;
+  record.copyNo = 1;
+  record.x = 0.5f * stepid;
+  record.E = 1.f;
+  record.step = 0.1f;
+  record.nsecondaries = nsecondaries;
+  for (int i = 0; i < nsecondaries && i < o2::BinaryStepRecord::kMaxSecondaryProcesses; ++i) {
+    record.secondaryprocesses[i] = i % 2 ? kPDecay : kPPair;
+  }
+  return record;
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_BinaryStepLog_roundtrip)
+{
+  {
+    o2::BinaryStepWriter writer(kFileName, { { "", "" }, { "vol1", "mod1" }, { "vol2", "mod2" } });
+    BOOST_REQUIRE(writer.good());
+    writer.push(makeStep(0, 1, 11, 1, 2));
+    writer.push(makeStep(1, 1, 11, 1, 0));
+    writer.push(makeStep(2, 2, 22, 2, 1));
+    o2::BinaryStepRecord field;
+    field.kind = o2::BinaryStepRecord::kField;
+    field.stepid = 2;
+    field.volId = 2;
+    field.E = 5.f;
+    writer.push(field);
+    writer.endEvent();
+    // more records than a ring holds, the writer thread has to keep up
+    for (size_t i = 0; i < 3 * o2::BinaryStepWriter::kRingSize; ++i) {
+      writer.push(makeStep(i, i % 10, 13, 1, 0));
+    }
+    writer.endEvent();
+    // the destructor writes the records of the unfinished event
+    writer.push(makeStep(0, 3, 211, 2, 0));
+  }
+
+  o2::BinaryStepReader reader(kFileName);
+  BOOST_REQUIRE(reader.good());
+  std::vector<o2::BinaryStepRecord> records;
+
+  BOOST_REQUIRE(reader.nextEvent(records));
+  BOOST_REQUIRE_EQUAL(records.size(), 4);
+  BOOST_CHECK_EQUAL(records[0].trackID, 1);
+  BOOST_CHECK_EQUAL(records[0].pdg, 11);
+  BOOST_CHECK_EQUAL(records[0].nsecondaries, 2);
+  BOOST_CHECK_EQUAL(records[0].secondaryprocesses[1], kPDecay);
+  BOOST_CHECK_EQUAL(records[2].x, 1.f);
+  BOOST_CHECK_EQUAL(records[3].kind, o2::BinaryStepRecord::kField);
+  BOOST_CHECK_EQUAL(records[3].E, 5.f);
+  BOOST_CHECK_EQUAL(reader.getVolumeName(1), "vol1");
+  BOOST_CHECK_EQUAL(reader.getModuleName(2), "mod2");
+  BOOST_CHECK_EQUAL(reader.getVolumeName(7), "UNKNOWN");
+
+  auto summary = o2::BinaryStepReader::summarize(records);
+  BOOST_CHECK_EQUAL(summary.steps, 3);
+  BOOST_CHECK_EQUAL(summary.fieldCalls, 1);
+  BOOST_CHECK_EQUAL(summary.tracks, 2);
+  BOOST_CHECK_EQUAL(summary.pdgs, 2);
+  BOOST_CHECK_EQUAL(summary.volumes[1].steps, 2);
+  BOOST_CHECK_EQUAL(summary.volumes[1].secondaries, 2);
+  BOOST_CHECK_EQUAL(summary.volumes[1].processes[kPPair], 1);
+  BOOST_CHECK_EQUAL(summary.volumes[1].processes[kPDecay], 1);
+  BOOST_CHECK_EQUAL(summary.volumes[2].steps, 1);
+  BOOST_CHECK_EQUAL(summary.volumes[2].fieldCalls, 1);
+
+  std::ostringstream out;
+  reader.print(summary, out);
+  BOOST_CHECK(out.str().find("VolName vol1 MODULE mod1 COUNT 2 SECONDARIES 2") != std::string::npos);
+  BOOST_CHECK(out.str().find("[FIELDLOGGER]: VolName vol2 COUNT 1") != std::string::npos);
+
+  BOOST_REQUIRE(reader.nextEvent(records));
+  BOOST_REQUIRE_EQUAL(records.size(), 3 * o2::BinaryStepWriter::kRingSize);
+  for (size_t i = 0; i < records.size(); ++i) {
+    BOOST_REQUIRE_EQUAL(records[i].stepid, int64_t(i));
+  }
+  summary = o2::BinaryStepReader::summarize(records);
+  BOOST_CHECK_EQUAL(summary.tracks, 10);
+  BOOST_CHECK_EQUAL(summary.pdgs, 1);
+
+  BOOST_REQUIRE(reader.nextEvent(records));
+  BOOST_REQUIRE_EQUAL(records.size(), 1);
+  BOOST_CHECK_EQUAL(records[0].pdg, 211);
+  BOOST_CHECK(!reader.nextEvent(records));
+
+  std::remove(kFileName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_BinaryStepLog_badfile)
+{
+  o2::BinaryStepWriter writer("/nonexistent/directory/steps.bin", {});
+  BOOST_CHECK(!writer.good());
+
+  o2::BinaryStepReader reader("/nonexistent/directory/steps.bin");
+  BOOST_CHECK(!reader.good());
+  std::vector<o2::BinaryStepRecord> records;
+  BOOST_CHECK(!reader.nextEvent(records));
+}
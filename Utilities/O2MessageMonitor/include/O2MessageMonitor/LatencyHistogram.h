@@ -0,0 +1,62 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file LatencyHistogram.h
+///
+/// @since 2026-10-19
+
+#ifndef LATENCYHISTOGRAM_H_
+#define LATENCYHISTOGRAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Histogram of positive integer values (e.g. latencies in ns) with a fixed
+/// relative precision over the full range, in the spirit of HdrHistogram:
+/// values below 2^subBucketBits are counted exactly, each higher power of two
+/// range is divided into 2^subBucketBits buckets of equal width, so a bucket
+/// is at most 2^-subBucketBits of its values wide.
+/// Recording is O(1), percentiles are computed by a walk over the buckets.
+class LatencyHistogram
+{
+public:
+  /// @param maxValue highest value resolved, larger values are counted in the last bucket
+  /// @param subBucketBits number of bits of precision
+  LatencyHistogram(uint64_t maxValue = 60000000000ull, unsigned subBucketBits = 7);
+
+  void record(uint64_t value, uint64_t count = 1);
+  void reset();
+
+  uint64_t getCount() const { return mCount; }
+  uint64_t getMin() const { return mCount ? mMin : 0; }
+  uint64_t getMax() const { return mMax; }
+  double getMean() const { return mCount ? static_cast<double>(mSum) / mCount : 0.; }
+
+  /// value below or at which the given percentage of the recorded values are,
+  /// reported as the upper edge of the bucket, limited to the maximum recorded value
+  uint64_t getValueAtPercentile(double percentile) const;
+
+  /// index of the bucket of a value, and lowest and highest value counted in a bucket
+  size_t getBucketIndex(uint64_t value) const;
+  uint64_t getBucketLowEdge(size_t index) const;
+  uint64_t getBucketHighEdge(size_t index) const;
+
+private:
+  unsigned mSubBucketBits;
+  uint64_t mSubBucketCount;
+  std::vector<uint64_t> mCounts;
+  uint64_t mCount;
+  uint64_t mMin;
+  uint64_t mMax;
+  uint64_t mSum;
+};
+
+#endif /* LATENCYHISTOGRAM_H_ */
@@ -28,8 +28,36 @@
 #ifndef O2MESSAGEMONITOR_H_
 #define O2MESSAGEMONITOR_H_
 
+#include <fstream>
+#include <string>
+#include <vector>
+
 #include "O2Device/O2Device.h"
 #include "Headers/DataHeader.h"
+#include "O2MessageMonitor/LatencyHistogram.h"
+
+/// Header of the benchmark messages.
+/// The send time is taken from the steady clock, latencies are therefore only
+/// meaningful between devices running on the same host.
+struct BenchmarkHeader : public o2::Header::BaseHeader {
+  //static data for this header type/version
+  static const uint32_t sVersion;
+  static const o2::Header::HeaderType sHeaderType;
+  static const o2::Header::SerializationMethod sSerializationMethod;
+
+  enum Flags : uint32_t {
+    kEndOfRun = 0x1 // no payload, the sender is done
+  };
+
+  uint64_t sendTime; // ns
+  uint64_t sequence; // index of the message in the step
+  uint32_t step;     // index of the message size in the sweep
+  uint32_t flags;
+
+  BenchmarkHeader()
+    : BaseHeader(sizeof(BenchmarkHeader), sHeaderType, sSerializationMethod, sVersion)
+    , sendTime(0), sequence(0), step(0), flags(0) {}
+};
 
 /// This is a simple FairMQ monitoring class
 /// assumption is the messages are O@ messages (constructed supported
@@ -38,6 +66,14 @@
 /// it will appropriately send requests, send/receive messages or send replies.
 /// All incoming traffic is dumped on screen in the form of a hex dump for both
 /// the header block and payload block.
+///
+/// With option --benchmark the device measures the throughput and latency of
+/// the channel instead: the sender ("send") sweeps the message sizes, sending
+/// a number of messages of each size at a target rate with the send time in a
+/// BenchmarkHeader; the receiver ("receive") histograms the latencies per
+/// message size. Both write one summary line per message size to the log and,
+/// with option --output, to a CSV file. With a req/rep channel the sender
+/// measures the round trip time.
 class O2MessageMonitor : public o2::Base::O2Device
 {
 public:
@@ -51,6 +87,12 @@ protected:
   bool HandleO2frame(const byte* headerBuffer, size_t headerBufferSize,
       const byte* dataBuffer,   size_t dataBufferSize);
 
+  void runBenchmarkSender();
+  void runBenchmarkReceiver();
+  void writeSummary(const std::string& role, size_t messageSize, uint64_t messages, uint64_t lost,
+                    double seconds, const LatencyHistogram* latency);
+  std::string getChannelType();
+
 private:
   o2::Header::DataHeader mDataHeader;
   std::string mPayload;
@@ -58,6 +100,13 @@ private:
   long long mDelay;
   long long mIterations;
   long long mLimitOutputCharacters;
+
+  std::string mBenchmark;
+  std::vector<size_t> mMessageSizes;
+  long long mMessagesPerSize;
+  double mRate;
+  std::string mTransport;
+  std::ofstream mOutput;
 };
 
 #endif /* O2MESSAGEMONITOR_H_ */
@@ -0,0 +1,124 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file LatencyHistogram.cxx
+///
+/// @since 2026-10-19
+
+#include "O2MessageMonitor/LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// position of the most significant bit, value must not be 0
+unsigned msb(uint64_t value)
+{
+  unsigned bit = 0;
+  while (value >>= 1) {
+    ++bit;
+  }
+  return bit;
+}
+}
+
+//__________________________________________________________________________________________________
+LatencyHistogram::LatencyHistogram(uint64_t maxValue, unsigned subBucketBits)
+  : mSubBucketBits(subBucketBits)
+  , mSubBucketCount(1ull << subBucketBits)
+  , mCounts()
+  , mCount(0)
+  , mMin(std::numeric_limits<uint64_t>::max())
+  , mMax(0)
+  , mSum(0)
+{
+  mCounts.resize(getBucketIndex(std::max(maxValue, mSubBucketCount)) + 1, 0);
+}
+
+//__________________________________________________________________________________________________
+size_t LatencyHistogram::getBucketIndex(uint64_t value) const
+{
+  if (value < mSubBucketCount) {
+    return value;
+  }
+  // the range [2^k, 2^(k+1)) is split in mSubBucketCount buckets of width 2^(k-mSubBucketBits)
+  unsigned shift = msb(value) - mSubBucketBits;
+  return mSubBucketCount * (shift + 1) + ((value >> shift) - mSubBucketCount);
+}
+
+//__________________________________________________________________________________________________
+uint64_t LatencyHistogram::getBucketLowEdge(size_t index) const
+{
+  if (index < mSubBucketCount) {
+    return index;
+  }
+  unsigned shift = index / mSubBucketCount - 1;
+  return (mSubBucketCount + index % mSubBucketCount) << shift;
+}
+
+//__________________________________________________________________________________________________
+uint64_t LatencyHistogram::getBucketHighEdge(size_t index) const
+{
+  if (index < mSubBucketCount) {
+    return index;
+  }
+  unsigned shift = index / mSubBucketCount - 1;
+  return getBucketLowEdge(index) + (1ull << shift) - 1;
+}
+
+//__________________________________________________________________________________________________
+void LatencyHistogram::record(uint64_t value, uint64_t count)
+{
+  if (count == 0) {
+    return;
+  }
+  size_t index = std::min(getBucketIndex(value), mCounts.size() - 1);
+  mCounts[index] += count;
+  mCount += count;
+  mSum += value * count;
+  mMin = std::min(mMin, value);
+  mMax = std::max(mMax, value);
+}
+
+//__________________________________________________________________________________________________
+void LatencyHistogram::reset()
+{
+  std::fill(mCounts.begin(), mCounts.end(), 0);
+  mCount = 0;
+  mMin = std::numeric_limits<uint64_t>::max();
+  mMax = 0;
+  mSum = 0;
+}
+
+//__________________________________________________________________________________________________
+uint64_t LatencyHistogram::getValueAtPercentile(double percentile) const
+{
+  if (mCount == 0) {
+    return 0;
+  }
+  if (percentile <= 0.) {
+    return mMin;
+  }
+  percentile = std::min(percentile, 100.);
+  uint64_t rank = std::max<uint64_t>(1, std::ceil(percentile / 100. * mCount));
+  uint64_t total = 0;
+  for (size_t index = 0; index < mCounts.size(); ++index) {
+    total += mCounts[index];
+    if (total >= rank) {
+      // the last bucket also counts the values above the resolved range
+      if (index + 1 == mCounts.size()) {
+        return mMax;
+      }
+      return std::min(std::max(getBucketHighEdge(index), mMin), mMax);
+    }
+  }
+  return mMax;
+}
@@ -27,6 +27,9 @@
 
 #include <thread> // this_thread::sleep_for
 #include <chrono>
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
 
 #include "O2MessageMonitor/O2MessageMonitor.h"
 #include <options/FairMQProgOptions.h>
@@ -39,6 +42,18 @@ using namespace o2::Base;
 
 using NameHeader48 = NameHeader<48>; //header holding 16 characters
 
+const uint32_t BenchmarkHeader::sVersion = 1;
+const o2::Header::HeaderType BenchmarkHeader::sHeaderType = "BenchHdr";
+const o2::Header::SerializationMethod BenchmarkHeader::sSerializationMethod = gSerializationMethodNone;
+
+namespace {
+// time in ns on the steady clock, which is shared by the processes of a host
+uint64_t now()
+{
+  return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
 //__________________________________________________________________________________________________
 O2MessageMonitor::O2MessageMonitor()
   : mDataHeader()
@@ -47,6 +62,12 @@ O2MessageMonitor::O2MessageMonitor()
   , mDelay(1000)
   , mIterations(10)
   , mLimitOutputCharacters(1024)
+  , mBenchmark()
+  , mMessageSizes()
+  , mMessagesPerSize(10000)
+  , mRate(0.)
+  , mTransport()
+  , mOutput()
 {
   mDataHeader = gDataOriginAny;
   mDataHeader = gDataDescriptionInfo;
@@ -62,18 +83,58 @@ void O2MessageMonitor::InitTask()
   std::string tmp = GetConfig()->GetValue<std::string>("name");
   if (!tmp.empty()) mName = tmp;
   mLimitOutputCharacters = GetConfig()->GetValue<int>("limit");
+
+  mBenchmark = GetConfig()->GetValue<std::string>("benchmark");
+  if (mBenchmark.empty()) return;
+  if (mBenchmark != "send" && mBenchmark != "receive") {
+    throw std::runtime_error("invalid benchmark mode '" + mBenchmark + "', expecting 'send' or 'receive'");
+  }
+
+  // geometric sweep of the message sizes
+  size_t size = GetConfig()->GetValue<int>("msg-size-min");
+  size_t maxSize = std::max<size_t>(size, GetConfig()->GetValue<int>("msg-size-max"));
+  size_t factor = GetConfig()->GetValue<int>("msg-size-factor");
+  mMessageSizes.clear();
+  do {
+    mMessageSizes.push_back(size);
+    size *= factor;
+  } while (factor > 1 && size <= maxSize);
+  mMessagesPerSize = GetConfig()->GetValue<int>("msgs-per-size");
+  mRate = GetConfig()->GetValue<double>("rate");
+  mTransport = GetConfig()->GetValue<std::string>("transport");
+
+  std::string outputFileName = GetConfig()->GetValue<std::string>("output");
+  if (!outputFileName.empty()) {
+    mOutput.open(outputFileName, std::ios::trunc);
+    if (!mOutput.good()) {
+      throw std::runtime_error("can not open benchmark output file " + outputFileName);
+    }
+    mOutput << "role,transport,msg_size,messages,lost,seconds,msg_per_s,MB_per_s,"
+            << "lat_count,lat_min_us,lat_mean_us,lat_p50_us,lat_p90_us,lat_p99_us,lat_p999_us,lat_max_us\n";
+  }
+}
+
+//__________________________________________________________________________________________________
+std::string O2MessageMonitor::getChannelType()
+{
+  std::vector<FairMQChannel>& subChannels = fChannels["data"];
+  return subChannels.size() > 0 ? subChannels[0].GetType() : std::string();
 }
 
 //__________________________________________________________________________________________________
 void O2MessageMonitor::Run()
 {
-  //check socket type of data channel
-  std::string type;
-  std::vector<FairMQChannel> subChannels = fChannels["data"];
-  if (subChannels.size()>0) {
-    type = subChannels[0].GetType();
+  if (mBenchmark == "send") {
+    runBenchmarkSender();
+    return;
+  } else if (mBenchmark == "receive") {
+    runBenchmarkReceiver();
+    return;
   }
 
+  //check socket type of data channel
+  std::string type = getChannelType();
+
   while (CheckCurrentState(RUNNING) && (--mIterations)!=0) {
     this_thread::sleep_for(chrono::milliseconds(mDelay));
 
@@ -119,3 +180,151 @@ bool O2MessageMonitor::HandleO2frame(const byte* headerBuffer, size_t headerBuff
   return true;
 }
 
+//__________________________________________________________________________________________________
+void O2MessageMonitor::runBenchmarkSender()
+{
+  // a request socket gets a reply for every message, its round trip time is measured
+  bool roundTrip = getChannelType() == "req";
+  LatencyHistogram latency;
+
+  for (size_t step = 0; step < mMessageSizes.size() && CheckCurrentState(RUNNING); ++step) {
+    size_t size = mMessageSizes[step];
+    latency.reset();
+    long long sent = 0;
+    auto start = chrono::steady_clock::now();
+    uint64_t startTime = now();
+    for (; sent < mMessagesPerSize && CheckCurrentState(RUNNING); ++sent) {
+      if (mRate > 0.) {
+        // the send times are fixed relative to the start of the step, a late
+        // message does not delay the following ones
+        this_thread::sleep_until(start + chrono::nanoseconds(static_cast<long long>(sent * 1e9 / mRate)));
+      }
+
+      DataHeader dataHeader = mDataHeader;
+      dataHeader.payloadSize = size;
+      BenchmarkHeader benchmarkHeader;
+      benchmarkHeader.step = step;
+      benchmarkHeader.sequence = sent;
+      benchmarkHeader.sendTime = now();
+
+      O2Message message;
+      AddMessage(message, { dataHeader, benchmarkHeader }, NewMessage(size));
+      if (Send(message, "data") < 0) {
+        break;
+      }
+      if (roundTrip) {
+        O2Message reply;
+        if (Receive(reply, "data") < 0) {
+          break;
+        }
+        latency.record(now() - benchmarkHeader.sendTime);
+      }
+    }
+    writeSummary("send", size, sent, 0, (now() - startTime) * 1e-9, roundTrip ? &latency : nullptr);
+  }
+
+  // tell the receiver that the sweep is over
+  if (CheckCurrentState(RUNNING)) {
+    BenchmarkHeader benchmarkHeader;
+    benchmarkHeader.flags = BenchmarkHeader::kEndOfRun;
+    benchmarkHeader.sendTime = now();
+    O2Message message;
+    AddMessage(message, { mDataHeader, benchmarkHeader }, NewMessage());
+    if (Send(message, "data") >= 0 && roundTrip) {
+      O2Message reply;
+      Receive(reply, "data");
+    }
+  }
+}
+
+//__________________________________________________________________________________________________
+void O2MessageMonitor::runBenchmarkReceiver()
+{
+  bool reply = getChannelType() == "rep";
+  LatencyHistogram latency;
+  long long step = -1;
+  size_t size = 0;
+  uint64_t received = 0;
+  uint64_t expected = 0;
+  uint64_t firstTime = 0;
+  uint64_t lastTime = 0;
+
+  auto finishStep = [&]() {
+    if (step >= 0) {
+      // messages lost before the last one received are counted, not those after
+      writeSummary("receive", size, received, expected - received, (lastTime - firstTime) * 1e-9, &latency);
+    }
+  };
+
+  while (CheckCurrentState(RUNNING)) {
+    O2Message message;
+    // timeout to check the device state when idle
+    if (Receive(message, "data", 0, 1000) <= 0) {
+      continue;
+    }
+    uint64_t receiveTime = now();
+
+    const BenchmarkHeader* header = nullptr;
+    if (message.Size() >= 2) {
+      header = get<BenchmarkHeader>(message.At(0)->GetData(), message.At(0)->GetSize());
+    }
+    if (reply) {
+      O2Message response;
+      AddMessage(response, { mDataHeader }, NewMessage());
+      Send(response, "data");
+    }
+    if (!header) {
+      LOG(WARN) << "ignoring message without benchmark header";
+      continue;
+    }
+    if (header->flags & BenchmarkHeader::kEndOfRun) {
+      break;
+    }
+
+    if (header->step != step) {
+      finishStep();
+      step = header->step;
+      size = message.At(1)->GetSize();
+      latency.reset();
+      received = 0;
+      expected = 0;
+      firstTime = receiveTime;
+    }
+    latency.record(receiveTime > header->sendTime ? receiveTime - header->sendTime : 0);
+    ++received;
+    expected = std::max<uint64_t>(expected, header->sequence + 1);
+    lastTime = receiveTime;
+  }
+  finishStep();
+}
+
+//__________________________________________________________________________________________________
+void O2MessageMonitor::writeSummary(const std::string& role, size_t messageSize, uint64_t messages,
+                                    uint64_t lost, double seconds, const LatencyHistogram* latency)
+{
+  double rate = seconds > 0. ? messages / seconds : 0.;
+  double bandwidth = rate * messageSize / 1e6;
+
+  LOG(INFO) << role << " " << messageSize << " bytes: " << messages << " messages, " << lost << " lost in "
+            << seconds << " s, " << rate << " msg/s, " << bandwidth << " MB/s";
+  if (latency && latency->getCount() > 0) {
+    LOG(INFO) << (role == "send" ? "round trip" : "latency") << " [us]: min " << latency->getMin() / 1e3
+              << " mean " << latency->getMean() / 1e3 << " p50 " << latency->getValueAtPercentile(50.) / 1e3
+              << " p90 " << latency->getValueAtPercentile(90.) / 1e3 << " p99 "
+              << latency->getValueAtPercentile(99.) / 1e3 << " p99.9 " << latency->getValueAtPercentile(99.9) / 1e3
+              << " max " << latency->getMax() / 1e3;
+  }
+
+  if (!mOutput.is_open()) return;
+  mOutput << role << ',' << mTransport << ',' << messageSize << ',' << messages << ',' << lost << ','
+          << std::setprecision(9) << seconds << ',' << rate << ',' << bandwidth << ',';
+  if (latency && latency->getCount() > 0) {
+    mOutput << latency->getCount() << ',' << latency->getMin() / 1e3 << ',' << latency->getMean() / 1e3 << ','
+            << latency->getValueAtPercentile(50.) / 1e3 << ',' << latency->getValueAtPercentile(90.) / 1e3 << ','
+            << latency->getValueAtPercentile(99.) / 1e3 << ',' << latency->getValueAtPercentile(99.9) / 1e3 << ','
+            << latency->getMax() / 1e3;
+  } else {
+    mOutput << "0,,,,,,,";
+  }
+  mOutput << std::endl;
+}
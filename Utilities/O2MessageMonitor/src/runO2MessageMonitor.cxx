@@ -43,6 +43,20 @@ void addCustomOptions(bpo::options_description& options)
      default_value("I am the info payload"), "the info string in the payload");
   options.add_options()
     ("name",bpo::value<std::string>()->default_value(""), "optional name in the header");
+  options.add_options()
+    ("benchmark",bpo::value<std::string>()->default_value(""), "benchmark mode: send or receive, monitoring if empty");
+  options.add_options()
+    ("msg-size-min",bpo::value<int>()->default_value(1024), "smallest message size of the benchmark in bytes");
+  options.add_options()
+    ("msg-size-max",bpo::value<int>()->default_value(1048576), "largest message size of the benchmark in bytes");
+  options.add_options()
+    ("msg-size-factor",bpo::value<int>()->default_value(4), "factor between the benchmark message sizes");
+  options.add_options()
+    ("msgs-per-size",bpo::value<int>()->default_value(10000), "number of benchmark messages of each size");
+  options.add_options()
+    ("rate",bpo::value<double>()->default_value(0.), "target benchmark message rate in Hz, 0 for no limit");
+  options.add_options()
+    ("output",bpo::value<std::string>()->default_value(""), "CSV file for the benchmark summary");
 }
 
 FairMQDevicePtr getDevice(const FairMQProgOptions& /*config*/)
@@ -0,0 +1,59 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test O2MessageMonitor LatencyHistogram
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "O2MessageMonitor/LatencyHistogram.h"
+
+BOOST_AUTO_TEST_CASE(LatencyHistogram_buckets)
+{
+  LatencyHistogram histogram(1000000, 4);
+  // exact below 2^bits, then every bucket contains its values and follows the previous one
+  BOOST_CHECK_EQUAL(histogram.getBucketIndex(15), 15);
+  BOOST_CHECK_EQUAL(histogram.getBucketIndex(16), 16);
+  uint64_t expectedLow = 0;
+  for (size_t index = 0; index < histogram.getBucketIndex(1000000); ++index) {
+    uint64_t low = histogram.getBucketLowEdge(index);
+    uint64_t high = histogram.getBucketHighEdge(index);
+    BOOST_CHECK_EQUAL(low, expectedLow);
+    BOOST_CHECK_EQUAL(histogram.getBucketIndex(low), index);
+    BOOST_CHECK_EQUAL(histogram.getBucketIndex(high), index);
+    // relative width below 2^-bits
+    BOOST_CHECK(high - low <= low / 16);
+    expectedLow = high + 1;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(LatencyHistogram_percentiles)
+{
+  LatencyHistogram histogram(1000000000ull, 7);
+  BOOST_CHECK_EQUAL(histogram.getValueAtPercentile(50.), 0);
+  for (uint64_t value = 1; value <= 10000; ++value) {
+    histogram.record(value * 1000);
+  }
+  BOOST_CHECK_EQUAL(histogram.getCount(), 10000);
+  BOOST_CHECK_EQUAL(histogram.getMin(), 1000);
+  BOOST_CHECK_EQUAL(histogram.getMax(), 10000000);
+  BOOST_CHECK_CLOSE(histogram.getMean(), 5000500., 1e-9);
+  BOOST_CHECK_CLOSE(static_cast<double>(histogram.getValueAtPercentile(50.)), 5000000., 1.);
+  BOOST_CHECK_CLOSE(static_cast<double>(histogram.getValueAtPercentile(99.)), 9900000., 1.);
+  BOOST_CHECK_EQUAL(histogram.getValueAtPercentile(100.), 10000000);
+  BOOST_CHECK_EQUAL(histogram.getValueAtPercentile(0.), 1000);
+
+  // values beyond the range are kept in the last bucket
+  histogram.record(5000000000ull);
+  BOOST_CHECK_EQUAL(histogram.getValueAtPercentile(100.), 5000000000ull);
+
+  histogram.reset();
+  BOOST_CHECK_EQUAL(histogram.getCount(), 0);
+  BOOST_CHECK_EQUAL(histogram.getMax(), 0);
+}
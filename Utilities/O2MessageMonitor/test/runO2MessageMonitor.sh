@@ -2,3 +2,11 @@
 #here's how to use it:
 #runO2MessageMonitor --id source1 --mq-config O2MessageMonitor.json
 #runO2MessageMonitor --id sink1 --mq-config O2MessageMonitor.json
+#
+#benchmark of a channel, sweeping the message sizes from 1 kB to 4 MB at 1000 messages per second,
+#the summary of each message size is written to the CSV files:
+#runO2MessageMonitor --id benchmarkReceiver --mq-config O2MessageMonitorBenchmark.json --benchmark receive --output receive.csv
+#runO2MessageMonitor --id benchmarkSender --mq-config O2MessageMonitorBenchmark.json --benchmark send --msg-size-min 1024 --msg-size-max 4194304 --msg-size-factor 4 --msgs-per-size 10000 --rate 1000 --output send.csv
+#the same with the shared memory transport (on both devices):
+#runO2MessageMonitor --id benchmarkReceiver --mq-config O2MessageMonitorBenchmark.json --transport shmem --benchmark receive --output receive.csv
+#runO2MessageMonitor --id benchmarkSender --mq-config O2MessageMonitorBenchmark.json --transport shmem --benchmark send --output send.csv
@@ -0,0 +1,454 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <TArrayD.h>
+#include <TArrayF.h>
+#include <TAxis.h>
+#include <TH1.h>
+#include <TH2.h>
+#include <TH3.h>
+#include <THn.h>
+
+namespace o2
+{
+namespace qc
+{
+/// Flat binary transport of the QC histograms (TH1F, TH2F, TH3F and THnF) replacing the streamed TMessage: an axes
+/// descriptor followed by the bin array, under- and overflow bins included, of which only the non-empty bins are sent
+/// when this is smaller. A delta holds the increments since the last publication and is applied by adding it.
+/// The conversion from and to ROOT keeps the contents, errors, entries and, for TH1, the statistics sums.
+class FlatHistogram
+{
+ public:
+  enum Type : uint8_t { TH1F_TYPE = 1, TH2F_TYPE, TH3F_TYPE, THNF_TYPE };
+
+  struct Axis {
+    int32_t nBins;
+    double min;
+    double max;
+    std::vector<double> edges; // empty for bins of fixed size
+  };
+
+  /// Whether the message holds a flat histogram rather than a TMessage
+  static bool isFlatHistogram(const void* data, size_t size)
+  {
+    uint32_t magic = 0;
+    if (size < sizeof(magic)) {
+      return false;
+    }
+    std::memcpy(&magic, data, sizeof(magic));
+    return magic == MAGIC;
+  }
+
+  /// nullptr if the object is not one of the supported histograms
+  static std::unique_ptr<FlatHistogram> fromROOT(const TObject* object, bool delta)
+  {
+    std::unique_ptr<FlatHistogram> flat(new FlatHistogram());
+    const char* className = object->ClassName();
+
+    if (std::strcmp(className, "TH1F") == 0 || std::strcmp(className, "TH2F") == 0 ||
+        std::strcmp(className, "TH3F") == 0) {
+      auto histogram = static_cast<const TH1*>(object);
+      int dimension = histogram->GetDimension();
+      flat->mType = dimension == 1 ? TH1F_TYPE : (dimension == 2 ? TH2F_TYPE : TH3F_TYPE);
+      const TAxis* axes[] = { histogram->GetXaxis(), histogram->GetYaxis(), histogram->GetZaxis() };
+      for (int i = 0; i < dimension; ++i) {
+        flat->mAxes.push_back(makeAxis(*axes[i]));
+      }
+
+      // TH1F, TH2F and TH3F are their own array of bin contents, the TArrayF base is not at the same offset in
+      // the three classes
+      auto contents = dynamic_cast<const TArrayF*>(object)->GetArray();
+      flat->mContents.assign(contents, contents + histogram->GetNcells());
+      if (histogram->GetSumw2N() > 0) {
+        auto sumw2 = histogram->GetSumw2()->GetArray();
+        flat->mSumw2.assign(sumw2, sumw2 + histogram->GetSumw2N());
+      }
+      flat->mStats.resize(TH1::kNstat);
+      histogram->GetStats(flat->mStats.data());
+    } else if (std::strcmp(className, "THnT<float>") == 0) {
+      auto histogram = static_cast<const THnF*>(object);
+      flat->mType = THNF_TYPE;
+      for (int i = 0; i < histogram->GetNdimensions(); ++i) {
+        flat->mAxes.push_back(makeAxis(*histogram->GetAxis(i)));
+      }
+
+      Long64_t nCells = histogram->GetNbins();
+      flat->mContents.resize(nCells);
+      for (Long64_t cell = 0; cell < nCells; ++cell) {
+        flat->mContents[cell] = histogram->GetBinContent(cell);
+      }
+      if (histogram->GetCalculateErrors()) {
+        flat->mSumw2.resize(nCells);
+        for (Long64_t cell = 0; cell < nCells; ++cell) {
+          flat->mSumw2[cell] = histogram->GetBinError2(cell);
+        }
+      }
+    } else {
+      return nullptr;
+    }
+
+    flat->mName = object->GetName();
+    flat->mTitle = object->GetTitle();
+    flat->mEntries = object->InheritsFrom(TH1::Class()) ? static_cast<const TH1*>(object)->GetEntries()
+                                                        : static_cast<const THnBase*>(object)->GetEntries();
+    flat->mDelta = delta;
+    return flat;
+  }
+
+  /// New ROOT histogram with the content of the flat one, owned by the caller
+  TObject* toROOT() const
+  {
+    if (mType == THNF_TYPE) {
+      std::vector<Int_t> nBins;
+      std::vector<Double_t> min, max;
+      for (const auto& axis : mAxes) {
+        nBins.push_back(axis.nBins);
+        min.push_back(axis.min);
+        max.push_back(axis.max);
+      }
+
+      auto histogram = new THnF(mName.c_str(), mTitle.c_str(), mAxes.size(), nBins.data(), min.data(), max.data());
+      for (size_t i = 0; i < mAxes.size(); ++i) {
+        if (!mAxes[i].edges.empty()) {
+          histogram->GetAxis(i)->Set(mAxes[i].nBins, mAxes[i].edges.data());
+        }
+      }
+      if (!mSumw2.empty()) {
+        histogram->Sumw2();
+      }
+      for (size_t cell = 0; cell < mContents.size(); ++cell) {
+        if (mContents[cell] != 0) {
+          histogram->SetBinContent(cell, mContents[cell]);
+        }
+        if (!mSumw2.empty() && mSumw2[cell] != 0) {
+          histogram->SetBinError2(cell, mSumw2[cell]);
+        }
+      }
+      histogram->SetEntries(mEntries);
+      return histogram;
+    }
+
+    TH1* histogram;
+    const Axis& x = mAxes[0];
+    if (mType == TH1F_TYPE) {
+      histogram = new TH1F(mName.c_str(), mTitle.c_str(), x.nBins, x.min, x.max);
+    } else if (mType == TH2F_TYPE) {
+      const Axis& y = mAxes[1];
+      histogram = new TH2F(mName.c_str(), mTitle.c_str(), x.nBins, x.min, x.max, y.nBins, y.min, y.max);
+    } else {
+      const Axis& y = mAxes[1];
+      const Axis& z = mAxes[2];
+      histogram = new TH3F(mName.c_str(), mTitle.c_str(), x.nBins, x.min, x.max, y.nBins, y.min, y.max, z.nBins,
+                           z.min, z.max);
+    }
+    TAxis* axes[] = { histogram->GetXaxis(), histogram->GetYaxis(), histogram->GetZaxis() };
+    for (size_t i = 0; i < mAxes.size(); ++i) {
+      if (!mAxes[i].edges.empty()) {
+        axes[i]->Set(mAxes[i].nBins, mAxes[i].edges.data());
+      }
+    }
+
+    // contents copied in the array directly: SetBinContent would reset the statistics at each bin
+    std::copy(mContents.begin(), mContents.end(), dynamic_cast<TArrayF*>(histogram)->GetArray());
+    if (!mSumw2.empty()) {
+      histogram->Sumw2();
+      histogram->GetSumw2()->Set(mSumw2.size(), mSumw2.data());
+    }
+    std::vector<Double_t> stats(mStats);
+    histogram->PutStats(stats.data());
+    histogram->SetEntries(mEntries);
+    return histogram;
+  }
+
+  void serialize(std::vector<char>& buffer) const
+  {
+    uint64_t nonZero = 0;
+    for (size_t cell = 0; cell < mContents.size(); ++cell) {
+      nonZero += !isEmpty(cell);
+    }
+    // a sparse bin costs a gap of usually 1-2 bytes on top of its value
+    size_t valueSize = sizeof(float) + (mSumw2.empty() ? 0 : sizeof(double));
+    bool sparse = nonZero * (valueSize + 2) < mContents.size() * valueSize;
+
+    buffer.clear();
+    write(buffer, static_cast<uint32_t>(MAGIC));
+    write(buffer, static_cast<uint8_t>(VERSION));
+    write(buffer, static_cast<uint8_t>(mType));
+    write(buffer, static_cast<uint8_t>((mDelta ? DELTA_FLAG : 0) | (sparse ? SPARSE_FLAG : 0) |
+                                       (mSumw2.empty() ? 0 : SUMW2_FLAG)));
+    write(buffer, uint8_t(0));
+    writeString(buffer, mName);
+    writeString(buffer, mTitle);
+    write(buffer, static_cast<uint32_t>(mAxes.size()));
+    for (const auto& axis : mAxes) {
+      write(buffer, axis.nBins);
+      write(buffer, axis.min);
+      write(buffer, axis.max);
+      write(buffer, static_cast<uint8_t>(!axis.edges.empty()));
+      writeArray(buffer, axis.edges.data(), axis.edges.size());
+    }
+    write(buffer, mEntries);
+    write(buffer, static_cast<uint32_t>(mStats.size()));
+    writeArray(buffer, mStats.data(), mStats.size());
+    write(buffer, static_cast<uint64_t>(mContents.size()));
+
+    if (!sparse) {
+      writeArray(buffer, mContents.data(), mContents.size());
+      writeArray(buffer, mSumw2.data(), mSumw2.size());
+      return;
+    }
+
+    // non-zero bins only, each index as a variable length gap from the previous one
+    write(buffer, nonZero);
+    uint64_t previous = 0;
+    for (uint64_t cell = 0; cell < mContents.size(); ++cell) {
+      if (isEmpty(cell)) {
+        continue;
+      }
+      writeVarint(buffer, cell - previous);
+      previous = cell;
+      write(buffer, mContents[cell]);
+      if (!mSumw2.empty()) {
+        write(buffer, mSumw2[cell]);
+      }
+    }
+  }
+
+  /// nullptr if the data is not a valid flat histogram
+  static std::unique_ptr<FlatHistogram> deserialize(const void* data, size_t size)
+  {
+    Reader reader{ static_cast<const char*>(data), static_cast<const char*>(data) + size };
+    std::unique_ptr<FlatHistogram> flat(new FlatHistogram());
+    uint32_t magic = 0, nAxes = 0, nStats = 0;
+    uint8_t version = 0, type = 0, flags = 0, reserved = 0;
+    uint64_t nCells = 0;
+
+    if (!reader.read(magic) || magic != MAGIC || !reader.read(version) || version != VERSION ||
+        !reader.read(type) || type < TH1F_TYPE || type > THNF_TYPE || !reader.read(flags) ||
+        !reader.read(reserved) || !reader.readString(flat->mName) || !reader.readString(flat->mTitle) ||
+        !reader.read(nAxes) || nAxes == 0 || (type != THNF_TYPE && nAxes != type)) {
+      return nullptr;
+    }
+    flat->mType = static_cast<Type>(type);
+    flat->mDelta = flags & DELTA_FLAG;
+
+    uint64_t expectedCells = 1;
+    for (uint32_t i = 0; i < nAxes; ++i) {
+      Axis axis;
+      uint8_t variable = 0;
+      if (!reader.read(axis.nBins) || axis.nBins <= 0 || !reader.read(axis.min) || !reader.read(axis.max) ||
+          !reader.read(variable) || (variable && !reader.readArray(axis.edges, axis.nBins + 1))) {
+        return nullptr;
+      }
+      expectedCells *= axis.nBins + 2;
+      flat->mAxes.push_back(std::move(axis));
+    }
+    if (!reader.read(flat->mEntries) || !reader.read(nStats) || !reader.readArray(flat->mStats, nStats) ||
+        !reader.read(nCells) || nCells != expectedCells) {
+      return nullptr;
+    }
+
+    bool sumw2 = flags & SUMW2_FLAG;
+    if (!(flags & SPARSE_FLAG)) {
+      if (!reader.readArray(flat->mContents, nCells) || (sumw2 && !reader.readArray(flat->mSumw2, nCells))) {
+        return nullptr;
+      }
+      return flat;
+    }
+
+    uint64_t nonZero = 0;
+    if (!reader.read(nonZero) || nonZero > nCells) {
+      return nullptr;
+    }
+    flat->mContents.assign(nCells, 0);
+    if (sumw2) {
+      flat->mSumw2.assign(nCells, 0);
+    }
+    uint64_t cell = 0;
+    for (uint64_t i = 0; i < nonZero; ++i) {
+      uint64_t gap = 0;
+      if (!reader.readVarint(gap) || (cell += gap) >= nCells || !reader.read(flat->mContents[cell]) ||
+          (sumw2 && !reader.read(flat->mSumw2[cell]))) {
+        return nullptr;
+      }
+    }
+    return flat;
+  }
+
+  /// Adds the increments of the delta, false if the binning differs
+  bool add(const FlatHistogram& delta)
+  {
+    if (delta.mType != mType || delta.mContents.size() != mContents.size() || delta.mAxes.size() != mAxes.size() ||
+        delta.mStats.size() != mStats.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < mAxes.size(); ++i) {
+      if (delta.mAxes[i].nBins != mAxes[i].nBins || delta.mAxes[i].min != mAxes[i].min ||
+          delta.mAxes[i].max != mAxes[i].max || delta.mAxes[i].edges != mAxes[i].edges) {
+        return false;
+      }
+    }
+
+    for (size_t cell = 0; cell < mContents.size(); ++cell) {
+      mContents[cell] += delta.mContents[cell];
+    }
+    if (!delta.mSumw2.empty()) {
+      if (mSumw2.empty()) {
+        // errors of the unweighted contents so far
+        mSumw2.assign(mContents.size(), 0);
+        for (size_t cell = 0; cell < mContents.size(); ++cell) {
+          mSumw2[cell] = mContents[cell] - delta.mContents[cell];
+        }
+      }
+      for (size_t cell = 0; cell < mSumw2.size(); ++cell) {
+        mSumw2[cell] += delta.mSumw2[cell];
+      }
+    } else if (!mSumw2.empty()) {
+      for (size_t cell = 0; cell < mSumw2.size(); ++cell) {
+        mSumw2[cell] += delta.mContents[cell];
+      }
+    }
+    for (size_t i = 0; i < mStats.size(); ++i) {
+      mStats[i] += delta.mStats[i];
+    }
+    mEntries += delta.mEntries;
+    return true;
+  }
+
+  const std::string& getTitle() const { return mTitle; }
+  bool isDelta() const { return mDelta; }
+  void setDelta(bool delta) { mDelta = delta; }
+
+ private:
+  static constexpr uint32_t MAGIC = 0x48464351; // "QCFH"
+  static constexpr uint8_t VERSION = 1;
+  static constexpr uint8_t DELTA_FLAG = 1;
+  static constexpr uint8_t SPARSE_FLAG = 2;
+  static constexpr uint8_t SUMW2_FLAG = 4;
+
+  struct Reader {
+    const char* current;
+    const char* end;
+
+    template <typename T>
+    bool read(T& value)
+    {
+      return readArray(&value, 1);
+    }
+
+    template <typename T>
+    bool readArray(T* values, uint64_t count)
+    {
+      if (count > uint64_t(end - current) / sizeof(T)) {
+        return false;
+      }
+      if (count == 0) {
+        return true;
+      }
+      std::memcpy(values, current, count * sizeof(T));
+      current += count * sizeof(T);
+      return true;
+    }
+
+    template <typename T>
+    bool readArray(std::vector<T>& values, uint64_t count)
+    {
+      if (count > uint64_t(end - current) / sizeof(T)) {
+        return false;
+      }
+      values.resize(count);
+      return readArray(values.data(), count);
+    }
+
+    bool readString(std::string& value)
+    {
+      uint32_t length = 0;
+      if (!read(length) || length > uint64_t(end - current)) {
+        return false;
+      }
+      value.assign(current, length);
+      current += length;
+      return true;
+    }
+
+    bool readVarint(uint64_t& value)
+    {
+      value = 0;
+      for (int shift = 0; shift < 64 && current < end; shift += 7) {
+        uint8_t byte = *current++;
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+          return true;
+        }
+      }
+      return false;
+    }
+  };
+
+  bool isEmpty(size_t cell) const { return mContents[cell] == 0 && (mSumw2.empty() || mSumw2[cell] == 0); }
+
+  static Axis makeAxis(const TAxis& axis)
+  {
+    Axis flatAxis{ axis.GetNbins(), axis.GetXmin(), axis.GetXmax(), {} };
+    if (axis.IsVariableBinSize()) {
+      flatAxis.edges.assign(axis.GetXbins()->GetArray(), axis.GetXbins()->GetArray() + axis.GetNbins() + 1);
+    }
+    return flatAxis;
+  }
+
+  template <typename T>
+  static void write(std::vector<char>& buffer, const T& value)
+  {
+    writeArray(buffer, &value, 1);
+  }
+
+  template <typename T>
+  static void writeArray(std::vector<char>& buffer, const T* values, size_t count)
+  {
+    auto bytes = reinterpret_cast<const char*>(values);
+    buffer.insert(buffer.end(), bytes, bytes + count * sizeof(T));
+  }
+
+  static void writeString(std::vector<char>& buffer, const std::string& value)
+  {
+    write(buffer, static_cast<uint32_t>(value.size()));
+    buffer.insert(buffer.end(), value.begin(), value.end());
+  }
+
+  static void writeVarint(std::vector<char>& buffer, uint64_t value)
+  {
+    while (value >= 0x80) {
+      buffer.push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    buffer.push_back(static_cast<char>(value));
+  }
+
+  Type mType{ TH1F_TYPE };
+  std::string mName;
+  std::string mTitle;
+  std::vector<Axis> mAxes;
+  std::vector<float> mContents;
+  std::vector<double> mSumw2;
+  std::vector<double> mStats; // TH1 statistics sums, empty for THn
+  double mEntries{ 0 };
+  bool mDelta{ false };
+};
+}
+}
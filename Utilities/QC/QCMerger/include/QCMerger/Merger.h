@@ -10,17 +10,32 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <unordered_map>
 
-#include <TList.h>
+#include <TObject.h>
 
 namespace o2
 {
 namespace qc
 {
-typedef std::unordered_map<std::string, TList*> TCollectionMap;
+/// Running merge of the objects received with the same title
+struct MergeAccumulator {
+  std::mutex mutex;
+  TObject* result{ nullptr };
+  int numberOfMergedObjects{ 0 };
+  std::chrono::microseconds mergeTime{ 0 };
+};
+
+typedef std::unordered_map<std::string, std::unique_ptr<MergeAccumulator>> TAccumulatorMap;
 
+/// Merges the objects with the same title as they arrive: each one is folded into the running result and deleted,
+/// the result is returned once the required number of objects was merged. Objects with distinct titles can be
+/// merged concurrently from several threads.
 class Merger
 {
  public:
@@ -28,17 +43,19 @@ class Merger
   virtual ~Merger();
 
   TObject* mergeObject(TObject* object);
-  TObject* mergeObjectWithGivenCollection(TObject* object);
-  void addReceivedObjectToMapByName(TObject* receivedObject);
   double getMergeTime();
   void dumpObjectsCollectionToFile(const char* title);
   void eraseCollection(const char* title);
 
  private:
-  TCollectionMap mTitlesToDataObjectsMap;
-  std::chrono::microseconds mMergeTime{ 0 };
+  MergeAccumulator* getAccumulator(const char* title);
+  bool mergeDelta(TObject* result, TObject* delta);
+
+  std::mutex mAccumulatorsMutex;
+  TAccumulatorMap mTitlesToAccumulatorsMap;
+  std::atomic<long long> mMergeTime{ 0 }; // microseconds
   unsigned int mNumberOfDumpedObjects{ 0 };
   const int NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA;
 };
 }
-}
\ No newline at end of file
+}
@@ -14,6 +14,7 @@
 #include <ctime>
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include <boost/property_tree/ptree.hpp>
@@ -24,6 +25,7 @@
 #include <dds_intercom.h>
 
 #include "Merger.h"
+#include "WorkQueue.h"
 
 namespace o2
 {
@@ -32,10 +34,11 @@ namespace qc
 class MergerDevice : public FairMQDevice
 {
  public:
-  MergerDevice(std::unique_ptr<Merger> merger, std::string producerId);
+  MergerDevice(std::unique_ptr<Merger> merger, std::string producerId, unsigned numberOfWorkers = 1);
   ~MergerDevice() override;
 
   static void deleteTMessage(void* data, void* hint);
+  static void deleteBuffer(void* data, void* hint);
   void establishChannel(std::string type, std::string method, std::string address, std::string channelName,
                         int receiveBuffer, int sendBuffer);
   void executeRunLoop();
@@ -49,10 +52,11 @@ class MergerDevice : public FairMQDevice
   void subscribeOnError();
   boost::property_tree::ptree createCheckStateResponse(const boost::property_tree::ptree& request);
   boost::property_tree::ptree createGetMetricsResponse(const boost::property_tree::ptree& request);
-  void handleReceivedDataObject();
-  TObject* receiveDataObjectFromProducer();
-  TMessage* createTMessageForViewer(const TObject* objectToSend) const;
-  size_t sendMergedObjectToViewer(TObject* dataObject);
+  void mergeReceivedObjects();
+  void sendMergedObjects();
+  TObject* deserializeDataObject(FairMQMessage& input) const;
+  std::unique_ptr<FairMQMessage> createMessageForViewer(const TObject* objectToSend);
+  size_t sendMergedObjectToViewer(std::unique_ptr<FairMQMessage> viewerRequest);
   void sendControlResponse(const boost::property_tree::ptree& response, std::string senderId);
   std::string getVmRSSUsage();
   double calculateAvgMegreTime();
@@ -61,9 +65,16 @@ class MergerDevice : public FairMQDevice
   void updateMetrics();
   inline bool isObjectNotEmpty(const TObject* object) const;
 
+  static constexpr size_t QUEUE_CAPACITY = 1000;
+
   std::unique_ptr<Merger> mMerger;
+  const unsigned mNumberOfWorkers;
+  // received messages are deserialized and merged by the workers, the merged objects are sent by a single thread
+  WorkQueue<std::unique_ptr<FairMQMessage>> mReceivedMessages{ QUEUE_CAPACITY };
+  WorkQueue<std::unique_ptr<FairMQMessage>> mMergedMessages{ QUEUE_CAPACITY };
   dds::intercom_api::CIntercomService mService;
   std::unique_ptr<dds::intercom_api::CCustomCmd> ddsCustomCmd;
+  std::mutex mMetricsMutex;
   std::deque<double> mMergeTimes;
 
   std::chrono::high_resolution_clock::time_point lastCpuMeasuredTime;
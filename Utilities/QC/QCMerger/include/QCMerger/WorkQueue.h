@@ -0,0 +1,81 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace o2
+{
+namespace qc
+{
+/// Bounded queue handing the messages over between the receiving, merging and sending threads
+template <typename T>
+class WorkQueue
+{
+ public:
+  explicit WorkQueue(size_t capacity) : mCapacity(capacity) {}
+
+  /// Blocks while the queue is full, returns false if the queue was closed
+  bool push(T&& item)
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mNotFull.wait(lock, [this] { return mClosed || mItems.size() < mCapacity; });
+
+    if (mClosed) {
+      return false;
+    }
+    mItems.push_back(std::move(item));
+    mNotEmpty.notify_one();
+    return true;
+  }
+
+  /// Blocks while the queue is empty, returns false once the queue is closed and empty
+  bool pop(T& item)
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mNotEmpty.wait(lock, [this] { return mClosed || !mItems.empty(); });
+
+    if (mItems.empty()) {
+      return false;
+    }
+    item = std::move(mItems.front());
+    mItems.pop_front();
+    mNotFull.notify_one();
+    return true;
+  }
+
+  bool isFull() const
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mItems.size() >= mCapacity;
+  }
+
+  /// Wakes up all the waiting threads, the remaining items can still be popped
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mClosed = true;
+    mNotEmpty.notify_all();
+    mNotFull.notify_all();
+  }
+
+ private:
+  mutable std::mutex mMutex;
+  std::condition_variable mNotEmpty;
+  std::condition_variable mNotFull;
+  std::deque<T> mItems;
+  const size_t mCapacity;
+  bool mClosed{ false };
+};
+}
+}
@@ -14,10 +14,12 @@
 #include <TH2.h>
 #include <TH3.h>
 #include <THn.h>
+#include <TList.h>
 #include <TTree.h>
 
 #include "QCMerger/Merger.h"
 
+#include <cstring>
 #include <sstream>
 
 using namespace std;
@@ -33,104 +35,101 @@ Merger::Merger(const int numberOfQCOgbjectForCompleteData)
 
 TObject* Merger::mergeObject(TObject* object)
 {
-  auto foundEntry = mTitlesToDataObjectsMap.find(object->GetTitle());
+  MergeAccumulator* accumulator = getAccumulator(object->GetTitle());
+  lock_guard<mutex> lock(accumulator->mutex);
 
-  if (foundEntry != mTitlesToDataObjectsMap.end() &&
-      foundEntry->second->GetSize() >= NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA - 1) {
-    TObject* output = mergeObjectWithGivenCollection(object);
-    eraseCollection(object->GetTitle());
-    return output;
+  if (accumulator->result == nullptr) {
+    accumulator->result = object;
   } else {
-    addReceivedObjectToMapByName(object);
+    auto measureTime = chrono::high_resolution_clock::now();
+    mergeDelta(accumulator->result, object);
+    accumulator->mergeTime +=
+      chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - measureTime);
+    delete object;
+  }
+
+  if (++accumulator->numberOfMergedObjects < NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA) {
     return nullptr;
   }
+
+  TObject* output = accumulator->result;
+  mMergeTime = accumulator->mergeTime.count();
+  accumulator->result = nullptr;
+  accumulator->numberOfMergedObjects = 0;
+  accumulator->mergeTime = chrono::microseconds{ 0 };
+  return output;
 }
 
-void Merger::addReceivedObjectToMapByName(TObject* receivedObject)
+MergeAccumulator* Merger::getAccumulator(const char* title)
 {
-  auto foundList = mTitlesToDataObjectsMap.find(receivedObject->GetTitle());
+  // accumulators are never removed from the map, the pointer stays valid once the map is unlocked
+  lock_guard<mutex> lock(mAccumulatorsMutex);
+  auto& accumulator = mTitlesToAccumulatorsMap[title];
 
-  if (foundList != mTitlesToDataObjectsMap.end()) {
-    foundList->second->Add(receivedObject);
-  } else {
-    auto newItemIterator = mTitlesToDataObjectsMap.insert(make_pair(receivedObject->GetTitle(), new TList()));
-    newItemIterator.first->second->Add(receivedObject);
+  if (!accumulator) {
+    accumulator.reset(new MergeAccumulator());
   }
+  return accumulator.get();
 }
 
 void Merger::eraseCollection(const char* title)
 {
-  auto foundCollection = mTitlesToDataObjectsMap.find(title);
-  foundCollection->second->Delete();
-  delete foundCollection->second;
-  mTitlesToDataObjectsMap.erase(foundCollection);
+  MergeAccumulator* accumulator = getAccumulator(title);
+  lock_guard<mutex> lock(accumulator->mutex);
+  delete accumulator->result;
+  accumulator->result = nullptr;
+  accumulator->numberOfMergedObjects = 0;
+  accumulator->mergeTime = chrono::microseconds{ 0 };
 }
 
 void Merger::dumpObjectsCollectionToFile(const char* title)
 {
-  auto foundCollection = mTitlesToDataObjectsMap.find(title);
-
-  ostringstream fileName;
-  fileName << ++mNumberOfDumpedObjects << "_" << title << ".root";
-  foundCollection->second->SaveAs(fileName.str().c_str());
-  foundCollection->second->Delete();
-  delete foundCollection->second;
-  mTitlesToDataObjectsMap.erase(foundCollection);
+  MergeAccumulator* accumulator = getAccumulator(title);
+  {
+    lock_guard<mutex> lock(accumulator->mutex);
+
+    if (accumulator->result != nullptr) {
+      ostringstream fileName;
+      fileName << ++mNumberOfDumpedObjects << "_" << title << ".root";
+      accumulator->result->SaveAs(fileName.str().c_str());
+    }
+  }
+  eraseCollection(title);
 }
 
-TObject* Merger::mergeObjectWithGivenCollection(TObject* mergedObject)
+bool Merger::mergeDelta(TObject* result, TObject* delta)
 {
-  TCollection* mergeList = mTitlesToDataObjectsMap.find(mergedObject->GetTitle())->second;
-
-  TObject* result = nullptr;
-  TH1F* histogram1F = nullptr;
-  TH2F* histogram2F = nullptr;
-  TH3F* histogram3F = nullptr;
-  THnF* histogramNF = nullptr;
-  TTree* tree = nullptr;
-  const char* className = mergedObject->ClassName();
-
-  auto measureTime = chrono::high_resolution_clock::now();
+  TList deltaList;
+  deltaList.Add(delta);
+  const char* className = result->ClassName();
 
   if (strcmp(className, "TH1F") == 0) {
-    histogram1F = reinterpret_cast<TH1F*>(mergedObject);
-    histogram1F->Merge(mergeList);
-    result = histogram1F;
+    reinterpret_cast<TH1F*>(result)->Merge(&deltaList);
   } else if (strcmp(className, "TH2F") == 0) {
-    histogram2F = reinterpret_cast<TH2F*>(mergedObject);
-    histogram2F->Merge(mergeList);
-    result = histogram2F;
+    reinterpret_cast<TH2F*>(result)->Merge(&deltaList);
   } else if (strcmp(className, "TH3F") == 0) {
-    histogram3F = reinterpret_cast<TH3F*>(mergedObject);
-    histogram3F->Merge(mergeList);
-    result = histogram3F;
+    reinterpret_cast<TH3F*>(result)->Merge(&deltaList);
   } else if (strcmp(className, "THnT<float>") == 0) {
-    histogramNF = reinterpret_cast<THnF*>(mergedObject);
-    histogramNF->Merge(mergeList);
-    result = histogramNF;
+    reinterpret_cast<THnF*>(result)->Merge(&deltaList);
   } else if (strcmp(className, "TTree") == 0) {
-    tree = reinterpret_cast<TTree*>(mergedObject);
-    tree->Merge(mergeList);
-    result = tree;
+    reinterpret_cast<TTree*>(result)->Merge(&deltaList);
   } else {
     LOG(ERROR) << "Object with type " << className << " is not one of mergable type.";
+    return false;
   }
-
-  mMergeTime = chrono::duration_cast<std::chrono::microseconds>(chrono::high_resolution_clock::now() - measureTime);
-
-  return mergedObject;
+  return true;
 }
 
 double Merger::getMergeTime()
 {
-  return mMergeTime.count() / 1000.0; // in miliseconds
+  return mMergeTime / 1000.0; // in miliseconds
 }
 
 Merger::~Merger()
 {
-  for (auto const& entry : mTitlesToDataObjectsMap) {
-    entry.second->Delete();
+  for (auto const& entry : mTitlesToAccumulatorsMap) {
+    delete entry.second->result;
   }
 }
 }
-}
\ No newline at end of file
+}
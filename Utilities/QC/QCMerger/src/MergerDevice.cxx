@@ -8,8 +8,10 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 
+#include <algorithm>
 #include <ratio>
 #include <thread>
+#include <vector>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
@@ -17,8 +19,12 @@
 
 #include <FairMQLogger.h>
 
+#include <TH1.h>
+#include <TROOT.h>
+
 #include <dds_intercom.h>
 
+#include "QCCommon/FlatHistogram.h"
 #include "QCCommon/TMessageWrapper.h"
 #include "QCMerger/MergerDevice.h"
 
@@ -32,8 +38,8 @@ namespace o2
 {
 namespace qc
 {
-MergerDevice::MergerDevice(unique_ptr<Merger> merger, string mergerId)
-  : mMerger(move(merger)), ddsCustomCmd(new CCustomCmd(mService))
+MergerDevice::MergerDevice(unique_ptr<Merger> merger, string mergerId, unsigned numberOfWorkers)
+  : mMerger(move(merger)), mNumberOfWorkers(max(numberOfWorkers, 1u)), ddsCustomCmd(new CCustomCmd(mService))
 {
   this->SetTransport("zeromq");
   this->SetId(mergerId);
@@ -46,6 +52,7 @@ MergerDevice::MergerDevice(unique_ptr<Merger> merger, string mergerId)
 
 MergerDevice::~MergerDevice() { procSelfStatus.close(); }
 void MergerDevice::deleteTMessage(void* data, void* hint) { delete static_cast<TMessage*>(hint); }
+void MergerDevice::deleteBuffer(void* data, void* hint) { delete static_cast<vector<char>*>(hint); }
 void MergerDevice::establishChannel(string type, string method, string address, string channelName, int receiveBuffer,
                                     int sendBuffer)
 {
@@ -164,22 +171,86 @@ void MergerDevice::sendControlResponse(const ptree& response, string senderId)
 
 void MergerDevice::Run()
 {
+  // objects are deserialized, merged and serialized by the workers
+  ROOT::EnableThreadSafety();
+  TH1::AddDirectory(kFALSE);
+
+  vector<thread> workers;
+  for (unsigned i = 0; i < mNumberOfWorkers; ++i) {
+    workers.emplace_back(&MergerDevice::mergeReceivedObjects, this);
+  }
+  thread sender(&MergerDevice::sendMergedObjects, this);
+
   while (CheckCurrentState(RUNNING)) {
-    handleReceivedDataObject();
+    unique_ptr<FairMQMessage> input(NewMessage());
+
+    // blocks until a message arrives, the timeout only lets the state be checked
+    if (Receive(input, "data-in", 0, 100) <= 0) {
+      continue;
+    }
+
+    if (mReceivedMessages.isFull()) {
+      mLastReceiveBufferOverloadTime = clock();
+      mReceiveBufferOverloaded = true;
+      LOG(DEBUG) << "Merging queue is full. Waiting for free space...";
+    }
+
+    mReceivedMessages.push(move(input));
+
+    if (mReceiveBufferOverloaded) {
+      mReceiveBufferOverloaded = false;
+      LOG(DEBUG) << "Queue was released after " << double(clock() - mLastReceiveBufferOverloadTime) / CLOCKS_PER_SEC
+                 << " seconds.";
+    }
+  }
+
+  mReceivedMessages.close();
+  for (auto& worker : workers) {
+    worker.join();
   }
+  mMergedMessages.close();
+  sender.join();
 }
 
-void MergerDevice::handleReceivedDataObject()
+void MergerDevice::mergeReceivedObjects()
 {
-  TObject* receivedObject = receiveDataObjectFromProducer();
+  unique_ptr<FairMQMessage> input;
+
+  while (mReceivedMessages.pop(input)) {
+    TObject* receivedObject = deserializeDataObject(*input);
+    input.reset();
+
+    if (isObjectNotEmpty(receivedObject)) {
+      // objects with distinct titles are merged concurrently, each new object is folded into the running result
+      TObject* mergedObject = mMerger->mergeObject(receivedObject);
+
+      if (isObjectNotEmpty(mergedObject)) {
+        updateMetrics();
+        unique_ptr<FairMQMessage> viewerMessage(createMessageForViewer(mergedObject));
+        delete mergedObject;
+
+        if (mMergedMessages.isFull()) {
+          mLastSendBufferOverloadTime = clock();
+          mSendBufferOverloaded = true;
+          LOG(DEBUG) << "Queue of data-out channel is full. Waiting for free space...";
+        }
+        mMergedMessages.push(move(viewerMessage));
+      }
+    }
+  }
+}
 
-  if (isObjectNotEmpty(receivedObject)) {
-    TObject* mergedObject = mMerger->mergeObject(receivedObject);
+void MergerDevice::sendMergedObjects()
+{
+  unique_ptr<FairMQMessage> viewerMessage;
 
-    if (isObjectNotEmpty(mergedObject)) {
-      updateMetrics();
-      size_t messageSize = sendMergedObjectToViewer(mergedObject);
-      delete mergedObject;
+  while (mMergedMessages.pop(viewerMessage)) {
+    sendMergedObjectToViewer(move(viewerMessage));
+
+    if (mSendBufferOverloaded && !mMergedMessages.isFull()) {
+      mSendBufferOverloaded = false;
+      LOG(DEBUG) << "Queue was released after " << double(clock() - mLastSendBufferOverloadTime) / CLOCKS_PER_SEC
+                 << " seconds.";
     }
   }
 }
@@ -187,6 +258,7 @@ void MergerDevice::handleReceivedDataObject()
 bool MergerDevice::isObjectNotEmpty(const TObject* object) const { return object == nullptr ? false : true; }
 void MergerDevice::updateMetrics()
 {
+  lock_guard<mutex> lock(mMetricsMutex);
   mNumberOfMergedObjects++;
 
   if (mMergeTimes.size() >= LOGGED_MESSAGES) {
@@ -196,68 +268,52 @@ void MergerDevice::updateMetrics()
   mMergeTimes.push_front(mMerger->getMergeTime());
 }
 
-TMessage* MergerDevice::createTMessageForViewer(const TObject* objectToSend) const
+unique_ptr<FairMQMessage> MergerDevice::createMessageForViewer(const TObject* objectToSend)
 {
+  // the merged histograms hold the increments of the producers since their last publication
+  auto flatHistogram = FlatHistogram::fromROOT(objectToSend, true);
+
+  if (flatHistogram) {
+    auto* buffer = new vector<char>();
+    flatHistogram->serialize(*buffer);
+    return unique_ptr<FairMQMessage>(
+      fTransportFactory->CreateMessage(buffer->data(), buffer->size(), deleteBuffer, buffer));
+  }
+
   auto* viewerMessage = new TMessage(kMESS_OBJECT);
   viewerMessage->WriteObject(objectToSend);
-  return viewerMessage;
+  return unique_ptr<FairMQMessage>(fTransportFactory->CreateMessage(viewerMessage->Buffer(),
+                                                                    viewerMessage->BufferSize(), deleteTMessage,
+                                                                    viewerMessage));
 }
 
-TObject* MergerDevice::receiveDataObjectFromProducer()
+TObject* MergerDevice::deserializeDataObject(FairMQMessage& input) const
 {
-  int respondeCode;
-  TObject* receivedDataObject;
-  unique_ptr<FairMQMessage> input(NewMessage());
-
-  if ((respondeCode = fChannels.at("data-in").at(0).ReceiveAsync(input)) == -2) {
-    if ((respondeCode = fChannels.at("data-in").at(0).ReceiveAsync(input)) == -2) {
-      mLastReceiveBufferOverloadTime = clock();
-      mReceiveBufferOverloaded = true;
-      LOG(DEBUG) << "Buffer of data-in channel is full. Waiting for free buffer...";
+  if (input.GetSize() == 0) {
+    LOG(ERROR) << "Received empty message from producer, nothing to merge";
+    return nullptr;
+  }
 
-      while ((respondeCode = fChannels.at("data-in").at(0).ReceiveAsync(input)) == -2) {
-        this_thread::sleep_for(chrono::milliseconds(10));
-      }
+  if (FlatHistogram::isFlatHistogram(input.GetData(), input.GetSize())) {
+    auto flatHistogram = FlatHistogram::deserialize(input.GetData(), input.GetSize());
 
-      mReceiveBufferOverloaded = false;
-      LOG(DEBUG) << "Buffer was released after " << double(clock() - mLastReceiveBufferOverloadTime) / CLOCKS_PER_SEC
-                 << " seconds.";
+    if (!flatHistogram) {
+      LOG(ERROR) << "Received malformed histogram from producer, nothing to merge";
+      return nullptr;
     }
+    return flatHistogram->toROOT();
   }
 
-  if (respondeCode >= 0) {
-    TMessage* message = new TMessageWrapper(input->GetData(), input->GetSize());
-    receivedDataObject = reinterpret_cast<TObject*>(message->ReadObject(message->GetClass()));
-    delete message;
-  } else {
-    LOG(ERROR) << "Received empty message from producer, nothing to merge";
-    receivedDataObject = nullptr;
-  }
-
-  return receivedDataObject;
+  TMessageWrapper message(input.GetData(), input.GetSize());
+  return reinterpret_cast<TObject*>(message.ReadObject(message.GetClass()));
 }
 
-size_t MergerDevice::sendMergedObjectToViewer(TObject* dataObject)
+size_t MergerDevice::sendMergedObjectToViewer(unique_ptr<FairMQMessage> viewerRequest)
 {
-  int respondeCode;
-  TMessage* viewerMessage = createTMessageForViewer(dataObject);
-  unique_ptr<FairMQMessage> viewerRequest(fTransportFactory->CreateMessage(
-    viewerMessage->Buffer(), viewerMessage->BufferSize(), deleteTMessage, viewerMessage));
   size_t messageSize = viewerRequest->GetSize();
-  if ((respondeCode = fChannels.at("data-out").at(0).SendAsync(viewerRequest)) == -2) {
-    if ((respondeCode = fChannels.at("data-out").at(0).SendAsync(viewerRequest)) == -2) {
-      mLastSendBufferOverloadTime = clock();
-      mSendBufferOverloaded = true;
-      LOG(DEBUG) << "Buffer of data-out channel is full. Waiting for free buffer...";
-
-      while ((respondeCode = fChannels.at("data-out").at(0).SendAsync(viewerRequest)) == -2) {
-        this_thread::sleep_for(chrono::milliseconds(10));
-      }
 
-      mSendBufferOverloaded = false;
-      LOG(DEBUG) << "Buffer was released after " << double(clock() - mLastSendBufferOverloadTime) / CLOCKS_PER_SEC
-                 << " seconds.";
-    }
+  // the timeout only lets the state be checked, the queue of merged objects waits meanwhile
+  while (Send(viewerRequest, "data-out", 0, 100) == -2 && CheckCurrentState(RUNNING)) {
   }
 
   return messageSize;
@@ -265,6 +321,7 @@ size_t MergerDevice::sendMergedObjectToViewer(TObject* dataObject)
 
 double MergerDevice::calculateAvgMegreTime()
 {
+  lock_guard<mutex> lock(mMetricsMutex);
   double sum = 0.;
 
   for (double entry : mMergeTimes) {
@@ -319,6 +376,7 @@ double MergerDevice::calculateNumberOfMergedObjectsPerSecond()
     std::chrono::duration_cast<std::chrono::microseconds>(measureTime - mLastNumberOfMergeObjectsTime).count();
 
   mLastNumberOfMergeObjectsTime = measureTime;
+  lock_guard<mutex> lock(mMetricsMutex);
   double normalizeFactor = 1.0 / (elapsedTime / 1000000.0);
   double mergedObjectsPerSecond = mNumberOfMergedObjects * normalizeFactor;
   mNumberOfMergedObjects = 0;
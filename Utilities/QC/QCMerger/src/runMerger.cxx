@@ -8,13 +8,17 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 #include <FairMQLogger.h>
 #include <TApplication.h>
@@ -39,6 +43,9 @@ namespace bpo = boost::program_options;
 namespace
 {
 const int NUMBER_OF_REQUIRED_PROGRAM_PARAMETERS = 6;
+// time given to the next merger to publish its address, during which this merger publishes its own one again
+const chrono::seconds ADDRESS_PUBLICATION_TIME(60);
+const chrono::seconds ADDRESS_REPUBLICATION_PERIOD(1);
 ostringstream localAddress;
 
 string exec(const char* cmd)
@@ -62,15 +69,42 @@ string exec(const char* cmd)
 
 int main(int argc, char** argv)
 {
+  if (argc != NUMBER_OF_REQUIRED_PROGRAM_PARAMETERS + 1 && argc != NUMBER_OF_REQUIRED_PROGRAM_PARAMETERS + 2) {
+    LOG(ERROR) << "Not sufficient arguments value: " << NUMBER_OF_REQUIRED_PROGRAM_PARAMETERS;
+    exit(-1);
+  }
+
   CIntercomService service;
   CKeyValue keyValue(service);
 
   const char* inputAddress = argv[1];
 
+  // an output which is not an address is the DDS property holding the input address of the next merger of the
+  // merge tree, published by that merger
+  string outputAddress = argv[6];
+  const string outputTopologyProperty = outputAddress;
+  bool outputAddressKnown = outputAddress.find("://") != string::npos;
+  mutex keyMutex;
+  condition_variable keyCondition;
+
   service.subscribeOnError([](EErrorCode _errorCode, const string& _msg) {
     LOG(ERROR) << "DDS key-value error code: " << _errorCode << ", message: " << _msg;
   });
 
+  if (!outputAddressKnown) {
+    keyValue.subscribe([&](const string& _propertyID, const string& _key, const string& _value) {
+      if (outputTopologyProperty.compare(_propertyID) == 0) {
+        // the next merger publishes its address repeatedly, only the first value is taken
+        lock_guard<mutex> lock(keyMutex);
+        if (!outputAddressKnown) {
+          outputAddress = _value;
+          outputAddressKnown = true;
+          keyCondition.notify_all();
+        }
+      }
+    });
+  }
+
   service.start();
 
   localAddress << "tcp://" << exec("hostname -i") << ":" << argv[4];
@@ -79,15 +113,33 @@ int main(int argc, char** argv)
 
   keyValue.putValue(inputAddress, stringLocalAddress.c_str());
 
-  if (argc != NUMBER_OF_REQUIRED_PROGRAM_PARAMETERS + 1) {
-    LOG(ERROR) << "Not sufficient arguments value: " << NUMBER_OF_REQUIRED_PROGRAM_PARAMETERS;
-    exit(-1);
-  }
+  // the intercom API delivers the updates of a property but cannot query its current value: the producers and
+  // mergers subscribing after the put above would wait forever, the address is published again meanwhile
+  bool publicationStopped = false;
+  condition_variable publicationCondition;
+  thread publisher([&] {
+    const auto end = chrono::steady_clock::now() + ADDRESS_PUBLICATION_TIME;
+    unique_lock<mutex> lock(keyMutex);
+    while (!publicationCondition.wait_for(lock, ADDRESS_REPUBLICATION_PERIOD, [&] { return publicationStopped; }) &&
+           chrono::steady_clock::now() < end) {
+      lock.unlock();
+      keyValue.putValue(inputAddress, stringLocalAddress.c_str());
+      lock.lock();
+    }
+  });
+  auto stopPublication = [&] {
+    {
+      lock_guard<mutex> lock(keyMutex);
+      publicationStopped = true;
+      publicationCondition.notify_all();
+    }
+    publisher.join();
+  };
 
   const char* MERGER_DEVICE_ID = argv[2];
   const int NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA = atoi(argv[3]);
   const int INPUT_BUFFER_SIZE = atoi(argv[5]);
-  const char* OUTPUT_HOST = argv[6];
+  const unsigned NUMBER_OF_WORKERS = argc > NUMBER_OF_REQUIRED_PROGRAM_PARAMETERS + 1 ? atoi(argv[7]) : 1;
 
   bpo::options_description options("task-custom-cmd options");
   options.add_options()("help,h", "Produce help message");
@@ -96,15 +148,31 @@ int main(int argc, char** argv)
   bpo::store(bpo::command_line_parser(argc, argv).options(options).run(), vm);
   bpo::notify(vm);
 
-  MergerDevice mergerDevice(unique_ptr<Merger>(new Merger(NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA)), MERGER_DEVICE_ID);
+  MergerDevice mergerDevice(unique_ptr<Merger>(new Merger(NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA)), MERGER_DEVICE_ID,
+                            NUMBER_OF_WORKERS);
 
   LOG(INFO) << "PID: " << getpid();
   LOG(INFO) << "Merger id: " << mergerDevice.GetId();
+  LOG(INFO) << "Merging workers: " << NUMBER_OF_WORKERS;
+
+  {
+    unique_lock<mutex> lock(keyMutex);
+    if (!keyCondition.wait_for(lock, ADDRESS_PUBLICATION_TIME, [&outputAddressKnown] { return outputAddressKnown; })) {
+      LOG(ERROR) << R"(No output address published in the DDS property ")" << outputTopologyProperty << R"(" within )"
+                 << ADDRESS_PUBLICATION_TIME.count() << " s";
+      lock.unlock();
+      stopPublication();
+      return -1;
+    }
+  }
+
+  LOG(INFO) << "Output address: " << outputAddress;
 
   mergerDevice.establishChannel("pull", "bind", stringLocalAddress.c_str(), "data-in", INPUT_BUFFER_SIZE,
                                 INPUT_BUFFER_SIZE);
-  mergerDevice.establishChannel("push", "connect", OUTPUT_HOST, "data-out", numeric_limits<int>::max(),
+  mergerDevice.establishChannel("push", "connect", outputAddress, "data-out", numeric_limits<int>::max(),
                                 numeric_limits<int>::max());
 
   mergerDevice.executeRunLoop();
+  stopPublication();
 }
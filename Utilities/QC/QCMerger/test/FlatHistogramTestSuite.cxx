@@ -0,0 +1,167 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE FlatHistogram
+#define BOOST_TEST_MAIN
+
+#include <TH1F.h>
+#include <TH2F.h>
+#include <TH3F.h>
+#include <THn.h>
+#include <boost/test/unit_test.hpp>
+#include <memory>
+#include <vector>
+
+#include "QCCommon/FlatHistogram.h"
+
+using namespace std;
+using o2::qc::FlatHistogram;
+
+namespace
+{
+const double BIN_TOLERANCE = 1e-6;
+
+unique_ptr<TObject> roundtrip(const TObject* object, bool delta = false)
+{
+  auto flat = FlatHistogram::fromROOT(object, delta);
+  BOOST_REQUIRE(flat != nullptr);
+  vector<char> buffer;
+  flat->serialize(buffer);
+  BOOST_REQUIRE(FlatHistogram::isFlatHistogram(buffer.data(), buffer.size()));
+  auto decoded = FlatHistogram::deserialize(buffer.data(), buffer.size());
+  BOOST_REQUIRE(decoded != nullptr);
+  BOOST_CHECK_EQUAL(decoded->isDelta(), delta);
+  return unique_ptr<TObject>(decoded->toROOT());
+}
+
+void checkSameHistogram(const TH1& expected, const TObject* object)
+{
+  BOOST_REQUIRE(object != nullptr);
+  BOOST_REQUIRE_EQUAL(string(object->ClassName()), string(expected.ClassName()));
+  auto histogram = static_cast<const TH1*>(object);
+  BOOST_CHECK_EQUAL(string(histogram->GetName()), string(expected.GetName()));
+  BOOST_CHECK_EQUAL(string(histogram->GetTitle()), string(expected.GetTitle()));
+  BOOST_REQUIRE_EQUAL(histogram->GetNcells(), expected.GetNcells());
+  BOOST_CHECK_CLOSE(histogram->GetEntries(), expected.GetEntries(), BIN_TOLERANCE);
+  for (int cell = 0; cell < expected.GetNcells(); ++cell) {
+    BOOST_CHECK_CLOSE(histogram->GetBinContent(cell), expected.GetBinContent(cell), BIN_TOLERANCE);
+    BOOST_CHECK_CLOSE(histogram->GetBinError(cell), expected.GetBinError(cell), BIN_TOLERANCE);
+  }
+  BOOST_CHECK_CLOSE(histogram->GetMean(), expected.GetMean(), BIN_TOLERANCE);
+}
+}
+
+BOOST_AUTO_TEST_SUITE(FlatHistogramTestSuite)
+
+BOOST_AUTO_TEST_CASE(roundtripTH1F)
+{
+  TH1F dense("dense", "dense title", 20, -10., 10.);
+  for (int i = 0; i < 1000; ++i) {
+    dense.Fill(-12. + 0.024 * i);
+  }
+  checkSameHistogram(dense, roundtrip(&dense).get());
+
+  // few filled bins of a large histogram are sent sparse, weights need the errors
+  TH1F sparse("sparse", "sparse title", 10000, 0., 10000.);
+  sparse.Sumw2();
+  sparse.Fill(3.5, 2.);
+  sparse.Fill(3.5, 0.5);
+  sparse.Fill(9000.5, 3.);
+  checkSameHistogram(sparse, roundtrip(&sparse).get());
+}
+
+BOOST_AUTO_TEST_CASE(roundtripTH2F)
+{
+  const double edges[] = { 0., 1., 3., 7., 15. };
+  TH2F histogram("th2", "th2 title", 4, edges, 5, -5., 5.);
+  for (int i = 0; i < 200; ++i) {
+    histogram.Fill(0.1 * i, -6. + 0.06 * i, 1. + (i % 3));
+  }
+  checkSameHistogram(histogram, roundtrip(&histogram).get());
+}
+
+BOOST_AUTO_TEST_CASE(roundtripTH3F)
+{
+  TH3F histogram("th3", "th3 title", 4, 0., 4., 3, 0., 3., 2, 0., 2.);
+  for (int i = 0; i < 50; ++i) {
+    histogram.Fill(i % 5, i % 4, i % 3);
+  }
+  checkSameHistogram(histogram, roundtrip(&histogram).get());
+}
+
+BOOST_AUTO_TEST_CASE(roundtripTHnF)
+{
+  const Int_t nBins[] = { 3, 4, 2, 5 };
+  const Double_t min[] = { 0., 0., 0., 0. };
+  const Double_t max[] = { 3., 4., 2., 5. };
+  THnF histogram("thn", "thn title", 4, nBins, min, max);
+  histogram.Sumw2();
+  for (int i = 0; i < 100; ++i) {
+    const Double_t point[] = { i % 3 + 0.5, i % 4 + 0.5, i % 2 + 0.5, i % 7 - 0.5 };
+    histogram.Fill(point, 0.5 + (i % 2));
+  }
+
+  auto decoded = roundtrip(&histogram);
+  BOOST_REQUIRE(decoded != nullptr);
+  BOOST_REQUIRE_EQUAL(string(decoded->ClassName()), string(histogram.ClassName()));
+  auto result = static_cast<const THnF*>(decoded.get());
+  BOOST_REQUIRE_EQUAL(result->GetNdimensions(), histogram.GetNdimensions());
+  BOOST_REQUIRE_EQUAL(result->GetNbins(), histogram.GetNbins());
+  BOOST_CHECK_CLOSE(result->GetEntries(), histogram.GetEntries(), BIN_TOLERANCE);
+  for (Long64_t cell = 0; cell < histogram.GetNbins(); ++cell) {
+    BOOST_CHECK_CLOSE(result->GetBinContent(cell), histogram.GetBinContent(cell), BIN_TOLERANCE);
+    BOOST_CHECK_CLOSE(result->GetBinError2(cell), histogram.GetBinError2(cell), BIN_TOLERANCE);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(addDeltas)
+{
+  TH2F first("delta", "delta title", 5, 0., 5., 5, 0., 5.);
+  TH2F second("delta", "delta title", 5, 0., 5., 5, 0., 5.);
+  TH2F total("delta", "delta title", 5, 0., 5., 5, 0., 5.);
+  for (int i = 0; i < 30; ++i) {
+    first.Fill(i % 5, i % 3);
+    total.Fill(i % 5, i % 3);
+  }
+  // weighted increments promote the accumulated histogram to errors from the sum of squares
+  second.Sumw2();
+  total.Sumw2();
+  for (int i = 0; i < 20; ++i) {
+    second.Fill(i % 4, i % 5, 2.);
+    total.Fill(i % 4, i % 5, 2.);
+  }
+
+  auto accumulated = FlatHistogram::fromROOT(&first, true);
+  auto increment = FlatHistogram::fromROOT(&second, true);
+  vector<char> buffer;
+  increment->serialize(buffer);
+  auto decoded = FlatHistogram::deserialize(buffer.data(), buffer.size());
+  BOOST_REQUIRE(decoded != nullptr);
+  BOOST_REQUIRE(accumulated->add(*decoded));
+  checkSameHistogram(total, unique_ptr<TObject>(accumulated->toROOT()).get());
+
+  // a different binning is rejected
+  TH2F other("delta", "delta title", 4, 0., 5., 5, 0., 5.);
+  BOOST_CHECK(!accumulated->add(*FlatHistogram::fromROOT(&other, true)));
+}
+
+BOOST_AUTO_TEST_CASE(rejectInvalidData)
+{
+  TH1F histogram("invalid", "invalid title", 10, 0., 10.);
+  histogram.Fill(1.);
+  vector<char> buffer;
+  FlatHistogram::fromROOT(&histogram, false)->serialize(buffer);
+  BOOST_CHECK(FlatHistogram::deserialize(buffer.data(), buffer.size() - 1) == nullptr);
+  buffer[0] = 0;
+  BOOST_CHECK(!FlatHistogram::isFlatHistogram(buffer.data(), buffer.size()));
+  BOOST_CHECK(FlatHistogram::deserialize(buffer.data(), buffer.size()) == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -12,14 +12,19 @@
 #define BOOST_TEST_MAIN
 
 #include <TH1F.h>
+#include <TROOT.h>
 #include <boost/test/unit_test.hpp>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "QCMerger/Merger.h"
-#include "QCMerger/MergerDevice.h"
 
 using namespace std;
+using o2::qc::Merger;
 
 namespace
 {
@@ -50,7 +55,9 @@ BOOST_AUTO_TEST_CASE(mergeTenHistograms)
     TObject* mergedObject = merger->mergeObject(histograms.at(i));
 
     if (i % NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA != 0) {
-      BOOST_TEST(mergedObject->GetName() == HISTOGRAM_NAME, "Wrong name of histogram: " << mergedObject->GetName());
+      BOOST_REQUIRE(mergedObject != nullptr);
+      BOOST_TEST(string(mergedObject->GetName()) == HISTOGRAM_NAME,
+                 "Wrong name of histogram: " << mergedObject->GetName());
       BOOST_TEST(reinterpret_cast<TH1F*>(mergedObject)->GetEntries() ==
                  (NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA * NUMBER_OF_ENTRIES));
 
@@ -63,4 +70,53 @@ BOOST_AUTO_TEST_CASE(mergeTenHistograms)
   }
 }
 
+BOOST_AUTO_TEST_CASE(mergeTitlesConcurrently)
+{
+  ROOT::EnableThreadSafety();
+  const int TITLES = 4;
+  const int THREADS = 4;
+  const int OBJECTS_PER_THREAD = 3;
+  const int COMPLETE = THREADS * OBJECTS_PER_THREAD;
+  Merger merger(COMPLETE);
+
+  // every thread merges objects of every title, each title is completed exactly once
+  vector<vector<TH1F*>> objects(THREADS);
+  for (int t = 0; t < THREADS; ++t) {
+    for (int i = 0; i < OBJECTS_PER_THREAD * TITLES; ++i) {
+      string title = "title" + to_string(i % TITLES);
+      auto histogram = new TH1F(("histogram" + to_string(t) + "_" + to_string(i)).c_str(), title.c_str(),
+                                NUMBER_OF_BINS, X_LOW, X_UP);
+      histogram->SetDirectory(nullptr);
+      histogram->Fill(1.0, 1 + i % TITLES);
+      objects[t].push_back(histogram);
+    }
+  }
+
+  mutex resultsMutex;
+  map<string, vector<unique_ptr<TObject>>> results;
+  vector<thread> threads;
+  for (int t = 0; t < THREADS; ++t) {
+    threads.emplace_back([&, t] {
+      for (auto histogram : objects[t]) {
+        if (TObject* merged = merger.mergeObject(histogram)) {
+          lock_guard<mutex> lock(resultsMutex);
+          results[merged->GetTitle()].emplace_back(merged);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  BOOST_REQUIRE_EQUAL(results.size(), TITLES);
+  for (int title = 0; title < TITLES; ++title) {
+    auto& merged = results["title" + to_string(title)];
+    BOOST_REQUIRE_EQUAL(merged.size(), 1);
+    auto histogram = static_cast<TH1F*>(merged.front().get());
+    BOOST_CHECK_EQUAL(histogram->GetEntries(), COMPLETE);
+    BOOST_CHECK_CLOSE(histogram->GetSumOfWeights(), COMPLETE * (1 + title), 1e-6);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,96 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE WorkQueue
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "QCMerger/WorkQueue.h"
+
+using namespace std;
+using o2::qc::WorkQueue;
+
+BOOST_AUTO_TEST_SUITE(WorkQueueTestSuite)
+
+BOOST_AUTO_TEST_CASE(pushBlocksWhileFull)
+{
+  WorkQueue<unique_ptr<int>> queue(2);
+  BOOST_CHECK(queue.push(unique_ptr<int>(new int(1))));
+  BOOST_CHECK(queue.push(unique_ptr<int>(new int(2))));
+  BOOST_CHECK(queue.isFull());
+
+  atomic<bool> pushed{ false };
+  thread producer([&] {
+    pushed = queue.push(unique_ptr<int>(new int(3)));
+  });
+  this_thread::sleep_for(chrono::milliseconds(50));
+  BOOST_CHECK(!pushed);
+
+  // the items come out in order, popping one makes room for the blocked one
+  unique_ptr<int> item;
+  for (int expected = 1; expected <= 3; ++expected) {
+    BOOST_REQUIRE(queue.pop(item));
+    BOOST_CHECK_EQUAL(*item, expected);
+    if (expected == 1) {
+      producer.join();
+      BOOST_CHECK(pushed);
+    }
+  }
+  BOOST_CHECK(!queue.isFull());
+}
+
+BOOST_AUTO_TEST_CASE(closeWakesWaitingThreads)
+{
+  WorkQueue<int> queue(1);
+  atomic<int> popped{ 0 };
+  vector<thread> consumers;
+  for (int i = 0; i < 3; ++i) {
+    consumers.emplace_back([&] {
+      int item;
+      while (queue.pop(item)) {
+        ++popped;
+      }
+    });
+  }
+
+  const int items = 100;
+  for (int i = 0; i < items; ++i) {
+    BOOST_REQUIRE(queue.push(int(i)));
+  }
+  queue.close();
+  for (auto& consumer : consumers) {
+    consumer.join();
+  }
+  BOOST_CHECK_EQUAL(popped, items);
+  BOOST_CHECK(!queue.push(0));
+}
+
+BOOST_AUTO_TEST_CASE(closedQueueIsDrained)
+{
+  WorkQueue<int> queue(4);
+  BOOST_CHECK(queue.push(7));
+  BOOST_CHECK(queue.push(8));
+  queue.close();
+
+  int item = 0;
+  BOOST_CHECK(queue.pop(item));
+  BOOST_CHECK_EQUAL(item, 7);
+  BOOST_CHECK(queue.pop(item));
+  BOOST_CHECK_EQUAL(item, 8);
+  BOOST_CHECK(!queue.pop(item));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -30,6 +30,7 @@ class ProducerDevice : public FairMQDevice
   ~ProducerDevice() override = default;
 
   static void deleteTMessage(void* data, void* hint);
+  static void deleteBuffer(void* data, void* hint);
   void executeRunLoop();
   void establishChannel(std::string type, std::string method, std::string address, std::string channelName,
                         const int bufferSize);
@@ -48,6 +49,7 @@ class ProducerDevice : public FairMQDevice
   clock_t mLastBufferOverloadTime{ 0 };
 
   void subscribeDdsCommands();
+  std::unique_ptr<FairMQMessage> createMessageForMerger(const TObject* dataObject);
   void sendDataToMerger(std::unique_ptr<FairMQMessage> request);
   bool outputLimitReached();
   int getCurrentSecond() const;
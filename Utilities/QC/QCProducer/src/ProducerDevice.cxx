@@ -11,6 +11,7 @@
 #include <chrono>
 #include <ctime>
 #include <thread>
+#include <vector>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/property_tree/json_parser.hpp>
@@ -19,6 +20,7 @@
 #include <FairMQLogger.h>
 #include <TMessage.h>
 
+#include "QCCommon/FlatHistogram.h"
 #include "QCProducer/ProducerDevice.h"
 
 using namespace std;
@@ -39,14 +41,12 @@ ProducerDevice::ProducerDevice(const char* producerId, shared_ptr<Producer>& pro
 }
 
 void ProducerDevice::deleteTMessage(void* data, void* hint) { delete static_cast<TMessage*>(hint); }
+void ProducerDevice::deleteBuffer(void* data, void* hint) { delete static_cast<vector<char>*>(hint); }
 void ProducerDevice::Run()
 {
   while (CheckCurrentState(RUNNING)) {
     TObject* newDataObject = mProducer->produceData();
-    auto* message = new TMessage(kMESS_OBJECT);
-    message->WriteObject(newDataObject);
-
-    unique_ptr<FairMQMessage> request(NewMessage(message->Buffer(), message->BufferSize(), deleteTMessage, message));
+    unique_ptr<FairMQMessage> request(createMessageForMerger(newDataObject));
 
     if (outputLimitReached()) {
       waitForLimitUnlock();
@@ -59,6 +59,22 @@ void ProducerDevice::Run()
   }
 }
 
+unique_ptr<FairMQMessage> ProducerDevice::createMessageForMerger(const TObject* dataObject)
+{
+  // each produced object holds the data of one cycle, sent as a delta with the bins changed since the last publication
+  auto flatHistogram = FlatHistogram::fromROOT(dataObject, true);
+
+  if (flatHistogram) {
+    auto* buffer = new vector<char>();
+    flatHistogram->serialize(*buffer);
+    return unique_ptr<FairMQMessage>(NewMessage(buffer->data(), buffer->size(), deleteBuffer, buffer));
+  }
+
+  auto* message = new TMessage(kMESS_OBJECT);
+  message->WriteObject(dataObject);
+  return unique_ptr<FairMQMessage>(NewMessage(message->Buffer(), message->BufferSize(), deleteTMessage, message));
+}
+
 bool ProducerDevice::outputLimitReached()
 {
   bool output;
@@ -8,6 +8,8 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
 #include <mutex>
 #include <string>
@@ -31,8 +33,11 @@ using namespace o2::qc;
 namespace
 {
 shared_ptr<Producer> producer;
-const char* outputAddress;
+string outputAddress;
+bool outputAddressKnown = false;
 mutex keyMutex;
+// time given to the merger to publish its address
+const chrono::seconds ADDRESS_PUBLICATION_TIME(60);
 }
 
 int main(int argc, char** argv)
@@ -96,14 +101,25 @@ int main(int argc, char** argv)
                 << std::endl;
 
       if (outputTopologyProperty.compare(_propertyID) == 0) {
-        outputAddress = _value.c_str();
-        keyCondition.notify_all();
+        // the merger publishes its address repeatedly, only the first value is taken
+        lock_guard<mutex> lock(keyMutex);
+        if (!outputAddressKnown) {
+          outputAddress = _value;
+          outputAddressKnown = true;
+          keyCondition.notify_all();
+        }
       }
     });
 
   service.start();
-  unique_lock<mutex> lock(keyMutex);
-  keyCondition.wait(lock);
+  {
+    unique_lock<mutex> lock(keyMutex);
+    if (!keyCondition.wait_for(lock, ADDRESS_PUBLICATION_TIME, [] { return outputAddressKnown; })) {
+      LOG(ERROR) << R"(No output address published in the DDS property ")" << outputTopologyProperty << R"(" within )"
+                 << ADDRESS_PUBLICATION_TIME.count() << " s";
+      return -1;
+    }
+  }
 
   LOG(INFO) << "Output address: " << outputAddress;
 
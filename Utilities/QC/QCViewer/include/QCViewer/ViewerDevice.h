@@ -19,6 +19,8 @@
 #include <TCanvas.h>
 #include <TList.h>
 
+#include "QCCommon/FlatHistogram.h"
+
 namespace o2
 {
 namespace qc
@@ -39,9 +41,12 @@ class ViewerDevice : public FairMQDevice
  private:
   std::unordered_map<std::string, std::shared_ptr<TCanvas>> objectsToDraw;
   std::string mDrawingOptions;
+  // histograms accumulated from the deltas sent by the merger, by title
+  std::unordered_map<std::string, std::unique_ptr<FlatHistogram>> mFlatHistograms;
 
   std::unique_ptr<FairMQMessage> receiveMessageFromMerger();
   TObject* receiveDataObjectFromMerger();
+  TObject* applyFlatHistogram(FairMQMessage& message);
   void updateCanvas(TObject* receivedObject);
 
   std::string getVmRSSUsage();
@@ -70,16 +70,40 @@ TObject* ViewerDevice::receiveDataObjectFromMerger()
   TObject* receivedObject;
   unique_ptr<FairMQMessage> request(NewMessage());
 
-  if (fChannels.at("data-in").at(0).ReceiveAsync(request) >= 0) {
+  if (fChannels.at("data-in").at(0).ReceiveAsync(request) < 0) {
+    receivedObject = nullptr;
+  } else if (FlatHistogram::isFlatHistogram(request->GetData(), request->GetSize())) {
+    receivedObject = applyFlatHistogram(*request);
+  } else {
     TMessageWrapper tm(request->GetData(), request->GetSize());
     receivedObject = static_cast<TObject*>(tm.ReadObject(tm.GetClass()));
-  } else {
-    receivedObject = nullptr;
   }
 
   return receivedObject;
 }
 
+TObject* ViewerDevice::applyFlatHistogram(FairMQMessage& message)
+{
+  auto received = FlatHistogram::deserialize(message.GetData(), message.GetSize());
+
+  if (!received) {
+    LOG(ERROR) << "Received malformed histogram from Merger device";
+    return nullptr;
+  }
+
+  // deltas are added to the histogram accumulated so far, complete histograms replace it
+  auto accumulated = mFlatHistograms.find(received->getTitle());
+
+  if (accumulated == mFlatHistograms.end()) {
+    accumulated = mFlatHistograms.emplace(received->getTitle(), move(received)).first;
+  } else if (!received->isDelta() || !accumulated->second->add(*received)) {
+    accumulated->second = move(received);
+  }
+
+  accumulated->second->setDelta(false);
+  return accumulated->second->toROOT();
+}
+
 void ViewerDevice::executeRunLoop()
 {
   ChangeState("INIT_DEVICE");
@@ -0,0 +1,69 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+//  @file   BufferPool.h
+//  @since  2026-10-19
+//  @brief  Pool of reusable output buffers for the HLT component
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace o2 {
+namespace alice_hlt {
+
+/// @class BufferPool
+/// Pool of memory buffers handed out as shared pointers. A buffer goes back
+/// to the pool when the last reference to it is released, which can happen
+/// in any thread, e.g. the one of the transport releasing a message sent
+/// without copy. Buffers released after the pool is gone are deleted.
+///
+/// The pool has to be created by std::make_shared.
+class BufferPool : public std::enable_shared_from_this<BufferPool> {
+public:
+  using Buffer = std::vector<uint8_t>;
+  using BufferPtr = std::shared_ptr<Buffer>;
+
+  /// constructor
+  /// @param maxFreeBuffers  number of released buffers kept for reuse
+  BufferPool(unsigned maxFreeBuffers = 8);
+  /// destructor
+  ~BufferPool();
+
+  /// get a buffer of at least size bytes
+  /// a free buffer is reused if possible, its size can be larger than requested
+  /// and its content is undefined
+  BufferPtr get(unsigned size);
+
+  /// number of buffers available for reuse
+  unsigned getNofFreeBuffers() const;
+
+private:
+  // copy constructor prohibited
+  BufferPool(const BufferPool&);
+  // assignment operator prohibited
+  BufferPool& operator=(const BufferPool&);
+
+  /// take back a buffer of which the last reference was released
+  void release(Buffer* buffer);
+
+  mutable std::mutex mMutex;
+  /// released buffers
+  std::vector<std::unique_ptr<Buffer>> mFreeBuffers;
+  unsigned mMaxFreeBuffers;
+};
+
+} // namespace alice_hlt
+} // namespace o2
+#endif // BUFFERPOOL_H
@@ -29,6 +29,8 @@
 
 #include "AliHLTDataTypes.h"
 #include "MessageFormat.h"
+#include "BufferPool.h"
+#include <memory>
 #include <vector>
 #include <boost/signals2.hpp>
 #include <boost/program_options.hpp>
@@ -62,10 +64,9 @@ class SystemInterface;
 ///                 calibration data from OCDB; OCDB interface needs to
 ///                 be initialized with run number
 /// --ocdb          uri of the OCDB, e.g. 'local://./OCDB'
-/// --msgsize       size of the output buffer in byte
-///                 This overrides the default behavior where output buffer
-///                 size is determined from the input size and properties
-///                 of the component
+/// --msgsize       minimum size of the output buffer in byte
+///                 By default the output buffer size is determined from the
+///                 input size and properties of the component
 /// --output-mode   mode of arranging output blocks, @see MessageFormat.h
 ///                 0  HOMER format
 ///                 1  blocks in multiple messages
@@ -127,6 +128,13 @@ public:
 
   int getEventCount() const {return mEventCount;}
 
+  /// get the buffer holding the output of the last processed event
+  /// The output descriptors of process() can point into this buffer. It is
+  /// replaced by a buffer from the pool in the next call of process(), a
+  /// reference can be kept to use the data beyond, e.g. in messages sent
+  /// without copy.
+  BufferPool::BufferPtr getOutputBuffer() const {return mOutputBuffer;}
+
 protected:
 
 private:
@@ -135,8 +143,18 @@ private:
   // assignment operator prohibited
   Component& operator=(const Component&);
 
+  /// upper limit for the scaling of the reported output size
+  static constexpr double kMaxOutputSizeScale = 16.;
+
+  /// pool of output buffers
+  std::shared_ptr<BufferPool> mBufferPool;
   /// output buffer to receive the data produced by component
-  std::vector<uint8_t> mOutputBuffer;
+  BufferPool::BufferPtr mOutputBuffer;
+  /// minimum size of the output buffer, set by option --msgsize
+  unsigned mMinOutputBufferSize;
+  /// scaling of the output size reported by the component, increased
+  /// each time the component runs out of space
+  double mOutputSizeScale;
 
   /// instance of the system interface
   SystemInterface* mpSystem;
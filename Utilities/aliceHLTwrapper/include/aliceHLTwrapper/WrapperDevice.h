@@ -87,6 +87,10 @@ private:
   /// create a new message with data buffer of specified size
   unsigned char* createMessageBuffer(unsigned size);
 
+  /// free function of messages sent without copy from the component output buffer,
+  /// hint is a heap allocated reference to the buffer
+  static void releaseOutputBuffer(void* data, void* hint);
+
   Component* mComponent;     // component instance
   std::vector<FairMQMessagePtr> mMessages; // array of output messages
 
@@ -0,0 +1,84 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//  @file   BufferPool.cxx
+//  @since  2026-10-19
+//  @brief  Pool of reusable output buffers for the HLT component
+
+#include "aliceHLTwrapper/BufferPool.h"
+
+using namespace o2::alice_hlt;
+
+BufferPool::BufferPool(unsigned maxFreeBuffers)
+  : mMutex()
+  , mFreeBuffers()
+  , mMaxFreeBuffers(maxFreeBuffers)
+{
+}
+
+BufferPool::~BufferPool()
+= default;
+
+BufferPool::BufferPtr BufferPool::get(unsigned size)
+{
+  std::unique_ptr<Buffer> buffer;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    // take the smallest buffer large enough, otherwise the largest one which
+    // is going to be extended
+    auto selected = mFreeBuffers.end();
+    for (auto it = mFreeBuffers.begin(); it != mFreeBuffers.end(); it++) {
+      if (selected == mFreeBuffers.end()) {
+        selected = it;
+      } else if ((*selected)->size() < size) {
+        if ((*it)->size() > (*selected)->size()) selected = it;
+      } else if ((*it)->size() >= size && (*it)->size() < (*selected)->size()) {
+        selected = it;
+      }
+    }
+    if (selected != mFreeBuffers.end()) {
+      buffer = std::move(*selected);
+      mFreeBuffers.erase(selected);
+    }
+  }
+  if (!buffer) {
+    buffer.reset(new Buffer);
+  }
+  // the size of a buffer never shrinks, the memory is initialized only when
+  // the buffer is extended
+  if (buffer->size() < size) {
+    buffer->resize(size);
+  }
+
+  std::weak_ptr<BufferPool> pool(shared_from_this());
+  return BufferPtr(buffer.release(), [pool](Buffer* released) {
+    auto owner = pool.lock();
+    if (owner) {
+      owner->release(released);
+    } else {
+      delete released;
+    }
+  });
+}
+
+void BufferPool::release(Buffer* buffer)
+{
+  std::unique_ptr<Buffer> released(buffer);
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mFreeBuffers.size() < mMaxFreeBuffers) {
+    mFreeBuffers.emplace_back(std::move(released));
+  }
+}
+
+unsigned BufferPool::getNofFreeBuffers() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mFreeBuffers.size();
+}
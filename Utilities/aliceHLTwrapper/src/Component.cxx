@@ -48,7 +48,10 @@ using std::vector;
 using std::stringstream;
 
 Component::Component()
-  : mOutputBuffer()
+  : mBufferPool(std::make_shared<BufferPool>())
+  , mOutputBuffer()
+  , mMinOutputBufferSize(0)
+  , mOutputSizeScale(1.)
   , mpSystem(nullptr)
   , mProcessor(kEmptyHLTComponentHandle)
   , mFormatHandler()
@@ -138,7 +141,7 @@ int Component::init(int argc, char** argv)
     case OptionKeyMsgsize: {
       unsigned size = 0;
       stringstream(varmap[OptionKeys[option]].as<string>()) >> size;
-      mOutputBuffer.resize(size);
+      mMinOutputBufferSize = size;
     } break;
     case OptionKeyOutputMode: {
       unsigned mode;
@@ -272,24 +275,23 @@ int Component::process(vector<MessageFormat::BufferDesc_t>& dataArray,
 
   // process
   evtData.fBlockCnt = inputBlocks.size();
+  unsigned usedOutputSize = 0;
   int nofTrials = 2;
   do {
     unsigned long constEventBase = 0;
     unsigned long constBlockBase = 0;
     double inputBlockMultiplier = 0.;
     mpSystem->getOutputSize(mProcessor, &constEventBase, &constBlockBase, &inputBlockMultiplier);
-    outputBufferSize = constEventBase + nofInputBlocks * constBlockBase + totalInputSize * inputBlockMultiplier;
+    outputBufferSize = mOutputSizeScale * (constEventBase + nofInputBlocks * constBlockBase + totalInputSize * inputBlockMultiplier);
     outputBufferSize+=sizeof(AliHLTComponentStatistics) + sizeof(AliHLTComponentTableEntry);
-    // take the full available buffer and increase if that
-    // is too little
-    mOutputBuffer.resize(mOutputBuffer.capacity());
-    if (mOutputBuffer.size() < outputBufferSize) {
-      mOutputBuffer.resize(outputBufferSize);
-    } else if (nofTrials < 2) {
-      // component did not update the output size
-      break;
+    if (outputBufferSize < mMinOutputBufferSize) {
+      outputBufferSize = mMinOutputBufferSize;
     }
-    outputBufferSize = mOutputBuffer.size();
+    // the buffer of the previous event can still be in use by the messages
+    // sent without copy, a new one is taken from the pool for every event
+    // and the full size of the buffer is offered to the component
+    mOutputBuffer = mBufferPool->get(outputBufferSize);
+    outputBufferSize = mOutputBuffer->size();
     outputBlockCnt = 0;
     // TODO: check if that is working with the corresponding allocation method of the
     // component environment
@@ -299,26 +301,26 @@ int Component::process(vector<MessageFormat::BufferDesc_t>& dataArray,
     pEventDoneData = nullptr;
 
     iResult = mpSystem->processEvent(mProcessor, &evtData, &inputBlocks[0], &trigData,
-                                     &mOutputBuffer[0], &outputBufferSize,
+                                     mOutputBuffer->data(), &outputBufferSize,
                                      &outputBlockCnt, &pOutputBlocks,
                                      &pEventDoneData);
-    if (outputBufferSize > 0) {
-      if (outputBufferSize > mOutputBuffer.size()) {
-        LOG(ERROR) << "FATAL: fatal error: component writing beyond buffer capacity";
-        return -EFAULT;
-      } else if (outputBufferSize < mOutputBuffer.size()) {
-        mOutputBuffer.resize(outputBufferSize);
-      }
-    } else {
-      mOutputBuffer.clear();
+    if (outputBufferSize > mOutputBuffer->size()) {
+      LOG(ERROR) << "FATAL: fatal error: component writing beyond buffer capacity";
+      return -EFAULT;
     }
+    usedOutputSize = outputBufferSize;
 
+    if (iResult == ENOSPC && mOutputSizeScale < kMaxOutputSizeScale) {
+      // the component needs more space than it reported, the larger buffer
+      // is kept for the following events to avoid processing twice
+      mOutputSizeScale *= 2;
+    }
   } while (iResult == ENOSPC && --nofTrials > 0);
 
   // prepare output
   { // keep this after removing condition to preserve formatting
-    uint8_t* pOutputBufferStart = &mOutputBuffer[0];
-    uint8_t* pOutputBufferEnd = pOutputBufferStart + mOutputBuffer.size();
+    uint8_t* pOutputBufferStart = mOutputBuffer->data();
+    uint8_t* pOutputBufferEnd = pOutputBufferStart + usedOutputSize;
     // consistency check for data blocks
     // 1) all specified data must be either inside the output buffer given
     //    to the component or in one of the input buffers
@@ -342,7 +344,7 @@ int Component::process(vector<MessageFormat::BufferDesc_t>& dataArray,
 
       // calculate the data reference
       uint8_t* pStart =
-        pOutputBlock->fPtr != nullptr ? reinterpret_cast<uint8_t*>(pOutputBlock->fPtr) : &mOutputBuffer[0];
+        pOutputBlock->fPtr != nullptr ? reinterpret_cast<uint8_t*>(pOutputBlock->fPtr) : pOutputBufferStart;
       pStart += pOutputBlock->fOffset;
       uint8_t* pEnd = pStart + pOutputBlock->fSize;
       pOutputBlock->fPtr = pStart;
@@ -374,16 +376,16 @@ int Component::process(vector<MessageFormat::BufferDesc_t>& dataArray,
     evtData.fBlockCnt=validBlocks;
 
     // create the messages
-    // TODO: for now there is an extra copy of the data, but it should be
-    // handled in place
+    // depending on the output mode, the payload descriptors can point to the
+    // output buffer, the device can send those without copy
     vector<MessageFormat::BufferDesc_t> outputMessages =
       mFormatHandler.createMessages(pOutputBlocks, validBlocks, totalPayloadSize, &evtData, cbAllocate);
     dataArray.insert(dataArray.end(), outputMessages.begin(), outputMessages.end());
   }
 
   // cleanup
-  // NOTE: don't cleanup mOutputBuffer as the data is going to be used outside the class
-  // until released.
+  // NOTE: don't release mOutputBuffer as the data is going to be used outside the class
+  // until the next event.
   inputBlocks.clear();
   outputBlockCnt = 0;
   if (pOutputBlocks) delete[] pOutputBlocks;
@@ -352,16 +352,16 @@ vector<MessageFormat::BufferDesc_t> MessageFormat::createMessages(const AliHLTCo
     } else {
       maxBufferSize += sizeof(AliHLTComponentEventData) + count * sizeof(AliHLTComponentBlockData);
     }
-    if (mDataBuffer.size() < position + maxBufferSize) {
+    if (cbAllocate == nullptr && mDataBuffer.size() < position + maxBufferSize) {
       // make the target in the internal buffer, for simplicity data is copied
       // to a new buffer, a memmove would be possible to make room for block
       // descriptors
       // resize to the full size before using individual chunks of
       // this buffer to ensure, that all pointers are valid at the end.
+      // Not needed if the targets are allocated by the callback
       mDataBuffer.resize(position + maxBufferSize);
     }
-    auto pTarget=&mDataBuffer[position];
-    pTarget = nullptr;
+    uint8_t* pTarget = nullptr;
     if (mOutputMode == kOutputModeO2 && mHeartbeatHeader) {
       // add additional heartbeat envelope block at the beginning
       // data header
@@ -456,7 +456,8 @@ vector<MessageFormat::BufferDesc_t> MessageFormat::createMessages(const AliHLTCo
           offset = 0;
           if (mHeartbeatHeader.headerWord == 0) {
             // no heartbeat information availalbe, send the buffer
-            // as it is
+            // as it is, the descriptor refers to the original block
+            // payload which can be sent without copy
             mMessages.emplace_back(pData, pOutputBlock->fSize);
           } else {
             // make the heartbeat frame
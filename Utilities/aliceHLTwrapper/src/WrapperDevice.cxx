@@ -27,6 +27,7 @@
 
 #include "aliceHLTwrapper/WrapperDevice.h"
 #include "aliceHLTwrapper/Component.h"
+#include "aliceHLTwrapper/BufferPool.h"
 #include <FairMQParts.h>
 #include <FairMQLogger.h>
 #include <FairMQPoller.h>
@@ -266,25 +267,45 @@ void WrapperDevice::Run()
         LOG(ERROR) << "component processing failed with error code " << iResult;
       }
 
-      // build messages from output data
+      // build messages from output data, one part per buffer descriptor
+      FairMQParts outputParts;
       if (dataArray.size() > 0) {
         if (mVerbosity > 2) {
           LOG(INFO) << "processing " << dataArray.size() << " buffer(s)";
         }
+        // the output buffer of the component stays valid as long as it is
+        // referenced by the messages
+        auto outputBuffer = mComponent->getOutputBuffer();
+        const uint8_t* outputBufferStart = outputBuffer ? outputBuffer->data() : nullptr;
+        const uint8_t* outputBufferEnd = outputBuffer ? outputBufferStart + outputBuffer->size() : nullptr;
+        // the pre-allocated messages are in the order of the buffer descriptors
+        auto nextPremsg = begin(mMessages);
         for (auto opayload : dataArray) {
-          FairMQMessage* omsg=nullptr;
+          FairMQMessagePtr omsg;
           // loop over pre-allocated messages
-          for (auto premsg = begin(mMessages); premsg != end(mMessages); premsg++) {
+          for (auto premsg = nextPremsg; premsg != end(mMessages); premsg++) {
             if ((*premsg)->GetData() == opayload.mP &&
                 (*premsg)->GetSize() == opayload.mSize) {
-              omsg=(*premsg).get();
+              omsg = move(*premsg);
+              nextPremsg = premsg + 1;
               if (mVerbosity > 2) {
                 LOG(DEBUG) << "using pre-allocated message of size " << opayload.mSize;
               }
               break;
             }
           }
-          if (omsg==nullptr) {
+          if (!omsg && opayload.mSize > 0 && opayload.mP >= outputBufferStart &&
+              opayload.mP + opayload.mSize <= outputBufferEnd) {
+            // data in the output buffer of the component is sent without copy
+            omsg = NewMessage(opayload.mP, opayload.mSize, releaseOutputBuffer,
+                              new BufferPool::BufferPtr(outputBuffer));
+            if (mVerbosity > 2) {
+              LOG(DEBUG) << "scheduling output buffer block of size " << opayload.mSize;
+            }
+          }
+          if (!omsg) {
+            // the data is somewhere else, e.g. forwarded from the input messages
+            // which are released after processing
             FairMQMessagePtr msg = NewMessage(opayload.mSize);
             if (msg.get()) {
               if (msg->GetSize() < opayload.mSize) {
@@ -296,30 +317,27 @@ void WrapperDevice::Run()
               }
               uint8_t* pTarget = reinterpret_cast<uint8_t*>(msg->GetData());
               memcpy(pTarget, opayload.mP, opayload.mSize);
-              mMessages.emplace_back(move(msg));
+              omsg = move(msg);
             } else {
               if (errorCount == maxError && errorCount++ > 0)
                 LOG(ERROR) << "persistent error, suppressing further output";
               else if (errorCount++ < maxError)
                 LOG(ERROR) << "can not get output message from framework";
               iResult = -ENOMSG;
+              continue;
             }
           }
+          outputParts.AddPart(move(omsg));
         }
       }
+      mMessages.clear();
 
-      if (mMessages.size()>0) {
+      if (outputParts.Size() > 0) {
         if (fChannels.find("data-out") != fChannels.end() && fChannels["data-out"].size() > 0) {
-          // TODO: request FairMQParts helper function to set vector
-          // of messages
-          FairMQParts outputParts;
-          for (auto & msg : mMessages) {
-            outputParts.AddPart(std::move(msg));
-          }
-          Send(outputParts, "data-out", 0);
           if (mVerbosity > 2) {
-            LOG(DEBUG) << "sending multipart message with " << mMessages.size() << " parts";
+            LOG(DEBUG) << "sending multipart message with " << outputParts.Size() << " parts";
           }
+          Send(outputParts, "data-out", 0);
         } else {
           if (errorCount == maxError && errorCount++ > 0)
             LOG(ERROR) << "persistent error, suppressing further output";
@@ -327,7 +345,6 @@ void WrapperDevice::Run()
             LOG(ERROR) << "no output slot available (" << (fChannels.find("data-out") == fChannels.end() ? "uninitialized" : "0 slots")
                        << ")";
         }
-        mMessages.clear();
       }
     }
 
@@ -340,6 +357,12 @@ void WrapperDevice::Run()
   }
 }
 
+void WrapperDevice::releaseOutputBuffer(void* /*data*/, void* hint)
+{
+  /// release the reference to the output buffer held by a message
+  delete reinterpret_cast<BufferPool::BufferPtr*>(hint);
+}
+
 unsigned char* WrapperDevice::createMessageBuffer(unsigned size)
 {
   /// create a new message with data buffer of specified size
@@ -0,0 +1,77 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test aliceHLTwrapper BufferPool
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <thread>
+#include <vector>
+#include "aliceHLTwrapper/BufferPool.h"
+
+namespace o2 {
+namespace alice_hlt {
+  BOOST_AUTO_TEST_CASE(test_BufferPool_reuse)
+  {
+    auto pool = std::make_shared<BufferPool>(2);
+    auto buffer = pool->get(100);
+    BOOST_REQUIRE(buffer);
+    BOOST_CHECK(buffer->size() >= 100);
+    const uint8_t* data = buffer->data();
+
+    // a buffer still in use is not handed out again
+    auto other = pool->get(100);
+    BOOST_CHECK(other->data() != data);
+    BOOST_CHECK(pool->getNofFreeBuffers() == 0);
+
+    // released buffers are reused, the smallest large enough first
+    buffer.reset();
+    other.reset();
+    BOOST_CHECK(pool->getNofFreeBuffers() == 2);
+    auto large = pool->get(1000);
+    BOOST_CHECK(large->size() >= 1000);
+    auto small = pool->get(50);
+    BOOST_CHECK(small->size() == 100);
+    BOOST_CHECK(pool->getNofFreeBuffers() == 0);
+
+    // no more than the maximum number of free buffers is kept
+    auto extra = pool->get(10);
+    large.reset();
+    small.reset();
+    extra.reset();
+    BOOST_CHECK(pool->getNofFreeBuffers() == 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(test_BufferPool_lifetime)
+  {
+    auto pool = std::make_shared<BufferPool>();
+    auto buffer = pool->get(10);
+    // buffers can outlive the pool
+    pool.reset();
+    (*buffer)[0] = 1;
+    buffer.reset();
+  }
+
+  BOOST_AUTO_TEST_CASE(test_BufferPool_threads)
+  {
+    // buffers are released in other threads, like messages sent without copy
+    auto pool = std::make_shared<BufferPool>(4);
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < 100; i++) {
+      auto buffer = pool->get(64 * (i % 8 + 1));
+      threads.emplace_back([buffer]() mutable { buffer.reset(); });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    BOOST_CHECK(pool->getNofFreeBuffers() <= 4);
+  }
+} // namespace alice_hlt
+} // namespace o2
@@ -194,6 +194,7 @@ o2_define_bucket(
     DEPENDENCIES
     O2Device_bucket
     O2Device
+    Boost::unit_test_framework
 )
 
 o2_define_bucket(
@@ -377,6 +378,7 @@ o2_define_bucket(
     root_physics_bucket
     common_math_bucket
     detectors_base_bucket
+    DetectorsBase
     RIO
 
     INCLUDE_DIRECTORIES
@@ -429,6 +431,8 @@ o2_define_bucket(
 
     DEPENDENCIES
     dl
+    pthread
+    Boost::unit_test_framework
     root_base_bucket
     VMC
     EG
@@ -958,10 +962,23 @@ o2_define_bucket(
 
 o2_define_bucket(
     NAME
-    trd_simulation_bucket
+    trd_base_bucket
 
     DEPENDENCIES
     emcal_base_bucket
+    detectors_base_bucket
+    DetectorsBase
+
+    INCLUDE_DIRECTORIES
+    ${CMAKE_SOURCE_DIR}/Detectors/Base/include
+)
+
+o2_define_bucket(
+    NAME
+    trd_simulation_bucket
+
+    DEPENDENCIES
+    trd_base_bucket
     root_base_bucket
     fairroot_geom
     RIO